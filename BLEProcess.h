@@ -23,14 +23,23 @@
 #include "events/EventQueue.h"
 #include "platform/Callback.h"
 #include "platform/NonCopyable.h"
+#include "rtos/Kernel.h"
 
 #include "ble/BLE.h"
 #include "ble/Gap.h"
+#include "ble/GattServer.h"
 #include "ble/GapAdvertisingParams.h"
 #include "ble/GapAdvertisingData.h"
 #include "ble/FunctionPointerWithContext.h"
 #include "ble/gap/Types.h"
 #include "ble/gap/Events.h"
+#include "ble/gap/AdvertisingDataBuilder.h"
+
+#include "trace.h"
+#include "startup_gate.h"
+#include "connection_table.h"
+#include "link_tuner.h"
+#include "reconnect_advertiser.h"
 
 /** Services */
 #include "DeviceInformationService.h"
@@ -43,10 +52,20 @@
  * Handle initialization adn shutdown of the BLE Instance.
  *
  * Setup advertising payload and manage advertising state.
- * Delegate to GattClientProcess once the connection is established.
+ * Up to BLE_MAX_CONNECTIONS centrals can be connected at the same time,
+ * advertising continues while there is room for another one. The state of
+ * each connection is kept in a ConnectionTable.
+ *
+ * Bonded centrals that disconnect get a burst of fast, whitelisted
+ * advertising to come back (ReconnectAdvertiser). The security manager is
+ * initialized once, its database file commits itself (see BondStore).
+ * Advertising does not wait for it: with defer_security_until_storage()
+ * the security manager and privacy are set up once storage_ready() says
+ * the database can be opened.
  */
 class BLEProcess : private mbed::NonCopyable<BLEProcess>,
 				   public ble::Gap::EventHandler,
+				   public GattServer::EventHandler,
 				   public SecurityManager::EventHandler {
 public:
     /**
@@ -57,11 +76,19 @@ public:
     BLEProcess(events::EventQueue &event_queue, BLE &ble_interface) :
         event_queue(event_queue),
         ble_interface(ble_interface),
-		connection_handle(),
-		connected(false),
+		connections(),
+		att_mtu(BLE_DEFAULT_ATT_MTU),
+		boot_to_advertising_ms(0),
+		broadcasting(false),
+		link_tuner(event_queue, ble_interface, connections),
+		reconnect(event_queue, ble_interface),
         post_init_cb(),
+		att_mtu_cb(),
+		security_gate(mbed::callback(this, &BLEProcess::init_security)),
 		sm_file_name(NULL)
 		{
+    	reconnect.on_burst_end(mbed::callback(this, &BLEProcess::on_reconnect_burst_end));
+    	security_gate.require(SECURITY_NEEDS_STACK);
     }
 
     virtual ~BLEProcess()
@@ -80,6 +107,44 @@ public:
         post_init_cb = cb;
     }
 
+    /**
+     * Subscription to changes of the ATT MTU usable on every connection
+     *
+     * @param[in] cb Called with the smallest ATT MTU of the connections when
+     * it changes, the default MTU once every central disconnected
+     */
+    void on_att_mtu_change(mbed::Callback<void(uint16_t)> cb)
+    {
+        att_mtu_cb = cb;
+    }
+
+    /**
+     * Let the filesystem come up while BLE starts advertising, call before start()
+     *
+     * The security manager opens its database file, so it (and with it
+     * pairing, bonding and privacy) waits for storage_ready(). Centrals that
+     * connect earlier can use the services but not pair yet.
+     */
+    void defer_security_until_storage(void)
+    {
+        security_gate.require(SECURITY_NEEDS_STORAGE);
+    }
+
+    /**
+     * The filesystem is up, call on the event queue
+     *
+     * @param[in] persistent false if there is no filesystem, bonds are then kept in RAM
+     */
+    void storage_ready(bool persistent)
+    {
+        if (!persistent) {
+        	printf("ble: no filesystem, bonding information will not persist\r\n");
+        	sm_file_name = NULL;
+        }
+
+        security_gate.satisfy(SECURITY_NEEDS_STORAGE);
+    }
+
     /**
      * Initialize the ble interface, configure it and start advertising.
      * @param[in] sm_file File name of where to store security manager data (for persistent pairing, if supported)
@@ -94,6 +159,13 @@ public:
         }
 
         ble_interface.gap().setEventHandler(this);
+        ble_interface.gattServer().setEventHandler(this);
+
+        // Single slots, services attach to ConnectionTable::on_subscriptions_changed()
+        ble_interface.gattServer().onUpdatesEnabled(
+            FunctionPointerWithContext<GattAttribute::Handle_t>(this, &BLEProcess::on_cccd_written));
+        ble_interface.gattServer().onUpdatesDisabled(
+            FunctionPointerWithContext<GattAttribute::Handle_t>(this, &BLEProcess::on_cccd_written));
 
         ble_interface.onEventsToProcess(
             makeFunctionPointer(this, &BLEProcess::schedule_ble_events)
@@ -114,20 +186,33 @@ public:
     }
 
     /**
-     * Disconnect from existing connection
+     * Disconnect from every connected central
      */
     void disconnect(void) {
-    	if(connected) {
-    		ble_error_t error = ble_interface.gap().disconnect(connection_handle,
-    				ble::local_disconnection_reason_t(ble::local_disconnection_reason_t::USER_TERMINATION));
-    		if(error) {
-    			printf("ble: error when disconnecting - 0x%X\n", error);
-    		} else {
-    			printf("ble: disconnecting from central...\n");
+    	for(int i = 0; i < ConnectionTable::get_capacity(); i++) {
+    		if(connections.at(i).in_use) {
+    			disconnect(connections.at(i).handle);
     		}
     	}
     }
 
+    /**
+     * Disconnect from one central
+     */
+    void disconnect(ble::connection_handle_t handle) {
+    	if(connections.find(handle) == NULL) {
+    		return;
+    	}
+
+    	ble_error_t error = ble_interface.gap().disconnect(handle,
+    			ble::local_disconnection_reason_t(ble::local_disconnection_reason_t::USER_TERMINATION));
+    	if(error) {
+    		printf("ble: error when disconnecting %u - 0x%X\n", handle, error);
+    	} else {
+    		printf("ble: disconnecting from central %u...\n", handle);
+    	}
+    }
+
     /**
      * Purge bonding/pairing information
      */
@@ -147,18 +232,109 @@ public:
         }
     }
 
+    /** At least one central is connected */
     bool is_connected(void) {
-    	return connected;
+    	return connections.get_count() != 0;
+    }
+
+    bool is_connected(ble::connection_handle_t handle) {
+    	return connections.find(handle) != NULL;
+    }
+
+    int get_connection_count(void) {
+    	return connections.get_count();
+    }
+
+    /** Per-connection state, BLE thread only */
+    ConnectionTable& get_connections(void) {
+    	return connections;
     }
 
+    /** Smallest ATT MTU negotiated on the connections */
+    uint16_t get_att_mtu(void) {
+    	return att_mtu;
+    }
+
+    /** ATT MTU negotiated on one connection, the default MTU if it is unknown */
+    uint16_t get_att_mtu(ble::connection_handle_t handle) {
+    	ble_connection_t* connection = connections.find(handle);
+    	return (connection != NULL)? connection->att_mtu : BLE_DEFAULT_ATT_MTU;
+    }
+
+    /**
+     * Carry sensor data in the legacy advertising payload (see SensorBroadcast)
+     *
+     * The name and appearance move to the scan response to make room for it.
+     * @param[in] data Manufacturer specific data (company ID first), NULL to
+     * restore the default payload
+     * @retval false if the payload could not be set
+     */
+    bool set_broadcast_data(const uint8_t* data, size_t len)
+    {
+    	if (!ble_interface.hasInitialized()) {
+    		return false;
+    	}
+
+    	if (data == NULL || len == 0) {
+    		broadcasting = false;
+    		return set_advertising_data();
+    	}
+
+    	uint8_t buffer[ble::LEGACY_ADVERTISING_MAX_SIZE];
+    	ble::AdvertisingDataBuilder builder(buffer, sizeof(buffer));
+    	builder.setFlags();
+    	ble_error_t error = builder.setManufacturerSpecificData(mbed::make_const_Span(data, len));
+    	if (!error) {
+    		error = ble_interface.gap().setAdvertisingPayload(ble::LEGACY_ADVERTISING_HANDLE,
+    				builder.getAdvertisingData());
+    	}
+    	if (error) {
+    		printf("ble: broadcast payload update failed - 0x%X\r\n", error);
+    		return false;
+    	}
+
+    	if (!broadcasting) {
+    		broadcasting = true;
+    		set_scan_response();
+    	}
+    	return true;
+    }
+
+    /** Milliseconds from boot until advertising first started, 0 until then */
+    uint32_t get_boot_to_advertising_ms(void) {
+    	return boot_to_advertising_ms;
+    }
+
+    /** Connection parameter policy, BLE thread only (except print_stats) */
+    LinkTuner& get_link_tuner(void) {
+    	return link_tuner;
+    }
+
+    /** Reconnection of bonded centrals, BLE thread only (except print_stats) */
+    ReconnectAdvertiser& get_reconnect_advertiser(void) {
+    	return reconnect;
+    }
+
+    /** Called when the last central disconnected */
     ep::CallChain<>& on_disconnect_event(void) {
     	return on_disconnect_callchain;
     }
 
+    /** Called when the first central connected */
     ep::CallChain<>& on_connect_event(void) {
     	return on_connect_callchain;
     }
 
+    /** Called with the handle of every connection that went down */
+    ep::CallChain<ble::connection_handle_t>& on_connection_closed(void) {
+    	return on_connection_closed_callchain;
+    }
+
+    /** Called with the handle of every new connection */
+    ep::CallChain<ble::connection_handle_t>& on_connection_opened(void) {
+    	return on_connection_opened_callchain;
+    }
+
 private:
 
     /**
@@ -166,7 +342,15 @@ private:
      */
     void schedule_ble_events(BLE::OnEventsToProcessCallbackContext *event)
     {
-        event_queue.call(mbed::callback(&event->ble, &BLE::processEvents));
+        TRACE_INSTANT(TRACE_EVENT_BLE_SCHEDULE, 0);
+        event_queue.call(mbed::callback(this, &BLEProcess::process_ble_events));
+    }
+
+    void process_ble_events(void)
+    {
+        TRACE_BEGIN(TRACE_EVENT_BLE_PROCESS, 0);
+        ble_interface.processEvents();
+        TRACE_END(TRACE_EVENT_BLE_PROCESS, 0);
     }
 
     void init_security_manager(void) {
@@ -218,20 +402,7 @@ private:
         }
         printf("Ble instance initialized\r\n");
 
-        init_security_manager();
-
-        /* Enable privacy */
-        ble_error_t error = event->ble.gap().enablePrivacy(true);
-        if(error) {
-        	printf("ble: error enabling privacy\r\n");
-        }
-
-        Gap::PeripheralPrivacyConfiguration_t config = {
-        		/* use_non_resolvable_random_address */ false,
-				Gap::PeripheralPrivacyConfiguration_t::DO_NOT_RESOLVE
-        };
-        event->ble.gap().setPeripheralPrivacyConfiguration(&config);
-
+        // Advertise first, only the security manager waits for storage
         if (!set_advertising_parameters()) {
             return;
         }
@@ -244,33 +415,168 @@ private:
             return;
         }
 
+        security_gate.satisfy(SECURITY_NEEDS_STACK);
+
         if (post_init_cb) {
             post_init_cb(ble_interface);
         }
     }
 
+    /** Security manager and privacy, once both the stack and storage are ready (security_gate) */
+    void init_security(void)
+    {
+        init_security_manager();
+
+        /* Enable privacy */
+        Gap &gap = ble_interface.gap();
+        ble_error_t error = gap.enablePrivacy(true);
+        if(error) {
+        	printf("ble: error enabling privacy\r\n");
+        }
+
+        Gap::PeripheralPrivacyConfiguration_t config = {
+        		/* use_non_resolvable_random_address */ false,
+				Gap::PeripheralPrivacyConfiguration_t::DO_NOT_RESOLVE
+        };
+        gap.setPeripheralPrivacyConfiguration(&config);
+
+        // The private address only applies to advertising started from now on
+        if (gap.isAdvertisingActive(ble::LEGACY_ADVERTISING_HANDLE)) {
+        	gap.stopAdvertising(ble::LEGACY_ADVERTISING_HANDLE);
+        	start_advertising();
+        }
+    }
+
     /** Override Gap event handler */
     void onConnectionComplete(const ble::ConnectionCompleteEvent &event)
     {
-    	connection_handle = event.getConnectionHandle();
-        connected = true;
-        printf("Connected.\r\n");
-        on_connect_callchain.call(); // Execute subscribed application handlers
+    	ble::connection_handle_t handle = event.getConnectionHandle();
+    	TRACE_BEGIN(TRACE_EVENT_BLE_CONNECT, handle);
+
+    	if(event.getStatus() != BLE_ERROR_NONE) {
+    		printf("ble: connection failed - 0x%X\r\n", event.getStatus());
+    		start_advertising();
+    		TRACE_END(TRACE_EVENT_BLE_CONNECT, handle);
+    		return;
+    	}
+
+    	if(connections.add(event) == NULL) {
+    		// Advertising stops once the table is full, should not happen
+    		printf("ble: no room for connection %u\r\n", handle);
+    		disconnect_unknown(handle);
+    		TRACE_END(TRACE_EVENT_BLE_CONNECT, handle);
+    		return;
+    	}
+
+        printf("Connected (%u, %d of %d).\r\n", handle, connections.get_count(),
+        		ConnectionTable::get_capacity());
+        link_tuner.on_connect(event);
+        reconnect.on_connect(handle);
+
+        // The controller stopped advertising, keep going while another central fits
+        if(!connections.is_full()) {
+        	start_advertising();
+        }
+
+        // Execute subscribed application handlers
+        on_connection_opened_callchain.call(handle);
+        if(connections.get_count() == 1) {
+        	on_connect_callchain.call();
+        }
+        TRACE_END(TRACE_EVENT_BLE_CONNECT, handle);
     }
 
     void onDisconnectionComplete(const ble::DisconnectionCompleteEvent &event)
     {
-    	BLE& ble = BLE::Instance();
-    	// Currently, this allows the security manager to close
-    	// the security database file and flush it to flash...
-    	ble.securityManager().reset();
-    	connected = false;
-        printf("Disconnected.\r\n");
-        // Reinitialize the security manager
-        init_security_manager();
+    	ble::connection_handle_t handle = event.getConnectionHandle();
+    	TRACE_BEGIN(TRACE_EVENT_BLE_DISCONNECT, handle);
+
+    	bool bonded = false;
+    	ble_connection_t* connection = connections.find(handle);
+    	if(connection != NULL) {
+    		bonded = connection->security == CONNECTION_SECURITY_ENCRYPTED ||
+    				connection->security == CONNECTION_SECURITY_AUTHENTICATED;
+    	}
+
+    	connections.remove(handle);
+        printf("Disconnected (%u, %d left).\r\n", handle, connections.get_count());
+        link_tuner.on_disconnect(handle);
+        reconnect.on_disconnect(handle);
+        update_att_mtu();
+
+        if(bonded) {
+        	reconnect.on_bonded_disconnect();
+        }
         start_advertising();
 
-        on_disconnect_callchain.call(); // Execute subscribed application handlers
+        // Execute subscribed application handlers
+        on_connection_closed_callchain.call(handle);
+        if(connections.get_count() == 0) {
+        	on_disconnect_callchain.call();
+        }
+        TRACE_END(TRACE_EVENT_BLE_DISCONNECT, handle);
+    }
+
+    /** Back to the default advertising parameters */
+    void on_reconnect_burst_end(void)
+    {
+    	start_advertising();
+    }
+
+    /** Drop a connection the table has no room for */
+    void disconnect_unknown(ble::connection_handle_t handle)
+    {
+    	ble_interface.gap().disconnect(handle,
+    			ble::local_disconnection_reason_t(ble::local_disconnection_reason_t::LOW_RESOURCES));
+    }
+
+    void onConnectionParametersUpdateComplete(const ble::ConnectionParametersUpdateCompleteEvent &event)
+    {
+    	link_tuner.on_parameters_updated(event);
+    }
+
+    void onPhyUpdateComplete(ble_error_t status, ble::connection_handle_t connectionHandle,
+    		ble::phy_t txPhy, ble::phy_t rxPhy)
+    {
+    	link_tuner.on_phy_updated(status, connectionHandle, txPhy, rxPhy);
+    }
+
+    void onDataLengthChange(ble::connection_handle_t connectionHandle, uint16_t txSize, uint16_t rxSize)
+    {
+    	link_tuner.on_data_length_changed(connectionHandle, txSize, rxSize);
+    }
+
+    /** Override GattServer event handler */
+    void onAttMtuChange(ble::connection_handle_t connectionHandle, uint16_t attMtuSize)
+    {
+    	printf("ble: ATT MTU of %u changed to %u\r\n", connectionHandle, attMtuSize);
+    	link_tuner.on_att_mtu_changed(connectionHandle, attMtuSize);
+
+    	ble_connection_t* connection = connections.find(connectionHandle);
+    	if(connection != NULL) {
+    		connection->att_mtu = attMtuSize;
+    	}
+    	update_att_mtu();
+    }
+
+    /** A client enabled or disabled updates of a characteristic */
+    void on_cccd_written(GattAttribute::Handle_t attribute)
+    {
+    	connections.refresh_subscriptions(ble_interface.gattServer(), attribute);
+    }
+
+    /** Report the MTU every connection can use when it changes */
+    void update_att_mtu(void)
+    {
+    	uint16_t mtu = connections.get_min_att_mtu();
+    	if(mtu == att_mtu) {
+    		return;
+    	}
+
+    	att_mtu = mtu;
+    	if(att_mtu_cb) {
+    		att_mtu_cb(att_mtu);
+    	}
     }
 
     void print_address(BLEProtocol::Address_t& addr) {
@@ -282,6 +588,7 @@ private:
 
     void whitelistFromBondTable(Gap::Whitelist_t* whitelist) {
     	printf("ble: whitelist size - %d\r\n", whitelist->size);
+    	reconnect.set_whitelist(*whitelist);
     	for(int i = 0; i < whitelist->size; i++) {
     		printf("\taddress:");
     		print_address(whitelist->addresses[i]);
@@ -293,6 +600,10 @@ private:
     {
         Gap &gap = ble_interface.gap();
 
+        if (connections.is_full() || gap.isAdvertisingActive(ble::LEGACY_ADVERTISING_HANDLE)) {
+            return true;
+        }
+
         /* Start advertising the set */
         ble_error_t error = gap.startAdvertising(ble::LEGACY_ADVERTISING_HANDLE);
 
@@ -301,25 +612,17 @@ private:
             return false;
         } else {
             printf("Advertising started.\r\n");
+            if (boot_to_advertising_ms == 0) {
+            	boot_to_advertising_ms = (uint32_t) rtos::Kernel::get_ms_count();
+            	printf("ble: advertising %lu ms after boot\r\n", boot_to_advertising_ms);
+            }
             return true;
         }
     }
 
     bool set_advertising_parameters()
     {
-        Gap &gap = ble_interface.gap();
-
-        ble_error_t error = gap.setAdvertisingParameters(
-            ble::LEGACY_ADVERTISING_HANDLE,
-            ble::AdvertisingParameters()
-        );
-
-        if (error) {
-            printf("Gap::setAdvertisingParameters() failed with error %d\r\n", error);
-            return false;
-        }
-
-        return true;
+        return reconnect.set_default_parameters();
     }
 
     bool set_advertising_data()
@@ -342,13 +645,7 @@ private:
             return false;
         }
 
-        error = gap.setAdvertisingScanResponse(ble::LEGACY_ADVERTISING_HANDLE,
-        		ble::AdvertisingDataSimpleBuilder<ble::LEGACY_ADVERTISING_MAX_SIZE>()
-//				.setLocalService(BME680_SERVICE_UUID)
-				.getAdvertisingData());
-
-        if (error) {
-            printf("Gap::setAdvertisingScanResponse() failed with error %d\r\n", error);
+        if (!set_scan_response()) {
             return false;
         }
 
@@ -365,20 +662,55 @@ private:
 
     }
 
+    /** Empty while the name is in the advertising payload, the name otherwise */
+    bool set_scan_response()
+    {
+        ble_error_t error;
+        if (broadcasting) {
+            error = ble_interface.gap().setAdvertisingScanResponse(ble::LEGACY_ADVERTISING_HANDLE,
+                    ble::AdvertisingDataSimpleBuilder<ble::LEGACY_ADVERTISING_MAX_SIZE>()
+                    .setName("EP Agora")
+                    .setAppearance(ble::adv_data_appearance_t::GENERIC_TAG)
+                    .getAdvertisingData());
+        } else {
+            error = ble_interface.gap().setAdvertisingScanResponse(ble::LEGACY_ADVERTISING_HANDLE,
+                    ble::AdvertisingDataSimpleBuilder<ble::LEGACY_ADVERTISING_MAX_SIZE>()
+//                    .setLocalService(BME680_SERVICE_UUID)
+                    .getAdvertisingData());
+        }
+
+        if (error) {
+            printf("Gap::setAdvertisingScanResponse() failed with error %d\r\n", error);
+            return false;
+        }
+
+        return true;
+    }
+
     /** Override SecurityManagerEventHandler */
     void pairingRequest(ble::connection_handle_t connectionHandle)
     {
     	BLE& ble = BLE::Instance();
-    	printf("ble: pairing requested\n");
+    	printf("ble: pairing requested by %u\n", connectionHandle);
+    	set_security(connectionHandle, CONNECTION_SECURITY_PAIRING);
     	ble.securityManager().acceptPairingRequest(connectionHandle);
     }
 
     virtual void pairingResult(ble::connection_handle_t connectionHandle,
     		SecurityManager::SecurityCompletionStatus_t result) {
+    	ble_connection_t* connection = connections.find(connectionHandle);
     	if(result != SecurityManager::SecurityCompletionStatus_t::SEC_STATUS_SUCCESS) {
-    		printf("ble: pairing failed - %d\r\n", result);
+    		printf("ble: pairing with %u failed - %d\r\n", connectionHandle, result);
+    		if(connection != NULL && connection->security == CONNECTION_SECURITY_PAIRING) {
+    			connection->security = CONNECTION_SECURITY_NONE;
+    		}
     	} else {
-    		printf("ble: pairing succeeded\r\n");
+    		printf("ble: pairing with %u succeeded\r\n", connectionHandle);
+    		if(connection != NULL) {
+    			connection->paired = true;
+    		}
+    		// Whitelist the new bond for the next reconnect burst
+    		ble_interface.securityManager().generateWhitelistFromBondTable(&whitelist);
     	}
 
 	}
@@ -387,8 +719,32 @@ private:
     void linkEncryptionResult(
     		ble::connection_handle_t connectionHandle, ble::link_encryption_t result)
     {
-    	printf("ble: link %s\r\n",
-    			(result == ble::link_encryption_t::ENCRYPTED? "ENCRYPTED" : "not encrypted!"));
+    	printf("ble: link %u %s\r\n", connectionHandle,
+    			(result == ble::link_encryption_t::NOT_ENCRYPTED? "not encrypted!" : "ENCRYPTED"));
+
+    	// Without a pairing request the stored keys were used, a bonded central is back
+    	ble_connection_t* connection = connections.find(connectionHandle);
+    	bool bonded = connection != NULL && connection->security != CONNECTION_SECURITY_PAIRING;
+
+    	switch(result.value()) {
+    	case ble::link_encryption_t::ENCRYPTED:
+    		set_security(connectionHandle, CONNECTION_SECURITY_ENCRYPTED);
+    		reconnect.on_encrypted(connectionHandle, bonded);
+    		break;
+    	case ble::link_encryption_t::ENCRYPTED_WITH_MITM:
+    	case ble::link_encryption_t::ENCRYPTED_WITH_SC_AND_MITM:
+    		set_security(connectionHandle, CONNECTION_SECURITY_AUTHENTICATED);
+    		reconnect.on_encrypted(connectionHandle, bonded);
+    		break;
+    	case ble::link_encryption_t::ENCRYPTION_IN_PROGRESS:
+    		break;
+    	default:
+    		set_security(connectionHandle, CONNECTION_SECURITY_NONE);
+    		break;
+    	}
+
+    	// Restored CCCDs of a bonded central take effect now
+    	connections.refresh_all_subscriptions(ble_interface.gattServer());
 
     	BLE& ble = BLE::Instance();
     	printf("ble: checking whitelist\r\n");
@@ -397,11 +753,28 @@ private:
 
     }
 
+    void set_security(ble::connection_handle_t handle, connection_security_t security)
+    {
+    	ble_connection_t* connection = connections.find(handle);
+    	if(connection != NULL) {
+    		connection->security = security;
+    	}
+    }
+
     events::EventQueue &event_queue;
     BLE &ble_interface;
-    ble::connection_handle_t connection_handle;
-    bool connected;
+    ConnectionTable connections;
+    uint16_t att_mtu;
+    uint32_t boot_to_advertising_ms;
+    bool broadcasting;
+    LinkTuner link_tuner;
+    ReconnectAdvertiser reconnect;
     mbed::Callback<void(BLE&)> post_init_cb;
+    mbed::Callback<void(uint16_t)> att_mtu_cb;
+    /** Prerequisites of init_security() */
+    static const uint32_t SECURITY_NEEDS_STACK = (1 << 0);
+    static const uint32_t SECURITY_NEEDS_STORAGE = (1 << 1);	/** Only after defer_security_until_storage() */
+    StartupGate security_gate;
     const char* sm_file_name;
     BLEProtocol::Address_t whitelist_addrs[5];
     Gap::Whitelist_t whitelist;
@@ -409,6 +782,8 @@ private:
     // Callchain for connection & disconnection events
     ep::CallChain<> on_connect_callchain;
     ep::CallChain<> on_disconnect_callchain;
+    ep::CallChain<ble::connection_handle_t> on_connection_opened_callchain;
+    ep::CallChain<ble::connection_handle_t> on_connection_closed_callchain;
 
 };
 
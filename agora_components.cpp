@@ -8,6 +8,8 @@
 #include "agora_components.h"
 
 mbed::I2C sensor_i2c(PIN_NAME_SDA, PIN_NAME_SCL);
+MbedI2CBus sensor_i2c_bus(sensor_i2c);
+I2CTransactionEngine sensor_i2c_engine(sensor_i2c_bus);
 
 mbed::DigitalOut sensor_power_en(PIN_NAME_SENSOR_POWER_ENABLE, 0);
 mbed::DigitalOut battery_mon_en(PIN_NAME_BATTERY_MONITOR_ENABLE, 0);
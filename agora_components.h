@@ -23,6 +23,9 @@
 #include "LSM9DS1.h"
 #include "icm20602_i2c.h"
 
+#include "mbed_i2c_bus.h"
+#include "i2c_transaction_engine.h"
+
 /** I2C Component Addresses */
 #define BME680_I2C_ADDR				(0x76 << 1)
 #define MAX44009_I2C_ADDR			(0x4A << 1)
@@ -33,6 +36,8 @@
 #define ICM20602_I2C_ADDR			(0x68 << 1)
 
 extern mbed::I2C sensor_i2c;
+extern MbedI2CBus sensor_i2c_bus;
+extern I2CTransactionEngine sensor_i2c_engine;
 
 extern mbed::DigitalOut sensor_power_en;
 extern mbed::DigitalOut battery_mon_en;
@@ -0,0 +1,63 @@
+/*
+ * async_uart_writer.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "async_uart_writer.h"
+
+#include "platform/mbed_critical.h"
+
+static_assert((ASYNC_UART_WRITER_BUFFER_SIZE & (ASYNC_UART_WRITER_BUFFER_SIZE - 1)) == 0,
+		"ASYNC_UART_WRITER_BUFFER_SIZE must be a power of two");
+
+AsyncUartWriter::AsyncUartWriter(mbed::RawSerial& serial) :
+	serial(serial),
+	buffer(),
+	head(0),
+	tail(0),
+	tx_active(false),
+	bytes_written(0),
+	dropped(0) {
+}
+
+bool AsyncUartWriter::write(const uint8_t* data, size_t len) {
+	uint32_t h = head.load(std::memory_order_relaxed);
+	uint32_t free = ASYNC_UART_WRITER_BUFFER_SIZE - (h - tail.load(std::memory_order_acquire));
+	if(len > free) {
+		dropped++;
+		return false;
+	}
+
+	for(size_t i = 0; i < len; i++) {
+		buffer[(h + i) & (ASYNC_UART_WRITER_BUFFER_SIZE - 1)] = data[i];
+	}
+	head.store(h + len, std::memory_order_release);
+	bytes_written += len;
+
+	// The interrupt detaches itself once the ring runs empty
+	core_util_critical_section_enter();
+	if(!tx_active) {
+		tx_active = true;
+		serial.attach(mbed::callback(this, &AsyncUartWriter::on_tx), mbed::SerialBase::TxIrq);
+	}
+	core_util_critical_section_exit();
+
+	return true;
+}
+
+void AsyncUartWriter::on_tx(void) {
+	uint32_t t = tail.load(std::memory_order_relaxed);
+	uint32_t h = head.load(std::memory_order_acquire);
+
+	while(t != h && serial.writeable()) {
+		serial.putc(buffer[t & (ASYNC_UART_WRITER_BUFFER_SIZE - 1)]);
+		t++;
+	}
+	tail.store(t, std::memory_order_release);
+
+	if(t == h) {
+		tx_active = false;
+		serial.attach(mbed::Callback<void()>(), mbed::SerialBase::TxIrq);
+	}
+}
@@ -0,0 +1,69 @@
+/*
+ * async_uart_writer.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef ASYNC_UART_WRITER_H_
+#define ASYNC_UART_WRITER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#include "drivers/RawSerial.h"
+#include "platform/NonCopyable.h"
+
+/** Bytes waiting for the UART, must be a power of two */
+#define ASYNC_UART_WRITER_BUFFER_SIZE	2048
+
+/**
+ * Interrupt-driven UART transmitter with a ring buffer
+ *
+ * write() copies into the ring and returns, the transmit interrupt feeds the
+ * UART from there. A write that does not fit is dropped as a whole, so a
+ * producer that outruns the baud rate loses frames instead of blocking.
+ *
+ * write() must be called from a single thread. The serial object may also be
+ * used by others for receiving (its receive interrupt is left alone).
+ */
+class AsyncUartWriter : private mbed::NonCopyable<AsyncUartWriter> {
+public:
+
+	AsyncUartWriter(mbed::RawSerial& serial);
+
+	/**
+	 * Queue bytes for transmission
+	 * @retval false if there was not enough room, nothing was queued
+	 */
+	bool write(const uint8_t* data, size_t len);
+
+	/** Bytes queued and not sent yet */
+	size_t pending(void) const {
+		return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+	}
+
+	uint32_t get_bytes_written(void) const {
+		return bytes_written;
+	}
+
+	/** Writes rejected because the buffer was full */
+	uint32_t get_dropped(void) const {
+		return dropped;
+	}
+
+private:
+
+	void on_tx(void);
+
+	mbed::RawSerial& serial;
+	uint8_t buffer[ASYNC_UART_WRITER_BUFFER_SIZE];
+	std::atomic<uint32_t> head;		/** Written by write() only */
+	std::atomic<uint32_t> tail;		/** Written by the transmit interrupt only */
+	bool tx_active;					/** Transmit interrupt attached */
+	uint32_t bytes_written;
+	uint32_t dropped;
+
+};
+
+#endif /* ASYNC_UART_WRITER_H_ */
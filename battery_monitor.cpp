@@ -0,0 +1,59 @@
+/*
+ * battery_monitor.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "battery_monitor.h"
+
+BatteryMonitor::BatteryMonitor(mbed::DigitalOut& enable, mbed::AnalogIn& adc,
+		float full_scale_v) :
+	enable(enable), adc(adc), full_scale_v(full_scale_v), state(STATE_IDLE),
+	samples(), raw(0), voltage(0.0f), measurements(0) {
+}
+
+uint32_t BatteryMonitor::step(void) {
+
+	switch(state) {
+	case STATE_IDLE:
+		// Power the divider and come back once it has settled
+		enable = 1;
+		state = STATE_SETTLING;
+		return BATTERY_MONITOR_SETTLE_MS;
+
+	case STATE_SETTLING:
+	default:
+		// Burst sample, then cut the divider before doing anything else
+		for(int i = 0; i < BATTERY_MONITOR_BURST_SAMPLES; i++) {
+			samples[i] = adc.read_u16();
+		}
+		enable = 0;
+		state = STATE_IDLE;
+
+		raw = filter();
+		voltage = (raw * full_scale_v) / 65535.0f;
+		measurements++;
+		return 0;
+	}
+}
+
+uint16_t BatteryMonitor::filter(void) {
+	uint32_t sum = 0;
+	uint16_t min = 0xFFFF;
+	uint16_t max = 0;
+
+	for(int i = 0; i < BATTERY_MONITOR_BURST_SAMPLES; i++) {
+		sum += samples[i];
+		if(samples[i] < min) {
+			min = samples[i];
+		}
+		if(samples[i] > max) {
+			max = samples[i];
+		}
+	}
+
+	// Drop the outliers at both ends, round to nearest
+	sum -= (min + max);
+	uint32_t count = BATTERY_MONITOR_BURST_SAMPLES - 2;
+	return (uint16_t) ((sum + (count / 2)) / count);
+}
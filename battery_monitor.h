@@ -0,0 +1,84 @@
+/*
+ * battery_monitor.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef BATTERY_MONITOR_H_
+#define BATTERY_MONITOR_H_
+
+#include <stdint.h>
+
+#include "drivers/DigitalOut.h"
+#include "drivers/AnalogIn.h"
+#include "platform/NonCopyable.h"
+
+/** Number of ADC samples taken in one burst */
+#define BATTERY_MONITOR_BURST_SAMPLES	16
+
+/** Time the divider needs after being enabled before the ADC input is stable */
+#define BATTERY_MONITOR_SETTLE_MS		10
+
+/**
+ * Non-blocking battery voltage measurement
+ *
+ * Enables the battery divider, waits for it to settle without blocking the
+ * caller, takes a burst of ADC samples and disables the divider again before
+ * any filtering is done so it is powered for as short a time as possible.
+ *
+ * The burst is filtered with a trimmed mean (lowest and highest samples dropped).
+ */
+class BatteryMonitor : private mbed::NonCopyable<BatteryMonitor> {
+public:
+
+	/**
+	 * @param[in] enable Output enabling the battery divider
+	 * @param[in] adc Analog input connected to the divider
+	 * @param[in] full_scale_v Battery voltage corresponding to a full scale ADC reading
+	 */
+	BatteryMonitor(mbed::DigitalOut& enable, mbed::AnalogIn& adc, float full_scale_v);
+
+	/**
+	 * Advance the measurement state machine
+	 *
+	 * @retval 0 when a new measurement is available (or there is nothing to do),
+	 * otherwise the number of milliseconds after which step() must be called again
+	 */
+	uint32_t step(void);
+
+	/** Latest filtered battery voltage in volts */
+	float get_voltage(void) const {
+		return voltage;
+	}
+
+	/** Latest filtered reading in raw 16-bit ADC counts */
+	uint16_t get_raw(void) const {
+		return raw;
+	}
+
+	/** Number of measurements completed */
+	uint32_t get_measurement_count(void) const {
+		return measurements;
+	}
+
+private:
+
+	typedef enum {
+		STATE_IDLE,
+		STATE_SETTLING
+	} state_t;
+
+	uint16_t filter(void);
+
+	mbed::DigitalOut& enable;
+	mbed::AnalogIn& adc;
+	float full_scale_v;
+	state_t state;
+	uint16_t samples[BATTERY_MONITOR_BURST_SAMPLES];
+	uint16_t raw;
+	float voltage;
+	uint32_t measurements;
+
+};
+
+#endif /* BATTERY_MONITOR_H_ */
@@ -0,0 +1,529 @@
+/*
+ * bond_store.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "bond_store.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include "drivers/MbedCRC.h"
+#include "platform/File.h"
+
+#define IMAGE_FILE_NAME		"image"
+#define IMAGE_TMP_FILE_NAME	"image.tmp"
+#define JOURNAL_FILE_NAME	"journal"
+
+/** Record data is checked in chunks before it is applied */
+#define CRC_CHUNK_SIZE		64
+
+/** CRC32 of a header (crc field zeroed by the caller) and the data after it */
+static uint32_t store_crc(const void* header, size_t header_len, const uint8_t* data, size_t len) {
+	mbed::MbedCRC<POLY_32BIT_ANSI, 32> ct;
+	uint32_t crc = 0;
+	ct.compute_partial_start(&crc);
+	ct.compute_partial((void*) header, header_len, &crc);
+	if(len != 0) {
+		ct.compute_partial((void*) data, len, &crc);
+	}
+	ct.compute_partial_stop(&crc);
+	return crc;
+}
+
+BondStore::BondStore(events::EventQueue& queue, const char* name) :
+	FileSystem(name), queue(queue), fs(NULL), dir(), data(), size(0), exists(false),
+	generation(0), file_is_open(false), position(0), append(false), dirty(false),
+	dirty_begin(0), dirty_end(0), flush_event(0), journal_size(0), records_written(0),
+	images_written(0), records_replayed(0), torn_records(0), write_errors(0) {
+}
+
+BondStore::~BondStore() {
+	if(flush_event != 0) {
+		queue.cancel(flush_event);
+	}
+}
+
+int BondStore::attach(FileSystem& fs, const char* dir, const char* legacy_file) {
+	if(strlen(dir) >= sizeof(this->dir)) {
+		return -ENAMETOOLONG;
+	}
+
+	int err = fs.mkdir(dir, 0777);
+	if(err != 0 && err != -EEXIST) {
+		printf("bonds: could not create %s - %d\r\n", dir, err);
+		return err;
+	}
+
+	this->fs = &fs;
+	strcpy(this->dir, dir);
+
+	// Left behind by a power cut during compact(), the old image is intact
+	char tmp_path[BOND_STORE_PATH_MAX];
+	make_path(tmp_path, sizeof(tmp_path), IMAGE_TMP_FILE_NAME);
+	fs.remove(tmp_path);
+
+	memset(data, 0, sizeof(data));
+	size = 0;
+	exists = false;
+	generation = 0;
+	journal_size = 0;
+	dirty = false;
+
+	bool have_image = load_image();
+	bool intact = replay_journal();
+
+	// Importing writes a new image too
+	bool imported = !exists && legacy_file != NULL && import_legacy(legacy_file);
+	if(!imported && !intact) {
+		// Appending after a torn record would hide the new records from replay
+		compact();
+	}
+
+	printf("bonds: %u bytes, generation %lu%s, %lu journal records\r\n", (unsigned) size,
+			(unsigned long) generation, have_image? "" : " (no image)",
+			(unsigned long) records_replayed);
+	return 0;
+}
+
+int BondStore::flush(void) {
+	if(flush_event != 0) {
+		queue.cancel(flush_event);
+		flush_event = 0;
+	}
+
+	if(!dirty) {
+		return 0;
+	}
+	if(fs == NULL) {
+		return -ENODEV;
+	}
+
+	// Written, then truncated away before the commit
+	if(dirty_end > size) {
+		dirty_end = size;
+	}
+	if(dirty_begin > dirty_end) {
+		dirty_begin = dirty_end;
+	}
+
+	size_t length = dirty_end - dirty_begin;
+	if(journal_size + sizeof(bond_store_record_t) + length > BOND_STORE_JOURNAL_LIMIT) {
+		return compact();
+	}
+
+	bond_store_record_t record;
+	memset(&record, 0, sizeof(record));
+	record.magic = BOND_STORE_RECORD_MAGIC;
+	record.offset = (uint16_t) dirty_begin;
+	record.length = (uint16_t) length;
+	record.size = (uint16_t) size;
+	record.generation = generation;
+	record.crc = store_crc(&record, sizeof(record), &data[dirty_begin], length);
+
+	char journal_path[BOND_STORE_PATH_MAX];
+	make_path(journal_path, sizeof(journal_path), JOURNAL_FILE_NAME);
+
+	mbed::File journal;
+	int err = journal.open(fs, journal_path, O_WRONLY | O_CREAT | O_APPEND);
+	if(err == 0) {
+		if(journal.write(&record, sizeof(record)) != (ssize_t) sizeof(record) ||
+				(length != 0 && journal.write(&data[dirty_begin], length) != (ssize_t) length)) {
+			err = -EIO;
+		}
+		// Closing commits the append
+		int close_err = journal.close();
+		if(err == 0) {
+			err = close_err;
+		}
+	}
+
+	if(err != 0) {
+		// A partial record is dropped on replay, the image replaces it
+		printf("bonds: journal write failed - %d\r\n", err);
+		write_errors++;
+		return compact();
+	}
+
+	journal_size += sizeof(record) + length;
+	records_written++;
+	dirty = false;
+	return 0;
+}
+
+int BondStore::compact(void) {
+	if(fs == NULL) {
+		return -ENODEV;
+	}
+
+	bond_store_image_header_t header;
+	memset(&header, 0, sizeof(header));
+	header.magic = BOND_STORE_MAGIC;
+	header.version = BOND_STORE_VERSION;
+	header.generation = generation + 1;
+	header.size = size;
+	header.crc = store_crc(&header, sizeof(header), data, size);
+
+	char tmp_path[BOND_STORE_PATH_MAX];
+	char image_path[BOND_STORE_PATH_MAX];
+	char journal_path[BOND_STORE_PATH_MAX];
+	make_path(tmp_path, sizeof(tmp_path), IMAGE_TMP_FILE_NAME);
+	make_path(image_path, sizeof(image_path), IMAGE_FILE_NAME);
+	make_path(journal_path, sizeof(journal_path), JOURNAL_FILE_NAME);
+
+	mbed::File image;
+	int err = image.open(fs, tmp_path, O_WRONLY | O_CREAT | O_TRUNC);
+	if(err == 0) {
+		if(image.write(&header, sizeof(header)) != (ssize_t) sizeof(header) ||
+				(size != 0 && image.write(data, size) != (ssize_t) size)) {
+			err = -EIO;
+		}
+		int close_err = image.close();
+		if(err == 0) {
+			err = close_err;
+		}
+	}
+
+	// The new image replaces the old one in a single step
+	if(err == 0) {
+		err = fs->rename(tmp_path, image_path);
+	}
+
+	if(err != 0) {
+		printf("bonds: image write failed - %d\r\n", err);
+		write_errors++;
+		fs->remove(tmp_path);
+		return err;
+	}
+
+	// Records of the old generation are ignored if this does not happen
+	generation = header.generation;
+	fs->remove(journal_path);
+	journal_size = 0;
+	images_written++;
+	dirty = false;
+	return 0;
+}
+
+void BondStore::print_stats(void) {
+	printf("bonds: %u bytes, generation %lu, journal %u bytes - %lu records written, "
+			"%lu images, %lu replayed, %lu torn, %lu write errors\r\n", (unsigned) size,
+			(unsigned long) generation, (unsigned) journal_size, (unsigned long) records_written,
+			(unsigned long) images_written, (unsigned long) records_replayed,
+			(unsigned long) torn_records, (unsigned long) write_errors);
+}
+
+int BondStore::mount(BlockDevice* bd) {
+	(void) bd;
+	return -ENOTSUP;
+}
+
+int BondStore::unmount(void) {
+	int err = flush();
+	fs = NULL;
+	return err;
+}
+
+int BondStore::stat(const char* path, struct stat* st) {
+	if(strcmp(path, BOND_STORE_FILE_NAME) != 0 || !exists) {
+		return -ENOENT;
+	}
+
+	memset(st, 0, sizeof(*st));
+	st->st_size = size;
+	st->st_mode = S_IFREG | 0666;
+	return 0;
+}
+
+int BondStore::file_open(fs_file_t* file, const char* path, int flags) {
+	if(strcmp(path, BOND_STORE_FILE_NAME) != 0) {
+		return -ENOENT;
+	}
+	if(fs == NULL) {
+		return -ENODEV;
+	}
+	if(file_is_open) {
+		return -EMFILE;
+	}
+	if(!exists && !(flags & O_CREAT)) {
+		return -ENOENT;
+	}
+
+	if(!exists) {
+		exists = true;
+		mark_dirty(0, 0);
+	}
+	if(flags & O_TRUNC) {
+		truncate(0);
+	}
+
+	file_is_open = true;
+	position = 0;
+	append = (flags & O_APPEND) != 0;
+	*file = this;
+	return 0;
+}
+
+int BondStore::file_close(fs_file_t file) {
+	(void) file;
+	file_is_open = false;
+	return flush();
+}
+
+ssize_t BondStore::file_read(fs_file_t file, void* buffer, size_t len) {
+	(void) file;
+	if(position >= size) {
+		return 0;
+	}
+
+	if(len > size - position) {
+		len = size - position;
+	}
+	memcpy(buffer, &data[position], len);
+	position += len;
+	return len;
+}
+
+ssize_t BondStore::file_write(fs_file_t file, const void* buffer, size_t len) {
+	(void) file;
+	if(append) {
+		position = size;
+	}
+	if(position + len > sizeof(data)) {
+		return -ENOSPC;
+	}
+
+	memcpy(&data[position], buffer, len);
+	mark_dirty(position, len);
+	position += len;
+	if(position > size) {
+		size = position;
+	}
+	return len;
+}
+
+int BondStore::file_sync(fs_file_t file) {
+	(void) file;
+	return flush();
+}
+
+off_t BondStore::file_seek(fs_file_t file, off_t offset, int whence) {
+	(void) file;
+	off_t target;
+	switch(whence) {
+	case SEEK_SET:
+		target = offset;
+		break;
+	case SEEK_CUR:
+		target = (off_t) position + offset;
+		break;
+	case SEEK_END:
+		target = (off_t) size + offset;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	if(target < 0 || target > (off_t) sizeof(data)) {
+		return -EINVAL;
+	}
+	position = (size_t) target;
+	return target;
+}
+
+off_t BondStore::file_tell(fs_file_t file) {
+	(void) file;
+	return position;
+}
+
+off_t BondStore::file_size(fs_file_t file) {
+	(void) file;
+	return size;
+}
+
+int BondStore::file_truncate(fs_file_t file, off_t length) {
+	(void) file;
+	if(length < 0 || length > (off_t) sizeof(data)) {
+		return -EINVAL;
+	}
+	truncate((size_t) length);
+	return 0;
+}
+
+bool BondStore::load_image(void) {
+	char image_path[BOND_STORE_PATH_MAX];
+	make_path(image_path, sizeof(image_path), IMAGE_FILE_NAME);
+
+	mbed::File image;
+	if(image.open(fs, image_path, O_RDONLY) != 0) {
+		return false;
+	}
+
+	bond_store_image_header_t header;
+	bool valid = image.read(&header, sizeof(header)) == (ssize_t) sizeof(header) &&
+			header.magic == BOND_STORE_MAGIC && header.version == BOND_STORE_VERSION &&
+			header.size <= sizeof(data) &&
+			image.read(data, header.size) == (ssize_t) header.size;
+	image.close();
+
+	if(valid) {
+		uint32_t crc = header.crc;
+		header.crc = 0;
+		valid = store_crc(&header, sizeof(header), data, header.size) == crc;
+	}
+
+	if(!valid) {
+		// Renamed into place complete, should not happen
+		printf("bonds: invalid image, ignored\r\n");
+		memset(data, 0, sizeof(data));
+		return false;
+	}
+
+	generation = header.generation;
+	size = header.size;
+	exists = true;
+	return true;
+}
+
+bool BondStore::replay_journal(void) {
+	char journal_path[BOND_STORE_PATH_MAX];
+	make_path(journal_path, sizeof(journal_path), JOURNAL_FILE_NAME);
+
+	mbed::File journal;
+	if(journal.open(fs, journal_path, O_RDONLY) != 0) {
+		return true;
+	}
+
+	bool intact = true;
+	while(true) {
+		bond_store_record_t record;
+		ssize_t read = journal.read(&record, sizeof(record));
+		if(read == 0) {
+			break;
+		}
+
+		if(read != (ssize_t) sizeof(record) || record.magic != BOND_STORE_RECORD_MAGIC ||
+				record.size > sizeof(data) || record.offset + record.length > record.size) {
+			intact = false;
+			break;
+		}
+
+		// Check the data before anything is applied
+		off_t data_position = journal.tell();
+		uint32_t crc = record.crc;
+		record.crc = 0;
+
+		mbed::MbedCRC<POLY_32BIT_ANSI, 32> ct;
+		uint32_t computed = 0;
+		ct.compute_partial_start(&computed);
+		ct.compute_partial((void*) &record, sizeof(record), &computed);
+		size_t left = record.length;
+		while(left != 0) {
+			uint8_t chunk[CRC_CHUNK_SIZE];
+			size_t len = (left < sizeof(chunk))? left : sizeof(chunk);
+			if(journal.read(chunk, len) != (ssize_t) len) {
+				break;
+			}
+			ct.compute_partial(chunk, len, &computed);
+			left -= len;
+		}
+		ct.compute_partial_stop(&computed);
+
+		if(left != 0 || computed != crc) {
+			intact = false;
+			break;
+		}
+
+		journal_size += sizeof(record) + record.length;
+
+		if(record.generation != generation) {
+			// Already in the image, the journal outlived a compaction
+			continue;
+		}
+
+		journal.seek(data_position, SEEK_SET);
+		journal.read(&data[record.offset], record.length);
+		journal.seek(data_position + record.length, SEEK_SET);
+		if(record.size < size) {
+			memset(&data[record.size], 0, size - record.size);
+		}
+		size = record.size;
+		exists = true;
+		records_replayed++;
+	}
+	journal.close();
+
+	if(!intact) {
+		torn_records++;
+		printf("bonds: journal ends with a torn record after %u bytes\r\n", (unsigned) journal_size);
+	}
+	return intact;
+}
+
+bool BondStore::import_legacy(const char* legacy_file) {
+	mbed::File legacy;
+	if(legacy.open(fs, legacy_file, O_RDONLY) != 0) {
+		return false;
+	}
+
+	ssize_t read = -1;
+	if(legacy.size() <= (off_t) sizeof(data)) {
+		read = legacy.read(data, sizeof(data));
+	}
+	legacy.close();
+
+	if(read <= 0) {
+		printf("bonds: could not import %s\r\n", legacy_file);
+		memset(data, 0, sizeof(data));
+		return false;
+	}
+
+	size = read;
+	exists = true;
+	if(compact() != 0) {
+		return false;
+	}
+
+	fs->remove(legacy_file);
+	printf("bonds: imported %u bytes from %s\r\n", (unsigned) size, legacy_file);
+	return true;
+}
+
+void BondStore::mark_dirty(size_t offset, size_t len) {
+	if(!dirty) {
+		dirty = true;
+		dirty_begin = offset;
+		dirty_end = offset + len;
+	} else {
+		if(offset < dirty_begin) {
+			dirty_begin = offset;
+		}
+		if(offset + len > dirty_end) {
+			dirty_end = offset + len;
+		}
+	}
+
+	// Commit once the security manager is done with this batch of writes
+	if(flush_event == 0 && fs != NULL) {
+		flush_event = queue.call(this, &BondStore::on_flush_event);
+	}
+}
+
+void BondStore::on_flush_event(void) {
+	flush_event = 0;
+	flush();
+}
+
+void BondStore::make_path(char* out, size_t len, const char* file) const {
+	snprintf(out, len, "%s/%s", dir, file);
+}
+
+void BondStore::truncate(size_t length) {
+	if(length < size) {
+		memset(&data[length], 0, size - length);
+	}
+	size = length;
+	mark_dirty(length, 0);
+}
@@ -0,0 +1,213 @@
+/*
+ * bond_store.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef BOND_STORE_H_
+#define BOND_STORE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FileSystem.h"
+#include "BlockDevice.h"
+#include "events/EventQueue.h"
+
+/** The one file presented to the security manager */
+#define BOND_STORE_FILE_NAME		"sm.dat"
+
+/** Largest database (FileSecurityDb with its default 5 entries is well below) */
+#define BOND_STORE_MAX_SIZE			4096
+
+/** The journal is folded into a new image once it grows past this */
+#define BOND_STORE_JOURNAL_LIMIT	2048
+
+/** Longest directory name, and path of a file in it */
+#define BOND_STORE_DIR_MAX			32
+#define BOND_STORE_PATH_MAX			(BOND_STORE_DIR_MAX + 16)
+
+#define BOND_STORE_MAGIC			0x444E4F42	// "BOND"
+#define BOND_STORE_VERSION			1
+#define BOND_STORE_RECORD_MAGIC		0x4A42		// "BJ"
+
+/** Header of the image file, followed by the database */
+typedef struct {
+	uint32_t magic;
+	uint8_t version;
+	uint8_t reserved[3];
+	uint32_t generation;	/** Increments with every image written */
+	uint32_t size;			/** Of the database */
+	uint32_t crc;			/** CRC32 of the header (crc zeroed) and the database */
+} bond_store_image_header_t;
+
+/** Journal record, followed by length bytes written at offset */
+typedef struct {
+	uint16_t magic;
+	uint16_t offset;
+	uint16_t length;
+	uint16_t size;			/** Of the database after the record (truncation, growth) */
+	uint32_t generation;	/** Of the image the record applies to */
+	uint32_t crc;			/** CRC32 of the record (crc zeroed) and its data */
+} bond_store_record_t;
+
+/**
+ * Bond database persistence for the security manager
+ *
+ * The security manager keeps its bonds in a file it writes field by field
+ * (FileSecurityDb). It only closes the file, flushing it, on a reset, which
+ * rewrites and re-reads everything and tears down the security of every
+ * link. BondStore is mounted as a filesystem of its own and presents that
+ * file from RAM instead, persisting it in a directory of the real
+ * filesystem (LittleFS):
+ *
+ *   image    the whole database, with a CRC and a generation number
+ *   journal  records of the bytes written since, appended in order
+ *
+ * Writes from the security manager are collected and the span they cover is
+ * committed as one journal record on the event queue right after (or with
+ * flush()), so each pairing costs a few small appends rather than a rewrite. Once the journal
+ * passes BOND_STORE_JOURNAL_LIMIT it is folded into a new image, written
+ * under a temporary name and renamed over the old one.
+ *
+ * A power cut at any point leaves either the previous or the new state:
+ * LittleFS commits an append or a rename atomically, records are checked
+ * against their CRC and the image generation on replay, and records of an
+ * older generation (left behind when the cut hit between the rename and the
+ * journal removal) are ignored.
+ *
+ * Only one file can be open at a time. All calls must come from the event
+ * queue's thread, except print_stats(). Not copyable (FileBase).
+ */
+class BondStore : public FileSystem {
+public:
+
+	/**
+	 * @param[in] queue Queue the deferred commits run on (the security manager's)
+	 * @param[in] name Mount point, NULL to use it through mbed::File only
+	 */
+	BondStore(events::EventQueue& queue, const char* name = NULL);
+
+	virtual ~BondStore();
+
+	/**
+	 * Load the database from a directory of a mounted filesystem
+	 *
+	 * A stale temporary image is removed and the journal replayed. If the
+	 * journal ends in a torn record it is folded into a new image right away.
+	 *
+	 * @param[in] fs Filesystem the image and the journal are kept on
+	 * @param[in] dir Directory, created if needed
+	 * @param[in] legacy_file Database file of an earlier firmware on fs, imported
+	 * (then removed) when there is no image yet. NULL if there is none.
+	 * @retval 0 on success, negative error code otherwise
+	 */
+	int attach(FileSystem& fs, const char* dir, const char* legacy_file = NULL);
+
+	bool is_attached(void) const {
+		return fs != NULL;
+	}
+
+	/**
+	 * Commit what was written since the last commit, as one journal record
+	 * (or a new image if the journal is full)
+	 * @retval 0 on success, negative error code otherwise
+	 */
+	int flush(void);
+
+	/**
+	 * Fold the journal into a new image
+	 * @retval 0 on success, negative error code otherwise
+	 */
+	int compact(void);
+
+	/** Size of the database */
+	size_t get_size(void) const {
+		return size;
+	}
+
+	uint32_t get_generation(void) const {
+		return generation;
+	}
+
+	void print_stats(void);
+
+	/** Stacked on a mounted filesystem with attach(), not on a block device */
+	virtual int mount(BlockDevice* bd);
+
+	virtual int unmount(void);
+
+	virtual int stat(const char* path, struct stat* st);
+
+protected:
+
+	virtual int file_open(fs_file_t* file, const char* path, int flags);
+
+	virtual int file_close(fs_file_t file);
+
+	virtual ssize_t file_read(fs_file_t file, void* buffer, size_t len);
+
+	virtual ssize_t file_write(fs_file_t file, const void* buffer, size_t len);
+
+	virtual int file_sync(fs_file_t file);
+
+	virtual off_t file_seek(fs_file_t file, off_t offset, int whence);
+
+	virtual off_t file_tell(fs_file_t file);
+
+	virtual off_t file_size(fs_file_t file);
+
+	virtual int file_truncate(fs_file_t file, off_t length);
+
+private:
+
+	/** Read the image, false if there is none or it is invalid */
+	bool load_image(void);
+
+	/** Apply the journal records of the current generation, false if it ends torn */
+	bool replay_journal(void);
+
+	bool import_legacy(const char* legacy_file);
+
+	/** Remember a change for the next commit */
+	void mark_dirty(size_t offset, size_t len);
+
+	void on_flush_event(void);
+
+	/** Path of a file in the store's directory */
+	void make_path(char* out, size_t len, const char* file) const;
+
+	/** Drop what is past length */
+	void truncate(size_t length);
+
+	events::EventQueue& queue;
+	FileSystem* fs;
+	char dir[BOND_STORE_DIR_MAX];
+
+	uint8_t data[BOND_STORE_MAX_SIZE];
+	size_t size;
+	bool exists;			/** The database file has been created */
+	uint32_t generation;
+
+	/** The open file */
+	bool file_is_open;
+	size_t position;
+	bool append;
+
+	/** Changes not committed yet, [dirty_begin, dirty_end) and the size */
+	bool dirty;
+	size_t dirty_begin;
+	size_t dirty_end;
+	int flush_event;
+
+	size_t journal_size;
+
+	uint32_t records_written;
+	uint32_t images_written;
+	uint32_t records_replayed;
+	uint32_t torn_records;
+	uint32_t write_errors;
+
+};
+
+#endif /* BOND_STORE_H_ */
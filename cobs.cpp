@@ -0,0 +1,54 @@
+/*
+ * cobs.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "cobs.h"
+
+size_t cobs_encode(const uint8_t* in, size_t len, uint8_t* out) {
+	size_t code_index = 0;
+	size_t write_index = 1;
+	uint8_t code = 1;
+
+	for(size_t i = 0; i < len; i++) {
+		if(in[i] != 0) {
+			out[write_index++] = in[i];
+			code++;
+		}
+
+		if(in[i] == 0 || code == 0xFF) {
+			// Close the block: its code is the distance to the next zero (or block)
+			out[code_index] = code;
+			code = 1;
+			code_index = write_index++;
+		}
+	}
+
+	out[code_index] = code;
+	return write_index;
+}
+
+size_t cobs_decode(const uint8_t* in, size_t len, uint8_t* out) {
+	size_t read_index = 0;
+	size_t write_index = 0;
+
+	while(read_index < len) {
+		uint8_t code = in[read_index];
+		if(code == 0 || read_index + code > len) {
+			return 0;
+		}
+		read_index++;
+
+		for(uint8_t i = 1; i < code; i++) {
+			out[write_index++] = in[read_index++];
+		}
+
+		// A block shorter than 254 bytes stands for a zero, except at the end
+		if(code != 0xFF && read_index != len) {
+			out[write_index++] = 0;
+		}
+	}
+
+	return write_index;
+}
@@ -0,0 +1,42 @@
+/*
+ * cobs.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef COBS_H_
+#define COBS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Consistent Overhead Byte Stuffing
+ *
+ * Encoded data contains no zero bytes, so a 0x00 delimits frames on a byte
+ * stream and a receiver resynchronizes on the next delimiter after losing
+ * bytes. The overhead is one byte, plus one per 254 bytes of input.
+ */
+
+/** Worst-case encoded size of len bytes, excluding the delimiter */
+#define COBS_MAX_ENCODED_SIZE(len)	((len) + ((len) / 254) + 1)
+
+/**
+ * Encode a buffer
+ * @param[in] in Data to encode
+ * @param[in] len Number of bytes in
+ * @param[out] out Receives at least COBS_MAX_ENCODED_SIZE(len) bytes, must not overlap in
+ * @retval Number of bytes written to out, the delimiter is not appended
+ */
+size_t cobs_encode(const uint8_t* in, size_t len, uint8_t* out);
+
+/**
+ * Decode a frame (without its delimiter)
+ * @param[in] in Encoded data
+ * @param[in] len Number of bytes in
+ * @param[out] out Receives at most len bytes, may be the same buffer as in
+ * @retval Number of decoded bytes, 0 if the frame is malformed
+ */
+size_t cobs_decode(const uint8_t* in, size_t len, uint8_t* out);
+
+#endif /* COBS_H_ */
@@ -0,0 +1,175 @@
+/*
+ * connection_table.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "connection_table.h"
+
+#include <stdio.h>
+
+#include "rtos/Kernel.h"
+
+ConnectionTable::ConnectionTable() : connections(), count(0), tracked(), tracked_count(0),
+	subscriptions_changed_callchain() {
+}
+
+ble_connection_t* ConnectionTable::add(const ble::ConnectionCompleteEvent& event) {
+	for(int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+		ble_connection_t& connection = connections[i];
+		if(connection.in_use) {
+			continue;
+		}
+
+		connection.in_use = true;
+		connection.handle = event.getConnectionHandle();
+		connection.peer_address_type = event.getPeerAddressType().value();
+		connection.peer_address = event.getPeerAddress();
+		connection.connect_ms = rtos::Kernel::get_ms_count();
+		connection.security = CONNECTION_SECURITY_NONE;
+		connection.paired = false;
+		connection.att_mtu = BLE_DEFAULT_ATT_MTU;
+		connection.subscriptions = 0;
+		connection.link_profile = 0;
+		count++;
+		return &connection;
+	}
+
+	return NULL;
+}
+
+void ConnectionTable::remove(ble::connection_handle_t handle) {
+	int index = index_of(handle);
+	if(index < 0) {
+		return;
+	}
+
+	connections[index].in_use = false;
+	connections[index].subscriptions = 0;
+	count--;
+}
+
+ble_connection_t* ConnectionTable::find(ble::connection_handle_t handle) {
+	int index = index_of(handle);
+	return (index < 0)? NULL : &connections[index];
+}
+
+int ConnectionTable::index_of(ble::connection_handle_t handle) const {
+	for(int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+		if(connections[i].in_use && connections[i].handle == handle) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+uint16_t ConnectionTable::get_min_att_mtu(void) const {
+	uint16_t mtu = 0;
+	for(int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+		if(connections[i].in_use && (mtu == 0 || connections[i].att_mtu < mtu)) {
+			mtu = connections[i].att_mtu;
+		}
+	}
+	return (mtu == 0)? BLE_DEFAULT_ATT_MTU : mtu;
+}
+
+int ConnectionTable::track(const GattCharacteristic& characteristic) {
+	for(int i = 0; i < tracked_count; i++) {
+		if(tracked[i] == &characteristic) {
+			return i;
+		}
+	}
+
+	if(tracked_count == BLE_MAX_TRACKED_CHARACTERISTICS) {
+		return -1;
+	}
+
+	tracked[tracked_count] = &characteristic;
+	return tracked_count++;
+}
+
+int ConnectionTable::refresh_subscriptions(GattServer& server, GattAttribute::Handle_t attribute) {
+	int bit = -1;
+	for(int i = 0; i < tracked_count; i++) {
+		if(tracked[i]->getValueHandle() == attribute) {
+			bit = i;
+			break;
+		}
+	}
+
+	if(bit < 0) {
+		return -1;
+	}
+
+	for(int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+		ble_connection_t& connection = connections[i];
+		if(!connection.in_use) {
+			continue;
+		}
+
+		bool enabled = false;
+		if(server.areUpdatesEnabled(connection.handle, *tracked[bit], &enabled) != BLE_ERROR_NONE) {
+			enabled = false;
+		}
+
+		if(enabled) {
+			connection.subscriptions |= (1UL << bit);
+		} else {
+			connection.subscriptions &= ~(1UL << bit);
+		}
+	}
+
+	subscriptions_changed_callchain.call(attribute);
+	return bit;
+}
+
+void ConnectionTable::refresh_all_subscriptions(GattServer& server) {
+	for(int i = 0; i < tracked_count; i++) {
+		refresh_subscriptions(server, tracked[i]->getValueHandle());
+	}
+}
+
+int ConnectionTable::get_subscriber_count(int bit) const {
+	int subscribers = 0;
+	for(int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+		if(is_subscribed(i, bit)) {
+			subscribers++;
+		}
+	}
+	return subscribers;
+}
+
+void ConnectionTable::print(void) const {
+	printf("ble: %d of %d connections\r\n", count, BLE_MAX_CONNECTIONS);
+
+	uint64_t now = rtos::Kernel::get_ms_count();
+	for(int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+		const ble_connection_t& connection = connections[i];
+		if(!connection.in_use) {
+			continue;
+		}
+
+		const uint8_t* addr = connection.peer_address.data();
+		printf("\t[%d] handle %u, peer %02X:%02X:%02X:%02X:%02X:%02X, %s%s, MTU %u, "
+				"subscriptions 0x%08lX, up %lu ms\r\n", i, connection.handle,
+				addr[5], addr[4], addr[3], addr[2], addr[1], addr[0],
+				security_name(connection.security), connection.paired? " (paired)" : "",
+				connection.att_mtu, (unsigned long) connection.subscriptions,
+				(unsigned long) (now - connection.connect_ms));
+	}
+}
+
+const char* ConnectionTable::security_name(connection_security_t security) {
+	switch(security) {
+	case CONNECTION_SECURITY_NONE:
+		return "not encrypted";
+	case CONNECTION_SECURITY_PAIRING:
+		return "pairing";
+	case CONNECTION_SECURITY_ENCRYPTED:
+		return "encrypted";
+	case CONNECTION_SECURITY_AUTHENTICATED:
+		return "authenticated";
+	default:
+		return "?";
+	}
+}
@@ -0,0 +1,172 @@
+/*
+ * connection_table.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef CONNECTION_TABLE_H_
+#define CONNECTION_TABLE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "ble/BLE.h"
+#include "ble/GattServer.h"
+#include "ble/gap/Types.h"
+#include "ble/gap/Events.h"
+#include "platform/NonCopyable.h"
+
+/** Extensions */
+#include "extensions/CallChain.h"
+
+/**
+ * Centrals connected at the same time
+ *
+ * Bounded by the host's connection pool (cordio.max-connections, see
+ * mbed_app.json), one entry is kept per connection.
+ */
+#ifndef BLE_MAX_CONNECTIONS
+#if defined(DM_CONN_MAX)
+#define BLE_MAX_CONNECTIONS DM_CONN_MAX
+#else
+#define BLE_MAX_CONNECTIONS 4
+#endif
+#endif
+
+/** Characteristics whose subscriptions can be tracked, one bit each */
+#define BLE_MAX_TRACKED_CHARACTERISTICS 32
+
+/** ATT MTU in use until the client negotiates a larger one */
+#define BLE_DEFAULT_ATT_MTU 23
+
+/** Security of a connection */
+typedef enum {
+	CONNECTION_SECURITY_NONE = 0,		/** Not encrypted */
+	CONNECTION_SECURITY_PAIRING,		/** Pairing requested, not completed yet */
+	CONNECTION_SECURITY_ENCRYPTED,		/** Encrypted, not authenticated */
+	CONNECTION_SECURITY_AUTHENTICATED	/** Encrypted with an authenticated (MITM protected) key */
+} connection_security_t;
+
+/** State kept for one connected central */
+typedef struct {
+	bool in_use;
+	ble::connection_handle_t handle;
+	uint8_t peer_address_type;			/** ble::peer_address_type_t */
+	ble::address_t peer_address;
+	uint64_t connect_ms;
+	connection_security_t security;
+	bool paired;						/** Pairing completed on this connection */
+	uint16_t att_mtu;
+	uint32_t subscriptions;				/** Bit per tracked characteristic with notifications enabled */
+	uint8_t link_profile;				/** link_profile_t selected for the connection, see LinkTuner */
+} ble_connection_t;
+
+/**
+ * Per-connection state of the centrals connected to the peripheral
+ *
+ * BLEProcess adds and removes entries as connections come and go, and keeps
+ * their security state and negotiated ATT MTU. Services register the
+ * characteristics they notify with track() and attach to
+ * on_subscriptions_changed(). BLEProcess owns the server's CCCD callbacks
+ * (there is a single slot for each) and refreshes the subscriptions of every
+ * connection when one fires, since the mbed callbacks do not say which
+ * connection wrote the CCCD.
+ *
+ * Entries stay at the same index for the lifetime of their connection, so
+ * per-connection state kept elsewhere can be indexed the same way (check
+ * the handle to notice that a slot was reused).
+ *
+ * Not thread safe, all calls must come from the BLE event queue.
+ */
+class ConnectionTable : private mbed::NonCopyable<ConnectionTable> {
+public:
+
+	ConnectionTable();
+
+	/**
+	 * Add a new connection
+	 * @retval NULL if the table is full
+	 */
+	ble_connection_t* add(const ble::ConnectionCompleteEvent& event);
+
+	/** Forget a connection, ignored if it is unknown */
+	void remove(ble::connection_handle_t handle);
+
+	/** @retval NULL if there is no such connection */
+	ble_connection_t* find(ble::connection_handle_t handle);
+
+	/** @retval -1 if there is no such connection */
+	int index_of(ble::connection_handle_t handle) const;
+
+	const ble_connection_t& at(int index) const {
+		return connections[index];
+	}
+
+	static int get_capacity(void) {
+		return BLE_MAX_CONNECTIONS;
+	}
+
+	int get_count(void) const {
+		return count;
+	}
+
+	bool is_full(void) const {
+		return count == BLE_MAX_CONNECTIONS;
+	}
+
+	/** Smallest ATT MTU of the connections, the default MTU without any */
+	uint16_t get_min_att_mtu(void) const;
+
+	/**
+	 * Track the subscriptions of a characteristic
+	 * @retval Bit of the characteristic in ble_connection_t::subscriptions, -1 if too many are tracked
+	 */
+	int track(const GattCharacteristic& characteristic);
+
+	/**
+	 * Re-read the CCCD of a tracked characteristic for every connection
+	 *
+	 * Calls on_subscriptions_changed() with the attribute if it is tracked.
+	 * @param[in] attribute Value handle reported by onUpdatesEnabled/onUpdatesDisabled
+	 * @retval Bit of the characteristic, -1 if it is not tracked
+	 */
+	int refresh_subscriptions(GattServer& server, GattAttribute::Handle_t attribute);
+
+	/**
+	 * Re-read the CCCDs of every tracked characteristic for every connection
+	 *
+	 * Bonded centrals get their CCCDs back once the link is encrypted, without
+	 * an onUpdatesEnabled callback.
+	 */
+	void refresh_all_subscriptions(GattServer& server);
+
+	bool is_subscribed(int index, int bit) const {
+		return bit >= 0 && connections[index].in_use &&
+				(connections[index].subscriptions & (1UL << bit)) != 0;
+	}
+
+	/** Called with the value handle of a tracked characteristic after its subscriptions were refreshed */
+	ep::CallChain<GattAttribute::Handle_t>& on_subscriptions_changed(void) {
+		return subscriptions_changed_callchain;
+	}
+
+	/** Number of connections subscribed to a tracked characteristic */
+	int get_subscriber_count(int bit) const;
+
+	void print(void) const;
+
+	static const char* security_name(connection_security_t security);
+
+private:
+
+	ble_connection_t connections[BLE_MAX_CONNECTIONS];
+	int count;
+
+	const GattCharacteristic* tracked[BLE_MAX_TRACKED_CHARACTERISTICS];
+	int tracked_count;
+
+	ep::CallChain<GattAttribute::Handle_t> subscriptions_changed_callchain;
+
+};
+
+#endif /* CONNECTION_TABLE_H_ */
@@ -0,0 +1,91 @@
+/*
+ * filesystem_boot.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "filesystem_boot.h"
+
+#include <string.h>
+
+#include "platform/Dir.h"
+#include "rtos/Kernel.h"
+
+static uint32_t elapsed_ms(uint64_t since) {
+	return (uint32_t) (rtos::Kernel::get_ms_count() - since);
+}
+
+/** The filesystem is only trusted if its root directory can be read back */
+static bool filesystem_usable(FileSystem& fs) {
+	mbed::Dir dir;
+	if(dir.open(&fs, "/") != 0) {
+		return false;
+	}
+
+	dir.close();
+	return true;
+}
+
+bool filesystem_boot(FileSystem& fs, BlockDevice& bd, bool erase, filesystem_boot_stats_t& stats) {
+	memset(&stats, 0, sizeof(stats));
+	stats.result = FILESYSTEM_BOOT_FAILED;
+
+	uint64_t start = rtos::Kernel::get_ms_count();
+	uint64_t step = start;
+
+	int err = bd.init();
+	stats.init_ms = elapsed_ms(step);
+	if(err) {
+		stats.total_ms = elapsed_ms(start);
+		return false;
+	}
+
+	if(erase) {
+		step = rtos::Kernel::get_ms_count();
+		err = bd.erase(0, bd.size());
+		stats.erase_ms = elapsed_ms(step);
+		if(err) {
+			stats.total_ms = elapsed_ms(start);
+			return false;
+		}
+	} else {
+		step = rtos::Kernel::get_ms_count();
+		err = fs.mount(&bd);
+		if(!err && !filesystem_usable(fs)) {
+			fs.unmount();
+			err = -1;
+		}
+		stats.mount_ms = elapsed_ms(step);
+
+		if(!err) {
+			stats.result = FILESYSTEM_BOOT_MOUNTED;
+			stats.total_ms = elapsed_ms(start);
+			return true;
+		}
+	}
+
+	// Erased, unmountable or corrupt: start over with an empty filesystem
+	step = rtos::Kernel::get_ms_count();
+	err = fs.reformat(&bd);
+	stats.format_ms = elapsed_ms(step);
+	stats.total_ms = elapsed_ms(start);
+	if(err) {
+		return false;
+	}
+
+	stats.result = erase? FILESYSTEM_BOOT_ERASED : FILESYSTEM_BOOT_REFORMATTED;
+	return true;
+}
+
+const char* filesystem_boot_result_name(filesystem_boot_result_t result) {
+	switch(result) {
+	case FILESYSTEM_BOOT_MOUNTED:
+		return "mounted";
+	case FILESYSTEM_BOOT_REFORMATTED:
+		return "reformatted";
+	case FILESYSTEM_BOOT_ERASED:
+		return "erased";
+	default:
+		return "failed";
+	}
+}
@@ -0,0 +1,51 @@
+/*
+ * filesystem_boot.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef FILESYSTEM_BOOT_H_
+#define FILESYSTEM_BOOT_H_
+
+#include <stdint.h>
+
+#include "BlockDevice.h"
+#include "FileSystem.h"
+
+/** How the filesystem came up */
+typedef enum {
+	FILESYSTEM_BOOT_MOUNTED = 0,	/** Existing filesystem, nothing erased */
+	FILESYSTEM_BOOT_REFORMATTED,	/** Did not mount or failed the check, reformatted */
+	FILESYSTEM_BOOT_ERASED,			/** Erase requested, block device erased and formatted */
+	FILESYSTEM_BOOT_FAILED
+} filesystem_boot_result_t;
+
+/** Time spent in each step, in milliseconds */
+typedef struct {
+	filesystem_boot_result_t result;
+	uint32_t init_ms;
+	uint32_t erase_ms;
+	uint32_t mount_ms;
+	uint32_t format_ms;
+	uint32_t total_ms;
+} filesystem_boot_stats_t;
+
+/**
+ * Bring up a filesystem without erasing it on every boot
+ *
+ * The existing filesystem is mounted and its root directory opened. Only
+ * if either fails is the block device reformatted, so pairing data
+ * survives a reboot and the common path costs a few reads.
+ *
+ * @param[in] fs Filesystem to mount
+ * @param[in] bd Block device holding it, initialized here
+ * @param[in] erase Erase the whole block device and format it regardless
+ * (eg: a factory reset requested at boot)
+ * @param[out] stats How the filesystem came up and what it cost
+ * @retval false if the filesystem could not be brought up
+ */
+bool filesystem_boot(FileSystem& fs, BlockDevice& bd, bool erase, filesystem_boot_stats_t& stats);
+
+const char* filesystem_boot_result_name(filesystem_boot_result_t result);
+
+#endif /* FILESYSTEM_BOOT_H_ */
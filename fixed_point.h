@@ -0,0 +1,100 @@
+/*
+ * fixed_point.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef FIXED_POINT_H_
+#define FIXED_POINT_H_
+
+#include <stdint.h>
+#include <limits>
+
+/**
+ * Saturating, rounding integer conversions
+ *
+ * Everything is constexpr so conversions with constant inputs are checked
+ * with static_assert (see gatt_units.h), and the same header builds on a host
+ * for testing. Intermediates are 64-bit, results are clamped to the output
+ * range instead of wrapping, and divisions round half away from zero instead
+ * of truncating.
+ */
+namespace fixed {
+
+/** Clamp value to [lo, hi] */
+constexpr int64_t clamp(int64_t value, int64_t lo, int64_t hi) {
+	return (value < lo)? lo : (value > hi)? hi : value;
+}
+
+/** Clamp value to the range of T */
+template<typename T>
+constexpr T saturate(int64_t value) {
+	return (T) clamp(value, (int64_t) std::numeric_limits<T>::min(),
+			(int64_t) std::numeric_limits<T>::max());
+}
+
+/** num / den rounded half away from zero, den must be positive */
+constexpr int64_t div_round(int64_t num, int64_t den) {
+	return (num < 0)? -((-num + den / 2) / den) : (num + den / 2) / den;
+}
+
+/**
+ * Round a float half away from zero, it must fit in an int64_t
+ *
+ * Compares the fraction with one half instead of adding 0.5f, which rounds
+ * the float just below a half up. The fraction is exact in float.
+ */
+constexpr int64_t round_half_away(float value) {
+	return (value < 0)? -round_half_away(-value) :
+			(int64_t) value + ((value - (float) (int64_t) value >= 0.5f)? 1 : 0);
+}
+
+/** Round a float half away from zero, clamped to [lo, hi] (NaN gives 0, clamped) */
+constexpr int64_t round_clamp(float value, int64_t lo, int64_t hi) {
+	return (value != value)? clamp(0, lo, hi) :
+			(value <= (float) lo)? lo :
+			(value >= (float) hi)? hi :
+			clamp(round_half_away(value), lo, hi);
+}
+
+/** a - b, saturated to the range of T (eg: bias removal on raw sensor counts) */
+template<typename T>
+constexpr T saturating_sub(int64_t a, int64_t b) {
+	return saturate<T>(a - b);
+}
+
+/**
+ * Linear unit conversion: out = round(in * Num / Den) + Offset, clamped to [Min, Max]
+ *
+ * @tparam Out Encoded type (eg: the characteristic's field)
+ * @tparam Num, Den Scale from the input unit to the output resolution
+ * @tparam Offset Added after scaling, in output units
+ * @tparam Min, Max Valid range of the encoding, defaults to the range of Out
+ */
+template<typename Out, int64_t Num, int64_t Den = 1, int64_t Offset = 0,
+		int64_t Min = (int64_t) std::numeric_limits<Out>::min(),
+		int64_t Max = (int64_t) std::numeric_limits<Out>::max()>
+struct Scale {
+
+	static_assert(Den > 0, "fixed::Scale denominator must be positive");
+	static_assert(Min <= Max, "fixed::Scale range is empty");
+	static_assert(Min >= (int64_t) std::numeric_limits<Out>::min() &&
+			Max <= (int64_t) std::numeric_limits<Out>::max(), "fixed::Scale range exceeds the output type");
+
+	typedef Out type;
+
+	/** Convert an integer reading, exact apart from the final rounding */
+	static constexpr Out from_int(int64_t in) {
+		return (Out) clamp(div_round(in * Num, Den) + Offset, Min, Max);
+	}
+
+	/** Convert a float reading (eg: from a vendor library), rounded once before the offset like from_int() */
+	static constexpr Out from_float(float in) {
+		return (Out) (round_clamp(in * ((float) Num / (float) Den), Min - Offset, Max - Offset) + Offset);
+	}
+
+};
+
+}
+
+#endif /* FIXED_POINT_H_ */
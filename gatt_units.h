@@ -0,0 +1,87 @@
+/*
+ * gatt_units.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef GATT_UNITS_H_
+#define GATT_UNITS_H_
+
+#include <stdint.h>
+
+#include "fixed_point.h"
+
+/**
+ * Encodings of the integer characteristics, one conversion per sensor output unit
+ *
+ * The sensor_channel_t values carry these encodings (see sensor_sample.h).
+ */
+
+/** org.bluetooth.characteristic.temperature: sint16, 0.01 degC */
+typedef fixed::Scale<int16_t, 100> TemperatureFromCelsius;
+typedef fixed::Scale<int16_t, 1, 10> TemperatureFromMilliCelsius;
+
+/** org.bluetooth.characteristic.pressure: uint32, 0.1 Pa */
+typedef fixed::Scale<uint32_t, 10> PressureFromPascal;
+
+/** org.bluetooth.characteristic.humidity: uint16, 0.01 %RH, 0 to 100 % */
+typedef fixed::Scale<uint16_t, 100, 1, 0, 0, 10000> HumidityFromPercent;
+typedef fixed::Scale<uint16_t, 1, 10, 0, 0, 10000> HumidityFromMilliPercent;
+
+/** Gas resistance: uint32, Ohm */
+typedef fixed::Scale<uint32_t, 1> GasResistanceFromOhm;
+
+/** IAQ index: uint16, 0 to 500 */
+typedef fixed::Scale<uint16_t, 1, 1, 0, 0, 500> IaqScore;
+
+/** IAQ accuracy: uint8, 0 (stabilizing) to 3 (calibrated) */
+typedef fixed::Scale<uint8_t, 1, 1, 0, 0, 3> IaqAccuracy;
+
+/** Distance: uint16, mm (0xFFFF is out of range) */
+typedef fixed::Scale<uint16_t, 1> DistanceFromMillimeter;
+
+/** Out of range distance, also what anything past 65.5 m saturates to */
+#define GATT_DISTANCE_OUT_OF_RANGE	0xFFFF
+
+/** Compact encodings of the float channels, used where space is short (eg: advertising data) */
+typedef fixed::Scale<uint16_t, 1> Co2FromPpm;
+typedef fixed::Scale<uint16_t, 1000> VocPpbFromPpm;
+typedef fixed::Scale<uint32_t, 100> LuxHundredthsFromLux;
+typedef fixed::Scale<uint16_t, 1000> MillivoltFromVolt;
+typedef fixed::Scale<int16_t, 1000> MilliGFromG;
+
+/** Snapshot (see sensor_snapshot_service.h): sint16 0.1 dps, sint16 mgauss */
+typedef fixed::Scale<int16_t, 10> DeciDpsFromDps;
+typedef fixed::Scale<int16_t, 1000> MilliGaussFromGauss;
+
+/** IMU features (see imu_feature_service.h): uint16 mg, 0.01 for ratios, 0.1 Hz */
+typedef fixed::Scale<uint16_t, 1000> MilliGMagnitudeFromG;
+typedef fixed::Scale<uint16_t, 100> HundredthsFromRatio;
+typedef fixed::Scale<uint16_t, 10> DeciHertzFromHertz;
+
+/** Bit-exact encodings, checked at compile time */
+static_assert(TemperatureFromCelsius::from_float(23.456f) == 2346, "temperature rounds");
+static_assert(TemperatureFromCelsius::from_float(-0.005f) == -1, "negative temperature rounds away from zero");
+static_assert(TemperatureFromCelsius::from_float(400.0f) == INT16_MAX, "temperature saturates");
+static_assert(TemperatureFromMilliCelsius::from_int(-12345) == -1235, "negative milli-degrees");
+static_assert(TemperatureFromMilliCelsius::from_int(25004) == 2500, "milli-degrees round");
+static_assert(PressureFromPascal::from_float(101325.04f) == 1013250, "pressure");
+static_assert(PressureFromPascal::from_float(-1.0f) == 0, "pressure does not wrap below zero");
+static_assert(PressureFromPascal::from_float(1e12f) == UINT32_MAX, "pressure saturates");
+static_assert(HumidityFromPercent::from_float(45.678f) == 4568, "humidity rounds");
+static_assert(HumidityFromPercent::from_float(101.0f) == 10000, "humidity is limited to 100 %");
+static_assert(HumidityFromMilliPercent::from_int(-3000) == 0, "humidity is not negative");
+static_assert(HumidityFromMilliPercent::from_int(54321) == 5432, "milli-percent rounds");
+static_assert(IaqScore::from_float(std::numeric_limits<float>::quiet_NaN()) == 0, "NaN encodes as 0");
+static_assert(DistanceFromMillimeter::from_int(70000) == GATT_DISTANCE_OUT_OF_RANGE, "distance saturates");
+static_assert(VocPpbFromPpm::from_float(0.5004f) == 500, "bVOC in ppb");
+static_assert(MillivoltFromVolt::from_float(3.2996f) == 3300, "battery in mV");
+static_assert(MilliGFromG::from_float(-40.0f) == INT16_MIN, "acceleration saturates");
+static_assert(DeciDpsFromDps::from_float(-2000.04f) == -20000, "rotation rate in 0.1 dps");
+static_assert(MilliGaussFromGauss::from_float(0.4567f) == 457, "magnetic field in mgauss");
+static_assert(MilliGMagnitudeFromG::from_float(0.01234f) == 12, "vibration in mg");
+static_assert(HundredthsFromRatio::from_float(1.4142f) == 141, "crest factor");
+static_assert(DeciHertzFromHertz::from_float(952.0f) == 9520, "frequency in 0.1 Hz");
+static_assert(fixed::saturating_sub<int16_t>(-32700, 200) == INT16_MIN, "bias removal saturates");
+
+#endif /* GATT_UNITS_H_ */
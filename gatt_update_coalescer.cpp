@@ -0,0 +1,150 @@
+/*
+ * gatt_update_coalescer.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "gatt_update_coalescer.h"
+
+#include <stdio.h>
+#include <math.h>
+
+GattUpdateCoalescer::GattUpdateCoalescer(publisher_t publisher) :
+	publisher(publisher), channels(), flushes(0) {
+}
+
+void GattUpdateCoalescer::set_deadband(sensor_channel_t channel, sensor_value_t deadband) {
+	if(channel >= SENSOR_CHANNEL_COUNT) {
+		return;
+	}
+	channels[channel].deadband = deadband;
+}
+
+bool GattUpdateCoalescer::exceeds_deadband(sensor_channel_t channel,
+		const sensor_value_t& value) const {
+	const channel_state_t& state = channels[channel];
+
+	if(!state.has_value) {
+		return true;
+	}
+
+	const sensor_value_t& last = state.accepted.value;
+	const sensor_value_t& db = state.deadband;
+
+	switch(sensor_channel_value_type(channel)) {
+	case SENSOR_VALUE_I32:
+		return ((value.i32 > last.i32)? (uint32_t) (value.i32 - last.i32) :
+				(uint32_t) (last.i32 - value.i32)) > (uint32_t) db.i32;
+	case SENSOR_VALUE_U32:
+		return ((value.u32 > last.u32)? (value.u32 - last.u32) : (last.u32 - value.u32)) > db.u32;
+	case SENSOR_VALUE_FLOAT:
+		return fabsf(value.f - last.f) > db.f;
+	case SENSOR_VALUE_VEC3:
+	default:
+		for(int i = 0; i < 3; i++) {
+			if(fabsf(value.vec3[i] - last.vec3[i]) > db.vec3[i]) {
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+bool GattUpdateCoalescer::update(const sensor_sample_t& sample) {
+	sensor_channel_t channel = (sensor_channel_t) sample.channel;
+	if(channel >= SENSOR_CHANNEL_COUNT) {
+		return false;
+	}
+
+	channel_state_t& state = channels[channel];
+
+	if(!exceeds_deadband(channel, sample.value)) {
+		state.suppressed++;
+		state.skipped += 1 + sample.skipped;
+		return false;
+	}
+
+	uint32_t skipped = state.skipped;
+	if(state.dirty) {
+		// Overwritten before it was flushed, only the latest value goes out
+		state.suppressed++;
+		skipped += 1 + state.accepted.skipped;
+	}
+	state.accepted = sample;
+	state.accepted.skipped = sensor_sample_add_skipped(sample.skipped, skipped);
+	state.skipped = 0;
+	state.has_value = true;
+	state.dirty = true;
+
+	return true;
+}
+
+void GattUpdateCoalescer::flush(void) {
+	bool any = false;
+
+	for(int i = 0; i < SENSOR_CHANNEL_COUNT; i++) {
+		channel_state_t& state = channels[i];
+		if(!state.dirty) {
+			continue;
+		}
+
+		state.dirty = false;
+		any = true;
+
+		state.published++;
+		if(publisher) {
+			publisher(state.accepted);
+		}
+	}
+
+	if(any) {
+		flushes++;
+	}
+}
+
+void GattUpdateCoalescer::replay(publisher_t to) {
+	if(!to) {
+		return;
+	}
+
+	for(int i = 0; i < SENSOR_CHANNEL_COUNT; i++) {
+		const channel_state_t& state = channels[i];
+		if(!state.has_value || state.dirty) {
+			// Dirty channels go out with the next flush anyway
+			continue;
+		}
+
+		to(state.accepted);
+	}
+}
+
+uint32_t GattUpdateCoalescer::get_published(sensor_channel_t channel) const {
+	if(channel >= SENSOR_CHANNEL_COUNT) {
+		return 0;
+	}
+	return channels[channel].published;
+}
+
+uint32_t GattUpdateCoalescer::get_suppressed(sensor_channel_t channel) const {
+	if(channel >= SENSOR_CHANNEL_COUNT) {
+		return 0;
+	}
+	return channels[channel].suppressed;
+}
+
+void GattUpdateCoalescer::print_stats(void) {
+	uint32_t total_published = 0;
+	uint32_t total_suppressed = 0;
+
+	for(int i = 0; i < SENSOR_CHANNEL_COUNT; i++) {
+		printf("gatt: %-18s published %8lu suppressed %8lu\r\n",
+				sensor_channel_name((sensor_channel_t) i),
+				(unsigned long) channels[i].published, (unsigned long) channels[i].suppressed);
+		total_published += channels[i].published;
+		total_suppressed += channels[i].suppressed;
+	}
+
+	printf("gatt: %lu updates in %lu batches, %lu suppressed\r\n",
+			(unsigned long) total_published, (unsigned long) flushes,
+			(unsigned long) total_suppressed);
+}
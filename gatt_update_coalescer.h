@@ -0,0 +1,95 @@
+/*
+ * gatt_update_coalescer.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef GATT_UPDATE_COALESCER_H_
+#define GATT_UPDATE_COALESCER_H_
+
+#include <stdint.h>
+
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+#include "sensor_sample.h"
+
+/**
+ * Change detection and batching in front of the GATT database
+ *
+ * Every new sample is handed to update(). A sample is only kept if it
+ * differs from the last accepted value of its channel by more than the
+ * channel's deadband; otherwise it is counted as suppressed. flush() then
+ * writes the latest accepted value of every changed channel in one pass,
+ * so several samples of the same channel between flushes result in a
+ * single GATT write. Every sample published carries the number of readings
+ * suppressed or overwritten since the previous one in skipped.
+ *
+ * Not thread safe, both update() and flush() run on the BLE event queue
+ * (fed by the SensorSampleHandoff).
+ */
+class GattUpdateCoalescer : private mbed::NonCopyable<GattUpdateCoalescer> {
+public:
+
+	/** Writes a sample to its characteristic */
+	typedef mbed::Callback<void(const sensor_sample_t&)> publisher_t;
+
+	GattUpdateCoalescer(publisher_t publisher);
+
+	/**
+	 * Set the deadband of a channel
+	 *
+	 * A new value is published only if it differs from the last accepted one
+	 * by strictly more than the deadband (per component for vec3 channels).
+	 * A zero deadband publishes every change.
+	 */
+	void set_deadband(sensor_channel_t channel, sensor_value_t deadband);
+
+	/**
+	 * Offer a new sample
+	 * @retval true if the sample will be published, false if it was suppressed
+	 */
+	bool update(const sensor_sample_t& sample);
+
+	/** Publish every changed channel */
+	void flush(void);
+
+	/**
+	 * Hand the last accepted value of every channel to a publisher (eg: to
+	 * characteristics added after the values went out), without counting
+	 * them as published
+	 */
+	void replay(publisher_t to);
+
+	uint32_t get_published(sensor_channel_t channel) const;
+
+	uint32_t get_suppressed(sensor_channel_t channel) const;
+
+	/** Number of flush passes executed */
+	uint32_t get_flushes(void) const {
+		return flushes;
+	}
+
+	void print_stats(void);
+
+private:
+
+	typedef struct {
+		sensor_value_t deadband;
+		sensor_sample_t accepted;	/** Last sample that passed the deadband, with its time and sequence */
+		bool has_value;
+		bool dirty;
+		uint32_t published;
+		uint32_t suppressed;
+		uint32_t skipped;			/** Suppressed since accepted was taken */
+	} channel_state_t;
+
+	bool exceeds_deadband(sensor_channel_t channel, const sensor_value_t& value) const;
+
+	publisher_t publisher;
+	channel_state_t channels[SENSOR_CHANNEL_COUNT];
+	uint32_t flushes;
+
+};
+
+#endif /* GATT_UPDATE_COALESCER_H_ */
@@ -0,0 +1,48 @@
+/*
+ * i2c_bus.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef I2C_BUS_H_
+#define I2C_BUS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** transfer() result when the transfer did not finish in time and was aborted */
+#define I2C_BUS_TIMEOUT		(-2)
+
+/**
+ * Abstract I2C bus used by the I2CTransactionEngine
+ *
+ * Keeps the engine independent of the Mbed driver so it can be
+ * exercised against a fake bus off-target.
+ */
+class I2CBus {
+public:
+
+	virtual ~I2CBus() { }
+
+	/** Acquire exclusive access to the bus */
+	virtual void lock(void) = 0;
+
+	/** Release exclusive access to the bus */
+	virtual void unlock(void) = 0;
+
+	/**
+	 * Write tx_len bytes then read rx_len bytes with a repeated start
+	 *
+	 * Blocks the calling thread until the transfer is complete.
+	 * Either length may be zero.
+	 *
+	 * @param[in] address 8-bit (left shifted) slave address
+	 * @retval 0 on success, I2C_BUS_TIMEOUT if the transfer hung, other negative
+	 * values on bus error or NACK
+	 */
+	virtual int transfer(int address, const uint8_t* tx, size_t tx_len,
+			uint8_t* rx, size_t rx_len) = 0;
+
+};
+
+#endif /* I2C_BUS_H_ */
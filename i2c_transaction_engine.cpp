@@ -0,0 +1,164 @@
+/*
+ * i2c_transaction_engine.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "i2c_transaction_engine.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hal/us_ticker_api.h"
+#include "rtos/ThisThread.h"
+
+#include "trace.h"
+
+I2CTransactionEngine::I2CTransactionEngine(I2CBus& bus, osPriority priority) :
+	bus(bus), mail(), thread(priority, I2C_ENGINE_THREAD_STACK_SIZE, NULL, "i2c"), in_flight(0),
+	stats_mutex(), stats(), rejected(0) {
+}
+
+void I2CTransactionEngine::start(void) {
+	thread.start(mbed::callback(this, &I2CTransactionEngine::bus_thread_main));
+}
+
+bool I2CTransactionEngine::submit(uint8_t address, const uint8_t* tx, size_t tx_len,
+		uint8_t* rx, size_t rx_len, events::EventQueue* queue, i2c_completion_cb_t cb) {
+
+	if(tx_len > I2C_ENGINE_MAX_TX_LEN || (rx == NULL && rx_len != 0)) {
+		return false;
+	}
+
+	// calloc so the callback member starts out empty
+	transaction_t* txn = mail.calloc();
+	if(txn == NULL) {
+		rejected++;
+		return false;
+	}
+
+	txn->address = address;
+	if(tx_len != 0) {
+		memcpy(txn->tx, tx, tx_len);
+	}
+	txn->tx_len = (uint8_t) tx_len;
+	txn->rx = rx;
+	txn->rx_len = rx_len;
+	txn->queue = queue;
+	txn->cb = cb;
+	txn->submitted_us = us_ticker_read();
+
+	TRACE_INSTANT(TRACE_EVENT_I2C_SUBMIT, address);
+
+	in_flight++;
+	mail.put(txn);
+
+	return true;
+}
+
+void I2CTransactionEngine::bus_thread_main(void) {
+
+	while(true) {
+		osEvent evt = mail.get();
+		if(evt.status != osEventMail) {
+			continue;
+		}
+
+		transaction_t* txn = (transaction_t*) evt.value.p;
+
+		bus.lock();
+		TRACE_BEGIN(TRACE_EVENT_I2C_TRANSFER, txn->address);
+		uint32_t start = us_ticker_read();
+		int status = bus.transfer(txn->address, txn->tx, txn->tx_len, txn->rx, txn->rx_len);
+		uint32_t end = us_ticker_read();
+		TRACE_END(TRACE_EVENT_I2C_TRANSFER, txn->address);
+		bus.unlock();
+		in_flight--;
+
+		i2c_transaction_result_t result;
+		result.status = status;
+		result.address = txn->address;
+		result.rx = txn->rx;
+		result.rx_len = txn->rx_len;
+		result.wait_us = start - txn->submitted_us;
+		result.bus_us = end - start;
+
+		stats_mutex.lock();
+		stats.completed++;
+		if(status != 0) {
+			stats.errors++;
+		}
+		stats.total_wait_us += result.wait_us;
+		stats.total_bus_us += result.bus_us;
+		if(result.wait_us > stats.max_wait_us) {
+			stats.max_wait_us = result.wait_us;
+		}
+		if(result.bus_us > stats.max_bus_us) {
+			stats.max_bus_us = result.bus_us;
+		}
+		stats_mutex.unlock();
+
+		post_completion(txn, result);
+
+		mail.free(txn);
+	}
+}
+
+void I2CTransactionEngine::post_completion(transaction_t* txn, const i2c_transaction_result_t& result) {
+	if(!txn->cb) {
+		return;
+	}
+
+	if(txn->queue == NULL) {
+		txn->cb(result);
+		return;
+	}
+
+	// The queue's thread frees room as it dispatches, give it a moment
+	for(int attempt = 0; attempt <= I2C_ENGINE_POST_RETRIES; attempt++) {
+		if(txn->queue->call(txn->cb, result) != 0) {
+			return;
+		}
+		rtos::ThisThread::sleep_for(I2C_ENGINE_POST_RETRY_MS);
+	}
+
+	stats_mutex.lock();
+	stats.lost_completions++;
+	stats_mutex.unlock();
+	printf("i2c: event queue full, completion of 0x%02X lost\r\n", result.address);
+}
+
+I2CTransactionEngine::stats_t I2CTransactionEngine::get_stats(void) {
+	stats_mutex.lock();
+	stats_t copy = stats;
+	stats_mutex.unlock();
+
+	copy.rejected = rejected.load();
+	return copy;
+}
+
+void I2CTransactionEngine::reset_stats(void) {
+	stats_mutex.lock();
+	stats = stats_t();
+	stats_mutex.unlock();
+
+	rejected.store(0);
+}
+
+void I2CTransactionEngine::print_stats(void) {
+	stats_t current = get_stats();
+
+	uint32_t avg_wait = 0;
+	uint32_t avg_bus = 0;
+	if(current.completed != 0) {
+		avg_wait = (uint32_t) (current.total_wait_us / current.completed);
+		avg_bus = (uint32_t) (current.total_bus_us / current.completed);
+	}
+
+	printf("i2c: %lu transactions, %lu errors, %lu rejected, %lu completions lost\r\n",
+			(unsigned long) current.completed, (unsigned long) current.errors,
+			(unsigned long) current.rejected, (unsigned long) current.lost_completions);
+	printf("i2c: wait avg %lu us max %lu us, bus avg %lu us max %lu us\r\n",
+			(unsigned long) avg_wait, (unsigned long) current.max_wait_us,
+			(unsigned long) avg_bus, (unsigned long) current.max_bus_us);
+}
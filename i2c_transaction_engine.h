@@ -0,0 +1,160 @@
+/*
+ * i2c_transaction_engine.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef I2C_TRANSACTION_ENGINE_H_
+#define I2C_TRANSACTION_ENGINE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <atomic>
+
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+#include "events/EventQueue.h"
+#include "rtos/Mail.h"
+#include "rtos/Mutex.h"
+#include "rtos/Thread.h"
+
+#include "i2c_bus.h"
+
+/** Maximum number of transactions waiting for the bus */
+#define I2C_ENGINE_QUEUE_DEPTH		32
+
+/** Maximum number of bytes written before the (optional) read phase */
+#define I2C_ENGINE_MAX_TX_LEN		8
+
+#define I2C_ENGINE_THREAD_STACK_SIZE	1024
+
+/**
+ * Posting a completion to a full event queue is retried this many times,
+ * I2C_ENGINE_POST_RETRY_MS apart, before it is given up (and counted)
+ */
+#ifndef I2C_ENGINE_POST_RETRIES
+#define I2C_ENGINE_POST_RETRIES		10
+#endif
+#define I2C_ENGINE_POST_RETRY_MS	1
+
+/** Outcome of a queued transaction, passed to the completion callback */
+typedef struct {
+	int status;				/** 0 on success, negative on bus error */
+	uint8_t address;		/** 8-bit slave address */
+	uint8_t* rx;			/** Buffer supplied at submission */
+	size_t rx_len;
+	uint32_t wait_us;		/** Time between submission and start of the transfer */
+	uint32_t bus_us;		/** Time the transfer occupied the bus */
+} i2c_transaction_result_t;
+
+typedef mbed::Callback<void(i2c_transaction_result_t)> i2c_completion_cb_t;
+
+/**
+ * Queued, non-blocking I2C transaction engine
+ *
+ * Submitters hand off transfers and return immediately. A dedicated
+ * thread runs them back to back on the bus and posts each completion
+ * callback to the event queue supplied at submission, so the submitter's
+ * thread never stalls for bus time.
+ *
+ * Receive buffers are owned by the submitter and must stay valid until the
+ * completion callback runs.
+ *
+ * A completion the event queue has no room for is retried for a few
+ * milliseconds (holding up the bus thread) and then dropped. Dropped
+ * completions are counted in stats_t::lost_completions, submitters waiting
+ * for one need a timeout of their own.
+ */
+class I2CTransactionEngine : private mbed::NonCopyable<I2CTransactionEngine> {
+public:
+
+	typedef struct {
+		uint32_t completed;
+		uint32_t errors;
+		uint32_t rejected;		/** Submissions dropped because the queue was full */
+		uint32_t lost_completions;	/** Completions that could not be posted to their event queue */
+		uint32_t max_wait_us;
+		uint32_t max_bus_us;
+		uint64_t total_wait_us;
+		uint64_t total_bus_us;
+	} stats_t;
+
+	I2CTransactionEngine(I2CBus& bus, osPriority priority = osPriorityBelowNormal1);
+
+	/** Start the bus thread */
+	void start(void);
+
+	/**
+	 * Queue a write-then-read transaction
+	 *
+	 * @param[in] address 8-bit slave address
+	 * @param[in] tx Bytes to write first (copied, may be a temporary)
+	 * @param[in] tx_len Number of bytes to write, at most I2C_ENGINE_MAX_TX_LEN
+	 * @param[in] rx Buffer receiving rx_len bytes, may be NULL if rx_len is 0
+	 * @param[in] queue Event queue the completion is posted to
+	 * @param[in] cb Completion callback, may be empty
+	 * @retval true if queued, false if the queue is full or arguments are invalid
+	 */
+	bool submit(uint8_t address, const uint8_t* tx, size_t tx_len, uint8_t* rx, size_t rx_len,
+			events::EventQueue* queue, i2c_completion_cb_t cb);
+
+	/** Queue a burst read starting at register reg */
+	bool read_registers(uint8_t address, uint8_t reg, uint8_t* rx, size_t rx_len,
+			events::EventQueue* queue, i2c_completion_cb_t cb) {
+		return submit(address, &reg, 1, rx, rx_len, queue, cb);
+	}
+
+	/** Queue a single register write */
+	bool write_register(uint8_t address, uint8_t reg, uint8_t value,
+			events::EventQueue* queue = NULL, i2c_completion_cb_t cb = i2c_completion_cb_t()) {
+		uint8_t tx[2] = { reg, value };
+		return submit(address, tx, sizeof(tx), NULL, 0, queue, cb);
+	}
+
+	/** True when no transaction is queued or on the bus (completions may still be pending) */
+	bool is_idle(void) const {
+		return in_flight.load() == 0;
+	}
+
+	/** Consistent copy of the statistics, safe to call from any thread */
+	stats_t get_stats(void);
+
+	void reset_stats(void);
+
+	/** Print per-transaction latency statistics */
+	void print_stats(void);
+
+private:
+
+	typedef struct {
+		uint8_t address;
+		uint8_t tx[I2C_ENGINE_MAX_TX_LEN];
+		uint8_t tx_len;
+		uint8_t* rx;
+		size_t rx_len;
+		events::EventQueue* queue;
+		i2c_completion_cb_t cb;
+		uint32_t submitted_us;
+	} transaction_t;
+
+	void bus_thread_main(void);
+
+	/** Hand the result to the submitter's callback, on its event queue if it gave one */
+	void post_completion(transaction_t* txn, const i2c_transaction_result_t& result);
+
+	I2CBus& bus;
+	rtos::Mail<transaction_t, I2C_ENGINE_QUEUE_DEPTH> mail;
+	rtos::Thread thread;
+	std::atomic<uint32_t> in_flight;
+
+	/** Written on the bus thread, read from the console */
+	rtos::Mutex stats_mutex;
+	stats_t stats;
+
+	/** Counted by submitters, which may not block on the mutex */
+	std::atomic<uint32_t> rejected;
+
+};
+
+#endif /* I2C_TRANSACTION_ENGINE_H_ */
@@ -0,0 +1,262 @@
+/*
+ * icm20602_stream.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "icm20602_stream.h"
+
+/** ICM-20602 registers */
+#define ICM20602_SMPLRT_DIV		0x19
+#define ICM20602_CONFIG			0x1A
+#define ICM20602_GYRO_CONFIG	0x1B
+#define ICM20602_ACCEL_CONFIG	0x1C
+#define ICM20602_ACCEL_CONFIG2	0x1D
+#define ICM20602_FIFO_EN		0x23
+#define ICM20602_ACCEL_XOUT_H	0x3B
+#define ICM20602_USER_CTRL		0x6A
+#define ICM20602_PWR_MGMT_1		0x6B
+#define ICM20602_PWR_MGMT_2		0x6C
+#define ICM20602_FIFO_COUNTH	0x72
+#define ICM20602_FIFO_R_W		0x74
+
+#define ICM20602_CONFIG_FIFO_MODE		(1 << 6)	// Drop new samples once the FIFO is full
+#define ICM20602_FIFO_EN_GYRO			(1 << 4)
+#define ICM20602_FIFO_EN_ACCEL			(1 << 3)
+#define ICM20602_USER_CTRL_FIFO_EN		(1 << 6)
+#define ICM20602_USER_CTRL_FIFO_RST		(1 << 2)
+#define ICM20602_FIFO_COUNT_MASK		0x3FF
+#define ICM20602_PWR_MGMT_1_SLEEP		(1 << 6)
+#define ICM20602_PWR_MGMT_1_CLK_AUTO	0x01		// PLL when the gyro is up, internal oscillator otherwise
+#define ICM20602_PWR_MGMT_2_STBY_G		0x07		// Gyro X, Y and Z in standby
+
+#define ICM20602_INTERNAL_RATE_HZ		1000
+
+/** Largest number of whole samples the FIFO can hold */
+#define ICM20602_FIFO_MAX_SAMPLES		(ICM20602_FIFO_SIZE / ICM20602_SAMPLE_SIZE)
+
+ICM20602Stream::ICM20602Stream(I2CTransactionEngine& engine, events::EventQueue& queue,
+		uint8_t address) :
+	engine(engine), queue(queue), address(address), frame_sink(), streaming(false),
+	odr_hz(ICM20602_DEFAULT_ODR_HZ), accel_range_g(ICM20602_DEFAULT_ACCEL_RANGE_G),
+	gyro_range(ICM20602_DEFAULT_GYRO_RANGE), fifo_count_raw(), samples_remaining(0),
+	chunk_samples(0), draining(false), max_frame_size(IMU_STREAM_MIN_FRAME_SIZE),
+	chunk_raw(), builder(), last_sample(), sample_count(0), overruns(0) {
+}
+
+void ICM20602Stream::init(void) {
+	imu_stream_config_t config;
+	config.odr_hz = ICM20602_DEFAULT_ODR_HZ;
+	config.accel_range_g = ICM20602_DEFAULT_ACCEL_RANGE_G;
+	config.gyro_range = ICM20602_DEFAULT_GYRO_RANGE;
+	configure(config);
+}
+
+void ICM20602Stream::parse_sample(const uint8_t* raw, imu_raw_sample_t& sample) {
+	// Accel X/Y/Z, temperature, gyro X/Y/Z
+	for(int axis = 0; axis < 3; axis++) {
+		sample.accel[axis] = (int16_t) ((raw[2*axis] << 8) | raw[2*axis + 1]);
+		sample.gyro[axis] = (int16_t) ((raw[8 + 2*axis] << 8) | raw[8 + 2*axis + 1]);
+	}
+}
+
+uint8_t ICM20602Stream::output_register(void) {
+	return ICM20602_ACCEL_XOUT_H;
+}
+
+void ICM20602Stream::set_sleep(bool sleep) {
+	write_register(ICM20602_PWR_MGMT_1, ICM20602_PWR_MGMT_1_CLK_AUTO |
+			(sleep? ICM20602_PWR_MGMT_1_SLEEP : 0));
+}
+
+void ICM20602Stream::set_gyro_standby(bool standby) {
+	write_register(ICM20602_PWR_MGMT_2, standby? ICM20602_PWR_MGMT_2_STBY_G : 0);
+}
+
+void ICM20602Stream::write_register(uint8_t reg, uint8_t value) {
+	engine.write_register(address, reg, value);
+}
+
+void ICM20602Stream::configure(const imu_stream_config_t& config) {
+	uint16_t requested_hz = config.odr_hz;
+	if(requested_hz == 0) {
+		requested_hz = odr_hz;
+	}
+	if(requested_hz > ICM20602_INTERNAL_RATE_HZ) {
+		requested_hz = ICM20602_INTERNAL_RATE_HZ;
+	}
+
+	uint32_t divider = (ICM20602_INTERNAL_RATE_HZ / requested_hz) - 1;
+	if(divider > 0xFF) {
+		divider = 0xFF;
+	}
+	odr_hz = (uint16_t) (ICM20602_INTERNAL_RATE_HZ / (divider + 1));
+
+	// DLPF_CFG/A_DLPF_CFG 1 to 6 roughly halve the bandwidth at every step (176 Hz down to 5 Hz),
+	// pick the widest one below the Nyquist frequency
+	uint8_t dlpf = 1;
+	for(uint16_t bandwidth = 176; dlpf < 6 && bandwidth * 4 > odr_hz * 2; bandwidth /= 2) {
+		dlpf++;
+	}
+
+	if(config.accel_range_g != 0) {
+		accel_range_g = 16;
+		for(uint8_t g = 2; g <= 16; g *= 2) {
+			if(g >= config.accel_range_g) {
+				accel_range_g = g;
+				break;
+			}
+		}
+	}
+
+	uint8_t accel_fs_sel = 0;
+	for(uint8_t g = accel_range_g; g > 2; g /= 2) {
+		accel_fs_sel++;
+	}
+
+	uint16_t gyro_dps = imu_stream_gyro_range_dps((imu_stream_gyro_range_t) config.gyro_range);
+	uint8_t gyro_fs_sel;
+	if(gyro_dps == 0) {
+		gyro_dps = imu_stream_gyro_range_dps(gyro_range);
+	}
+	if(gyro_dps <= 250) {
+		gyro_range = IMU_STREAM_GYRO_RANGE_250DPS;
+		gyro_fs_sel = 0;
+	} else if(gyro_dps <= 500) {
+		gyro_range = IMU_STREAM_GYRO_RANGE_500DPS;
+		gyro_fs_sel = 1;
+	} else if(gyro_dps <= 1000) {
+		gyro_range = IMU_STREAM_GYRO_RANGE_1000DPS;
+		gyro_fs_sel = 2;
+	} else {
+		gyro_range = IMU_STREAM_GYRO_RANGE_2000DPS;
+		gyro_fs_sel = 3;
+	}
+
+	write_register(ICM20602_SMPLRT_DIV, (uint8_t) divider);
+	write_register(ICM20602_CONFIG, ICM20602_CONFIG_FIFO_MODE | dlpf);
+	write_register(ICM20602_GYRO_CONFIG, (uint8_t) (gyro_fs_sel << 3));
+	write_register(ICM20602_ACCEL_CONFIG, (uint8_t) (accel_fs_sel << 3));
+	write_register(ICM20602_ACCEL_CONFIG2, dlpf);
+}
+
+void ICM20602Stream::start(const imu_stream_config_t& config) {
+	// Stop the FIFO while the sample rate and ranges change
+	write_register(ICM20602_USER_CTRL, 0);
+	write_register(ICM20602_FIFO_EN, 0);
+
+	configure(config);
+
+	write_register(ICM20602_USER_CTRL, ICM20602_USER_CTRL_FIFO_RST);
+	write_register(ICM20602_FIFO_EN, ICM20602_FIFO_EN_GYRO | ICM20602_FIFO_EN_ACCEL);
+	write_register(ICM20602_USER_CTRL, ICM20602_USER_CTRL_FIFO_EN);
+
+	streaming = true;
+	begin_frame();
+}
+
+void ICM20602Stream::stop(void) {
+	if(!streaming) {
+		return;
+	}
+
+	streaming = false;
+
+	write_register(ICM20602_USER_CTRL, 0);
+	write_register(ICM20602_FIFO_EN, 0);
+	write_register(ICM20602_USER_CTRL, ICM20602_USER_CTRL_FIFO_RST);
+}
+
+uint32_t ICM20602Stream::get_poll_interval_ms(void) const {
+	if(odr_hz == 0) {
+		return 1000;
+	}
+
+	uint32_t interval = (ICM20602_STREAM_FIFO_TARGET * 1000) / odr_hz;
+	return (interval == 0)? 1 : interval;
+}
+
+void ICM20602Stream::begin_frame(void) {
+	builder.begin(IMU_STREAM_SOURCE_ICM20602, odr_hz, accel_range_g, gyro_range, max_frame_size);
+}
+
+void ICM20602Stream::poll(size_t frame_size) {
+	if(!streaming || draining) {
+		return;
+	}
+
+	if(frame_size != max_frame_size) {
+		max_frame_size = frame_size;
+		if(builder.empty()) {
+			// Resize the frame to the new notification payload
+			begin_frame();
+		}
+	}
+
+	draining = engine.read_registers(address, ICM20602_FIFO_COUNTH, fifo_count_raw,
+			sizeof(fifo_count_raw), &queue, mbed::callback(this, &ICM20602Stream::on_fifo_count));
+}
+
+void ICM20602Stream::on_fifo_count(i2c_transaction_result_t result) {
+	if(result.status != 0 || !streaming) {
+		draining = false;
+		return;
+	}
+
+	uint16_t count = ((fifo_count_raw[0] << 8) | fifo_count_raw[1]) & ICM20602_FIFO_COUNT_MASK;
+	samples_remaining = count / ICM20602_SAMPLE_SIZE;
+
+	if(samples_remaining >= ICM20602_FIFO_MAX_SAMPLES) {
+		// Full, samples have been dropped since the last drain
+		overruns++;
+	}
+
+	read_chunk();
+}
+
+void ICM20602Stream::read_chunk(void) {
+	if(samples_remaining == 0) {
+		draining = false;
+		return;
+	}
+
+	chunk_samples = (samples_remaining > ICM20602_STREAM_CHUNK_SAMPLES)?
+			ICM20602_STREAM_CHUNK_SAMPLES : samples_remaining;
+
+	// FIFO_R_W does not auto-increment, a single burst pops the whole chunk
+	draining = engine.read_registers(address, ICM20602_FIFO_R_W, chunk_raw,
+			chunk_samples * ICM20602_SAMPLE_SIZE, &queue,
+			mbed::callback(this, &ICM20602Stream::on_chunk_read));
+}
+
+void ICM20602Stream::on_chunk_read(i2c_transaction_result_t result) {
+	if(!streaming) {
+		draining = false;
+		return;
+	}
+
+	if(result.status != 0) {
+		// Part of a sample may have been popped, start over from a clean FIFO
+		write_register(ICM20602_USER_CTRL, ICM20602_USER_CTRL_FIFO_EN | ICM20602_USER_CTRL_FIFO_RST);
+		draining = false;
+		return;
+	}
+
+	for(int i = 0; i < chunk_samples; i++) {
+		imu_raw_sample_t sample;
+		parse_sample(&chunk_raw[i * ICM20602_SAMPLE_SIZE], sample);
+
+		last_sample = sample;
+		sample_count++;
+
+		if(builder.append(sample)) {
+			if(frame_sink) {
+				frame_sink(builder.finish());
+			}
+			begin_frame();
+		}
+	}
+
+	samples_remaining -= chunk_samples;
+	read_chunk();
+}
@@ -0,0 +1,180 @@
+/*
+ * icm20602_stream.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef ICM20602_STREAM_H_
+#define ICM20602_STREAM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "events/EventQueue.h"
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+#include "i2c_transaction_engine.h"
+#include "imu_stream_source.h"
+
+/** Bytes per sample in the FIFO and in the output registers (accel, temperature, gyro) */
+#define ICM20602_SAMPLE_SIZE			14
+
+/** FIFO size of the ICM-20602 in bytes */
+#define ICM20602_FIFO_SIZE				1008
+
+/** Samples fetched by each FIFO burst read */
+#define ICM20602_STREAM_CHUNK_SAMPLES	16
+
+/** FIFO level the drain interval is sized for (the FIFO holds 72 samples) */
+#define ICM20602_STREAM_FIFO_TARGET		32
+
+/** Configuration applied by init(), used by the low rate characteristics */
+#define ICM20602_DEFAULT_ODR_HZ			100
+#define ICM20602_DEFAULT_ACCEL_RANGE_G	4
+#define ICM20602_DEFAULT_GYRO_RANGE		IMU_STREAM_GYRO_RANGE_500DPS
+
+/** Gyro start-up time out of sleep (35 ms typical) plus filter settling */
+#define ICM20602_WAKE_MS				50
+
+/**
+ * High rate accelerometer/gyroscope streaming from the ICM-20602 FIFO
+ *
+ * Each FIFO sample is 14 bytes, so one burst read of FIFO_R_W fetches a
+ * whole chunk of samples. The FIFO stops accepting data when it is full
+ * rather than overwriting, so an overrun loses samples without breaking the
+ * packet alignment.
+ *
+ * Output data rate is 1 kHz / (1 + SMPLRT_DIV); the digital low pass
+ * filters are set below half the output data rate.
+ *
+ * All methods and callbacks run on the sensor thread.
+ */
+class ICM20602Stream : public ImuStreamSource, private mbed::NonCopyable<ICM20602Stream> {
+public:
+
+	/**
+	 * @param[in] engine I2C transaction engine shared with the other sensors
+	 * @param[in] queue Event queue of the sensor thread
+	 * @param[in] address 8-bit address of the ICM-20602
+	 */
+	ICM20602Stream(I2CTransactionEngine& engine, events::EventQueue& queue, uint8_t address);
+
+	/** Apply the default rate and ranges, call once after the driver initialized the part */
+	void init(void);
+
+	/**
+	 * Put the part to sleep or wake it up (queued on the engine like every other write)
+	 *
+	 * Accel and gyro are both off while asleep, the gyro needs ICM20602_WAKE_MS after waking.
+	 */
+	void set_sleep(bool sleep);
+
+	/**
+	 * Put only the gyro in standby, the accelerometer keeps running (eg: for wake-on-motion)
+	 *
+	 * The gyro needs ICM20602_WAKE_MS after leaving standby, like after sleep.
+	 */
+	void set_gyro_standby(bool standby);
+
+	virtual void set_frame_sink(frame_sink_t sink) {
+		frame_sink = sink;
+	}
+
+	/**
+	 * Rate is rounded up to the next rate the sample rate divider can
+	 * produce (up to 1 kHz), ranges are rounded up to the next supported
+	 * range (245 dps becomes 250 dps). A rate or accel range of 0 and an
+	 * unknown gyro range keep the current setting.
+	 */
+	virtual void start(const imu_stream_config_t& config);
+
+	/** Stop streaming, the rate and ranges stay in effect */
+	virtual void stop(void);
+
+	virtual bool is_streaming(void) const {
+		return streaming;
+	}
+
+	virtual uint16_t get_odr_hz(void) const {
+		return odr_hz;
+	}
+
+	virtual uint32_t get_poll_interval_ms(void) const;
+
+	virtual void poll(size_t max_frame_size);
+
+	virtual const imu_raw_sample_t& get_last_sample(void) const {
+		return last_sample;
+	}
+
+	virtual bool has_sample(void) const {
+		return sample_count != 0;
+	}
+
+	virtual uint32_t get_sample_count(void) const {
+		return sample_count;
+	}
+
+	virtual uint32_t get_overruns(void) const {
+		return overruns;
+	}
+
+	virtual const char* get_name(void) const {
+		return "icm20602";
+	}
+
+	/** Decode one sample as laid out in the FIFO and the output registers (big endian) */
+	static void parse_sample(const uint8_t* raw, imu_raw_sample_t& sample);
+
+	/** Register the accel/temperature/gyro output registers start at */
+	static uint8_t output_register(void);
+
+	float accel_to_g(int16_t raw) const {
+		return (raw * (float) accel_range_g) / 32768.0f;
+	}
+
+	float gyro_to_dps(int16_t raw) const {
+		return (raw * (float) imu_stream_gyro_range_dps(gyro_range)) / 32768.0f;
+	}
+
+private:
+
+	void configure(const imu_stream_config_t& config);
+
+	void on_fifo_count(i2c_transaction_result_t result);
+
+	void on_chunk_read(i2c_transaction_result_t result);
+
+	void read_chunk(void);
+
+	void begin_frame(void);
+
+	void write_register(uint8_t reg, uint8_t value);
+
+	I2CTransactionEngine& engine;
+	events::EventQueue& queue;
+	uint8_t address;
+	frame_sink_t frame_sink;
+
+	bool streaming;
+	uint16_t odr_hz;
+	uint8_t accel_range_g;
+	imu_stream_gyro_range_t gyro_range;
+
+	/** Drain state */
+	uint8_t fifo_count_raw[2];
+	uint16_t samples_remaining;
+	uint16_t chunk_samples;
+	bool draining;
+	size_t max_frame_size;
+	uint8_t chunk_raw[ICM20602_STREAM_CHUNK_SAMPLES * ICM20602_SAMPLE_SIZE];
+
+	ImuFrameBuilder builder;
+	imu_raw_sample_t last_sample;
+	uint32_t sample_count;
+	uint32_t overruns;
+
+};
+
+#endif /* ICM20602_STREAM_H_ */
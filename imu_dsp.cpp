@@ -0,0 +1,265 @@
+/*
+ * imu_dsp.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "imu_dsp.h"
+
+#include <math.h>
+
+#define IMU_DSP_PI 3.14159265358979323846
+
+void imu_dsp_stats_reference(const float* x, size_t n, imu_dsp_stats_t& stats) {
+	stats.mean = 0.0f;
+	stats.rms = 0.0f;
+	stats.peak_to_peak = 0.0f;
+	stats.crest_factor = 0.0f;
+	if(n == 0) {
+		return;
+	}
+
+	double sum = 0.0;
+	double min = x[0];
+	double max = x[0];
+	for(size_t i = 0; i < n; i++) {
+		sum += x[i];
+		if(x[i] < min) {
+			min = x[i];
+		}
+		if(x[i] > max) {
+			max = x[i];
+		}
+	}
+	double mean = sum / n;
+
+	double squares = 0.0;
+	double peak = 0.0;
+	for(size_t i = 0; i < n; i++) {
+		double deviation = x[i] - mean;
+		squares += deviation * deviation;
+		if(fabs(deviation) > peak) {
+			peak = fabs(deviation);
+		}
+	}
+	double rms = sqrt(squares / n);
+
+	stats.mean = (float) mean;
+	stats.rms = (float) rms;
+	stats.peak_to_peak = (float) (max - min);
+	stats.crest_factor = (rms > 0.0)? (float) (peak / rms) : 0.0f;
+}
+
+void imu_dsp_stats(const float* x, size_t n, imu_dsp_stats_t& stats) {
+	stats.mean = 0.0f;
+	stats.rms = 0.0f;
+	stats.peak_to_peak = 0.0f;
+	stats.crest_factor = 0.0f;
+	if(n == 0) {
+		return;
+	}
+
+	// Two accumulators each, the FPU pipelines them
+	float shift = x[0];
+	float sum[2] = { 0.0f, 0.0f };
+	float squares[2] = { 0.0f, 0.0f };
+	float min = x[0];
+	float max = x[0];
+
+	size_t i = 0;
+	for(; i + 1 < n; i += 2) {
+		float d0 = x[i] - shift;
+		float d1 = x[i + 1] - shift;
+		sum[0] += d0;
+		sum[1] += d1;
+		squares[0] += d0 * d0;
+		squares[1] += d1 * d1;
+		float lo = (x[i] < x[i + 1])? x[i] : x[i + 1];
+		float hi = (x[i] < x[i + 1])? x[i + 1] : x[i];
+		if(lo < min) {
+			min = lo;
+		}
+		if(hi > max) {
+			max = hi;
+		}
+	}
+	if(i < n) {
+		float d = x[i] - shift;
+		sum[0] += d;
+		squares[0] += d * d;
+		if(x[i] < min) {
+			min = x[i];
+		}
+		if(x[i] > max) {
+			max = x[i];
+		}
+	}
+
+	float inv_n = 1.0f / (float) n;
+	float mean_shifted = (sum[0] + sum[1]) * inv_n;
+	float variance = (squares[0] + squares[1]) * inv_n - mean_shifted * mean_shifted;
+	float rms = (variance > 0.0f)? sqrtf(variance) : 0.0f;
+	float mean = shift + mean_shifted;
+
+	// The largest deviation is at one of the extremes
+	float peak = ((max - mean) > (mean - min))? (max - mean) : (mean - min);
+
+	stats.mean = mean;
+	stats.rms = rms;
+	stats.peak_to_peak = max - min;
+	stats.crest_factor = (rms > 0.0f)? peak / rms : 0.0f;
+}
+
+void imu_dsp_dft_reference(const float* x, size_t n, float* spectrum) {
+	for(size_t k = 0; k <= n / 2; k++) {
+		double re = 0.0;
+		double im = 0.0;
+		for(size_t i = 0; i < n; i++) {
+			double angle = 2.0 * IMU_DSP_PI * (double) ((k * i) % n) / (double) n;
+			re += x[i] * cos(angle);
+			im -= x[i] * sin(angle);
+		}
+
+		if(k == 0) {
+			spectrum[0] = (float) re;
+		} else if(k == n / 2) {
+			spectrum[1] = (float) re;
+		} else {
+			spectrum[2*k] = (float) re;
+			spectrum[2*k + 1] = (float) im;
+		}
+	}
+}
+
+ImuRfft::ImuRfft() : n(0), twiddle(), bit_reverse() {
+}
+
+bool ImuRfft::init(size_t size) {
+	if(size < 4 || size > IMU_DSP_MAX_FFT_SIZE || (size & (size - 1)) != 0) {
+		return false;
+	}
+
+	n = size;
+	for(size_t k = 0; k < n / 2; k++) {
+		double angle = 2.0 * IMU_DSP_PI * (double) k / (double) n;
+		twiddle[2*k] = (float) cos(angle);
+		twiddle[2*k + 1] = (float) sin(angle);
+	}
+
+	size_t m = n / 2;
+	size_t bits = 0;
+	while((1U << bits) < m) {
+		bits++;
+	}
+	for(size_t i = 0; i < m; i++) {
+		size_t reversed = 0;
+		for(size_t b = 0; b < bits; b++) {
+			if(i & (1U << b)) {
+				reversed |= 1U << (bits - 1 - b);
+			}
+		}
+		bit_reverse[i] = (uint16_t) reversed;
+	}
+	return true;
+}
+
+void ImuRfft::forward(float* in, float* spectrum) const {
+	// Even samples are the real parts, odd ones the imaginary parts of m complex samples
+	size_t m = n / 2;
+	float* z = in;
+
+	for(size_t i = 0; i < m; i++) {
+		size_t j = bit_reverse[i];
+		if(j > i) {
+			float re = z[2*i];
+			float im = z[2*i + 1];
+			z[2*i] = z[2*j];
+			z[2*i + 1] = z[2*j + 1];
+			z[2*j] = re;
+			z[2*j + 1] = im;
+		}
+	}
+
+	// Radix-2 butterflies, W_m^j = W_n^(2j)
+	for(size_t len = 2; len <= m; len <<= 1) {
+		size_t half = len / 2;
+		size_t step = 2 * (m / len);
+		for(size_t start = 0; start < m; start += len) {
+			for(size_t j = 0; j < half; j++) {
+				float c = twiddle[2 * (j * step)];
+				float s = twiddle[2 * (j * step) + 1];
+				size_t a = 2 * (start + j);
+				size_t b = 2 * (start + j + half);
+				float tr = c * z[b] + s * z[b + 1];
+				float ti = c * z[b + 1] - s * z[b];
+				z[b] = z[a] - tr;
+				z[b + 1] = z[a + 1] - ti;
+				z[a] += tr;
+				z[a + 1] += ti;
+			}
+		}
+	}
+
+	// Split: X[k] = E[k] + W_n^k O[k], E and O from Z[k] and conj(Z[m - k])
+	spectrum[0] = z[0] + z[1];
+	spectrum[1] = z[0] - z[1];
+	for(size_t k = 1; k < m; k++) {
+		float ar = z[2*k];
+		float ai = z[2*k + 1];
+		float br = z[2 * (m - k)];
+		float bi = -z[2 * (m - k) + 1];
+		float er = 0.5f * (ar + br);
+		float ei = 0.5f * (ai + bi);
+		float dr = 0.5f * (ar - br);
+		float di = 0.5f * (ai - bi);
+		float c = twiddle[2*k];
+		float s = twiddle[2*k + 1];
+		spectrum[2*k] = er + c * di - s * dr;
+		spectrum[2*k + 1] = ei - c * dr - s * di;
+	}
+}
+
+float imu_dsp_hann(float* window, size_t n) {
+	double power = 0.0;
+	for(size_t i = 0; i < n; i++) {
+		double w = 0.5 - 0.5 * cos(2.0 * IMU_DSP_PI * (double) i / (double) n);
+		window[i] = (float) w;
+		power += w * w;
+	}
+	return (n != 0)? (float) (power / n) : 0.0f;
+}
+
+void imu_dsp_band_rms(const float* spectrum, size_t n, float window_power, float* bands,
+		size_t band_count) {
+	size_t bins = n / 2;
+	float scale = 2.0f / ((float) n * (float) n * window_power);
+
+	for(size_t band = 0; band < band_count; band++) {
+		size_t first = 1 + (band * bins) / band_count;
+		size_t last = 1 + ((band + 1) * bins) / band_count;
+		float energy = 0.0f;
+		for(size_t k = first; k < last; k++) {
+			if(k == bins) {
+				// Nyquist has no mirror image
+				energy += 0.5f * spectrum[1] * spectrum[1];
+			} else {
+				energy += spectrum[2*k] * spectrum[2*k] + spectrum[2*k + 1] * spectrum[2*k + 1];
+			}
+		}
+		bands[band] = sqrtf(energy * scale);
+	}
+}
+
+size_t imu_dsp_peak_bin(const float* spectrum, size_t n) {
+	size_t peak = 0;
+	float peak_energy = -1.0f;
+	for(size_t k = 1; k <= n / 2; k++) {
+		float energy = (k == n / 2)? spectrum[1] * spectrum[1] :
+				spectrum[2*k] * spectrum[2*k] + spectrum[2*k + 1] * spectrum[2*k + 1];
+		if(energy > peak_energy) {
+			peak_energy = energy;
+			peak = k;
+		}
+	}
+	return peak;
+}
@@ -0,0 +1,103 @@
+/*
+ * imu_dsp.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef IMU_DSP_H_
+#define IMU_DSP_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Signal processing kernels for the IMU features
+ *
+ * Portable C++ without mbed dependencies, so the same file builds on a host
+ * (see imu_dsp_benchmark.h). Every kernel has a reference version, written
+ * the obvious way in double precision, and the version used on the device.
+ *
+ * Spectra use the layout of CMSIS-DSP's arm_rfft_fast_f32() so the FFT can
+ * be swapped for the CMSIS one where the library is available:
+ *
+ *   out[0]        X[0] (real)
+ *   out[1]        X[N/2] (real)
+ *   out[2k:2k+1]  real, imaginary part of X[k], 0 < k < N/2
+ */
+
+/** Largest transform ImuRfft supports */
+#define IMU_DSP_MAX_FFT_SIZE	256
+
+/** Statistics of a window of samples */
+typedef struct {
+	float mean;
+	float rms;				/** Around the mean */
+	float peak_to_peak;
+	float crest_factor;		/** Largest deviation from the mean over the RMS, 0 for a flat signal */
+} imu_dsp_stats_t;
+
+/** Two passes (mean, then deviations) in double precision */
+void imu_dsp_stats_reference(const float* x, size_t n, imu_dsp_stats_t& stats);
+
+/**
+ * Single pass in single precision
+ *
+ * Sums are taken relative to the first sample, which keeps the precision
+ * of small vibrations riding on a large offset (gravity).
+ */
+void imu_dsp_stats(const float* x, size_t n, imu_dsp_stats_t& stats);
+
+/** Direct DFT, O(n^2), the spectrum in the layout above */
+void imu_dsp_dft_reference(const float* x, size_t n, float* spectrum);
+
+/**
+ * Real FFT, O(n log n)
+ *
+ * The n real samples are transformed as n/2 complex ones (radix-2, in place)
+ * and the result split into the spectrum of the real signal. Twiddle factors
+ * and the bit reversal are tabulated once by init().
+ */
+class ImuRfft {
+public:
+
+	ImuRfft();
+
+	/** @retval false unless size is a power of two from 4 to IMU_DSP_MAX_FFT_SIZE */
+	bool init(size_t size);
+
+	size_t get_size(void) const {
+		return n;
+	}
+
+	/**
+	 * Forward transform
+	 * @param[in,out] in n samples, used as scratch and overwritten (like CMSIS)
+	 * @param[out] spectrum n values in the layout above
+	 */
+	void forward(float* in, float* spectrum) const;
+
+private:
+
+	size_t n;
+	float twiddle[IMU_DSP_MAX_FFT_SIZE];			/** cos, sin of 2 pi k / n for k < n/2 */
+	uint16_t bit_reverse[IMU_DSP_MAX_FFT_SIZE / 2];
+
+};
+
+/** Hann window, and its power (mean of the squared coefficients) */
+float imu_dsp_hann(float* window, size_t n);
+
+/**
+ * RMS of bands of equal width, DC excluded
+ *
+ * Bins 1 to n/2 are split into band_count bands. The squares of the bands
+ * add up to the mean square of the signal without its mean (Parseval),
+ * divided by window_power to make up for the window.
+ */
+void imu_dsp_band_rms(const float* spectrum, size_t n, float window_power, float* bands,
+		size_t band_count);
+
+/** Bin with the most energy, DC excluded */
+size_t imu_dsp_peak_bin(const float* spectrum, size_t n);
+
+#endif /* IMU_DSP_H_ */
@@ -0,0 +1,135 @@
+/*
+ * imu_dsp_benchmark.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "imu_dsp_benchmark.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include "imu_dsp.h"
+
+/** Single precision kernels against double precision references */
+#define STATS_TOLERANCE		1e-3f
+#define SPECTRUM_TOLERANCE	1e-4f
+
+static float signal[IMU_DSP_MAX_FFT_SIZE];
+static float scratch[IMU_DSP_MAX_FFT_SIZE];
+static float reference_spectrum[IMU_DSP_MAX_FFT_SIZE];
+static float spectrum[IMU_DSP_MAX_FFT_SIZE];
+static ImuRfft rfft;
+
+/** Keeps the compiler from dropping the results of the timed calls */
+static volatile float sink;
+
+/** 1 g of gravity, 0.2 g at 1/8 and 0.05 g at 3/10 of the sample rate, 0.01 g of noise */
+static void make_signal(size_t n) {
+	uint32_t lcg = 12345;
+	for(size_t i = 0; i < n; i++) {
+		lcg = lcg * 1664525UL + 1013904223UL;
+		float noise = ((float) (lcg >> 8) / 16777216.0f - 0.5f) * 0.02f;
+		signal[i] = 1.0f + 0.2f * sinf(2.0f * 3.14159265f * 0.125f * i) +
+				0.05f * sinf(2.0f * 3.14159265f * 0.3f * i + 1.0f) + noise;
+	}
+}
+
+static uint32_t per_call_ns(uint32_t elapsed_us, uint32_t iterations) {
+	return (uint32_t) (((uint64_t) elapsed_us * 1000) / iterations);
+}
+
+/** Relative error in parts per billion, the console has no float formatting */
+static unsigned long ppb(float error) {
+	return (unsigned long) (error * 1e9f + 0.5f);
+}
+
+static float difference(float a, float b) {
+	return fabsf(a - b);
+}
+
+bool imu_dsp_benchmark(size_t fft_size, uint32_t iterations, uint32_t (*clock_us)(void),
+		imu_dsp_benchmark_result_t& result) {
+	result = imu_dsp_benchmark_result_t();
+	result.fft_size = fft_size;
+	result.iterations = iterations;
+	if(iterations == 0 || !rfft.init(fft_size)) {
+		return false;
+	}
+
+	size_t n = fft_size;
+	make_signal(n);
+
+	imu_dsp_stats_t reference_stats;
+	imu_dsp_stats_t stats;
+
+	uint32_t start = clock_us();
+	for(uint32_t i = 0; i < iterations; i++) {
+		imu_dsp_stats_reference(signal, n, reference_stats);
+		sink = reference_stats.rms;
+	}
+	result.stats_reference_ns = per_call_ns(clock_us() - start, iterations);
+
+	start = clock_us();
+	for(uint32_t i = 0; i < iterations; i++) {
+		imu_dsp_stats(signal, n, stats);
+		sink = stats.rms;
+	}
+	result.stats_ns = per_call_ns(clock_us() - start, iterations);
+
+	start = clock_us();
+	for(uint32_t i = 0; i < iterations; i++) {
+		imu_dsp_dft_reference(signal, n, reference_spectrum);
+		sink = reference_spectrum[0];
+	}
+	result.dft_reference_ns = per_call_ns(clock_us() - start, iterations);
+
+	// The copy is part of the cost, forward() overwrites its input like arm_rfft_fast_f32()
+	start = clock_us();
+	for(uint32_t i = 0; i < iterations; i++) {
+		for(size_t k = 0; k < n; k++) {
+			scratch[k] = signal[k];
+		}
+		rfft.forward(scratch, spectrum);
+		sink = spectrum[0];
+	}
+	result.fft_ns = per_call_ns(clock_us() - start, iterations);
+
+	float rms = reference_stats.rms;
+	float error = difference(stats.mean, reference_stats.mean);
+	if(difference(stats.rms, reference_stats.rms) > error) {
+		error = difference(stats.rms, reference_stats.rms);
+	}
+	if(difference(stats.peak_to_peak, reference_stats.peak_to_peak) > error) {
+		error = difference(stats.peak_to_peak, reference_stats.peak_to_peak);
+	}
+	result.stats_error = error / rms;
+	result.crest_error = difference(stats.crest_factor, reference_stats.crest_factor) /
+			reference_stats.crest_factor;
+
+	float largest = 0.0f;
+	error = 0.0f;
+	for(size_t k = 0; k < n; k++) {
+		if(fabsf(reference_spectrum[k]) > largest) {
+			largest = fabsf(reference_spectrum[k]);
+		}
+		if(difference(spectrum[k], reference_spectrum[k]) > error) {
+			error = difference(spectrum[k], reference_spectrum[k]);
+		}
+	}
+	result.spectrum_error = error / largest;
+
+	return result.stats_error < STATS_TOLERANCE && result.crest_error < STATS_TOLERANCE &&
+			result.spectrum_error < SPECTRUM_TOLERANCE;
+}
+
+void imu_dsp_benchmark_print(const imu_dsp_benchmark_result_t& result) {
+	printf("dsp: %u points, %lu iterations\r\n", (unsigned) result.fft_size,
+			(unsigned long) result.iterations);
+	printf("dsp: stats %lu ns (reference %lu ns), error %lu ppb, crest factor %lu ppb\r\n",
+			(unsigned long) result.stats_ns, (unsigned long) result.stats_reference_ns,
+			ppb(result.stats_error), ppb(result.crest_error));
+	printf("dsp: fft %lu ns (reference dft %lu ns), error %lu ppb\r\n",
+			(unsigned long) result.fft_ns, (unsigned long) result.dft_reference_ns,
+			ppb(result.spectrum_error));
+}
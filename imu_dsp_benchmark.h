@@ -0,0 +1,44 @@
+/*
+ * imu_dsp_benchmark.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef IMU_DSP_BENCHMARK_H_
+#define IMU_DSP_BENCHMARK_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct {
+	size_t fft_size;
+	uint32_t iterations;
+	uint32_t stats_reference_ns;	/** Per call, averaged over the iterations */
+	uint32_t stats_ns;
+	uint32_t dft_reference_ns;
+	uint32_t fft_ns;
+	float stats_error;				/** Largest difference of mean, RMS, peak-to-peak, relative to the RMS */
+	float crest_error;
+	float spectrum_error;			/** Largest difference of a bin, relative to the largest bin */
+} imu_dsp_benchmark_result_t;
+
+/**
+ * Time the kernels of imu_dsp.h against their reference versions
+ *
+ * Runs both on the same synthetic accelerometer signal (gravity, two tones
+ * and noise) and reports the time per call and the largest difference of
+ * their results. Runs on the board from the console (DSP_BENCHMARK_COMMAND
+ * in main.cpp), and on a host as tests/host/bench_imu_dsp.
+ *
+ * Not reentrant (static buffers, they would not fit the console stack).
+ *
+ * @param[in] fft_size Power of two, up to IMU_DSP_MAX_FFT_SIZE
+ * @param[in] clock_us Free running microsecond counter
+ * @retval false if fft_size is not supported or the results differ by more than expected
+ */
+bool imu_dsp_benchmark(size_t fft_size, uint32_t iterations, uint32_t (*clock_us)(void),
+		imu_dsp_benchmark_result_t& result);
+
+void imu_dsp_benchmark_print(const imu_dsp_benchmark_result_t& result);
+
+#endif /* IMU_DSP_BENCHMARK_H_ */
@@ -0,0 +1,109 @@
+/*
+ * imu_feature_service.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "imu_feature_service.h"
+
+#include <string.h>
+
+#include "gatt_units.h"
+
+static void put_u16(uint8_t* p, uint16_t value) {
+	p[0] = (uint8_t) (value & 0xFF);
+	p[1] = (uint8_t) (value >> 8);
+}
+
+static uint8_t log2_window(void) {
+	uint8_t bits = 0;
+	while((1U << bits) < IMU_FEATURES_WINDOW_SIZE) {
+		bits++;
+	}
+	return bits;
+}
+
+ImuFeatureService::ImuFeatureService(events::EventQueue& queue) :
+	queue(queue),
+	ble(NULL),
+	feature_value(),
+	feature_char(UUID(IMU_FEATURE_CHAR_UUID), feature_value,
+			GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY),
+	values(),
+	update_scheduled(false),
+	updates(0) {
+}
+
+void ImuFeatureService::start(BLE& ble) {
+	this->ble = &ble;
+
+	GattCharacteristic* chars[] = { &feature_char };
+	GattService service(UUID(IMU_FEATURE_SERVICE_UUID), chars, sizeof(chars) / sizeof(chars[0]));
+
+	ble.gattServer().addService(service);
+
+	// Vectors computed before the service existed
+	update();
+}
+
+void ImuFeatureService::encode(const imu_features_t& features, imu_feature_value_t& value) {
+	uint8_t* p = value.data;
+
+	p[0] = (uint8_t) ((IMU_FEATURE_VERSION << 4) | (features.source & 0x0F));
+	p[1] = log2_window();
+	put_u16(&p[2], features.sequence);
+	put_u16(&p[4], DeciHertzFromHertz::from_float(features.sample_rate_hz));
+	p += 6;
+
+	for(int i = 0; i < 3; i++) {
+		put_u16(&p[0], MilliGMagnitudeFromG::from_float(features.axis[i].rms));
+		put_u16(&p[2], MilliGMagnitudeFromG::from_float(features.axis[i].peak_to_peak));
+		put_u16(&p[4], HundredthsFromRatio::from_float(features.axis[i].crest_factor));
+		p += 6;
+	}
+
+	for(int i = 0; i < IMU_FEATURES_BAND_COUNT; i++) {
+		put_u16(p, MilliGMagnitudeFromG::from_float(features.band_rms[i]));
+		p += 2;
+	}
+
+	put_u16(p, DeciHertzFromHertz::from_float(features.peak_hz));
+}
+
+bool ImuFeatureService::set_features(const imu_features_t& features) {
+	imu_feature_value_t value;
+	encode(features, value);
+	if(!values.push(value)) {
+		return false;
+	}
+
+	if(!update_scheduled.exchange(true)) {
+		if(queue.call(mbed::callback(this, &ImuFeatureService::update)) == 0) {
+			update_scheduled.store(false);
+		}
+	}
+	return true;
+}
+
+void ImuFeatureService::update(void) {
+	update_scheduled.store(false);
+
+	if(ble == NULL) {
+		// start() writes whatever has been computed by then
+		return;
+	}
+
+	// Only the latest vector is worth notifying
+	imu_feature_value_t value;
+	bool latest = false;
+	while(values.pop(value)) {
+		latest = true;
+	}
+	if(!latest) {
+		return;
+	}
+
+	memcpy(feature_value, value.data, sizeof(feature_value));
+	ble->gattServer().write(feature_char.getValueHandle(), feature_value, sizeof(feature_value));
+	updates++;
+}
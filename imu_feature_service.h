@@ -0,0 +1,101 @@
+/*
+ * imu_feature_service.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef IMU_FEATURE_SERVICE_H_
+#define IMU_FEATURE_SERVICE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#include "ble/BLE.h"
+#include "ble/GattServer.h"
+#include "events/EventQueue.h"
+#include "platform/NonCopyable.h"
+
+#include "imu_features.h"
+#include "spsc_ring.h"
+
+#define IMU_FEATURE_SERVICE_UUID	"00000013-8dd4-4087-a16a-04a7c8e01734"
+#define IMU_FEATURE_CHAR_UUID		"00001013-8dd4-4087-a16a-04a7c8e01734"
+
+/**
+ * Feature vector (all fields little endian), 42 bytes:
+ *
+ *   [0]      version (high nibble) | imu_stream_source_t (low nibble)
+ *   [1]      log2 of the window size in samples
+ *   [2:3]    window sequence number, wraps at 0xFFFF
+ *   [4:5]    sample rate, uint16 0.1 Hz
+ *   [6:23]   x, y, z axis: RMS, peak-to-peak (uint16 mg), crest factor (uint16 0.01)
+ *   [24:39]  RMS of the vector magnitude in IMU_FEATURES_BAND_COUNT bands of equal
+ *            width from DC to half the sample rate, uint16 mg
+ *   [40:41]  strongest frequency of the vector magnitude, uint16 0.1 Hz
+ *
+ * scripts/imu_features.py decodes this format.
+ */
+#define IMU_FEATURE_VERSION		1
+#define IMU_FEATURE_VALUE_SIZE	(6 + 3 * 6 + 2 * IMU_FEATURES_BAND_COUNT + 2)
+
+/** Feature vectors buffered between the sensor thread and the BLE stack */
+#define IMU_FEATURE_QUEUE_DEPTH	2
+
+typedef struct {
+	uint8_t data[IMU_FEATURE_VALUE_SIZE];
+} imu_feature_value_t;
+
+/**
+ * Vibration features computed on the device
+ *
+ * Clients that cannot keep up with the raw IMU stream get a summary of
+ * every window instead (see ImuFeatureExtractor): the feature
+ * characteristic is read and notify. Notifications carry the whole vector
+ * from an ATT MTU of 45, below that clients should read the characteristic.
+ *
+ * Vectors are encoded on the sensor thread with set_features() and
+ * written to the characteristic from the BLE event queue.
+ */
+class ImuFeatureService : private mbed::NonCopyable<ImuFeatureService> {
+public:
+
+	ImuFeatureService(events::EventQueue& queue);
+
+	void start(BLE& ble);
+
+	/**
+	 * Producer side: encode a feature vector and schedule its notification
+	 * @retval false if the queue is full and the vector was dropped
+	 */
+	bool set_features(const imu_features_t& features);
+
+	static void encode(const imu_features_t& features, imu_feature_value_t& value);
+
+	uint32_t get_updates(void) const {
+		return updates;
+	}
+
+	/** Vectors the BLE thread did not pick up in time */
+	uint32_t get_dropped(void) const {
+		return values.get_dropped();
+	}
+
+private:
+
+	/** Write the latest vector to the characteristic, BLE thread */
+	void update(void);
+
+	events::EventQueue& queue;
+	BLE* ble;
+
+	uint8_t feature_value[IMU_FEATURE_VALUE_SIZE];
+	ReadOnlyArrayGattCharacteristic<uint8_t, IMU_FEATURE_VALUE_SIZE> feature_char;
+
+	SpscRing<imu_feature_value_t, IMU_FEATURE_QUEUE_DEPTH> values;
+	std::atomic<bool> update_scheduled;
+	uint32_t updates;
+
+};
+
+#endif /* IMU_FEATURE_SERVICE_H_ */
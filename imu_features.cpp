@@ -0,0 +1,92 @@
+/*
+ * imu_features.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "imu_features.h"
+
+#include <math.h>
+
+static_assert((IMU_FEATURES_WINDOW_SIZE & (IMU_FEATURES_WINDOW_SIZE - 1)) == 0 &&
+		IMU_FEATURES_WINDOW_SIZE <= IMU_DSP_MAX_FFT_SIZE,
+		"IMU_FEATURES_WINDOW_SIZE must be a power of two the FFT supports");
+
+ImuFeatureExtractor::ImuFeatureExtractor() :
+	rfft(),
+	hann(),
+	hann_power(0.0f),
+	samples(),
+	count(0),
+	scratch(),
+	spectrum(),
+	source(0),
+	sample_rate_hz(0.0f),
+	sequence(0),
+	windows(0),
+	discarded(0) {
+}
+
+void ImuFeatureExtractor::init(void) {
+	rfft.init(IMU_FEATURES_WINDOW_SIZE);
+	hann_power = imu_dsp_hann(hann, IMU_FEATURES_WINDOW_SIZE);
+}
+
+void ImuFeatureExtractor::set_source(uint8_t source, float sample_rate_hz) {
+	if(source == this->source && sample_rate_hz == this->sample_rate_hz) {
+		return;
+	}
+
+	if(count != 0) {
+		discarded++;
+	}
+	count = 0;
+	this->source = source;
+	this->sample_rate_hz = sample_rate_hz;
+}
+
+bool ImuFeatureExtractor::add(const float accel_g[3]) {
+	if(count >= IMU_FEATURES_WINDOW_SIZE) {
+		return true;
+	}
+
+	for(int i = 0; i < 3; i++) {
+		samples[i][count] = accel_g[i];
+	}
+	count++;
+
+	return count >= IMU_FEATURES_WINDOW_SIZE;
+}
+
+void ImuFeatureExtractor::compute(imu_features_t& features) {
+	const size_t n = IMU_FEATURES_WINDOW_SIZE;
+
+	features.source = source;
+	features.sample_rate_hz = sample_rate_hz;
+	features.sequence = sequence++;
+
+	for(int i = 0; i < 3; i++) {
+		imu_dsp_stats(samples[i], n, features.axis[i]);
+	}
+
+	// Orientation does not matter for the magnitude, gravity ends up in its mean
+	float sum = 0.0f;
+	for(size_t k = 0; k < n; k++) {
+		float x = samples[0][k];
+		float y = samples[1][k];
+		float z = samples[2][k];
+		scratch[k] = sqrtf(x * x + y * y + z * z);
+		sum += scratch[k];
+	}
+	float mean = sum / (float) n;
+	for(size_t k = 0; k < n; k++) {
+		scratch[k] = (scratch[k] - mean) * hann[k];
+	}
+
+	rfft.forward(scratch, spectrum);
+	imu_dsp_band_rms(spectrum, n, hann_power, features.band_rms, IMU_FEATURES_BAND_COUNT);
+	features.peak_hz = (float) imu_dsp_peak_bin(spectrum, n) * sample_rate_hz / (float) n;
+
+	count = 0;
+	windows++;
+}
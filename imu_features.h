@@ -0,0 +1,101 @@
+/*
+ * imu_features.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef IMU_FEATURES_H_
+#define IMU_FEATURES_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "imu_dsp.h"
+
+/** Samples per window, power of two (the FFT size) */
+#define IMU_FEATURES_WINDOW_SIZE	128
+
+/** Bands the spectrum is summarized in, between DC and half the sample rate */
+#define IMU_FEATURES_BAND_COUNT		8
+
+/** Features of one window of accelerometer samples, in g */
+typedef struct {
+	uint8_t source;					/** imu_stream_source_t */
+	float sample_rate_hz;
+	uint16_t sequence;				/** Increments with every window */
+	imu_dsp_stats_t axis[3];		/** x, y, z */
+	float band_rms[IMU_FEATURES_BAND_COUNT];	/** Of the vector magnitude */
+	float peak_hz;					/** Strongest frequency of the vector magnitude, DC excluded */
+} imu_features_t;
+
+/**
+ * Vibration features over fixed windows of accelerometer samples
+ *
+ * Samples are collected into windows of IMU_FEATURES_WINDOW_SIZE, one after
+ * the other (no overlap). Every window gives the statistics of each axis,
+ * and the spectrum of the vector magnitude (Hann window, mean removed):
+ * the RMS in IMU_FEATURES_BAND_COUNT bands of equal width, and the
+ * strongest frequency.
+ *
+ * Not thread safe, feed it from a single thread (the sensor thread).
+ */
+class ImuFeatureExtractor {
+public:
+
+	ImuFeatureExtractor();
+
+	/** Tabulate the FFT and window */
+	void init(void);
+
+	/**
+	 * Source and rate of the samples to come
+	 *
+	 * A change throws away the window collected so far, it mixed in
+	 * samples at another rate.
+	 */
+	void set_source(uint8_t source, float sample_rate_hz);
+
+	float get_sample_rate(void) const {
+		return sample_rate_hz;
+	}
+
+	/**
+	 * Add one sample
+	 * @retval true once the window is full, call compute() before adding more
+	 */
+	bool add(const float accel_g[3]);
+
+	/** Features of the full window, starts the next one */
+	void compute(imu_features_t& features);
+
+	uint32_t get_windows(void) const {
+		return windows;
+	}
+
+	/** Windows thrown away because the source or rate changed */
+	uint32_t get_discarded(void) const {
+		return discarded;
+	}
+
+private:
+
+	ImuRfft rfft;
+	float hann[IMU_FEATURES_WINDOW_SIZE];
+	float hann_power;
+
+	float samples[3][IMU_FEATURES_WINDOW_SIZE];
+	size_t count;
+
+	/** FFT input (overwritten) and output */
+	float scratch[IMU_FEATURES_WINDOW_SIZE];
+	float spectrum[IMU_FEATURES_WINDOW_SIZE];
+
+	uint8_t source;
+	float sample_rate_hz;
+	uint16_t sequence;
+	uint32_t windows;
+	uint32_t discarded;
+
+};
+
+#endif /* IMU_FEATURES_H_ */
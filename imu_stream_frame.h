@@ -0,0 +1,195 @@
+/*
+ * imu_stream_frame.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef IMU_STREAM_FRAME_H_
+#define IMU_STREAM_FRAME_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Multi-sample IMU notification frame (all fields little endian)
+ *
+ * Header (8 bytes):
+ *   [0]    version (high nibble) | imu_stream_source_t (low nibble)
+ *   [1]    number of samples in the frame
+ *   [2:3]  frame sequence number, wraps at 0xFFFF
+ *   [4:5]  output data rate in Hz
+ *   [6]    accelerometer full scale in g
+ *   [7]    imu_stream_gyro_range_t
+ *
+ * Followed by 12 bytes per sample:
+ *   accel x, y, z, gyro x, y, z as int16 raw counts
+ *   (physical value = raw * full scale / 32768)
+ *
+ * scripts/imu_stream.py decodes this format.
+ */
+#define IMU_STREAM_FRAME_VERSION	1
+#define IMU_STREAM_HEADER_SIZE		8
+#define IMU_STREAM_SAMPLE_SIZE		12
+
+/** Header field offsets */
+#define IMU_STREAM_VERSION_SOURCE	0
+#define IMU_STREAM_SAMPLE_COUNT		1
+#define IMU_STREAM_SEQUENCE			2
+#define IMU_STREAM_ODR				4
+#define IMU_STREAM_ACCEL_RANGE		6
+#define IMU_STREAM_GYRO_RANGE		7
+
+/** Largest frame, fills one notification at an ATT MTU of 247 */
+#define IMU_STREAM_MAX_FRAME_SIZE	244
+
+/** Smallest frame that carries at least one sample (ATT MTU of 23) */
+#define IMU_STREAM_MIN_FRAME_SIZE	20
+
+typedef enum {
+	IMU_STREAM_SOURCE_LSM9DS1 = 0,
+	IMU_STREAM_SOURCE_ICM20602 = 1
+} imu_stream_source_t;
+
+typedef enum {
+	IMU_STREAM_GYRO_RANGE_245DPS = 0,
+	IMU_STREAM_GYRO_RANGE_500DPS = 1,
+	IMU_STREAM_GYRO_RANGE_2000DPS = 2,
+	IMU_STREAM_GYRO_RANGE_250DPS = 3,
+	IMU_STREAM_GYRO_RANGE_1000DPS = 4
+} imu_stream_gyro_range_t;
+
+typedef struct {
+	int16_t accel[3];
+	int16_t gyro[3];
+} imu_raw_sample_t;
+
+/** Streaming configuration requested by the client */
+typedef struct {
+	uint16_t odr_hz;
+	uint8_t accel_range_g;		/** 2, 4, 8 or 16 */
+	uint8_t gyro_range;			/** imu_stream_gyro_range_t */
+} imu_stream_config_t;
+
+/** Full scale of a gyro range in degrees per second */
+static inline uint16_t imu_stream_gyro_range_dps(imu_stream_gyro_range_t range) {
+	switch(range) {
+	case IMU_STREAM_GYRO_RANGE_245DPS:
+		return 245;
+	case IMU_STREAM_GYRO_RANGE_500DPS:
+		return 500;
+	case IMU_STREAM_GYRO_RANGE_2000DPS:
+		return 2000;
+	case IMU_STREAM_GYRO_RANGE_250DPS:
+		return 250;
+	case IMU_STREAM_GYRO_RANGE_1000DPS:
+		return 1000;
+	default:
+		return 0;
+	}
+}
+
+/** Complete frame as queued for notification */
+typedef struct {
+	uint8_t len;
+	uint8_t data[IMU_STREAM_MAX_FRAME_SIZE];
+} imu_stream_frame_t;
+
+static inline uint8_t imu_stream_frame_sample_count(const imu_stream_frame_t& frame) {
+	return frame.data[IMU_STREAM_SAMPLE_COUNT];
+}
+
+/** Accelerometer full scale in g, raw counts * full scale / 32768 is the acceleration */
+static inline uint8_t imu_stream_frame_accel_range_g(const imu_stream_frame_t& frame) {
+	return frame.data[IMU_STREAM_ACCEL_RANGE];
+}
+
+/** Decode sample index of a frame, index < imu_stream_frame_sample_count() */
+static inline imu_raw_sample_t imu_stream_frame_sample(const imu_stream_frame_t& frame, int index) {
+	const uint8_t* p = &frame.data[IMU_STREAM_HEADER_SIZE + index * IMU_STREAM_SAMPLE_SIZE];
+	imu_raw_sample_t sample;
+	for(int i = 0; i < 3; i++) {
+		sample.accel[i] = (int16_t) (p[2*i] | (p[2*i + 1] << 8));
+		sample.gyro[i] = (int16_t) (p[6 + 2*i] | (p[6 + 2*i + 1] << 8));
+	}
+	return sample;
+}
+
+/**
+ * Packs raw IMU samples into notification frames
+ */
+class ImuFrameBuilder {
+public:
+
+	ImuFrameBuilder() : frame(), capacity(0), sequence(0) {
+	}
+
+	/**
+	 * Start a new frame
+	 * @param[in] max_size Usable notification payload (ATT MTU - 3)
+	 */
+	void begin(imu_stream_source_t source, uint16_t odr_hz, uint8_t accel_range_g,
+			imu_stream_gyro_range_t gyro_range, size_t max_size) {
+		if(max_size > IMU_STREAM_MAX_FRAME_SIZE) {
+			max_size = IMU_STREAM_MAX_FRAME_SIZE;
+		}
+		capacity = (max_size < IMU_STREAM_HEADER_SIZE)? 0 :
+				(max_size - IMU_STREAM_HEADER_SIZE) / IMU_STREAM_SAMPLE_SIZE;
+
+		frame.data[IMU_STREAM_VERSION_SOURCE] =
+				(uint8_t) ((IMU_STREAM_FRAME_VERSION << 4) | (source & 0x0F));
+		frame.data[IMU_STREAM_SAMPLE_COUNT] = 0;
+		put_u16(&frame.data[IMU_STREAM_SEQUENCE], sequence);
+		put_u16(&frame.data[IMU_STREAM_ODR], odr_hz);
+		frame.data[IMU_STREAM_ACCEL_RANGE] = accel_range_g;
+		frame.data[IMU_STREAM_GYRO_RANGE] = (uint8_t) gyro_range;
+		frame.len = IMU_STREAM_HEADER_SIZE;
+	}
+
+	/**
+	 * Append a sample
+	 * @retval true if the frame is full and should be sent
+	 */
+	bool append(const imu_raw_sample_t& sample) {
+		if(count() >= capacity) {
+			return true;
+		}
+
+		uint8_t* p = &frame.data[frame.len];
+		for(int i = 0; i < 3; i++) {
+			put_u16(&p[2*i], (uint16_t) sample.accel[i]);
+			put_u16(&p[6 + 2*i], (uint16_t) sample.gyro[i]);
+		}
+		frame.len += IMU_STREAM_SAMPLE_SIZE;
+		frame.data[IMU_STREAM_SAMPLE_COUNT]++;
+
+		return count() >= capacity;
+	}
+
+	uint8_t count(void) const {
+		return imu_stream_frame_sample_count(frame);
+	}
+
+	bool empty(void) const {
+		return count() == 0;
+	}
+
+	/** Finished frame, advances the sequence number */
+	const imu_stream_frame_t& finish(void) {
+		sequence++;
+		return frame;
+	}
+
+private:
+
+	static void put_u16(uint8_t* p, uint16_t value) {
+		p[0] = (uint8_t) (value & 0xFF);
+		p[1] = (uint8_t) (value >> 8);
+	}
+
+	imu_stream_frame_t frame;
+	size_t capacity;
+	uint16_t sequence;
+
+};
+
+#endif /* IMU_STREAM_FRAME_H_ */
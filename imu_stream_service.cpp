@@ -0,0 +1,275 @@
+/*
+ * imu_stream_service.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "imu_stream_service.h"
+
+#include <stdio.h>
+
+/** Notification payload is the ATT MTU minus the opcode and handle */
+#define ATT_NOTIFICATION_HEADER_SIZE 3
+
+#define ATT_DEFAULT_MTU 23
+
+ImuStreamService::ImuStreamService(events::EventQueue& queue) :
+	queue(queue),
+	ble(NULL),
+	connections(NULL),
+	subscription_bit(-1),
+	stream_control_cb(),
+	data_value(),
+	odr_value(IMU_STREAM_DEFAULT_ODR_HZ),
+	range_value(),
+	data_char(UUID(IMU_STREAM_DATA_CHAR_UUID), data_value, 0, sizeof(data_value),
+			GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ |
+			GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY, NULL, 0, true),
+	odr_char(UUID(IMU_STREAM_ODR_CHAR_UUID), &odr_value),
+	range_char(UUID(IMU_STREAM_RANGE_CHAR_UUID), range_value),
+	frames(),
+	drain_scheduled(false),
+	max_frame_size(ATT_DEFAULT_MTU - ATT_NOTIFICATION_HEADER_SIZE),
+	streaming(false),
+	config(),
+	history(),
+	history_head(0),
+	readers(),
+	credit_cursor(0),
+	frames_sent(0),
+	frames_skipped(0),
+	bytes_sent(0) {
+	config.odr_hz = IMU_STREAM_DEFAULT_ODR_HZ;
+	config.accel_range_g = IMU_STREAM_DEFAULT_ACCEL_RANGE_G;
+	config.gyro_range = IMU_STREAM_DEFAULT_GYRO_RANGE;
+	range_value[0] = config.accel_range_g;
+	range_value[1] = config.gyro_range;
+}
+
+void ImuStreamService::start(BLE& ble, ConnectionTable& connections) {
+	this->ble = &ble;
+	this->connections = &connections;
+
+	GattCharacteristic* chars[] = { &data_char, &odr_char, &range_char };
+	GattService service(UUID(IMU_STREAM_SERVICE_UUID), chars, sizeof(chars) / sizeof(chars[0]));
+
+	ble.gattServer().addService(service);
+
+	ble.gattServer().write(odr_char.getValueHandle(), (const uint8_t*) &odr_value,
+			sizeof(odr_value), true);
+	ble.gattServer().write(range_char.getValueHandle(), range_value, sizeof(range_value), true);
+
+	subscription_bit = connections.track(data_char);
+
+	connections.on_subscriptions_changed().attach(
+			mbed::callback(this, &ImuStreamService::on_subscriptions_changed));
+	ble.gattServer().onDataWritten(this, &ImuStreamService::on_data_written);
+	ble.gattServer().onDataSent(this, &ImuStreamService::on_data_sent);
+}
+
+void ImuStreamService::set_att_mtu(uint16_t att_mtu) {
+	size_t size = (att_mtu > ATT_NOTIFICATION_HEADER_SIZE)?
+			(att_mtu - ATT_NOTIFICATION_HEADER_SIZE) : 0;
+	if(size > IMU_STREAM_MAX_FRAME_SIZE) {
+		size = IMU_STREAM_MAX_FRAME_SIZE;
+	}
+	if(size < IMU_STREAM_MIN_FRAME_SIZE) {
+		size = IMU_STREAM_MIN_FRAME_SIZE;
+	}
+	max_frame_size.store(size);
+}
+
+void ImuStreamService::stop_streaming(void) {
+	for(int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+		readers[i].active = false;
+	}
+
+	if(!streaming) {
+		return;
+	}
+
+	streaming = false;
+	if(stream_control_cb) {
+		stream_control_cb(false, config);
+	}
+}
+
+void ImuStreamService::on_disconnect(ble::connection_handle_t handle) {
+	for(int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+		if(readers[i].active && readers[i].handle == handle) {
+			readers[i].active = false;
+		}
+	}
+
+	update_streaming();
+}
+
+void ImuStreamService::commit(void) {
+	if(frames.empty() || drain_scheduled.exchange(true)) {
+		return;
+	}
+
+	if(queue.call(mbed::callback(this, &ImuStreamService::drain)) == 0) {
+		drain_scheduled.store(false);
+	}
+}
+
+void ImuStreamService::drain(void) {
+	drain_scheduled.store(false);
+
+	imu_stream_frame_t frame;
+
+	// Frames go to the history first, every connection reads them from there
+	while(frames.pop(frame)) {
+		if(!streaming || ble == NULL) {
+			// Nobody is listening anymore, throw away stale frames
+			continue;
+		}
+
+		history[history_head & (IMU_STREAM_HISTORY_DEPTH - 1)] = frame;
+		history_head++;
+	}
+
+	if(!streaming || ble == NULL) {
+		return;
+	}
+
+	for(int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+		send(i);
+	}
+}
+
+void ImuStreamService::send(int index) {
+	if(!connections->is_subscribed(index, subscription_bit)) {
+		readers[index].active = false;
+		return;
+	}
+
+	reader_t& reader = readers[index];
+	const ble_connection_t& connection = connections->at(index);
+
+	if(!reader.active || reader.handle != connection.handle) {
+		// New subscriber, starts with the next frame
+		reader.active = true;
+		reader.handle = connection.handle;
+		reader.next = history_head;
+		reader.in_flight = 0;
+		reader.frames_sent = 0;
+		reader.frames_skipped = 0;
+	}
+
+	uint32_t behind = history_head - reader.next;
+	if(behind > IMU_STREAM_HISTORY_DEPTH) {
+		// Overwritten while this central was busy, the others kept going
+		uint32_t skipped = behind - IMU_STREAM_HISTORY_DEPTH;
+		reader.next += skipped;
+		reader.frames_skipped += skipped;
+		frames_skipped += skipped;
+	}
+
+	while(reader.next != history_head && reader.in_flight < IMU_STREAM_MAX_IN_FLIGHT) {
+		const imu_stream_frame_t& frame = history[reader.next & (IMU_STREAM_HISTORY_DEPTH - 1)];
+
+		ble_error_t error = ble->gattServer().write(reader.handle, data_char.getValueHandle(),
+				frame.data, frame.len);
+		if(error) {
+			// This connection's buffers are full, retried on the next drain
+			break;
+		}
+
+		reader.next++;
+		reader.in_flight++;
+		reader.frames_sent++;
+		frames_sent++;
+		bytes_sent += frame.len;
+	}
+}
+
+bool ImuStreamService::is_subscribed(ble::connection_handle_t handle) const {
+	if(connections == NULL) {
+		return false;
+	}
+
+	int index = connections->index_of(handle);
+	return index >= 0 && connections->is_subscribed(index, subscription_bit);
+}
+
+void ImuStreamService::update_streaming(void) {
+	if(connections == NULL) {
+		return;
+	}
+
+	bool subscribed = connections->get_subscriber_count(subscription_bit) != 0;
+	if(subscribed == streaming) {
+		return;
+	}
+
+	if(!subscribed) {
+		stop_streaming();
+		return;
+	}
+
+	streaming = true;
+	if(stream_control_cb) {
+		stream_control_cb(true, config);
+	}
+}
+
+void ImuStreamService::on_subscriptions_changed(GattAttribute::Handle_t handle) {
+	if(handle != data_char.getValueHandle()) {
+		return;
+	}
+
+	update_streaming();
+}
+
+void ImuStreamService::on_data_written(const GattWriteCallbackParams* params) {
+	if(params->handle == odr_char.getValueHandle() && params->len == sizeof(uint16_t)) {
+		config.odr_hz = (uint16_t) (params->data[0] | (params->data[1] << 8));
+	} else if(params->handle == range_char.getValueHandle() && params->len == sizeof(range_value)) {
+		config.accel_range_g = params->data[0];
+		config.gyro_range = params->data[1];
+	} else {
+		return;
+	}
+
+	// Restart with the new configuration, shared by every subscriber
+	if(streaming && stream_control_cb) {
+		stream_control_cb(true, config);
+	}
+}
+
+void ImuStreamService::on_data_sent(unsigned count) {
+	// The count covers every notification sent by the server, not just ours,
+	// and does not say which connection it was sent on. Credits are handed
+	// back round robin over the connections waiting for them, which errs on
+	// the side of releasing credits early: a stalled central then fails the
+	// write and is skipped rather than holding the others back.
+	for(int checked = 0; count != 0 && checked < BLE_MAX_CONNECTIONS; ) {
+		reader_t& reader = readers[credit_cursor];
+		credit_cursor = (credit_cursor + 1) % BLE_MAX_CONNECTIONS;
+		if(!reader.active || reader.in_flight == 0) {
+			checked++;
+			continue;
+		}
+		reader.in_flight--;
+		count--;
+		checked = 0;
+	}
+
+	if(streaming) {
+		drain();
+	}
+}
+
+void ImuStreamService::print_stats(void) {
+	for(int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+		const reader_t& reader = readers[i];
+		if(!reader.active) {
+			continue;
+		}
+		printf("\t%u: %lu frames sent, %lu skipped, %u in flight, %lu behind\r\n", reader.handle,
+				(unsigned long) reader.frames_sent, (unsigned long) reader.frames_skipped,
+				reader.in_flight, (unsigned long) (history_head - reader.next));
+	}
+}
@@ -0,0 +1,193 @@
+/*
+ * imu_stream_service.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef IMU_STREAM_SERVICE_H_
+#define IMU_STREAM_SERVICE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#include "ble/BLE.h"
+#include "ble/GattServer.h"
+#include "events/EventQueue.h"
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+#include "connection_table.h"
+#include "imu_stream_frame.h"
+#include "spsc_ring.h"
+
+#define IMU_STREAM_SERVICE_UUID		"00000010-8dd4-4087-a16a-04a7c8e01734"
+#define IMU_STREAM_DATA_CHAR_UUID	"00001010-8dd4-4087-a16a-04a7c8e01734"
+#define IMU_STREAM_ODR_CHAR_UUID	"00002010-8dd4-4087-a16a-04a7c8e01734"
+#define IMU_STREAM_RANGE_CHAR_UUID	"00003010-8dd4-4087-a16a-04a7c8e01734"
+
+/** Frames buffered between the sensor thread and the BLE stack */
+#define IMU_STREAM_FRAME_QUEUE_DEPTH	8
+
+/** Frames kept on the BLE thread for connections that are behind, power of two */
+#define IMU_STREAM_HISTORY_DEPTH		8
+
+/** Notifications handed to the stack for one connection that have not been reported as sent yet */
+#define IMU_STREAM_MAX_IN_FLIGHT		4
+
+#define IMU_STREAM_DEFAULT_ODR_HZ		238
+#define IMU_STREAM_DEFAULT_ACCEL_RANGE_G	4
+#define IMU_STREAM_DEFAULT_GYRO_RANGE	IMU_STREAM_GYRO_RANGE_500DPS
+
+/**
+ * High rate IMU streaming service
+ *
+ * Streams multi-sample frames (see imu_stream_frame.h) as notifications of
+ * the data characteristic. Streaming is active while at least one client
+ * is subscribed to the data characteristic. The output data rate is selected by writing a
+ * uint16 (Hz) to the ODR characteristic and the full scale ranges by writing
+ * { accel range in g, imu_stream_gyro_range_t } to the range characteristic.
+ * Sources round both to what the part supports, the frame header carries
+ * the values actually in use.
+ *
+ * Frames are produced on the sensor thread with push_frame()/commit() and
+ * notified from the BLE event queue to each subscribed connection on its
+ * own. Every connection reads the last IMU_STREAM_HISTORY_DEPTH frames at
+ * its own pace, with at most IMU_STREAM_MAX_IN_FLIGHT notifications in the
+ * stack's buffers: a central that falls further behind skips the frames it
+ * missed (counted) instead of holding the others back.
+ */
+class ImuStreamService : private mbed::NonCopyable<ImuStreamService> {
+public:
+
+	/** Called on the BLE thread when streaming is enabled/disabled or the configuration changes */
+	typedef mbed::Callback<void(bool enabled, imu_stream_config_t config)> stream_control_cb_t;
+
+	ImuStreamService(events::EventQueue& queue);
+
+	/** Add the service, subscriptions are tracked in the BLE process' connection table */
+	void start(BLE& ble, ConnectionTable& connections);
+
+	void on_stream_control(stream_control_cb_t cb) {
+		stream_control_cb = cb;
+	}
+
+	/** Update the usable notification payload, BLE thread only */
+	void set_att_mtu(uint16_t att_mtu);
+
+	/** Largest frame that fits one notification, safe to call from any thread */
+	size_t get_max_frame_size(void) const {
+		return max_frame_size.load();
+	}
+
+	/** Stop streaming to every client, BLE thread only */
+	void stop_streaming(void);
+
+	/** A connection went down (already removed from the table), BLE thread only */
+	void on_disconnect(ble::connection_handle_t handle);
+
+	bool is_streaming(void) const {
+		return streaming;
+	}
+
+	/** The connection is subscribed to the data characteristic, BLE thread only */
+	bool is_subscribed(ble::connection_handle_t handle) const;
+
+	const imu_stream_config_t& get_config(void) const {
+		return config;
+	}
+
+	/**
+	 * Producer side: queue a frame for notification
+	 * @retval false if the frame queue is full and the frame was dropped
+	 */
+	bool push_frame(const imu_stream_frame_t& frame) {
+		return frames.push(frame);
+	}
+
+	/** Producer side: schedule notification of the queued frames */
+	void commit(void);
+
+	uint32_t get_frames_sent(void) const {
+		return frames_sent;
+	}
+
+	/** Frames the BLE thread did not pick up in time */
+	uint32_t get_frames_dropped(void) const {
+		return frames.get_dropped();
+	}
+
+	/** Frames connections skipped because they fell behind, summed over the connections */
+	uint32_t get_frames_skipped(void) const {
+		return frames_skipped;
+	}
+
+	/** Print the state of each subscribed connection */
+	void print_stats(void);
+
+	/** Payload bytes of the frames sent */
+	uint32_t get_bytes_sent(void) const {
+		return bytes_sent;
+	}
+
+private:
+
+	/** Position of one connection in the frame history */
+	typedef struct {
+		bool active;
+		ble::connection_handle_t handle;
+		uint32_t next;				/** Sequence of the next frame to notify */
+		unsigned in_flight;
+		uint32_t frames_sent;
+		uint32_t frames_skipped;
+	} reader_t;
+
+	void drain(void);
+
+	/** Notify the connection at a table index as many frames as its window allows */
+	void send(int index);
+
+	/** Recount the subscribers, starts/stops streaming on the first/last */
+	void update_streaming(void);
+
+	/** Subscriptions of a tracked characteristic were refreshed */
+	void on_subscriptions_changed(GattAttribute::Handle_t handle);
+
+	void on_data_written(const GattWriteCallbackParams* params);
+
+	void on_data_sent(unsigned count);
+
+	events::EventQueue& queue;
+	BLE* ble;
+	ConnectionTable* connections;
+	int subscription_bit;
+	stream_control_cb_t stream_control_cb;
+
+	uint8_t data_value[IMU_STREAM_MAX_FRAME_SIZE];
+	uint16_t odr_value;
+	uint8_t range_value[2];
+	GattCharacteristic data_char;
+	ReadWriteGattCharacteristic<uint16_t> odr_char;
+	ReadWriteArrayGattCharacteristic<uint8_t, 2> range_char;
+
+	SpscRing<imu_stream_frame_t, IMU_STREAM_FRAME_QUEUE_DEPTH> frames;
+	std::atomic<bool> drain_scheduled;
+	std::atomic<size_t> max_frame_size;
+	bool streaming;
+	imu_stream_config_t config;
+
+	/** BLE thread only */
+	imu_stream_frame_t history[IMU_STREAM_HISTORY_DEPTH];
+	uint32_t history_head;			/** Sequence of the next frame added */
+	reader_t readers[BLE_MAX_CONNECTIONS];
+	int credit_cursor;				/** Reader the next unattributed completion goes to */
+	uint32_t frames_sent;
+	uint32_t frames_skipped;
+	uint32_t bytes_sent;
+
+};
+
+static_assert((IMU_STREAM_HISTORY_DEPTH & (IMU_STREAM_HISTORY_DEPTH - 1)) == 0,
+		"IMU_STREAM_HISTORY_DEPTH must be a power of two");
+
+#endif /* IMU_STREAM_SERVICE_H_ */
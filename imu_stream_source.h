@@ -0,0 +1,73 @@
+/*
+ * imu_stream_source.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef IMU_STREAM_SOURCE_H_
+#define IMU_STREAM_SOURCE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "platform/Callback.h"
+
+#include "imu_stream_frame.h"
+
+/**
+ * IMU that can stream high rate accel/gyro frames out of its FIFO
+ *
+ * Implementations drain their FIFO through the I2C transaction engine
+ * whenever poll() is called and hand every completed frame to the sink.
+ * All methods and callbacks run on the sensor thread.
+ */
+class ImuStreamSource {
+public:
+
+	typedef mbed::Callback<void(const imu_stream_frame_t&)> frame_sink_t;
+
+	virtual ~ImuStreamSource() {
+	}
+
+	/** Called with every completed frame */
+	virtual void set_frame_sink(frame_sink_t sink) = 0;
+
+	/**
+	 * Configure the FIFO and start streaming
+	 * @param[in] config Requested rate and ranges, rounded to what the part supports
+	 */
+	virtual void start(const imu_stream_config_t& config) = 0;
+
+	/** Stop streaming */
+	virtual void stop(void) = 0;
+
+	virtual bool is_streaming(void) const = 0;
+
+	/** Output data rate actually in use */
+	virtual uint16_t get_odr_hz(void) const = 0;
+
+	/** Interval at which poll() should be called to keep up with the FIFO */
+	virtual uint32_t get_poll_interval_ms(void) const = 0;
+
+	/**
+	 * Start draining the FIFO
+	 * @param[in] max_frame_size Current notification payload size
+	 */
+	virtual void poll(size_t max_frame_size) = 0;
+
+	/** Most recent sample read out of the FIFO */
+	virtual const imu_raw_sample_t& get_last_sample(void) const = 0;
+
+	virtual bool has_sample(void) const = 0;
+
+	virtual uint32_t get_sample_count(void) const = 0;
+
+	/** Number of times the FIFO overflowed before it was drained */
+	virtual uint32_t get_overruns(void) const = 0;
+
+	/** Name used in log messages */
+	virtual const char* get_name(void) const = 0;
+
+};
+
+#endif /* IMU_STREAM_SOURCE_H_ */
@@ -0,0 +1,116 @@
+/*
+ * init_graph.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "init_graph.h"
+
+#include <stdio.h>
+
+#include "rtos/Kernel.h"
+#include "rtos/ThisThread.h"
+
+static uint32_t now_ms(void) {
+	return (uint32_t) rtos::Kernel::get_ms_count();
+}
+
+InitGraph::InitGraph() : steps(), step_count(0), completed(), succeeded_mask(0) {
+}
+
+InitGraph::step_id_t InitGraph::add_step(const char* name, uint32_t depends_on) {
+	if(step_count >= INIT_GRAPH_MAX_STEPS) {
+		return INVALID_STEP;
+	}
+
+	step_t& step = steps[step_count];
+	step.name = name;
+	step.thread = NULL;
+	step.depends_on = depends_on;
+
+	return step_count++;
+}
+
+void InitGraph::wait_dependencies(step_id_t id) {
+	step_t& step = steps[id];
+	step.thread = rtos::ThisThread::get_name();
+	step.ready_ms = now_ms();
+
+	if(step.depends_on != 0) {
+		completed.wait_all(step.depends_on, osWaitForever, false);
+	}
+
+	step.start_ms = now_ms();
+}
+
+bool InitGraph::run(step_id_t id, step_fn_t fn) {
+	if(id < 0 || id >= step_count) {
+		return false;
+	}
+
+	wait_dependencies(id);
+	bool ok = fn? fn() : true;
+	complete(id, ok);
+
+	return ok;
+}
+
+void InitGraph::begin(step_id_t id) {
+	if(id >= 0 && id < step_count) {
+		wait_dependencies(id);
+	}
+}
+
+void InitGraph::complete(step_id_t id, bool ok) {
+	if(id < 0 || id >= step_count || is_complete(id)) {
+		return;
+	}
+
+	steps[id].end_ms = now_ms();
+	if(ok) {
+		succeeded_mask.fetch_or(after(id));
+	}
+	completed.set(after(id));
+}
+
+bool InitGraph::wait(step_id_t id, uint32_t timeout_ms) {
+	if(id < 0 || id >= step_count) {
+		return false;
+	}
+
+	uint32_t flags = completed.wait_all(after(id), timeout_ms, false);
+	if(flags & osFlagsError) {
+		return false;
+	}
+
+	return succeeded(id);
+}
+
+bool InitGraph::wait_all(uint32_t timeout_ms) {
+	if(step_count == 0) {
+		return true;
+	}
+
+	uint32_t flags = completed.wait_all((1UL << step_count) - 1, timeout_ms, false);
+	return (flags & osFlagsError) == 0;
+}
+
+bool InitGraph::is_complete(step_id_t id) const {
+	return (completed.get() & after(id)) != 0;
+}
+
+void InitGraph::print_timeline(void) {
+	printf("boot timeline (ms since boot):\r\n");
+	for(int i = 0; i < step_count; i++) {
+		const step_t& step = steps[i];
+		if(!is_complete(i)) {
+			printf("\t%-12s pending\r\n", step.name);
+			continue;
+		}
+
+		printf("\t%-12s %-8s waited %4lu, %5lu -> %5lu (%lu ms) %s\r\n", step.name,
+				step.thread? step.thread : "?", step.start_ms - step.ready_ms,
+				step.start_ms, step.end_ms, step.end_ms - step.start_ms,
+				succeeded(i)? "ok" : "FAILED");
+	}
+}
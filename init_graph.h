@@ -0,0 +1,114 @@
+/*
+ * init_graph.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef INIT_GRAPH_H_
+#define INIT_GRAPH_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+#include "rtos/EventFlags.h"
+
+/** Largest number of steps, one event flag each */
+#define INIT_GRAPH_MAX_STEPS	16
+
+/**
+ * Start-up steps with dependencies between them
+ *
+ * Every step runs on whichever thread calls run() for it, after the steps
+ * it depends on have completed (successfully or not, a step checks
+ * succeeded() if it needs to). Independent steps started from different
+ * threads therefore overlap. Steps that finish asynchronously use
+ * begin()/complete() instead of run().
+ *
+ * Start and end times of every step are kept for print_timeline().
+ *
+ * All steps must be added before any of them runs.
+ */
+class InitGraph : private mbed::NonCopyable<InitGraph> {
+public:
+
+	typedef int step_id_t;
+
+	static const step_id_t INVALID_STEP = -1;
+
+	/** Returns true on success */
+	typedef mbed::Callback<bool()> step_fn_t;
+
+	InitGraph();
+
+	/**
+	 * Declare a step
+	 * @param[in] name Shown in the timeline, must outlive the graph
+	 * @param[in] depends_on Steps to wait for, built with after()
+	 * @retval Step id, INVALID_STEP if the graph is full
+	 */
+	step_id_t add_step(const char* name, uint32_t depends_on = 0);
+
+	/** Dependency mask for add_step(), OR several together */
+	static uint32_t after(step_id_t id) {
+		return (id == INVALID_STEP)? 0 : (1UL << id);
+	}
+
+	/**
+	 * Wait for the dependencies of a step, then run it on the calling thread
+	 * @retval Result of fn
+	 */
+	bool run(step_id_t id, step_fn_t fn);
+
+	/** Wait for the dependencies of a step and mark it as started */
+	void begin(step_id_t id);
+
+	/** Mark a step started with begin() as finished, from any thread */
+	void complete(step_id_t id, bool ok);
+
+	/**
+	 * Block until a step has completed
+	 * @retval true if it completed successfully within timeout_ms
+	 */
+	bool wait(step_id_t id, uint32_t timeout_ms = osWaitForever);
+
+	/**
+	 * Block until every step has completed
+	 * @retval false on timeout
+	 */
+	bool wait_all(uint32_t timeout_ms = osWaitForever);
+
+	bool is_complete(step_id_t id) const;
+
+	bool succeeded(step_id_t id) const {
+		return (succeeded_mask.load() & after(id)) != 0;
+	}
+
+	/** Print when every step waited, started and ended, in ms since boot */
+	void print_timeline(void);
+
+private:
+
+	typedef struct {
+		const char* name;
+		const char* thread;
+		uint32_t depends_on;
+		uint32_t ready_ms;		/** Called run()/begin() */
+		uint32_t start_ms;		/** Dependencies done */
+		uint32_t end_ms;
+	} step_t;
+
+	void wait_dependencies(step_id_t id);
+
+	step_t steps[INIT_GRAPH_MAX_STEPS];
+	int step_count;
+
+	/** One flag per completed step */
+	mutable rtos::EventFlags completed;
+	std::atomic<uint32_t> succeeded_mask;
+
+};
+
+#endif /* INIT_GRAPH_H_ */
@@ -0,0 +1,344 @@
+/*
+ * link_tuner.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "link_tuner.h"
+
+#include <stdio.h>
+
+#include "rtos/Kernel.h"
+
+#if defined(TARGET_CORDIO)
+/** The BLE API has no data length request yet, go to the Cordio host directly */
+#include "dm_api.h"
+#endif
+
+#define ATT_DEFAULT_MTU 23
+
+/** Link layer payload before the data length update */
+#define LINK_DEFAULT_OCTETS 27
+
+const LinkTuner::link_parameters_t LinkTuner::profiles[LINK_PROFILE_COUNT] = {
+	{ "environmental", LINK_ENVIRONMENTAL_MIN_INTERVAL, LINK_ENVIRONMENTAL_MAX_INTERVAL,
+			LINK_ENVIRONMENTAL_SLAVE_LATENCY, LINK_ENVIRONMENTAL_TIMEOUT, false },
+	{ "streaming", LINK_STREAMING_MIN_INTERVAL, LINK_STREAMING_MAX_INTERVAL,
+			LINK_STREAMING_SLAVE_LATENCY, LINK_STREAMING_TIMEOUT, true },
+};
+
+static const char* phy_name(uint8_t phy) {
+	switch(phy) {
+	case ble::phy_t::LE_1M:
+		return "1M";
+	case ble::phy_t::LE_2M:
+		return "2M";
+	case ble::phy_t::LE_CODED:
+		return "coded";
+	default:
+		return "?";
+	}
+}
+
+LinkTuner::LinkTuner(events::EventQueue& queue, BLE& ble, ConnectionTable& table) :
+	queue(queue), ble(ble), table(table), bytes_source(), links(),
+	link_count(0), throughput_event(0), connections(0), sample_ms(0), sample_bytes(0), peak_bps(0) {
+}
+
+LinkTuner::~LinkTuner() {
+	for(int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+		if(links[i].tuning_event != 0) {
+			queue.cancel(links[i].tuning_event);
+		}
+	}
+	if(throughput_event != 0) {
+		queue.cancel(throughput_event);
+	}
+}
+
+void LinkTuner::set_profile(ble::connection_handle_t handle, link_profile_t profile) {
+	ble_connection_t* connection = table.find(handle);
+	if(profile >= LINK_PROFILE_COUNT || connection == NULL || connection->link_profile == profile) {
+		return;
+	}
+
+	connection->link_profile = (uint8_t) profile;
+	printf("link: %u %s profile\r\n", handle, profiles[profile].name);
+
+	link_state_t* link = find(handle);
+	if(link != NULL && link->tuning) {
+		apply(*link);
+	}
+}
+
+link_profile_t LinkTuner::get_profile(ble::connection_handle_t handle) const {
+	int index = table.index_of(handle);
+	return (index < 0)? LINK_PROFILE_ENVIRONMENTAL : (link_profile_t) table.at(index).link_profile;
+}
+
+void LinkTuner::on_connect(const ble::ConnectionCompleteEvent& event) {
+	if(event.getStatus() != BLE_ERROR_NONE) {
+		return;
+	}
+
+	link_state_t* free_link = NULL;
+	for(int i = 0; i < BLE_MAX_CONNECTIONS && free_link == NULL; i++) {
+		if(!links[i].connected) {
+			free_link = &links[i];
+		}
+	}
+	if(free_link == NULL) {
+		return;
+	}
+
+	link_state_t& link = *free_link;
+	link.connected = true;
+	link.handle = event.getConnectionHandle();
+	link.tuning = false;
+	link.update_pending = false;
+	link.requested = LINK_PROFILE_ENVIRONMENTAL;
+	link.interval = event.getConnectionInterval().value();
+	link.slave_latency = event.getConnectionLatency().value();
+	link.supervision_timeout = event.getSupervisionTimeout().value();
+	link.tx_phy = ble::phy_t::LE_1M;
+	link.rx_phy = ble::phy_t::LE_1M;
+	link.tx_octets = LINK_DEFAULT_OCTETS;
+	link.rx_octets = LINK_DEFAULT_OCTETS;
+	link.att_mtu = ATT_DEFAULT_MTU;
+	link.number = ++connections;
+	link.connect_ms = rtos::Kernel::get_ms_count();
+	link.connect_bytes = bytes_sent();
+
+	if(link_count++ == 0) {
+		// Throughput is sampled while any central is connected
+		sample_ms = link.connect_ms;
+		sample_bytes = link.connect_bytes;
+		peak_bps = 0;
+		throughput_event = queue.call_every(LINK_THROUGHPUT_INTERVAL_MS, this,
+				&LinkTuner::sample_throughput);
+	}
+
+	print_parameters(link, "central chose");
+
+	// Larger packets help discovery too, only the timing waits for the central
+	ble_error_t error = ble.gattClient().negotiateAttMtu(link.handle);
+	if(error) {
+		printf("link: ATT MTU exchange failed - 0x%X\r\n", error);
+	}
+	request_data_length(link);
+
+	link.tuning_event = queue.call_in(LINK_TUNING_DELAY_MS, this, &LinkTuner::on_tuning_delay,
+			link.handle);
+}
+
+void LinkTuner::on_disconnect(ble::connection_handle_t handle) {
+	link_state_t* link = find(handle);
+	if(link == NULL) {
+		return;
+	}
+
+	if(link->tuning_event != 0) {
+		queue.cancel(link->tuning_event);
+		link->tuning_event = 0;
+	}
+
+	sample_throughput();
+
+	// The byte count covers every connection that was up at the same time
+	uint32_t duration_ms = (uint32_t) (rtos::Kernel::get_ms_count() - link->connect_ms);
+	uint32_t bytes = bytes_sent() - link->connect_bytes;
+	uint32_t average_bps = (duration_ms == 0)? 0 : (uint32_t) (((uint64_t) bytes * 1000) / duration_ms);
+	printf("link: connection %lu lasted %lu ms, %lu bytes sent (all links), average %lu B/s, peak %lu B/s\r\n",
+			(unsigned long) link->number, (unsigned long) duration_ms, (unsigned long) bytes,
+			(unsigned long) average_bps, (unsigned long) peak_bps);
+
+	link->connected = false;
+	link->tuning = false;
+	link->update_pending = false;
+
+	if(--link_count == 0 && throughput_event != 0) {
+		queue.cancel(throughput_event);
+		throughput_event = 0;
+	}
+}
+
+void LinkTuner::on_parameters_updated(const ble::ConnectionParametersUpdateCompleteEvent& event) {
+	link_state_t* link = find(event.getConnectionHandle());
+	if(link == NULL) {
+		return;
+	}
+
+	link->update_pending = false;
+
+	if(event.getStatus() != BLE_ERROR_NONE) {
+		printf("link: connection parameter update failed - 0x%X\r\n", event.getStatus());
+	} else {
+		link->interval = event.getConnectionInterval().value();
+		link->slave_latency = event.getSlaveLatency().value();
+		link->supervision_timeout = event.getSupervisionTimeout().value();
+		print_parameters(*link, "parameters updated");
+	}
+
+	// The profile changed while the request was in flight
+	if(link->tuning && link->requested != get_profile(link->handle)) {
+		apply(*link);
+	}
+}
+
+void LinkTuner::on_phy_updated(ble_error_t status, ble::connection_handle_t handle,
+		ble::phy_t tx_phy, ble::phy_t rx_phy) {
+	if(status != BLE_ERROR_NONE) {
+		printf("link: PHY update failed - 0x%X\r\n", status);
+		return;
+	}
+
+	link_state_t* link = find(handle);
+	if(link == NULL) {
+		return;
+	}
+
+	link->tx_phy = tx_phy.value();
+	link->rx_phy = rx_phy.value();
+	printf("link: %u PHY tx %s, rx %s\r\n", handle, phy_name(link->tx_phy), phy_name(link->rx_phy));
+}
+
+void LinkTuner::on_data_length_changed(ble::connection_handle_t handle, uint16_t tx_octets,
+		uint16_t rx_octets) {
+	link_state_t* link = find(handle);
+	if(link == NULL) {
+		return;
+	}
+
+	link->tx_octets = tx_octets;
+	link->rx_octets = rx_octets;
+	printf("link: %u data length tx %u, rx %u octets\r\n", handle, tx_octets, rx_octets);
+}
+
+void LinkTuner::on_att_mtu_changed(ble::connection_handle_t handle, uint16_t att_mtu) {
+	link_state_t* link = find(handle);
+	if(link != NULL) {
+		link->att_mtu = att_mtu;
+	}
+}
+
+LinkTuner::link_state_t* LinkTuner::find(ble::connection_handle_t handle) {
+	for(int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+		if(links[i].connected && links[i].handle == handle) {
+			return &links[i];
+		}
+	}
+	return NULL;
+}
+
+void LinkTuner::apply(link_state_t& link) {
+	if(link.update_pending) {
+		// Reissued by on_parameters_updated
+		return;
+	}
+
+	link_profile_t profile = get_profile(link.handle);
+	const link_parameters_t& params = profiles[profile];
+	Gap& gap = ble.gap();
+
+	ble_error_t error = gap.updateConnectionParameters(link.handle,
+			ble::conn_interval_t(params.min_interval), ble::conn_interval_t(params.max_interval),
+			ble::slave_latency_t(params.slave_latency),
+			ble::supervision_timeout_t(params.supervision_timeout));
+	if(error) {
+		printf("link: connection parameter request failed - 0x%X\r\n", error);
+	} else {
+		link.update_pending = true;
+	}
+	link.requested = profile;
+
+	if(gap.isFeatureSupported(ble::controller_supported_features_t::LE_2M_PHY)) {
+		ble::phy_set_t phys(!params.phy_2m, params.phy_2m, false);
+		error = gap.setPhy(link.handle, &phys, &phys, ble::coded_symbol_per_bit_t::UNDEFINED);
+		if(error) {
+			printf("link: PHY request failed - 0x%X\r\n", error);
+		}
+	}
+}
+
+void LinkTuner::on_tuning_delay(ble::connection_handle_t handle) {
+	link_state_t* link = find(handle);
+	if(link == NULL) {
+		return;
+	}
+
+	link->tuning_event = 0;
+	link->tuning = true;
+	apply(*link);
+}
+
+void LinkTuner::request_data_length(link_state_t& link) {
+#if defined(TARGET_CORDIO)
+	dmConnId_t conn_id = DmConnIdByHandle(link.handle);
+	if(conn_id != DM_CONN_ID_NONE) {
+		DmConnSetDataLen(conn_id, LINK_MAX_TX_OCTETS, LINK_MAX_TX_TIME_US);
+	}
+#else
+	(void) link;
+#endif
+}
+
+void LinkTuner::sample_throughput(void) {
+	uint64_t now = rtos::Kernel::get_ms_count();
+	uint32_t bytes = bytes_sent();
+	uint32_t elapsed_ms = (uint32_t) (now - sample_ms);
+	uint32_t delta = bytes - sample_bytes;
+	sample_ms = now;
+	sample_bytes = bytes;
+
+	if(elapsed_ms == 0 || delta == 0) {
+		return;
+	}
+
+	uint32_t bps = (uint32_t) (((uint64_t) delta * 1000) / elapsed_ms);
+	if(bps > peak_bps) {
+		peak_bps = bps;
+	}
+
+	printf("link: %lu B/s over %d connection%s\r\n", (unsigned long) bps, link_count,
+			(link_count == 1)? "" : "s");
+	for(int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+		const link_state_t& link = links[i];
+		if(!link.connected) {
+			continue;
+		}
+		uint32_t interval_hundredths = (uint32_t) link.interval * 125;
+		printf("\t%u: interval %lu.%02lu ms, latency %u, %s, MTU %u, data length %u\r\n", link.handle,
+				(unsigned long) (interval_hundredths / 100), (unsigned long) (interval_hundredths % 100),
+				link.slave_latency, phy_name(link.tx_phy), link.att_mtu, link.tx_octets);
+	}
+}
+
+void LinkTuner::print_parameters(const link_state_t& link, const char* what) {
+	uint32_t interval_hundredths = (uint32_t) link.interval * 125;
+	printf("link: %u %s interval %lu.%02lu ms, latency %u, timeout %u ms\r\n", link.handle, what,
+			(unsigned long) (interval_hundredths / 100), (unsigned long) (interval_hundredths % 100),
+			link.slave_latency, (unsigned) link.supervision_timeout * 10);
+}
+
+void LinkTuner::print_stats(void) {
+	if(link_count == 0) {
+		printf("link: not connected\r\n");
+		return;
+	}
+
+	printf("link: %d connection%s, peak %lu B/s\r\n", link_count,
+			(link_count == 1)? "" : "s", (unsigned long) peak_bps);
+	for(int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+		const link_state_t& link = links[i];
+		if(!link.connected) {
+			continue;
+		}
+		uint32_t interval_hundredths = (uint32_t) link.interval * 125;
+		printf("\t%u: %s profile%s, interval %lu.%02lu ms, latency %u, timeout %u ms, "
+				"PHY tx %s rx %s, data length tx %u rx %u, MTU %u\r\n",
+				link.handle, profiles[get_profile(link.handle)].name, link.tuning? "" : " (not applied yet)",
+				(unsigned long) (interval_hundredths / 100), (unsigned long) (interval_hundredths % 100),
+				link.slave_latency, (unsigned) link.supervision_timeout * 10, phy_name(link.tx_phy),
+				phy_name(link.rx_phy), link.tx_octets, link.rx_octets, link.att_mtu);
+	}
+}
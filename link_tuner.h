@@ -0,0 +1,180 @@
+/*
+ * link_tuner.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef LINK_TUNER_H_
+#define LINK_TUNER_H_
+
+#include <stdint.h>
+
+#include "ble/BLE.h"
+#include "ble/Gap.h"
+#include "ble/gap/Types.h"
+#include "ble/gap/Events.h"
+#include "events/EventQueue.h"
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+#include "connection_table.h"
+
+/**
+ * Streaming: 15 to 30 ms without slave latency
+ * (15 ms is the shortest interval Apple's accessory guidelines accept)
+ */
+#define LINK_STREAMING_MIN_INTERVAL			12		// 1.25 ms units
+#define LINK_STREAMING_MAX_INTERVAL			24
+#define LINK_STREAMING_SLAVE_LATENCY		0
+#define LINK_STREAMING_TIMEOUT				200		// 10 ms units
+
+/**
+ * Environmental: 300 to 400 ms, up to 4 events skipped while there is nothing to send
+ * (max interval x (latency + 1) stays within 2 s, timeout within 6 s)
+ */
+#define LINK_ENVIRONMENTAL_MIN_INTERVAL		240
+#define LINK_ENVIRONMENTAL_MAX_INTERVAL		320
+#define LINK_ENVIRONMENTAL_SLAVE_LATENCY	4
+#define LINK_ENVIRONMENTAL_TIMEOUT			600
+
+/** Leave the central's parameters alone this long after connecting (service discovery) */
+#define LINK_TUNING_DELAY_MS				5000
+
+/** Throughput is logged at this interval while data flows */
+#define LINK_THROUGHPUT_INTERVAL_MS			5000
+
+/** Largest link layer payload and its air time at 1M PHY */
+#define LINK_MAX_TX_OCTETS					251
+#define LINK_MAX_TX_TIME_US					2120
+
+/** What the link is used for, selects the parameters requested */
+typedef enum {
+	LINK_PROFILE_ENVIRONMENTAL = 0,	/** Slow sensor updates: long interval, slave latency, 1M PHY */
+	LINK_PROFILE_STREAMING,			/** IMU stream or log download: short interval, 2M PHY */
+	LINK_PROFILE_COUNT
+} link_profile_t;
+
+/**
+ * Link-tuning policy for the peripheral's connections
+ *
+ * Right after a central connects it asks for the largest ATT MTU (the
+ * stack's cordio.desired-att-mtu, see mbed_app.json) and data length. Once
+ * the central had time for service discovery it requests the connection
+ * parameters and PHY of the connection's profile, and again every time the
+ * profile of that connection changes. Each connection is tuned on its own:
+ * its profile is kept in its ConnectionTable entry and starts out
+ * environmental. The parameters each central
+ * settles on, the PHY, data length and MTU are logged as they change,
+ * along with the throughput of the notified payload (over all connections)
+ * and a summary per connection.
+ *
+ * BLEProcess forwards the connection events. All calls must come from the
+ * BLE event queue, print_stats() included (it reads the connection table).
+ */
+class LinkTuner : private mbed::NonCopyable<LinkTuner> {
+public:
+
+	LinkTuner(events::EventQueue& queue, BLE& ble, ConnectionTable& table);
+
+	~LinkTuner();
+
+	/** Count of the payload bytes notified so far, sampled for the throughput */
+	void set_bytes_source(mbed::Callback<uint32_t()> source) {
+		bytes_source = source;
+	}
+
+	/** Select the profile of a connection, ignored if the connection is unknown */
+	void set_profile(ble::connection_handle_t handle, link_profile_t profile);
+
+	/** @retval LINK_PROFILE_ENVIRONMENTAL if the connection is unknown */
+	link_profile_t get_profile(ble::connection_handle_t handle) const;
+
+	/** Events forwarded by BLEProcess */
+	void on_connect(const ble::ConnectionCompleteEvent& event);
+
+	void on_disconnect(ble::connection_handle_t handle);
+
+	void on_parameters_updated(const ble::ConnectionParametersUpdateCompleteEvent& event);
+
+	void on_phy_updated(ble_error_t status, ble::connection_handle_t handle, ble::phy_t tx_phy,
+			ble::phy_t rx_phy);
+
+	void on_data_length_changed(ble::connection_handle_t handle, uint16_t tx_octets,
+			uint16_t rx_octets);
+
+	void on_att_mtu_changed(ble::connection_handle_t handle, uint16_t att_mtu);
+
+	/** Print the state of every connection, BLE thread only */
+	void print_stats(void);
+
+private:
+
+	/** Connection parameters requested for a profile */
+	typedef struct {
+		const char* name;
+		uint16_t min_interval;
+		uint16_t max_interval;
+		uint16_t slave_latency;
+		uint16_t supervision_timeout;
+		bool phy_2m;
+	} link_parameters_t;
+
+	static const link_parameters_t profiles[LINK_PROFILE_COUNT];
+
+	/** State of one connection */
+	typedef struct {
+		bool connected;
+		ble::connection_handle_t handle;
+		bool tuning;					/** Past the tuning delay, profiles are requested */
+		bool update_pending;			/** Parameter update requested, not completed yet */
+		link_profile_t requested;		/** Profile of the last request on this connection */
+		uint16_t interval;
+		uint16_t slave_latency;
+		uint16_t supervision_timeout;
+		uint8_t tx_phy;
+		uint8_t rx_phy;
+		uint16_t tx_octets;
+		uint16_t rx_octets;
+		uint16_t att_mtu;
+		int tuning_event;
+		uint32_t number;				/** Of this connection since boot */
+		uint64_t connect_ms;
+		uint32_t connect_bytes;
+	} link_state_t;
+
+	/** @retval NULL if the connection is unknown */
+	link_state_t* find(ble::connection_handle_t handle);
+
+	/** Request the parameters and PHY of the profile */
+	void apply(link_state_t& link);
+
+	void on_tuning_delay(ble::connection_handle_t handle);
+
+	void request_data_length(link_state_t& link);
+
+	void sample_throughput(void);
+
+	void print_parameters(const link_state_t& link, const char* what);
+
+	uint32_t bytes_sent(void) {
+		return bytes_source? bytes_source() : 0;
+	}
+
+	events::EventQueue& queue;
+	BLE& ble;
+	ConnectionTable& table;
+	mbed::Callback<uint32_t()> bytes_source;
+
+	link_state_t links[BLE_MAX_CONNECTIONS];
+	int link_count;
+	int throughput_event;
+
+	/** Throughput of the notified payload, all connections together */
+	uint32_t connections;
+	uint64_t sample_ms;
+	uint32_t sample_bytes;
+	uint32_t peak_bps;				/** Bytes per second, best sampling interval while connected */
+
+};
+
+#endif /* LINK_TUNER_H_ */
@@ -0,0 +1,193 @@
+/*
+ * log_transfer_service.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "log_transfer_service.h"
+
+#include <stdio.h>
+
+#include "rtos/Kernel.h"
+
+/** Notification payload is the ATT MTU minus the opcode and handle */
+#define ATT_NOTIFICATION_HEADER_SIZE 3
+
+#define ATT_DEFAULT_MTU 23
+
+LogTransferService::LogTransferService(events::EventQueue& queue) :
+	queue(queue),
+	ble(NULL),
+	connections(NULL),
+	subscription_bit(-1),
+	session(NULL),
+	transfer_active_cb(),
+	control_value(),
+	data_value(),
+	control_char(UUID(LOG_TRANSFER_CONTROL_CHAR_UUID), control_value, 0, sizeof(control_value),
+			GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_WRITE |
+			GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_WRITE_WITHOUT_RESPONSE, NULL, 0, true),
+	data_char(UUID(LOG_TRANSFER_DATA_CHAR_UUID), data_value, 0, sizeof(data_value),
+			GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY, NULL, 0, true),
+	client(),
+	max_packet_size(ATT_DEFAULT_MTU - ATT_NOTIFICATION_HEADER_SIZE),
+	in_flight(0),
+	tick_event(0),
+	active(false) {
+}
+
+LogTransferService::~LogTransferService() {
+	if(tick_event != 0) {
+		queue.cancel(tick_event);
+	}
+	delete session;
+}
+
+void LogTransferService::start(BLE& ble, ConnectionTable& connections) {
+	this->ble = &ble;
+	this->connections = &connections;
+
+	GattCharacteristic* chars[] = { &control_char, &data_char };
+	GattService service(UUID(LOG_TRANSFER_SERVICE_UUID), chars, sizeof(chars) / sizeof(chars[0]));
+
+	ble.gattServer().addService(service);
+
+	subscription_bit = connections.track(data_char);
+
+	connections.on_subscriptions_changed().attach(
+			mbed::callback(this, &LogTransferService::on_subscriptions_changed));
+	ble.gattServer().onDataWritten(this, &LogTransferService::on_data_written);
+	ble.gattServer().onDataSent(this, &LogTransferService::on_data_sent);
+}
+
+void LogTransferService::set_log(SensorLog& log) {
+	if(session == NULL) {
+		session = new LogTransferSession(log, *this);
+	}
+}
+
+void LogTransferService::set_att_mtu(uint16_t att_mtu) {
+	size_t size = (att_mtu > ATT_NOTIFICATION_HEADER_SIZE)?
+			(att_mtu - ATT_NOTIFICATION_HEADER_SIZE) : 0;
+	if(size > LOG_TRANSFER_MAX_PACKET_SIZE) {
+		size = LOG_TRANSFER_MAX_PACKET_SIZE;
+	}
+	max_packet_size = size;
+}
+
+void LogTransferService::stop_transfer(void) {
+	in_flight = 0;
+
+	if(session != NULL) {
+		session->abort();
+	}
+	update_active();
+}
+
+void LogTransferService::on_disconnect(ble::connection_handle_t handle) {
+	if(handle == client && active) {
+		stop_transfer();
+	}
+}
+
+bool LogTransferService::send(const uint8_t* packet, size_t len) {
+	if(ble == NULL || !is_client_subscribed() || in_flight >= LOG_TRANSFER_MAX_IN_FLIGHT) {
+		// on_data_sent will pump the session again
+		return false;
+	}
+
+	ble_error_t error = ble->gattServer().write(client, data_char.getValueHandle(), packet, len);
+	if(error) {
+		return false;
+	}
+
+	in_flight++;
+	return true;
+}
+
+void LogTransferService::tick(void) {
+	if(session == NULL || !session->is_active()) {
+		queue.cancel(tick_event);
+		tick_event = 0;
+		update_active();
+		return;
+	}
+
+	session->tick((uint32_t) rtos::Kernel::get_ms_count());
+}
+
+void LogTransferService::update_active(void) {
+	bool now_active = (session != NULL && session->is_active());
+	if(now_active == active) {
+		return;
+	}
+
+	active = now_active;
+	if(transfer_active_cb) {
+		transfer_active_cb(active);
+	}
+}
+
+bool LogTransferService::is_client_subscribed(void) {
+	if(connections == NULL) {
+		return false;
+	}
+
+	int index = connections->index_of(client);
+	return index >= 0 && connections->is_subscribed(index, subscription_bit);
+}
+
+void LogTransferService::on_subscriptions_changed(GattAttribute::Handle_t handle) {
+	if(handle != data_char.getValueHandle()) {
+		return;
+	}
+
+	if(active && !is_client_subscribed()) {
+		stop_transfer();
+	}
+}
+
+void LogTransferService::on_data_written(const GattWriteCallbackParams* params) {
+	if(params->handle != control_char.getValueHandle() || session == NULL) {
+		return;
+	}
+
+	if(session->is_active() && params->connHandle != client) {
+		// Another central's transfer is running
+		return;
+	}
+
+	if(!session->is_active()) {
+		client = params->connHandle;
+		in_flight = 0;
+	}
+
+	session->handle_command(params->data, params->len, (uint32_t) rtos::Kernel::get_ms_count());
+
+	if(session->is_active() && tick_event == 0) {
+		tick_event = queue.call_every(LOG_TRANSFER_TICK_MS, this, &LogTransferService::tick);
+	}
+	update_active();
+}
+
+void LogTransferService::on_data_sent(unsigned count) {
+	// The count covers every notification sent by the server, not just ours,
+	// so this errs on the side of releasing credits early
+	in_flight = (count >= in_flight)? 0 : (in_flight - count);
+
+	if(session != NULL) {
+		session->pump();
+	}
+}
+
+void LogTransferService::print_stats(void) {
+	if(session == NULL) {
+		return;
+	}
+
+	printf("log transfer: %lu completed, %lu broken off, %lu packets, %lu bytes, "
+			"%lu retransmitted%s\r\n", session->get_transfers_completed(),
+			session->get_transfers_broken(), session->get_packets_sent(),
+			session->get_bytes_sent(), session->get_retransmits(),
+			session->is_active()? " (active)" : "");
+}
@@ -0,0 +1,134 @@
+/*
+ * log_transfer_service.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef LOG_TRANSFER_SERVICE_H_
+#define LOG_TRANSFER_SERVICE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "ble/BLE.h"
+#include "ble/GattServer.h"
+#include "events/EventQueue.h"
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+#include "connection_table.h"
+#include "log_transfer_session.h"
+#include "log_transfer_transport.h"
+#include "sensor_log.h"
+
+#define LOG_TRANSFER_SERVICE_UUID		"00000011-8dd4-4087-a16a-04a7c8e01734"
+#define LOG_TRANSFER_CONTROL_CHAR_UUID	"00001011-8dd4-4087-a16a-04a7c8e01734"
+#define LOG_TRANSFER_DATA_CHAR_UUID		"00002011-8dd4-4087-a16a-04a7c8e01734"
+
+#define LOG_TRANSFER_CONTROL_MAX_SIZE	8
+
+/** Notifications handed to the stack that have not been reported as sent yet */
+#define LOG_TRANSFER_MAX_IN_FLIGHT		8
+
+/** Acknowledgment timeout check period while a transfer is running */
+#define LOG_TRANSFER_TICK_MS			100
+
+/**
+ * Bulk download of the sensor log
+ *
+ * Runs the LogTransferSession protocol (see log_transfer_session.h) with
+ * commands written to the control characteristic (write or write without
+ * response) and packets notified on the data characteristic, sized to the
+ * negotiated ATT MTU. The client has to subscribe to the data
+ * characteristic before sending commands.
+ *
+ * One transfer runs at a time. It belongs to the connection whose command
+ * started it: packets are notified to that central only, and commands from
+ * the other connections are ignored until it ends.
+ *
+ * All calls must come from the BLE event queue.
+ */
+class LogTransferService : public LogTransferTransport,
+		private mbed::NonCopyable<LogTransferService> {
+public:
+
+	LogTransferService(events::EventQueue& queue);
+
+	virtual ~LogTransferService();
+
+	/** Add the service, subscriptions are tracked in the BLE process' connection table */
+	void start(BLE& ble, ConnectionTable& connections);
+
+	/** Called with true when a transfer starts and false when it ends */
+	void on_transfer_active(mbed::Callback<void(bool)> cb) {
+		transfer_active_cb = cb;
+	}
+
+	/** Serve this log, commands are ignored until it is set */
+	void set_log(SensorLog& log);
+
+	/** Update the usable notification payload */
+	void set_att_mtu(uint16_t att_mtu);
+
+	/** Stop a running transfer */
+	void stop_transfer(void);
+
+	/** Connection of the current (or last) transfer */
+	ble::connection_handle_t get_client(void) const {
+		return client;
+	}
+
+	/** A connection went down, stops its transfer */
+	void on_disconnect(ble::connection_handle_t handle);
+
+	virtual size_t get_max_packet_size(void) {
+		return max_packet_size;
+	}
+
+	virtual bool send(const uint8_t* packet, size_t len);
+
+	/** Payload bytes notified by the session, retransmissions included */
+	uint32_t get_bytes_sent(void) const {
+		return (session != NULL)? session->get_bytes_sent() : 0;
+	}
+
+	void print_stats(void);
+
+private:
+
+	void tick(void);
+
+	/** Report a change of the session's activity */
+	void update_active(void);
+
+	/** The client of the transfer is subscribed to the data characteristic */
+	bool is_client_subscribed(void);
+
+	/** Subscriptions of a tracked characteristic were refreshed */
+	void on_subscriptions_changed(GattAttribute::Handle_t handle);
+
+	void on_data_written(const GattWriteCallbackParams* params);
+
+	void on_data_sent(unsigned count);
+
+	events::EventQueue& queue;
+	BLE* ble;
+	ConnectionTable* connections;
+	int subscription_bit;
+	LogTransferSession* session;
+	mbed::Callback<void(bool)> transfer_active_cb;
+
+	uint8_t control_value[LOG_TRANSFER_CONTROL_MAX_SIZE];
+	uint8_t data_value[LOG_TRANSFER_MAX_PACKET_SIZE];
+	GattCharacteristic control_char;
+	GattCharacteristic data_char;
+
+	ble::connection_handle_t client;	/** Connection of the current (or last) transfer */
+	size_t max_packet_size;
+	unsigned in_flight;
+	int tick_event;
+	bool active;
+
+};
+
+#endif /* LOG_TRANSFER_SERVICE_H_ */
@@ -0,0 +1,392 @@
+/*
+ * log_transfer_session.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "log_transfer_session.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static_assert((LOG_TRANSFER_MAX_WINDOW & (LOG_TRANSFER_MAX_WINDOW - 1)) == 0,
+		"log transfer window must be a power of two");
+
+static void put_u16(uint8_t* p, uint16_t value) {
+	p[0] = (uint8_t) value;
+	p[1] = (uint8_t) (value >> 8);
+}
+
+static void put_u32(uint8_t* p, uint32_t value) {
+	put_u16(p, (uint16_t) value);
+	put_u16(p + 2, (uint16_t) (value >> 16));
+}
+
+static uint16_t get_u16(const uint8_t* p) {
+	return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+	return get_u16(p) | ((uint32_t) get_u16(p + 2) << 16);
+}
+
+LogTransferSession::LogTransferSession(SensorLog& log, LogTransferTransport& transport) :
+	log(log), transport(transport), active(false), end_sent(false),
+	window(LOG_TRANSFER_DEFAULT_WINDOW), end_sequence(0), tail_flushed(false), waiting(false),
+	base_packet(0), next_packet(0), next_position(), positions(), last_progress_ms(0),
+	retries(0), block_sequence(0), block_valid(false), block_header(), packet(),
+	packet_ready(false), packet_len(0), packet_end(), packets_sent(0), bytes_sent(0),
+	retransmits(0), transfers_completed(0), transfers_broken(0) {
+}
+
+void LogTransferSession::handle_command(const uint8_t* data, size_t len, uint32_t now_ms) {
+	if(len == 0) {
+		return;
+	}
+
+	switch(data[0]) {
+	case LOG_TRANSFER_CMD_GET_INFO:
+		send_info();
+		break;
+	case LOG_TRANSFER_CMD_START:
+		start(data, len, now_ms);
+		break;
+	case LOG_TRANSFER_CMD_ACK:
+		if(len >= 3) {
+			acknowledge(get_u16(&data[1]), now_ms);
+		}
+		break;
+	case LOG_TRANSFER_CMD_ABORT:
+		abort();
+		break;
+	default:
+		break;
+	}
+}
+
+void LogTransferSession::send_info(void) {
+	uint32_t oldest = 1, newest = 0;	// oldest > newest: the log is empty
+	log.get_sequence_range(oldest, newest);
+
+	uint8_t info[LOG_TRANSFER_PACKET_HEADER_SIZE + LOG_TRANSFER_INFO_SIZE];
+	info[0] = LOG_TRANSFER_PACKET_INFO;
+	put_u16(&info[1], 0);
+	put_u32(&info[3], oldest);
+	put_u32(&info[7], newest);
+	put_u32(&info[11], log.get_boot_count());
+	put_u16(&info[15], SENSOR_LOG_RECORDS_PER_SEGMENT);
+	info[17] = sizeof(sensor_log_record_t);
+	info[18] = LOG_TRANSFER_MAX_WINDOW;
+
+	// Not windowed, the client asks again if this one is lost
+	transport.send(info, sizeof(info));
+}
+
+void LogTransferSession::start(const uint8_t* data, size_t len, uint32_t now_ms) {
+	if(len < 8) {
+		return;
+	}
+
+	uint32_t sequence = get_u32(&data[1]);
+	uint16_t first_record = get_u16(&data[5]);
+
+	window = data[7];
+	if(window == 0) {
+		window = LOG_TRANSFER_DEFAULT_WINDOW;
+	}
+	if(window > LOG_TRANSFER_MAX_WINDOW) {
+		window = LOG_TRANSFER_MAX_WINDOW;
+	}
+
+	// What is in RAM is written once the stream gets there, see flush_tail()
+	uint32_t oldest, newest;
+	if(log.get_sequence_range(oldest, newest)) {
+		end_sequence = newest + 1;
+		if(sequence < oldest) {
+			// Overwritten since the client last asked, continue from the oldest left
+			sequence = oldest;
+			first_record = 0;
+		}
+	} else {
+		// Nothing on flash yet, records in RAM go to the first segment
+		end_sequence = 0;
+		sequence = 0;
+		first_record = 0;
+	}
+	tail_flushed = false;
+	waiting = false;
+
+	next_position.sequence = sequence;
+	next_position.first_record = first_record;
+	next_position.offset = 0;
+	block_valid = false;
+
+	base_packet = 0;
+	next_packet = 0;
+	packet_ready = false;
+	end_sent = false;
+	retries = 0;
+	last_progress_ms = now_ms;
+	active = true;
+
+	printf("log transfer: start at %lu/%u, window %u\r\n", sequence, first_record, window);
+
+	pump();
+}
+
+void LogTransferSession::acknowledge(uint16_t packet_sequence, uint32_t now_ms) {
+	if(!active) {
+		return;
+	}
+
+	// Cumulative, ignore anything outside the window (stale or bogus)
+	uint16_t acked = (uint16_t) (packet_sequence - base_packet) + 1;
+	if(acked == 0 || acked > (uint16_t) (next_packet - base_packet)) {
+		return;
+	}
+
+	base_packet = packet_sequence + 1;
+	last_progress_ms = now_ms;
+	retries = 0;
+
+	if(end_sent && base_packet == next_packet) {
+		active = false;
+		if(packet[0] == LOG_TRANSFER_PACKET_RESUME) {
+			transfers_broken++;
+			printf("log transfer: broke off, the client resumes, %lu packets, %lu bytes\r\n",
+					packets_sent, bytes_sent);
+		} else {
+			transfers_completed++;
+			printf("log transfer: complete, %lu packets, %lu bytes, %lu retransmitted\r\n",
+					packets_sent, bytes_sent, retransmits);
+		}
+		return;
+	}
+
+	pump();
+}
+
+void LogTransferSession::tick(uint32_t now_ms) {
+	if(!active) {
+		return;
+	}
+
+	if(waiting) {
+		pump();
+	}
+
+	if(base_packet == next_packet || (now_ms - last_progress_ms) < LOG_TRANSFER_ACK_TIMEOUT_MS) {
+		return;
+	}
+
+	if(++retries > LOG_TRANSFER_MAX_RETRIES) {
+		printf("log transfer: client stopped acknowledging, giving up\r\n");
+		abort();
+		return;
+	}
+
+	// Go back to the oldest unacknowledged packet
+	retransmits += (uint16_t) (next_packet - base_packet);
+	next_position = positions[base_packet % LOG_TRANSFER_MAX_WINDOW];
+	next_packet = base_packet;
+	packet_ready = false;
+	end_sent = false;
+	last_progress_ms = now_ms;
+
+	pump();
+}
+
+void LogTransferSession::abort(void) {
+	active = false;
+	packet_ready = false;
+}
+
+void LogTransferSession::pump(void) {
+	if(!active) {
+		return;
+	}
+
+	size_t max_packet_size = transport.get_max_packet_size();
+	if(max_packet_size > LOG_TRANSFER_MAX_PACKET_SIZE) {
+		max_packet_size = LOG_TRANSFER_MAX_PACKET_SIZE;
+	}
+	if(max_packet_size <= LOG_TRANSFER_PACKET_HEADER_SIZE) {
+		return;
+	}
+
+	while(!end_sent && (uint16_t) (next_packet - base_packet) < window) {
+		// A packet the transport refused is kept rather than read from flash again
+		if(!packet_ready) {
+			block_status_t status;
+			packet_end = next_position;
+			packet_len = read_stream(&packet[LOG_TRANSFER_PACKET_HEADER_SIZE],
+					max_packet_size - LOG_TRANSFER_PACKET_HEADER_SIZE, packet_end, status);
+
+			// Nothing to send until the writer is done, tick() pumps again
+			waiting = (packet_len == 0 && status == BLOCK_WAIT);
+			if(waiting) {
+				break;
+			}
+
+			if(packet_len > 0) {
+				packet[0] = LOG_TRANSFER_PACKET_DATA;
+			} else if(status == BLOCK_LOST) {
+				// A block cannot be finished once its segment is gone, have the
+				// client start over from its last complete record
+				uint16_t record = packet_end.first_record;
+				if(packet_end.offset > LOG_TRANSFER_BLOCK_HEADER_SIZE) {
+					record += (packet_end.offset - LOG_TRANSFER_BLOCK_HEADER_SIZE) /
+							sizeof(sensor_log_record_t);
+				}
+				packet[0] = LOG_TRANSFER_PACKET_RESUME;
+				put_u32(&packet[LOG_TRANSFER_PACKET_HEADER_SIZE], packet_end.sequence);
+				put_u16(&packet[LOG_TRANSFER_PACKET_HEADER_SIZE + 4], record);
+				packet_len = LOG_TRANSFER_RESUME_SIZE;
+			} else {
+				packet[0] = LOG_TRANSFER_PACKET_END;
+			}
+			put_u16(&packet[1], next_packet);
+			packet_ready = true;
+		}
+
+		if(!transport.send(packet, LOG_TRANSFER_PACKET_HEADER_SIZE + packet_len)) {
+			// Out of buffers, the transport calls pump() again once some are freed
+			break;
+		}
+
+		packet_ready = false;
+		positions[next_packet % LOG_TRANSFER_MAX_WINDOW] = next_position;
+		next_position = packet_end;
+		next_packet++;
+		packets_sent++;
+
+		if(packet[0] == LOG_TRANSFER_PACKET_DATA) {
+			bytes_sent += packet_len;
+		} else {
+			end_sent = true;
+		}
+	}
+}
+
+LogTransferSession::block_status_t LogTransferSession::load_block(
+		stream_position_t& position) {
+	while(true) {
+		if(position.sequence >= end_sequence) {
+			block_status_t status = flush_tail();
+			if(status != BLOCK_READY) {
+				return status;
+			}
+			continue;
+		}
+
+		// The segment is still on its way to flash
+		uint32_t oldest, newest;
+		if(log.is_writing() && (!log.get_sequence_range(oldest, newest) ||
+				position.sequence > newest)) {
+			return BLOCK_WAIT;
+		}
+
+		if(!block_valid || block_sequence != position.sequence) {
+			block_sequence = position.sequence;
+			block_valid = log.read_header(position.sequence, block_header);
+		}
+
+		if(position.offset != 0) {
+			// The rest of a block whose header has already been sent, lost if
+			// the segment has been recycled in the meantime
+			return block_valid? BLOCK_READY : BLOCK_LOST;
+		}
+
+		if(block_valid && position.first_record < block_header.record_count) {
+			return BLOCK_READY;
+		}
+
+		// Overwritten, invalid or nothing left in it: on to the next segment
+		position.sequence++;
+		position.first_record = 0;
+	}
+}
+
+LogTransferSession::block_status_t LogTransferSession::flush_tail(void) {
+	if(tail_flushed) {
+		return BLOCK_END;
+	}
+
+	// Once per transfer, so a busy log does not keep it going forever. The
+	// segments written since the start are included as well.
+	uint32_t newest;
+	bool any;
+	if(log.has_unsynced()) {
+		if(!log.flush(newest)) {
+			return BLOCK_WAIT;
+		}
+		any = true;
+	} else {
+		uint32_t oldest;
+		any = log.get_sequence_range(oldest, newest);
+	}
+	tail_flushed = true;
+
+	if(!any || newest < end_sequence) {
+		return BLOCK_END;
+	}
+
+	end_sequence = newest + 1;
+	return BLOCK_READY;
+}
+
+size_t LogTransferSession::read_stream(uint8_t* buffer, size_t len,
+		stream_position_t& position, block_status_t& status) {
+	size_t copied = 0;
+	status = BLOCK_READY;
+
+	while(copied < len) {
+		status = load_block(position);
+		if(status != BLOCK_READY) {
+			break;
+		}
+
+		uint16_t record_count = block_header.record_count - position.first_record;
+		size_t block_len = LOG_TRANSFER_BLOCK_HEADER_SIZE +
+				record_count * sizeof(sensor_log_record_t);
+		size_t n;
+
+		if(position.offset < LOG_TRANSFER_BLOCK_HEADER_SIZE) {
+			uint8_t header[LOG_TRANSFER_BLOCK_HEADER_SIZE];
+			put_u32(&header[0], position.sequence);
+			put_u32(&header[4], block_header.boot_count);
+			put_u16(&header[8], position.first_record);
+			put_u16(&header[10], record_count);
+
+			n = LOG_TRANSFER_BLOCK_HEADER_SIZE - position.offset;
+			if(n > len - copied) {
+				n = len - copied;
+			}
+			memcpy(&buffer[copied], &header[position.offset], n);
+		} else {
+			n = block_len - position.offset;
+			if(n > len - copied) {
+				n = len - copied;
+			}
+
+			size_t data_offset = position.first_record * sizeof(sensor_log_record_t) +
+					position.offset - LOG_TRANSFER_BLOCK_HEADER_SIZE;
+			if(log.read_record_data(position.sequence, data_offset, &buffer[copied], n) != 0) {
+				// Recycled or unreadable, the rest of the block cannot be sent
+				status = BLOCK_LOST;
+				break;
+			}
+		}
+
+		copied += n;
+		position.offset += n;
+
+		if(position.offset == block_len) {
+			position.sequence++;
+			position.first_record = 0;
+			position.offset = 0;
+		}
+	}
+
+	return copied;
+}
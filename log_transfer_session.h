@@ -0,0 +1,204 @@
+/*
+ * log_transfer_session.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef LOG_TRANSFER_SESSION_H_
+#define LOG_TRANSFER_SESSION_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "platform/NonCopyable.h"
+
+#include "log_transfer_transport.h"
+#include "sensor_log.h"
+
+/**
+ * Bulk log transfer protocol
+ *
+ * All fields are little endian.
+ *
+ * Commands (client -> device):
+ *  GET_INFO	{ 0x01 }
+ *  START		{ 0x02, u32 segment sequence, u16 first record, u8 window }
+ *  ACK			{ 0x03, u16 packet sequence } (cumulative)
+ *  ABORT		{ 0x04 }
+ *
+ * Packets (device -> client), { u8 type, u16 packet sequence, payload }:
+ *  DATA		next bytes of the stream
+ *  END			no payload, the stream is complete
+ *  INFO		{ u32 oldest, u32 newest, u32 boot count, u16 records per segment,
+ *				  u8 record size, u8 max window } (packet sequence 0, not windowed)
+ *  RESUME		{ u32 segment sequence, u16 record } the stream broke off in the
+ *				middle of a block (the segment was overwritten or could not be
+ *				read), ends the stream like END. The record given is the first
+ *				one not sent, the client drops the partial block and sends START
+ *				again (an overwritten segment resumes at the oldest left)
+ *
+ * The stream is a series of blocks, one per segment starting at the START
+ * position: { u32 segment sequence, u32 boot count, u16 first record,
+ * u16 record count } followed by record count sensor_log_record_t. A client
+ * resumes an interrupted transfer by sending START with the position after
+ * the last complete record it received.
+ *
+ * Records still in RAM are only written to flash once the stream reaches
+ * them, without blocking: the stream waits for the writer and then includes
+ * that segment as well.
+ *
+ * DATA and END packets are numbered from 0 for every START. At most
+ * "window" packets are sent ahead of the last ACK; if no ACK arrives for
+ * LOG_TRANSFER_ACK_TIMEOUT_MS everything after the last acknowledged packet
+ * is sent again (go-back-N), clients drop packets out of order.
+ */
+#define LOG_TRANSFER_CMD_GET_INFO		0x01
+#define LOG_TRANSFER_CMD_START			0x02
+#define LOG_TRANSFER_CMD_ACK			0x03
+#define LOG_TRANSFER_CMD_ABORT			0x04
+
+#define LOG_TRANSFER_PACKET_DATA		0x01
+#define LOG_TRANSFER_PACKET_END			0x02
+#define LOG_TRANSFER_PACKET_INFO		0x03
+#define LOG_TRANSFER_PACKET_RESUME		0x04
+
+#define LOG_TRANSFER_PACKET_HEADER_SIZE	3
+#define LOG_TRANSFER_BLOCK_HEADER_SIZE	12
+#define LOG_TRANSFER_INFO_SIZE			16
+#define LOG_TRANSFER_RESUME_SIZE		6
+
+/** Largest packet, a notification at the largest ATT MTU */
+#define LOG_TRANSFER_MAX_PACKET_SIZE	244
+
+/** Packets sent ahead of the last acknowledgment, a power of two */
+#define LOG_TRANSFER_MAX_WINDOW			32
+#define LOG_TRANSFER_DEFAULT_WINDOW		16
+
+#define LOG_TRANSFER_ACK_TIMEOUT_MS		1000
+
+/** Give up after this many timeouts without any progress */
+#define LOG_TRANSFER_MAX_RETRIES		5
+
+/**
+ * Sender side of the bulk log transfer
+ *
+ * Reads the stream straight from flash as packets are sent, so the only
+ * state kept per unacknowledged packet is its position in the stream.
+ * Not thread safe, all calls must come from the same thread.
+ */
+class LogTransferSession : private mbed::NonCopyable<LogTransferSession> {
+public:
+
+	LogTransferSession(SensorLog& log, LogTransferTransport& transport);
+
+	/** Handle a command written by the client */
+	void handle_command(const uint8_t* data, size_t len, uint32_t now_ms);
+
+	/** Send as many packets as the window and the transport allow */
+	void pump(void);
+
+	/** Check the acknowledgment timeout and the log writer, call periodically while active */
+	void tick(uint32_t now_ms);
+
+	/** Stop the transfer (eg: the client disconnected) */
+	void abort(void);
+
+	bool is_active(void) const {
+		return active;
+	}
+
+	uint32_t get_packets_sent(void) const {
+		return packets_sent;
+	}
+
+	uint32_t get_bytes_sent(void) const {
+		return bytes_sent;
+	}
+
+	uint32_t get_retransmits(void) const {
+		return retransmits;
+	}
+
+	uint32_t get_transfers_completed(void) const {
+		return transfers_completed;
+	}
+
+	/** Streams that broke off with a RESUME packet */
+	uint32_t get_transfers_broken(void) const {
+		return transfers_broken;
+	}
+
+private:
+
+	/** Position in the stream */
+	typedef struct {
+		uint32_t sequence;		/** Segment */
+		uint16_t first_record;	/** First record of the segment's block */
+		uint16_t offset;		/** Byte offset into the block */
+	} stream_position_t;
+
+	typedef enum {
+		BLOCK_READY = 0,	/** block_header holds the segment at the position */
+		BLOCK_WAIT,			/** The segment is being written to flash, try again later */
+		BLOCK_END,			/** Nothing left to send */
+		BLOCK_LOST			/** The segment went away in the middle of its block */
+	} block_status_t;
+
+	void send_info(void);
+
+	void start(const uint8_t* data, size_t len, uint32_t now_ms);
+
+	void acknowledge(uint16_t packet_sequence, uint32_t now_ms);
+
+	/**
+	 * Copy up to len bytes of the stream at position into buffer and advance it
+	 * @param[out] status Why fewer than len bytes were copied
+	 * @retval Bytes copied
+	 */
+	size_t read_stream(uint8_t* buffer, size_t len, stream_position_t& position,
+			block_status_t& status);
+
+	/** Load the header of the segment at position, skipping segments that are gone */
+	block_status_t load_block(stream_position_t& position);
+
+	/** Start writing the records still in RAM once the stream reached them */
+	block_status_t flush_tail(void);
+
+	SensorLog& log;
+	LogTransferTransport& transport;
+
+	bool active;
+	bool end_sent;
+	uint8_t window;
+	uint32_t end_sequence;			/** Segments before this one are streamed */
+	bool tail_flushed;				/** end_sequence includes the records that were in RAM */
+	bool waiting;					/** For the log writer, pump() again from tick() */
+
+	uint16_t base_packet;			/** Oldest unacknowledged packet */
+	uint16_t next_packet;
+	stream_position_t next_position;
+	stream_position_t positions[LOG_TRANSFER_MAX_WINDOW];	/** Start of every packet in flight */
+
+	uint32_t last_progress_ms;
+	uint8_t retries;
+
+	/** Header of the segment being read */
+	uint32_t block_sequence;
+	bool block_valid;
+	sensor_log_segment_header_t block_header;
+
+	/** Next packet, kept if the transport had no room for it */
+	uint8_t packet[LOG_TRANSFER_MAX_PACKET_SIZE];
+	bool packet_ready;
+	size_t packet_len;
+	stream_position_t packet_end;	/** Stream position after the packet */
+
+	uint32_t packets_sent;
+	uint32_t bytes_sent;
+	uint32_t retransmits;
+	uint32_t transfers_completed;
+	uint32_t transfers_broken;
+
+};
+
+#endif /* LOG_TRANSFER_SESSION_H_ */
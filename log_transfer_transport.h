@@ -0,0 +1,37 @@
+/*
+ * log_transfer_transport.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef LOG_TRANSFER_TRANSPORT_H_
+#define LOG_TRANSFER_TRANSPORT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Packet transport used by LogTransferSession
+ *
+ * Implemented over GATT notifications by LogTransferService and in memory
+ * by LoopbackLogTransport, so the session can run without a radio.
+ */
+class LogTransferTransport {
+public:
+
+	virtual ~LogTransferTransport() {
+	}
+
+	/** Largest packet send() accepts */
+	virtual size_t get_max_packet_size(void) = 0;
+
+	/**
+	 * Send a packet to the client
+	 * @retval false if the transport has no room right now, the session
+	 * retries once pump() is called again
+	 */
+	virtual bool send(const uint8_t* packet, size_t len) = 0;
+
+};
+
+#endif /* LOG_TRANSFER_TRANSPORT_H_ */
@@ -0,0 +1,90 @@
+/*
+ * loopback_log_transport.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef LOOPBACK_LOG_TRANSPORT_H_
+#define LOOPBACK_LOG_TRANSPORT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "log_transfer_session.h"
+#include "log_transfer_transport.h"
+#include "spsc_ring.h"
+
+/**
+ * In memory transport for running LogTransferSession without a radio
+ *
+ * Packets sent by the session are queued and read back by the test client
+ * with receive(), the queue depth stands in for the stack's notification
+ * buffers. Every drop_interval-th packet can be thrown away to exercise
+ * the retransmission path.
+ */
+template<uint32_t Depth = 8>
+class LoopbackLogTransport : public LogTransferTransport {
+public:
+
+	typedef struct {
+		uint8_t len;
+		uint8_t data[LOG_TRANSFER_MAX_PACKET_SIZE];
+	} packet_t;
+
+	LoopbackLogTransport(size_t max_packet_size = LOG_TRANSFER_MAX_PACKET_SIZE) :
+		packets(), max_packet_size(max_packet_size), drop_interval(0), sent(0), dropped(0) {
+	}
+
+	/** Emulate a different ATT MTU */
+	void set_max_packet_size(size_t size) {
+		max_packet_size = size;
+	}
+
+	/** Drop every interval-th packet, 0 to disable */
+	void set_drop_interval(uint32_t interval) {
+		drop_interval = interval;
+	}
+
+	virtual size_t get_max_packet_size(void) {
+		return max_packet_size;
+	}
+
+	virtual bool send(const uint8_t* data, size_t len) {
+		if(len > max_packet_size || packets.size() == Depth) {
+			return false;
+		}
+
+		sent++;
+		if(drop_interval != 0 && (sent % drop_interval) == 0) {
+			// Accepted, then "lost over the air"
+			dropped++;
+			return true;
+		}
+
+		packet_t packet;
+		packet.len = (uint8_t) len;
+		memcpy(packet.data, data, len);
+		return packets.push(packet);
+	}
+
+	/** Client side: take the oldest packet, false if there is none */
+	bool receive(packet_t& packet) {
+		return packets.pop(packet);
+	}
+
+	uint32_t get_dropped(void) const {
+		return dropped;
+	}
+
+private:
+
+	SpscRing<packet_t, Depth> packets;
+	size_t max_packet_size;
+	uint32_t drop_interval;
+	uint32_t sent;
+	uint32_t dropped;
+
+};
+
+#endif /* LOOPBACK_LOG_TRANSPORT_H_ */
@@ -0,0 +1,253 @@
+/*
+ * lsm9ds1_stream.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "lsm9ds1_stream.h"
+
+#include "fixed_point.h"
+
+/** Accel/gyro registers */
+#define LSM9DS1_CTRL_REG1_G		0x10
+#define LSM9DS1_OUT_X_L_G		0x18
+#define LSM9DS1_CTRL_REG6_XL	0x20
+#define LSM9DS1_CTRL_REG9		0x23
+#define LSM9DS1_OUT_X_L_XL		0x28
+#define LSM9DS1_FIFO_CTRL		0x2E
+#define LSM9DS1_FIFO_SRC		0x2F
+
+#define LSM9DS1_CTRL_REG9_FIFO_EN		(1 << 1)
+#define LSM9DS1_FIFO_MODE_BYPASS		(0x0 << 5)
+#define LSM9DS1_FIFO_MODE_CONTINUOUS	(0x6 << 5)
+#define LSM9DS1_FIFO_SRC_OVRN			(1 << 6)
+#define LSM9DS1_FIFO_SRC_FSS_MASK		0x3F
+
+/** Auto-increment the register address during burst reads */
+#define LSM9DS1_AUTO_INCREMENT			0x80
+
+typedef struct {
+	uint16_t hz;
+	uint8_t code;	/** ODR_G field of CTRL_REG1_G (accel follows the gyro rate) */
+} odr_entry_t;
+
+static const odr_entry_t odr_table[] = {
+	{ 119, 3 },
+	{ 238, 4 },
+	{ 476, 5 },
+	{ 952, 6 },
+};
+
+#define ODR_TABLE_SIZE (sizeof(odr_table) / sizeof(odr_table[0]))
+
+LSM9DS1Stream::LSM9DS1Stream(LSM9DS1& imu, I2CTransactionEngine& engine,
+		events::EventQueue& queue, uint8_t xg_address) :
+	imu(imu), engine(engine), queue(queue), address(xg_address), frame_sink(),
+	accel_bias(), gyro_bias(), streaming(false), odr_code(0), odr_hz(0),
+	fifo_status(0), samples_remaining(0), chunk_samples(0), chunk_reads_pending(0),
+	chunk_error(false), draining(false), max_frame_size(IMU_STREAM_MIN_FRAME_SIZE),
+	chunk_raw(), builder(), last_sample(), sample_count(0), overruns(0) {
+}
+
+void LSM9DS1Stream::set_bias(const int16_t accel_bias[3], const int16_t gyro_bias[3]) {
+	for(int i = 0; i < 3; i++) {
+		this->accel_bias[i] = accel_bias[i];
+		this->gyro_bias[i] = gyro_bias[i];
+	}
+}
+
+uint8_t LSM9DS1Stream::gyro_fs_bits(void) const {
+	switch(imu.settings.gyro.scale) {
+	case 500:
+		return 1;
+	case 2000:
+		return 3;
+	case 245:
+	default:
+		return 0;
+	}
+}
+
+uint8_t LSM9DS1Stream::accel_fs_bits(void) const {
+	switch(imu.settings.accel.scale) {
+	case 16:
+		return 1;
+	case 4:
+		return 2;
+	case 8:
+		return 3;
+	case 2:
+	default:
+		return 0;
+	}
+}
+
+void LSM9DS1Stream::write_register(uint8_t reg, uint8_t value) {
+	engine.write_register(address, reg, value);
+}
+
+void LSM9DS1Stream::start(const imu_stream_config_t& config) {
+	const odr_entry_t* odr = &odr_table[ODR_TABLE_SIZE - 1];
+	for(size_t i = 0; i < ODR_TABLE_SIZE; i++) {
+		if(odr_table[i].hz >= config.odr_hz) {
+			odr = &odr_table[i];
+			break;
+		}
+	}
+
+	odr_code = odr->code;
+	odr_hz = odr->hz;
+
+	// Run accel and gyro at the stream rate, keep the driver's full scale
+	write_register(LSM9DS1_CTRL_REG1_G, (uint8_t) ((odr_code << 5) | (gyro_fs_bits() << 3) |
+			(imu.settings.gyro.bandwidth & 0x3)));
+	write_register(LSM9DS1_CTRL_REG6_XL, (uint8_t) ((odr_code << 5) | (accel_fs_bits() << 3)));
+
+	// Flush anything left in the FIFO by cycling through bypass mode
+	write_register(LSM9DS1_FIFO_CTRL, LSM9DS1_FIFO_MODE_BYPASS);
+	write_register(LSM9DS1_CTRL_REG9, LSM9DS1_CTRL_REG9_FIFO_EN);
+	write_register(LSM9DS1_FIFO_CTRL, LSM9DS1_FIFO_MODE_CONTINUOUS | LSM9DS1_STREAM_FIFO_TARGET);
+
+	streaming = true;
+	begin_frame();
+}
+
+void LSM9DS1Stream::stop(void) {
+	if(!streaming) {
+		return;
+	}
+
+	streaming = false;
+
+	write_register(LSM9DS1_FIFO_CTRL, LSM9DS1_FIFO_MODE_BYPASS);
+	write_register(LSM9DS1_CTRL_REG9, 0);
+
+	// Back to the rates configured by LSM9DS1::begin()
+	write_register(LSM9DS1_CTRL_REG1_G, (uint8_t) (((imu.settings.gyro.sampleRate & 0x7) << 5) |
+			(gyro_fs_bits() << 3) | (imu.settings.gyro.bandwidth & 0x3)));
+	write_register(LSM9DS1_CTRL_REG6_XL, (uint8_t) (((imu.settings.accel.sampleRate & 0x7) << 5) |
+			(accel_fs_bits() << 3)));
+}
+
+uint32_t LSM9DS1Stream::get_poll_interval_ms(void) const {
+	if(odr_hz == 0) {
+		return 1000;
+	}
+
+	uint32_t interval = (LSM9DS1_STREAM_FIFO_TARGET * 1000) / odr_hz;
+	return (interval == 0)? 1 : interval;
+}
+
+void LSM9DS1Stream::begin_frame(void) {
+	imu_stream_gyro_range_t gyro_range = IMU_STREAM_GYRO_RANGE_245DPS;
+	if(imu.settings.gyro.scale == 500) {
+		gyro_range = IMU_STREAM_GYRO_RANGE_500DPS;
+	} else if(imu.settings.gyro.scale == 2000) {
+		gyro_range = IMU_STREAM_GYRO_RANGE_2000DPS;
+	}
+
+	builder.begin(IMU_STREAM_SOURCE_LSM9DS1, odr_hz, (uint8_t) imu.settings.accel.scale,
+			gyro_range, max_frame_size);
+}
+
+void LSM9DS1Stream::poll(size_t frame_size) {
+	if(!streaming || draining) {
+		return;
+	}
+
+	if(frame_size != max_frame_size) {
+		max_frame_size = frame_size;
+		if(builder.empty()) {
+			// Resize the frame to the new notification payload
+			begin_frame();
+		}
+	}
+
+	draining = engine.read_registers(address, LSM9DS1_FIFO_SRC, &fifo_status, 1, &queue,
+			mbed::callback(this, &LSM9DS1Stream::on_fifo_status));
+}
+
+void LSM9DS1Stream::on_fifo_status(i2c_transaction_result_t result) {
+	if(result.status != 0 || !streaming) {
+		draining = false;
+		return;
+	}
+
+	if(fifo_status & LSM9DS1_FIFO_SRC_OVRN) {
+		overruns++;
+	}
+
+	samples_remaining = fifo_status & LSM9DS1_FIFO_SRC_FSS_MASK;
+	read_chunk();
+}
+
+void LSM9DS1Stream::read_chunk(void) {
+	if(samples_remaining == 0) {
+		draining = false;
+		return;
+	}
+
+	chunk_samples = (samples_remaining > LSM9DS1_STREAM_CHUNK_SAMPLES)?
+			LSM9DS1_STREAM_CHUNK_SAMPLES : samples_remaining;
+	chunk_reads_pending = 0;
+	chunk_error = false;
+
+	mbed::Callback<void(i2c_transaction_result_t)> cb(this, &LSM9DS1Stream::on_sample_read);
+
+	// Each FIFO slot is popped by reading the gyro output followed by the accel output
+	for(int i = 0; i < chunk_samples; i++) {
+		bool ok = engine.read_registers(address, LSM9DS1_OUT_X_L_G | LSM9DS1_AUTO_INCREMENT,
+				&chunk_raw[i][0], 6, &queue, cb);
+		ok = ok && engine.read_registers(address, LSM9DS1_OUT_X_L_XL | LSM9DS1_AUTO_INCREMENT,
+				&chunk_raw[i][6], 6, &queue, cb);
+		chunk_reads_pending += ok? 2 : 0;
+		if(!ok) {
+			chunk_error = true;
+			break;
+		}
+	}
+
+	if(chunk_reads_pending == 0) {
+		draining = false;
+	}
+}
+
+void LSM9DS1Stream::on_sample_read(i2c_transaction_result_t result) {
+	if(result.status != 0) {
+		chunk_error = true;
+	}
+
+	if(--chunk_reads_pending != 0) {
+		return;
+	}
+
+	if(chunk_error || !streaming) {
+		// Resynchronize from FIFO_SRC on the next poll
+		draining = false;
+		return;
+	}
+
+	for(int i = 0; i < chunk_samples; i++) {
+		const uint8_t* raw = chunk_raw[i];
+		imu_raw_sample_t sample;
+		for(int axis = 0; axis < 3; axis++) {
+			int16_t gyro = (int16_t) ((raw[2*axis + 1] << 8) | raw[2*axis]);
+			int16_t accel = (int16_t) ((raw[6 + 2*axis + 1] << 8) | raw[6 + 2*axis]);
+			sample.gyro[axis] = fixed::saturating_sub<int16_t>(gyro, gyro_bias[axis]);
+			sample.accel[axis] = fixed::saturating_sub<int16_t>(accel, accel_bias[axis]);
+		}
+
+		last_sample = sample;
+		sample_count++;
+
+		if(builder.append(sample)) {
+			if(frame_sink) {
+				frame_sink(builder.finish());
+			}
+			begin_frame();
+		}
+	}
+
+	samples_remaining -= chunk_samples;
+	read_chunk();
+}
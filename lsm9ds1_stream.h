@@ -0,0 +1,145 @@
+/*
+ * lsm9ds1_stream.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef LSM9DS1_STREAM_H_
+#define LSM9DS1_STREAM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "events/EventQueue.h"
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+#include "LSM9DS1.h"
+
+#include "i2c_transaction_engine.h"
+#include "imu_stream_source.h"
+
+/** Samples read per round of queued I2C transactions (2 transactions per sample) */
+#define LSM9DS1_STREAM_CHUNK_SAMPLES	4
+
+/** FIFO level the drain interval is sized for (the FIFO holds 32 samples) */
+#define LSM9DS1_STREAM_FIFO_TARGET		16
+
+/**
+ * High rate accelerometer/gyroscope streaming from the LSM9DS1 FIFO
+ *
+ * The accel/gyro FIFO is run in continuous mode at the requested output data
+ * rate and drained in bursts through the I2C transaction engine. Samples are
+ * packed into ImuFrameBuilder frames sized to the current notification payload.
+ *
+ * All methods and callbacks run on the sensor thread.
+ */
+class LSM9DS1Stream : public ImuStreamSource, private mbed::NonCopyable<LSM9DS1Stream> {
+public:
+
+	/**
+	 * @param[in] imu Driver, used for its current full scale settings
+	 * @param[in] engine I2C transaction engine shared with the other sensors
+	 * @param[in] queue Event queue of the sensor thread
+	 * @param[in] xg_address 8-bit address of the accel/gyro
+	 */
+	LSM9DS1Stream(LSM9DS1& imu, I2CTransactionEngine& engine, events::EventQueue& queue,
+			uint8_t xg_address);
+
+	virtual void set_frame_sink(frame_sink_t sink) {
+		frame_sink = sink;
+	}
+
+	/** Raw offsets subtracted from every sample (eg: from LSM9DS1::calibrate) */
+	void set_bias(const int16_t accel_bias[3], const int16_t gyro_bias[3]);
+
+	/**
+	 * The rate is rounded up to a supported rate (119 to 952 Hz). The full
+	 * scale ranges stay at the driver's settings, the magnetometer and the
+	 * low rate characteristics rely on them.
+	 */
+	virtual void start(const imu_stream_config_t& config);
+
+	/** Stop streaming and restore the driver's configuration */
+	virtual void stop(void);
+
+	virtual bool is_streaming(void) const {
+		return streaming;
+	}
+
+	virtual uint16_t get_odr_hz(void) const {
+		return odr_hz;
+	}
+
+	virtual uint32_t get_poll_interval_ms(void) const;
+
+	virtual void poll(size_t max_frame_size);
+
+	/** Most recent (bias corrected) sample */
+	virtual const imu_raw_sample_t& get_last_sample(void) const {
+		return last_sample;
+	}
+
+	virtual bool has_sample(void) const {
+		return sample_count != 0;
+	}
+
+	virtual uint32_t get_sample_count(void) const {
+		return sample_count;
+	}
+
+	virtual uint32_t get_overruns(void) const {
+		return overruns;
+	}
+
+	virtual const char* get_name(void) const {
+		return "lsm9ds1";
+	}
+
+private:
+
+	void on_fifo_status(i2c_transaction_result_t result);
+
+	void on_sample_read(i2c_transaction_result_t result);
+
+	void read_chunk(void);
+
+	void begin_frame(void);
+
+	void write_register(uint8_t reg, uint8_t value);
+
+	uint8_t gyro_fs_bits(void) const;
+
+	uint8_t accel_fs_bits(void) const;
+
+	LSM9DS1& imu;
+	I2CTransactionEngine& engine;
+	events::EventQueue& queue;
+	uint8_t address;
+	frame_sink_t frame_sink;
+
+	int16_t accel_bias[3];
+	int16_t gyro_bias[3];
+
+	bool streaming;
+	uint8_t odr_code;
+	uint16_t odr_hz;
+
+	/** Drain state */
+	uint8_t fifo_status;
+	uint8_t samples_remaining;
+	uint8_t chunk_samples;
+	int chunk_reads_pending;
+	bool chunk_error;
+	bool draining;
+	size_t max_frame_size;
+	uint8_t chunk_raw[LSM9DS1_STREAM_CHUNK_SAMPLES][12];
+
+	ImuFrameBuilder builder;
+	imu_raw_sample_t last_sample;
+	uint32_t sample_count;
+	uint32_t overruns;
+
+};
+
+#endif /* LSM9DS1_STREAM_H_ */
@@ -5,15 +5,23 @@
  */
 
 #include <stdio.h>
+#include <string.h>
+
+#include <atomic>
 
 /** Mbed */
+#include "drivers/DigitalIn.h"
 #include "drivers/DigitalOut.h"
 #include "platform/Callback.h"
 #include "platform/NonCopyable.h"
+#include "platform/mbed_assert.h"
 #include "platform/mbed_wait_api.h"
+#include "rtos/Kernel.h"
+#include "rtos/ThisThread.h"
 #include "rtos/Thread.h"
 #include "events/EventQueue.h"
 #include "events/Event.h"
+#include "hal/us_ticker_api.h"
 #include "LittleFileSystem.h"
 #include "BlockDevice.h"
 
@@ -38,14 +46,187 @@
 #include "BatteryVoltageService.h"
 
 #include "agora_components.h"
-
-// Prints extra sensor polling information
+#include "sensor_scheduler.h"
+#include "rtos_scheduler_clock.h"
+#include "battery_monitor.h"
+#include "sensor_sample.h"
+#include "gatt_update_coalescer.h"
+#include "sensor_sample_handoff.h"
+#include "imu_stream_service.h"
+#include "lsm9ds1_stream.h"
+#include "icm20602_stream.h"
+#include "sensor_log.h"
+#include "log_transfer_service.h"
+#include "filesystem_boot.h"
+#include "init_graph.h"
+#include "status_service.h"
+#include "trace.h"
+#include "serial_console.h"
+#include "async_uart_writer.h"
+#include "sensor_telemetry.h"
+#include "gatt_units.h"
+#include "sensor_power_manager.h"
+#include "sensor_broadcast.h"
+#include "bond_store.h"
+#include "imu_features.h"
+#include "imu_feature_service.h"
+#include "imu_dsp_benchmark.h"
+#include "sensor_interrupts.h"
+#include "vl53l0x_ranging.h"
+#include "vl53l0x_ranging_service.h"
+#include "sensor_snapshot_service.h"
+#include "time_sync_service.h"
+
+// Periodically prints scheduler statistics (readings are available as binary telemetry, see below)
 #define DEBUG_SENSOR_POLLING 0
 
-// Erases the block device during filesystem initialization
-#define ERASE_BLOCK_DEVICE 1
+/**
+ * Console UART baud rate while binary sensor telemetry is on ('t' on the console),
+ * scripts/telemetry_decode.py switches over to it
+ */
+#define TELEMETRY_BAUD_RATE			230400
+
+/** Longest wait for queued telemetry to go out before switching back to the console baud rate */
+#define TELEMETRY_DRAIN_TIMEOUT_MS	500
+
+/**
+ * Holding the push button through reset for this long erases the filesystem
+ * (and with it the pairing data), otherwise the existing one is mounted
+ */
+#define FILESYSTEM_ERASE_HOLD_MS	2000
+
+/** Level of the push button pin while pressed (DigitalButton is active high) */
+#define PUSH_BUTTON_PRESSED_LEVEL	1
+
+/** Sensors need this long after their power domain is switched on */
+#define SENSOR_POWER_UP_MS			100
+
+/**
+ * After a power cycle: worst case re-init until measured (VL53L0X reference calibration
+ * dominates), then up to 800 ms for the MAX44009's first conversion
+ */
+#define SENSOR_REINIT_ESTIMATE_MS	50
+#define SENSOR_SETTLE_MS			800
+
+/** Start in the low power profile (toggled with 'p' on the console) */
+#define LOW_POWER_PROFILE_AT_BOOT	0
+
+/** Broadcast sensor readings in the advertising data from boot (toggled with 'b' on the console) */
+#define SENSOR_BROADCAST_AT_BOOT	0
 
-#define POLL_INTERVAL_MS 5000 // Sensor polling interval in milliseconds
+/** Wake the IMU and light polling from the sensors' interrupts from boot (toggled with 'i' on the console) */
+#define EVENT_DRIVEN_AT_BOOT		0
+
+/**
+ * Event-driven sensing: sensors whose interrupt is wired (see mbed_app.json) are only
+ * polled this often to keep their characteristics fresh while nothing happens
+ */
+#define EVENT_KEEPALIVE_INTERVAL_MS	60000
+#define EVENT_MOTION_HOLD_MS		5000	// IMUs keep their poll rate this long after the last motion interrupt
+#define EVENT_MOTION_THRESHOLD_MG	64
+
+/** Poll intervals of the low power profile, long enough for the IMUs to sleep in between */
+#define LOW_POWER_IMU_POLL_INTERVAL_MS		1000
+#define LOW_POWER_VL53L0X_POLL_INTERVAL_MS	5000
+
+/** VL53L0X ranging profile at boot (cycled with 'r' on the console), see vl53l0x_ranging.h */
+#define VL53L0X_PROFILE_AT_BOOT				VL53L0X_PROFILE_DEFAULT
+
+/** Ranging period of the high speed profile, whatever the power profile */
+#define VL53L0X_HIGH_SPEED_POLL_INTERVAL_MS	30		// 33 Hz
+
+/** Gyro turn-on out of sleep, a few output periods at 119 Hz */
+#define LSM9DS1_GYRO_WAKE_MS		100
+
+/**
+ * Supply current estimates for the power statistics (datasheet typicals, uA),
+ * scripts/power_sim.py uses the same figures
+ */
+#define SENSOR_DOMAIN_ON_UA			110		// BSEC low power mode (~90), Si7021/MAX44009/VL53L0X standby
+#define SENSOR_DOMAIN_OFF_UA		1		// Load switch leakage
+#define LSM9DS1_ACTIVE_UA			4600	// Accel + gyro (4 mA), magnetometer (0.6 mA)
+#define LSM9DS1_LOW_POWER_UA		1200	// Gyro asleep
+#define ICM20602_ACTIVE_UA			2800	// 6-axis low noise mode
+#define ICM20602_LOW_POWER_UA		6
+#define VL53L0X_RANGING_UA			19000	// While ranging, a measurement lasts one timing budget
+
+/** Charge drawn by a single measurement in nC (uA x ms) */
+#define SI7021_MEASUREMENT_NC		1800	// 150 uA through RH and temperature conversions
+
+/** Runs the filesystem and sensor log bring-up while BLE comes up */
+#define BOOT_THREAD_STACK_SIZE		4096
+
+/** Print the boot timeline once every step finished, or after this long */
+#define BOOT_TIMELINE_TIMEOUT_MS	10000
+
+/** Layout of the default block device: filesystem, then the sensor log */
+#define FILESYSTEM_SIZE		(128*1024)
+#define SENSOR_LOG_SIZE		(1024*1024)
+
+// Minimum interval between logged IMU readings, the other channels are logged on every change
+#define SENSOR_LOG_IMU_INTERVAL_MS	1000
+
+/** Per-sensor polling intervals in milliseconds */
+#define BME680_POLL_INTERVAL_MS		3000	// BSEC low power mode produces a new output every 3s
+#define MAX44009_POLL_INTERVAL_MS	1000
+#define SI7021_POLL_INTERVAL_MS		5000
+#define VL53L0X_POLL_INTERVAL_MS	1000
+#define LSM9DS1_POLL_INTERVAL_MS	50		// 20Hz
+#define ICM20602_POLL_INTERVAL_MS	50		// 20Hz
+#define BATTERY_POLL_INTERVAL_MS	60000
+
+#define LSM9DS1_POLL_DEADLINE_MS	10		// IMU samples should not be held up by slower sensors
+#define ICM20602_POLL_DEADLINE_MS	10
+
+// Streams from the ICM20602 (1kHz, single burst per FIFO chunk) when it is present,
+// otherwise from the LSM9DS1
+#define IMU_STREAM_PREFER_ICM20602	1
+
+// Sensor I2C bus clock, 400kHz leaves headroom for draining the LSM9DS1 FIFO while streaming
+#define SENSOR_I2C_FREQUENCY_HZ		400000
+
+/** LSM9DS1 output registers, read in bursts through the I2C transaction engine */
+#define LSM9DS1_OUT_X_L_G_REG		0x18
+#define LSM9DS1_OUT_X_L_XL_REG		0x28
+#define LSM9DS1_OUT_X_L_M_REG		0x28
+#define LSM9DS1_AUTO_INCREMENT		0x80
+
+/**
+ * Polled reads still pending after this long lost their completion (see
+ * I2CTransactionEngine), the next poll starts over. Well above the worst
+ * case wait behind a full engine queue.
+ */
+#define I2C_READ_TIMEOUT_MS			250
+
+// Interval at which scheduler statistics are printed (DEBUG_SENSOR_POLLING only)
+#define SCHEDULER_STATS_INTERVAL_MS 30000
+
+/**
+ * 'f' on the console times the feature kernels against their reference
+ * versions (imu_dsp_benchmark.h), which keeps the console thread busy for
+ * seconds: development builds only
+ */
+#ifndef DSP_BENCHMARK_COMMAND
+#define DSP_BENCHMARK_COMMAND 0
+#endif
+
+/** Iterations of the DSP benchmark (console), the reference DFT takes the most of it */
+#define DSP_BENCHMARK_ITERATIONS	10
+
+/** Change a value must exceed before it is written to the GATT database (in channel units) */
+#define TEMP_DEADBAND			5		// 0.05 degC
+#define PRESSURE_DEADBAND		50		// 5 Pa
+#define HUMIDITY_DEADBAND		20		// 0.2 %RH
+#define GAS_RESISTANCE_DEADBAND	500		// Ohm
+#define CO2_DEADBAND			1.0f	// ppm
+#define BVOC_DEADBAND			0.05f	// ppm
+#define IAQ_SCORE_DEADBAND		1
+#define ALS_DEADBAND			1.0f	// lux
+#define DISTANCE_DEADBAND		5		// mm
+#define ACCEL_DEADBAND			0.02f	// g
+#define GYRO_DEADBAND			0.5f	// dps
+#define MAG_DEADBAND			0.01f	// gauss
+#define BATTERY_DEADBAND		0.01f	// V
 
 #define MAX_VBAT_VOLTAGE 3.3f
 
@@ -78,18 +259,150 @@ VL53L0XService vl53l0x_service;
 LEDService led_service(true);
 BatteryVoltageService battery_voltage_service;
 
+/** Sensor thread event queue (I2C completions and other deferred sensor work) */
+events::EventQueue sensor_event_queue;
+
+/** Sensor Scheduler */
+RtosSchedulerClock scheduler_clock(&sensor_event_queue);
+SensorScheduler sensor_scheduler(scheduler_clock);
+SensorScheduler::task_id_t bme680_task = SensorScheduler::INVALID_TASK;
+SensorScheduler::task_id_t max44009_task = SensorScheduler::INVALID_TASK;
+SensorScheduler::task_id_t si7021_task = SensorScheduler::INVALID_TASK;
+SensorScheduler::task_id_t vl53l0x_task = SensorScheduler::INVALID_TASK;
+SensorScheduler::task_id_t lsm9ds1_task = SensorScheduler::INVALID_TASK;
+SensorScheduler::task_id_t icm20602_task = SensorScheduler::INVALID_TASK;
+SensorScheduler::task_id_t battery_task = SensorScheduler::INVALID_TASK;
+
+/** Sensor power domain and low power modes, between the scheduler's releases */
+SensorPowerManager sensor_power(sensor_scheduler, scheduler_clock, sensor_i2c_engine, sensor_power_en);
+
+/** Selected from the console thread, applied on the sensor thread */
+static std::atomic<bool> low_power_profile(LOW_POWER_PROFILE_AT_BOOT);
+
+/** Threshold and motion interrupts of the sensors (sensor thread only) */
+SensorInterrupts sensor_interrupts(sensor_i2c_engine, sensor_event_queue);
+
+/** Selected from the console thread, applied on the sensor thread */
+static std::atomic<bool> event_driven(EVENT_DRIVEN_AT_BOOT);
+
+/** A motion interrupt came within EVENT_MOTION_HOLD_MS (sensor thread only) */
+static bool motion_active = false;
+static int motion_hold_event = 0;
+
+/** Battery voltage measurement (divider halves the battery voltage) */
+BatteryMonitor battery_monitor(battery_mon_en, battery_voltage_in, MAX_VBAT_VOLTAGE * 2.0f);
+
 /** Event Queue */
 events::EventQueue event_queue;
 
+/** Latest readings in the advertising data, for scanners that do not connect (BLE thread only) */
+SensorBroadcast sensor_broadcast(event_queue);
+
+/** Selected from the console thread, applied on the BLE thread */
+static std::atomic<bool> broadcast_enabled(SENSOR_BROADCAST_AT_BOOT);
+
+/** Every sensor's latest value in one characteristic (BLE thread only) */
+SensorSnapshotService sensor_snapshot_service(event_queue);
+
+/** Device time to wall time mapping set by a host (BLE thread only) */
+TimeSyncService time_sync_service;
+
 /** Blink LED Event */
 void blink_led(void);
 events::Event<void(void)> led_event(&event_queue, blink_led);
 
+/** Coalesces sensor updates into batched, deadband-filtered GATT writes (BLE thread only) */
+void publish_sample(const sensor_sample_t& sample);
+void write_characteristic(const sensor_sample_t& sample);
+GattUpdateCoalescer gatt_coalescer(mbed::callback(publish_sample));
+
+/** Lock-free handoff of samples from the sensor thread to the BLE event queue */
+void on_sample_received(const sensor_sample_t& sample);
+void on_sample_batch_received(void);
+SensorSampleHandoff sample_handoff(event_queue, mbed::callback(on_sample_received),
+		mbed::callback(on_sample_batch_received));
+
+/** Set once BSEC is running on the BME680 */
+static bool bme680_online = false;
+
+/** Set once calibrate() has computed the LSM9DS1 accel/gyro bias */
+static bool lsm9ds1_calibrated = false;
+
+/** Set once the ICM20602 has been detected and configured */
+static bool icm20602_online = false;
+
+/** High rate IMU streaming (FIFO drained on the sensor thread, notified from the BLE thread) */
+ImuStreamService imu_stream_service(event_queue);
+LSM9DS1Stream lsm9ds1_stream(lsm9ds1, sensor_i2c_engine, sensor_event_queue,
+		LSM9DS1_ACC_GYRO_I2C_ADDR);
+ICM20602Stream icm20602_stream(sensor_i2c_engine, sensor_event_queue, ICM20602_I2C_ADDR);
+ImuStreamSource* imu_stream_source = NULL;	/** Selected in init_sensors() */
+SensorScheduler::task_id_t imu_stream_task = SensorScheduler::INVALID_TASK;
+
+/** Vibration features of the stream source's accelerometer (computed on the sensor thread) */
+ImuFeatureExtractor imu_features;
+ImuFeatureService imu_feature_service(event_queue);
+static uint32_t imu_features_compute_us = 0;
+
+/** Continuous ranging on the VL53L0X, range status and signal rate alongside the distance */
+void on_vl53l0x_range(const vl53l0x_range_t& range);
+VL53L0XRanging vl53l0x_ranging(sensor_i2c_bus, sensor_i2c_engine, sensor_event_queue,
+		VL53L0X_I2C_ADDR);
+VL53L0XRangingService vl53l0x_ranging_service(event_queue);
+
+/** Set once the VL53L0X is calibrated and ranging */
+static bool vl53l0x_online = false;
+
+/** Selected from the console thread, applied on the sensor thread */
+static std::atomic<int> vl53l0x_profile(VL53L0X_PROFILE_AT_BOOT);
+
 /** BlockDevice on which the filesystem is mounted */
 BlockDevice* fsbd;
 
+/** The filesystem, NULL until it is mounted */
+FileSystem* filesystem = NULL;
+
+/** Security manager database, mounted at /bonds and kept in the filesystem (BLE thread only) */
+BondStore bond_store(event_queue, "bonds");
+
+/** Persistent log of published samples, NULL if it could not be initialized */
+SensorLog* sensor_log = NULL;
+
+/** Bulk download of the sensor log */
+LogTransferService log_transfer_service(event_queue);
+
+/** Which of the components brought up in the background are ready */
+StatusService status_service(event_queue);
+
+/** Start-up steps, see main() */
+InitGraph init_graph;
+InitGraph::step_id_t boot_ble = InitGraph::INVALID_STEP;
+InitGraph::step_id_t boot_filesystem = InitGraph::INVALID_STEP;
+InitGraph::step_id_t boot_sensor_log = InitGraph::INVALID_STEP;
+InitGraph::step_id_t boot_sensors = InitGraph::INVALID_STEP;
+
+/** Set once start_services() added the characteristics samples are written to */
+static bool services_started = false;
+
+/** Console UART: stdio output, single-key commands and binary sensor telemetry */
+mbed::RawSerial console_uart(STDIO_UART_TX, STDIO_UART_RX, MBED_CONF_PLATFORM_STDIO_BAUD_RATE);
+SerialConsole console(console_uart);
+AsyncUartWriter telemetry_writer(console_uart);
+SensorTelemetry telemetry(telemetry_writer);
+
 /** Pairing file location */
-static const char pairing_file_name[] = "/fs/sm.dat";
+static const char pairing_file_name[] = "/bonds/" BOND_STORE_FILE_NAME;
+
+/** Where the bond store keeps its image and journal, and the pairing file of earlier firmware */
+static const char bond_store_dir[] = "bonds";
+static const char legacy_pairing_file_name[] = "sm.dat";
+
+/** A host set the wall clock, keep the mapping with the log (BLE thread) */
+void on_time_sync(uint64_t device_ms, int64_t wall_ms) {
+	if(sensor_log != NULL) {
+		sensor_log->append_time_sync((uint32_t) device_ms, wall_ms);
+	}
+}
 
 void start_services(BLE& ble) {
 
@@ -106,7 +419,23 @@ void start_services(BLE& ble) {
 	vl53l0x_service.start(ble);
 	led_service.start(ble);
 	battery_voltage_service.start(ble);
-
+	imu_stream_service.start(ble, ble_process->get_connections());
+	log_transfer_service.start(ble, ble_process->get_connections());
+	status_service.start(ble);
+	imu_feature_service.start(ble);
+	vl53l0x_ranging_service.start(ble);
+	sensor_snapshot_service.start(ble);
+	time_sync_service.on_sync(mbed::callback(on_time_sync));
+	time_sync_service.start(ble);
+
+	sensor_broadcast.on_legacy_payload(mbed::callback(ble_process, &BLEProcess::set_broadcast_data));
+	sensor_broadcast.start(ble);
+
+	// Sensors may have come up first, catch the new characteristics up
+	services_started = true;
+	gatt_coalescer.replay(mbed::callback(write_characteristic));
+
+	init_graph.complete(boot_ble, true);
 }
 
 void stop_services(void) {
@@ -116,65 +445,128 @@ void stop_services(void) {
 	}
 }
 
-void init_sensors(void) {
+/** Print a sensor's init result on one line (other threads print too) and publish it */
+static bool report_sensor(status_component_t component, const char* name, bool ok) {
+	printf("\t %s: %s\r\n", name, ok? "OK" : "FAILED");
+	status_service.set_ready(component, ok);
+	return ok;
+}
+
+/**
+ * Bring up the sensors, runs on the sensor thread while BLE comes up
+ *
+ * Each sensor's readiness is reported through the status service.
+ * @retval false if any sensor failed
+ */
+bool init_sensors(void) {
 
 	// Enable sensor power domain
 	sensor_power_en = 1;
 
-	wait_ms(100);
+	rtos::ThisThread::sleep_for(SENSOR_POWER_UP_MS);
+
+	// Through the bus, which sizes its transfer timeouts from the clock
+	sensor_i2c_bus.frequency(SENSOR_I2C_FREQUENCY_HZ);
 
 	printf("Initializing sensors...\r\n");
-	printf("\t BME680: ");
 
-	if(bme680->init(&sensor_i2c)) {
-		printf("OK\r\n");
-	} else {
-		printf("FAILED\r\n");
-	}
+	bool all_ok = true;
+
+	bme680_online = bme680->init(&sensor_i2c);
+	all_ok &= report_sensor(STATUS_COMPONENT_BME680, "BME680", bme680_online);
 
 	// No way to check this really...
-	printf("\t MAX44009: OK\r\n");
+	all_ok &= report_sensor(STATUS_COMPONENT_MAX44009, "MAX44009", true);
 
-	printf("\t Si7021: ");
-	if(si7021.check() == 1) {
-		printf("OK\r\n");
-	} else {
-		printf("FAILED\r\n");
-	}
+	all_ok &= report_sensor(STATUS_COMPONENT_SI7021, "Si7021", si7021.check() == 1);
 
-	printf("\t VL53L0X: ");
-	if(vl53l0x.init_sensor(DEFAULT_DEVICE_ADDRESS) == 0) {
-		printf("OK\r\n");
-	} else {
-		printf("FAILED\r\n");
-	}
+	// The driver calibrates, ranging itself runs on VL53L0XRanging
+	vl53l0x_ranging.set_range_sink(mbed::callback(on_vl53l0x_range));
+	vl53l0x_online = (vl53l0x.init_sensor(DEFAULT_DEVICE_ADDRESS) == 0) &&
+			vl53l0x_ranging.configure((vl53l0x_profile_t) vl53l0x_profile.load()) &&
+			vl53l0x_ranging.start(VL53L0X_POLL_INTERVAL_MS);
+	all_ok &= report_sensor(STATUS_COMPONENT_VL53L0X, "VL53L0X", vl53l0x_online);
 
-	printf("\t LSM9DS1: ");
 	if(lsm9ds1.begin() != 0) {
 		lsm9ds1.calibrate();
-		printf("OK\r\n");
-	} else {
-		printf("FAILED\r\n");
+		lsm9ds1_calibrated = true;
+		lsm9ds1_stream.set_bias(lsm9ds1.aBiasRaw, lsm9ds1.gBiasRaw);
 	}
+	all_ok &= report_sensor(STATUS_COMPONENT_LSM9DS1, "LSM9DS1", lsm9ds1_calibrated);
 
-	printf("\t ICM20602: ");
 	icm20602.init();
 	if(icm20602.isOnline()) {
-		printf("OK\r\n");
-	} else {
-		printf("FAILED\r\n");
+		icm20602_stream.init();
+		icm20602_online = true;
+	}
+	all_ok &= report_sensor(STATUS_COMPONENT_ICM20602, "ICM20602", icm20602_online);
+
+	if(lsm9ds1_calibrated) {
+		imu_stream_source = &lsm9ds1_stream;
+	}
+#if IMU_STREAM_PREFER_ICM20602
+	if(icm20602_online) {
+		imu_stream_source = &icm20602_stream;
 	}
+#else
+	if(imu_stream_source == NULL && icm20602_online) {
+		imu_stream_source = &icm20602_stream;
+	}
+#endif
 
-	// Attach LED to BLE service
-	led_service.bind(&board_led);
-	led_service.set_led_status(0);
+	return all_ok;
 }
 
-void poll_sensors(void) {
-#if DEBUG_SENSOR_POLLING
-	printf("Polling sensors...\n");
-#endif
+/**
+ * Bring the sensors back after their power domain was switched off, on the sensor thread
+ *
+ * The LSM9DS1 keeps the bias calibrate() measured at boot instead of running it
+ * again, it takes a while and the board would have to be still. The BME680 is
+ * never power cycled (BSEC keeps running on it, see init_sensor_power()).
+ * The Si7021 and MAX44009 come up in the modes they are used in.
+ */
+bool reinit_sensors(void) {
+	bool ok = true;
 
+	ok &= (vl53l0x.init_sensor(DEFAULT_DEVICE_ADDRESS) == 0);
+	if(vl53l0x_online) {
+		ok &= vl53l0x_ranging.restore();
+	}
+
+	if(lsm9ds1_calibrated) {
+		int16_t accel_bias[3];
+		int16_t gyro_bias[3];
+		memcpy(accel_bias, lsm9ds1.aBiasRaw, sizeof(accel_bias));
+		memcpy(gyro_bias, lsm9ds1.gBiasRaw, sizeof(gyro_bias));
+		ok &= (lsm9ds1.begin() != 0);
+		memcpy(lsm9ds1.aBiasRaw, accel_bias, sizeof(accel_bias));
+		memcpy(lsm9ds1.gBiasRaw, gyro_bias, sizeof(gyro_bias));
+	}
+
+	if(icm20602_online) {
+		icm20602.init();
+		icm20602_stream.init();
+	}
+
+	// Interrupt configuration is lost with the rest
+	sensor_interrupts.reconfigure();
+
+	return ok;
+}
+
+/** LSM9DS1 low power mode: gyro asleep, accelerometer and magnetometer keep running */
+void set_lsm9ds1_low_power(bool low_power) {
+	lsm9ds1.sleepGyro(low_power);
+}
+
+/** ICM20602 low power mode: asleep, or only the gyro in standby while the accelerometer wakes on motion */
+void set_icm20602_low_power(bool low_power) {
+	bool wake_on_motion = sensor_interrupts.is_enabled() && sensor_interrupts.has_icm20602_line();
+	icm20602_stream.set_sleep(low_power && !wake_on_motion);
+	icm20602_stream.set_gyro_standby(low_power && wake_on_motion);
+}
+
+void poll_bme680(void) {
 	/** Poll BME680 */
 	float temperature 	= bme680->get_temperature();
 	float pressure		= bme680->get_pressure();
@@ -185,132 +577,989 @@ void poll_sensors(void) {
 	float iaq_score		= bme680->get_iaq_score();
 	uint8_t iaq_acc		= bme680->get_iaq_accuracy();
 
-#if DEBUG_SENSOR_POLLING
-	printf("BME680:\n");
-	printf("\ttemperature: %.2f\n", temperature);
-	printf("\tpressure: %.2f\n", pressure);
-	printf("\thumidity: %.2f\n", humidity);
-	printf("\tgas resistance: %.2f\n", gas_res);
-	printf("\tco2 equivalent: %.2f\n", co2_eq);
-	printf("\tbreath voc eq: %.2f\n", breath_voc_eq);
-	printf("\tiaq score: %.2f\n", iaq_score);
-	printf("\tiaq accuracy: %i\n", iaq_acc);
-#endif
-
-	temperature *= 100;	/** Scale up before converting to integer (preserves decimal component) */
-	pressure *= 10;		/** Scale up before converting to integer (preserves decimal component) */
-	humidity *= 100;		/** Scale up before converting to integer (preserves decimal component) */
-	bme680_service.set_temp_c((int16_t) temperature);
-	bme680_service.set_pressure((uint32_t) pressure);
-	bme680_service.set_rel_humidity((uint16_t) humidity);
-	bme680_service.set_gas_resistance((uint32_t) gas_res);
-	bme680_service.set_estimated_co2(co2_eq);
-	bme680_service.set_estimated_b_voc(breath_voc_eq);
-	bme680_service.set_iaq_score((uint16_t) iaq_score);
-	bme680_service.set_iaq_accuracy(iaq_acc);
+	telemetry_bme680_t record = { temperature, pressure, humidity, gas_res, co2_eq,
+			breath_voc_eq, iaq_score, iaq_acc };
+	telemetry.send(TELEMETRY_RECORD_BME680, record);
+
+	// BSEC only reports floats, each is rounded and range checked once into its characteristic's unit
+	sample_handoff.push(sensor_sample_i32(SENSOR_CHANNEL_BME680_TEMP,
+			TemperatureFromCelsius::from_float(temperature)));
+	sample_handoff.push(sensor_sample_u32(SENSOR_CHANNEL_BME680_PRESSURE,
+			PressureFromPascal::from_float(pressure)));
+	sample_handoff.push(sensor_sample_u32(SENSOR_CHANNEL_BME680_HUMIDITY,
+			HumidityFromPercent::from_float(humidity)));
+	sample_handoff.push(sensor_sample_u32(SENSOR_CHANNEL_BME680_GAS_RESISTANCE,
+			GasResistanceFromOhm::from_float(gas_res)));
+	sample_handoff.push(sensor_sample_float(SENSOR_CHANNEL_BME680_CO2, co2_eq));
+	sample_handoff.push(sensor_sample_float(SENSOR_CHANNEL_BME680_BVOC, breath_voc_eq));
+	sample_handoff.push(sensor_sample_u32(SENSOR_CHANNEL_BME680_IAQ_SCORE,
+			IaqScore::from_float(iaq_score)));
+	sample_handoff.push(sensor_sample_u32(SENSOR_CHANNEL_BME680_IAQ_ACCURACY,
+			IaqAccuracy::from_int(iaq_acc)));
+	sample_handoff.commit();
+}
 
+void poll_max44009(void) {
 	/** Poll MAX44009 */
 	float als = (float) max44009.getLUXReading();
 
-#if DEBUG_SENSOR_POLLING
-	printf("MAX44009:\n");
-	printf("\tambient light reading: %.2f\n", als);
-#endif
+	telemetry_max44009_t record = { als };
+	telemetry.send(TELEMETRY_RECORD_MAX44009, record);
+
+	// Event-driven sensing: the next interrupt comes when the light changes from here
+	sensor_interrupts.set_light_window(als);
 
-	max44009_service.set_als_reading(als);
+	sample_handoff.push(sensor_sample_float(SENSOR_CHANNEL_MAX44009_ALS, als));
+	sample_handoff.commit();
+}
 
+void poll_si7021(void) {
 	/** Poll Si7021 */
 	si7021.measure();
-	uint32_t humidity_si = si7021.get_humidity();
-	uint32_t temp_si	 = si7021.get_temperature();
-	humidity_si /= 10; // Divide by 10 to scale to 0.01 increments as specified by BLE
-	temp_si /= 10;
-	si7021_service.set_rel_humidity((uint16_t) humidity_si);
-	si7021_service.set_temp_c((int16_t) temp_si);
+	// Driver reports milli-units (temperature may be negative), BLE wants 0.01 increments
+	uint16_t humidity_si = HumidityFromMilliPercent::from_int((int32_t) si7021.get_humidity());
+	int16_t temp_si = TemperatureFromMilliCelsius::from_int((int32_t) si7021.get_temperature());
+	sample_handoff.push(sensor_sample_u32(SENSOR_CHANNEL_SI7021_HUMIDITY, humidity_si));
+	sample_handoff.push(sensor_sample_i32(SENSOR_CHANNEL_SI7021_TEMP, temp_si));
+	sample_handoff.commit();
+
+	telemetry_si7021_t record = { temp_si, humidity_si };
+	telemetry.send(TELEMETRY_RECORD_SI7021, record);
+}
 
-#if DEBUG_SENSOR_POLLING
-	printf("Si7021:\n");
-	printf("\ttemperature: %lu\n", temp_si);
-	printf("\thumidity: %lu\n", humidity_si);
-#endif
+void poll_vl53l0x(void) {
+	/** Picks up the latest measurement, see on_vl53l0x_range() */
+	if(vl53l0x_online) {
+		vl53l0x_ranging.poll();
+	}
+}
 
-	/** Poll VL53L0X */
-	uint32_t distance = 0;
-	vl53l0x.get_distance(&distance);
-	if(distance == 0) {
-		// 0 means the distance is too far
-		// Set to infinity
-		distance = 0xFFFF;
+/** A VL53L0X measurement was read, on the sensor thread */
+void on_vl53l0x_range(const vl53l0x_range_t& range) {
+	uint32_t distance = range.distance_mm;
+	if(range.status != VL53L0X_RANGE_VALID || distance >= VL53L0X_RANGING_MAX_DISTANCE_MM) {
+		// No target, set to infinity
+		distance = GATT_DISTANCE_OUT_OF_RANGE;
 	}
-	vl53l0x_service.set_distance((uint16_t) distance);
+	sample_handoff.push(sensor_sample_u32(SENSOR_CHANNEL_VL53L0X_DISTANCE,
+			DistanceFromMillimeter::from_int(distance)));
+	sample_handoff.commit();
 
-#if DEBUG_SENSOR_POLLING
-	printf("VL53L0X:\n");
-	printf("\tdistance: %lu\n", distance);
-#endif
+	vl53l0x_ranging_service.set_range(range, (uint16_t) distance, vl53l0x_ranging.get_profile());
+
+	telemetry_vl53l0x_t record = { distance, range.status, range.signal_rate };
+	telemetry.send(TELEMETRY_RECORD_VL53L0X, record);
+}
+
+/** Raw LSM9DS1 output registers, filled in by the I2C transaction engine */
+static uint8_t lsm9ds1_gyro_raw[6];
+static uint8_t lsm9ds1_accel_raw[6];
+static uint8_t lsm9ds1_mag_raw[6];
+static int lsm9ds1_reads_pending = 0;
+static bool lsm9ds1_read_error = false;
+static uint64_t lsm9ds1_reads_queued_ms = 0;
+
+/** Polls that gave up on a read, see I2C_READ_TIMEOUT_MS */
+static uint32_t i2c_read_timeouts = 0;
+
+/** A read queued at queued_ms should have completed by now */
+static bool i2c_read_timed_out(uint64_t queued_ms) {
+	return rtos::Kernel::get_ms_count() - queued_ms >= I2C_READ_TIMEOUT_MS;
+}
+
+static int16_t raw_to_int16(const uint8_t* raw) {
+	return (int16_t) ((raw[1] << 8) | raw[0]);
+}
+
+/**
+ * Sample rate of the feature windows, on the sensor thread
+ *
+ * The FIFO's rate while streaming, the poll rate of the source otherwise.
+ */
+void update_imu_feature_rate(void) {
+	if(imu_stream_source == NULL) {
+		return;
+	}
+
+	bool icm20602 = (imu_stream_source == &icm20602_stream);
+	uint32_t poll_interval_ms = sensor_scheduler.get_period(icm20602? icm20602_task : lsm9ds1_task);
+	float rate_hz;
+	if(imu_stream_source->is_streaming()) {
+		rate_hz = imu_stream_source->get_odr_hz();
+	} else if(poll_interval_ms != 0) {
+		rate_hz = 1000.0f / poll_interval_ms;
+	} else {
+		return;
+	}
+
+	imu_features.set_source(icm20602? IMU_STREAM_SOURCE_ICM20602 : IMU_STREAM_SOURCE_LSM9DS1,
+			rate_hz);
+}
+
+/** Add an accelerometer sample to the feature window, notify the features once it is full */
+static void add_imu_feature_sample(const float accel_g[3]) {
+	if(!imu_features.add(accel_g)) {
+		return;
+	}
+
+	imu_features_t features;
+	uint32_t start = us_ticker_read();
+	imu_features.compute(features);
+	imu_features_compute_us = us_ticker_read() - start;
+	imu_feature_service.set_features(features);
+}
+
+/** Runs on the sensor thread once all queued LSM9DS1 reads have completed */
+void on_lsm9ds1_read_complete(i2c_transaction_result_t result) {
+	if(lsm9ds1_reads_pending == 0) {
+		// Timed out and given up on
+		return;
+	}
+
+	if(result.status != 0) {
+		lsm9ds1_read_error = true;
+	}
+
+	if(--lsm9ds1_reads_pending != 0 || lsm9ds1_read_error) {
+		return;
+	}
+
+	float reading[3];
+	int16_t raw[3];
+	telemetry_lsm9ds1_t record = telemetry_lsm9ds1_t();
+
+	if(lsm9ds1_stream.is_streaming()) {
+		// Accel/gyro come out of the FIFO while streaming, only the magnetometer was read
+		if(lsm9ds1_stream.has_sample()) {
+			const imu_raw_sample_t& sample = lsm9ds1_stream.get_last_sample();
+			for(int i = 0; i < 3; i++) {
+				reading[i] = lsm9ds1.calcAccel(sample.accel[i]);
+				record.accel[i] = reading[i];
+			}
+			sample_handoff.push(sensor_sample_vec3(SENSOR_CHANNEL_LSM9DS1_ACCEL,
+					reading[0], reading[1], reading[2]));
+			for(int i = 0; i < 3; i++) {
+				reading[i] = lsm9ds1.calcGyro(sample.gyro[i]);
+				record.gyro[i] = reading[i];
+			}
+			sample_handoff.push(sensor_sample_vec3(SENSOR_CHANNEL_LSM9DS1_GYRO,
+					reading[0], reading[1], reading[2]));
+			record.valid_mask |= TELEMETRY_LSM9DS1_ACCEL_VALID | TELEMETRY_LSM9DS1_GYRO_VALID;
+		}
+
+		for(int i = 0; i < 3; i++) {
+			reading[i] = lsm9ds1.calcMag(raw_to_int16(&lsm9ds1_mag_raw[2*i]));
+			record.mag[i] = reading[i];
+		}
+		sample_handoff.push(sensor_sample_vec3(SENSOR_CHANNEL_LSM9DS1_MAG,
+				reading[0], reading[1], reading[2]));
+		sample_handoff.commit();
+
+		record.valid_mask |= TELEMETRY_LSM9DS1_MAG_VALID;
+		telemetry.send(TELEMETRY_RECORD_LSM9DS1, record);
+		return;
+	}
+
+	for(int i = 0; i < 3; i++) {
+		raw[i] = raw_to_int16(&lsm9ds1_accel_raw[2*i]);
+		if(lsm9ds1_calibrated) {
+			raw[i] = fixed::saturating_sub<int16_t>(raw[i], lsm9ds1.aBiasRaw[i]);
+		}
+	}
+	for(int i = 0; i < 3; i++) {
+		reading[i] = lsm9ds1.calcAccel(raw[i]);
+		record.accel[i] = reading[i];
+	}
 
+	sample_handoff.push(sensor_sample_vec3(SENSOR_CHANNEL_LSM9DS1_ACCEL,
+			reading[0], reading[1], reading[2]));
+	if(imu_stream_source == &lsm9ds1_stream) {
+		add_imu_feature_sample(reading);
+	}
+
+	for(int i = 0; i < 3; i++) {
+		raw[i] = raw_to_int16(&lsm9ds1_gyro_raw[2*i]);
+		if(lsm9ds1_calibrated) {
+			raw[i] = fixed::saturating_sub<int16_t>(raw[i], lsm9ds1.gBiasRaw[i]);
+		}
+	}
+	for(int i = 0; i < 3; i++) {
+		reading[i] = lsm9ds1.calcGyro(raw[i]);
+		record.gyro[i] = reading[i];
+	}
+
+	sample_handoff.push(sensor_sample_vec3(SENSOR_CHANNEL_LSM9DS1_GYRO,
+			reading[0], reading[1], reading[2]));
+
+	for(int i = 0; i < 3; i++) {
+		reading[i] = lsm9ds1.calcMag(raw_to_int16(&lsm9ds1_mag_raw[2*i]));
+		record.mag[i] = reading[i];
+	}
+
+	sample_handoff.push(sensor_sample_vec3(SENSOR_CHANNEL_LSM9DS1_MAG,
+			reading[0], reading[1], reading[2]));
+	sample_handoff.commit();
+
+	record.valid_mask = TELEMETRY_LSM9DS1_ACCEL_VALID | TELEMETRY_LSM9DS1_GYRO_VALID |
+			TELEMETRY_LSM9DS1_MAG_VALID;
+	telemetry.send(TELEMETRY_RECORD_LSM9DS1, record);
+}
+
+void poll_lsm9ds1(void) {
 	/** Poll LSM9DS1 */
-	LSM9DS1Service::tri_axis_reading_t reading;
-	lsm9ds1.readAccel();
-	reading.x = lsm9ds1.calcAccel(lsm9ds1.ax);
-	reading.y = lsm9ds1.calcAccel(lsm9ds1.ay);
-	reading.z = lsm9ds1.calcAccel(lsm9ds1.az);
+	if(lsm9ds1_reads_pending != 0) {
+		if(!i2c_read_timed_out(lsm9ds1_reads_queued_ms)) {
+			// Previous reads are still queued behind other bus traffic
+			return;
+		}
+		printf("lsm9ds1: %d reads timed out\r\n", lsm9ds1_reads_pending);
+		i2c_read_timeouts++;
+		lsm9ds1_reads_pending = 0;
+	}
 
-#if DEBUG_SENSOR_POLLING
-	printf("LSM9DS1:\n");
-	printf("\taccel: (%0.2f, %0.2f, %0.2f)\n", reading.x, reading.y, reading.z);
-#endif
+	lsm9ds1_read_error = false;
+	lsm9ds1_reads_queued_ms = rtos::Kernel::get_ms_count();
+
+	// Queue gyro, accel and magnetometer back to back on the bus, the sensor
+	// thread is free to service other sensors until they complete.
+	// Reading the accel/gyro outputs would pop the FIFO while streaming.
+	mbed::Callback<void(i2c_transaction_result_t)> cb(on_lsm9ds1_read_complete);
+	int reads_queued = 1;
+	if(!lsm9ds1_stream.is_streaming()) {
+		reads_queued += 2;
+		lsm9ds1_reads_pending += sensor_i2c_engine.read_registers(LSM9DS1_ACC_GYRO_I2C_ADDR,
+				LSM9DS1_OUT_X_L_G_REG | LSM9DS1_AUTO_INCREMENT, lsm9ds1_gyro_raw,
+				sizeof(lsm9ds1_gyro_raw), &sensor_event_queue, cb);
+		lsm9ds1_reads_pending += sensor_i2c_engine.read_registers(LSM9DS1_ACC_GYRO_I2C_ADDR,
+				LSM9DS1_OUT_X_L_XL_REG | LSM9DS1_AUTO_INCREMENT, lsm9ds1_accel_raw,
+				sizeof(lsm9ds1_accel_raw), &sensor_event_queue, cb);
+	}
+	lsm9ds1_reads_pending += sensor_i2c_engine.read_registers(LSM9DS1_MAG_I2C_ADDR,
+			LSM9DS1_OUT_X_L_M_REG | LSM9DS1_AUTO_INCREMENT, lsm9ds1_mag_raw,
+			sizeof(lsm9ds1_mag_raw), &sensor_event_queue, cb);
 
-	lsm9ds1_service.set_accel_reading(reading);
+	if(lsm9ds1_reads_pending != reads_queued) {
+		// Engine queue is full, results of this poll are discarded
+		lsm9ds1_read_error = true;
+	}
+}
 
-	lsm9ds1.readGyro();
-	reading.x = lsm9ds1.calcGyro(lsm9ds1.gx);
-	reading.y = lsm9ds1.calcGyro(lsm9ds1.gy);
-	reading.z = lsm9ds1.calcGyro(lsm9ds1.gz);
-	lsm9ds1_service.set_gyro_reading(reading);
+/** Raw ICM20602 output registers, filled in by the I2C transaction engine */
+static uint8_t icm20602_raw[ICM20602_SAMPLE_SIZE];
+static bool icm20602_read_pending = false;
+static uint64_t icm20602_read_queued_ms = 0;
 
-	lsm9ds1.readMag();
-	reading.x = lsm9ds1.calcMag(lsm9ds1.mx);
-	reading.y = lsm9ds1.calcMag(lsm9ds1.my);
-	reading.z = lsm9ds1.calcMag(lsm9ds1.mz);
+static void publish_icm20602_sample(const imu_raw_sample_t& sample) {
+	float reading[3];
+	telemetry_icm20602_t record;
 
-#if DEBUG_SENSOR_POLLING
-	printf("\tgyro:  (%0.2f, %0.2f, %0.2f)\n", reading.x, reading.y, reading.z);
-	printf("\tmag:   (%0.2f, %0.2f, %0.2f)\n", reading.x, reading.y, reading.z);
-#endif
+	for(int i = 0; i < 3; i++) {
+		reading[i] = icm20602_stream.accel_to_g(sample.accel[i]);
+		record.accel[i] = reading[i];
+	}
+
+	sample_handoff.push(sensor_sample_vec3(SENSOR_CHANNEL_ICM20602_ACCEL,
+			reading[0], reading[1], reading[2]));
+	if(imu_stream_source == &icm20602_stream && !icm20602_stream.is_streaming()) {
+		// While streaming every FIFO sample goes in through the frames instead
+		add_imu_feature_sample(reading);
+	}
+
+	for(int i = 0; i < 3; i++) {
+		reading[i] = icm20602_stream.gyro_to_dps(sample.gyro[i]);
+		record.gyro[i] = reading[i];
+	}
+
+	sample_handoff.push(sensor_sample_vec3(SENSOR_CHANNEL_ICM20602_GYRO,
+			reading[0], reading[1], reading[2]));
+	sample_handoff.commit();
+
+	telemetry.send(TELEMETRY_RECORD_ICM20602, record);
+}
+
+/** Runs on the sensor thread once the ICM20602 burst read has completed */
+void on_icm20602_read_complete(i2c_transaction_result_t result) {
+	if(!icm20602_read_pending) {
+		// Timed out and given up on
+		return;
+	}
 
-	lsm9ds1_service.set_mag_reading(reading);
+	icm20602_read_pending = false;
+	if(result.status != 0) {
+		return;
+	}
+
+	imu_raw_sample_t sample;
+	ICM20602Stream::parse_sample(icm20602_raw, sample);
+	publish_icm20602_sample(sample);
+}
 
+void poll_icm20602(void) {
 	/** Poll ICM20602 */
-	// TODO - support for ICM20602
-	//icm20602.getAccXvalue();
+	if(icm20602_stream.is_streaming()) {
+		// The FIFO drain already has the latest sample
+		if(icm20602_stream.has_sample()) {
+			publish_icm20602_sample(icm20602_stream.get_last_sample());
+		}
+		return;
+	}
+
+	if(icm20602_read_pending) {
+		if(!i2c_read_timed_out(icm20602_read_queued_ms)) {
+			return;
+		}
+		printf("icm20602: read timed out\r\n");
+		i2c_read_timeouts++;
+	}
 
+	// Accel, temperature and gyro in a single burst
+	icm20602_read_queued_ms = rtos::Kernel::get_ms_count();
+	icm20602_read_pending = sensor_i2c_engine.read_registers(ICM20602_I2C_ADDR,
+			ICM20602Stream::output_register(), icm20602_raw, sizeof(icm20602_raw),
+			&sensor_event_queue, mbed::callback(on_icm20602_read_complete));
+}
+
+/** Drains the streaming IMU's FIFO, runs on the sensor thread */
+void poll_imu_stream(void) {
+	imu_stream_source->poll(imu_stream_service.get_max_frame_size());
+}
+
+/** Hands completed frames to the BLE thread, runs on the sensor thread */
+void on_imu_stream_frame(const imu_stream_frame_t& frame) {
+	imu_stream_service.push_frame(frame);
+	imu_stream_service.commit();
+
+	// Every sample of the frame goes into the features
+	float scale = (float) imu_stream_frame_accel_range_g(frame) / 32768.0f;
+	for(int s = 0; s < imu_stream_frame_sample_count(frame); s++) {
+		imu_raw_sample_t sample = imu_stream_frame_sample(frame, s);
+		float accel_g[3];
+		for(int i = 0; i < 3; i++) {
+			accel_g[i] = sample.accel[i] * scale;
+		}
+		add_imu_feature_sample(accel_g);
+	}
+}
+
+/** Start/stop streaming on the sensor thread */
+void set_imu_streaming(bool enabled, imu_stream_config_t config) {
+	if(imu_stream_source == NULL) {
+		// Neither IMU came up
+		return;
+	}
+
+	if(enabled) {
+		if(!imu_stream_source->is_streaming()) {
+			// Powered and awake until streaming stops
+			sensor_power.acquire();
+		}
+		imu_stream_source->start(config);
+		sensor_scheduler.set_period(imu_stream_task, imu_stream_source->get_poll_interval_ms());
+		sensor_scheduler.set_active(imu_stream_task, true);
+		printf("imu stream: %s started at %u Hz\r\n", imu_stream_source->get_name(),
+				imu_stream_source->get_odr_hz());
+	} else {
+		bool was_streaming = imu_stream_source->is_streaming();
+		sensor_scheduler.set_active(imu_stream_task, false);
+		imu_stream_source->stop();
+		if(was_streaming) {
+			sensor_power.release();
+		}
+		printf("imu stream: stopped (%lu samples, %lu overruns)\r\n",
+				imu_stream_source->get_sample_count(), imu_stream_source->get_overruns());
+	}
 
+	update_imu_feature_rate();
+}
+
+/** Bulk data on the link, BLE thread only */
+bool imu_streaming = false;
+bool log_transfer_active = false;
+
+/**
+ * Short interval and 2M PHY on the connections bulk data flows on (IMU
+ * stream subscribers while streaming, the client of a log download), long
+ * interval with slave latency on the others
+ */
+void update_link_profile(void) {
+	ConnectionTable& connections = ble_process->get_connections();
+	for(int i = 0; i < ConnectionTable::get_capacity(); i++) {
+		const ble_connection_t& connection = connections.at(i);
+		if(!connection.in_use) {
+			continue;
+		}
+
+		bool bulk = (imu_streaming && imu_stream_service.is_subscribed(connection.handle)) ||
+				(log_transfer_active && log_transfer_service.get_client() == connection.handle);
+		ble_process->get_link_tuner().set_profile(connection.handle,
+				bulk? LINK_PROFILE_STREAMING : LINK_PROFILE_ENVIRONMENTAL);
+	}
+}
+
+/** Centrals joining or leaving a running stream change profile too, runs on the BLE event queue */
+void on_link_subscriptions_changed(GattAttribute::Handle_t handle) {
+	update_link_profile();
+}
+
+/** Streaming was enabled/disabled or reconfigured by the client, runs on the BLE event queue */
+void on_imu_stream_control(bool enabled, imu_stream_config_t config) {
+	imu_streaming = enabled;
+	update_link_profile();
+	sensor_event_queue.call(set_imu_streaming, enabled, config);
+}
+
+/** A log download started or ended, runs on the BLE event queue */
+void on_log_transfer_active(bool active) {
+	log_transfer_active = active;
+	update_link_profile();
+}
+
+/** Payload notified by the bulk services, sampled for the link throughput */
+uint32_t get_link_bytes_sent(void) {
+	return imu_stream_service.get_bytes_sent() + log_transfer_service.get_bytes_sent();
+}
+
+void poll_battery(void) {
 	/** Check battery voltage */
-	battery_mon_en = 1;
-	wait_ms(10);
-	float vbat = battery_voltage_in.read() * MAX_VBAT_VOLTAGE * 2.0f;
+	uint32_t delay_ms = battery_monitor.step();
+	if(delay_ms != 0) {
+		// Divider is settling, come back for the sample burst without blocking other sensors
+		sensor_scheduler.run_again_in(battery_task, delay_ms);
+		return;
+	}
 
-#if DEBUG_SENSOR_POLLING
-	printf("Battery Voltage:\n");
-	printf("\tVbat: %.2f V\n", vbat);
-#endif
+	float vbat = battery_monitor.get_voltage();
+
+	telemetry_battery_t record = { vbat };
+	telemetry.send(TELEMETRY_RECORD_BATTERY, record);
+
+	sample_handoff.push(sensor_sample_float(SENSOR_CHANNEL_BATTERY_VOLTAGE, vbat));
+	sample_handoff.commit();
+}
+
+/** Runs on the BLE event queue for every sample handed off by the sensor thread */
+void on_sample_received(const sensor_sample_t& sample) {
+	// The snapshot carries the latest values, the deadbands only apply to the single characteristics
+	sensor_snapshot_service.update(sample);
+	gatt_coalescer.update(sample);
+}
+
+/** Runs on the BLE event queue once all pending samples have been received */
+void on_sample_batch_received(void) {
+	gatt_coalescer.flush();
+}
+
+template<typename reading_t>
+static reading_t to_tri_axis_reading(const sensor_sample_t& sample) {
+	reading_t reading;
+	reading.x = sample.value.vec3[0];
+	reading.y = sample.value.vec3[1];
+	reading.z = sample.value.vec3[2];
+	return reading;
+}
+
+/** Log a sample and write it to its characteristic, runs on the BLE event queue */
+void publish_sample(const sensor_sample_t& sample) {
+	// Log what passed the deadbands, connected or not
+	if(sensor_log != NULL) {
+		sensor_log->append(sample);
+	}
+
+	sensor_broadcast.update(sample);
+
+	// Before the services exist the value is replayed once they are started
+	if(services_started) {
+		write_characteristic(sample);
+	}
+}
+
+/** Write a sample to its characteristic, runs on the BLE event queue */
+void write_characteristic(const sensor_sample_t& sample) {
+	switch(sample.channel) {
+	case SENSOR_CHANNEL_BME680_TEMP:
+		bme680_service.set_temp_c((int16_t) sample.value.i32);
+		break;
+	case SENSOR_CHANNEL_BME680_PRESSURE:
+		bme680_service.set_pressure(sample.value.u32);
+		break;
+	case SENSOR_CHANNEL_BME680_HUMIDITY:
+		bme680_service.set_rel_humidity((uint16_t) sample.value.u32);
+		break;
+	case SENSOR_CHANNEL_BME680_GAS_RESISTANCE:
+		bme680_service.set_gas_resistance(sample.value.u32);
+		break;
+	case SENSOR_CHANNEL_BME680_CO2:
+		bme680_service.set_estimated_co2(sample.value.f);
+		break;
+	case SENSOR_CHANNEL_BME680_BVOC:
+		bme680_service.set_estimated_b_voc(sample.value.f);
+		break;
+	case SENSOR_CHANNEL_BME680_IAQ_SCORE:
+		bme680_service.set_iaq_score((uint16_t) sample.value.u32);
+		break;
+	case SENSOR_CHANNEL_BME680_IAQ_ACCURACY:
+		bme680_service.set_iaq_accuracy((uint8_t) sample.value.u32);
+		break;
+	case SENSOR_CHANNEL_MAX44009_ALS:
+		max44009_service.set_als_reading(sample.value.f);
+		break;
+	case SENSOR_CHANNEL_SI7021_TEMP:
+		si7021_service.set_temp_c((int16_t) sample.value.i32);
+		break;
+	case SENSOR_CHANNEL_SI7021_HUMIDITY:
+		si7021_service.set_rel_humidity((uint16_t) sample.value.u32);
+		break;
+	case SENSOR_CHANNEL_VL53L0X_DISTANCE:
+		vl53l0x_service.set_distance((uint16_t) sample.value.u32);
+		break;
+	case SENSOR_CHANNEL_LSM9DS1_ACCEL:
+		lsm9ds1_service.set_accel_reading(
+				to_tri_axis_reading<LSM9DS1Service::tri_axis_reading_t>(sample));
+		break;
+	case SENSOR_CHANNEL_LSM9DS1_GYRO:
+		lsm9ds1_service.set_gyro_reading(
+				to_tri_axis_reading<LSM9DS1Service::tri_axis_reading_t>(sample));
+		break;
+	case SENSOR_CHANNEL_LSM9DS1_MAG:
+		lsm9ds1_service.set_mag_reading(
+				to_tri_axis_reading<LSM9DS1Service::tri_axis_reading_t>(sample));
+		break;
+	case SENSOR_CHANNEL_ICM20602_ACCEL:
+		icm20602_service.set_accel_reading(
+				to_tri_axis_reading<ICM20602Service::tri_axis_reading_t>(sample));
+		break;
+	case SENSOR_CHANNEL_ICM20602_GYRO:
+		icm20602_service.set_gyro_reading(
+				to_tri_axis_reading<ICM20602Service::tri_axis_reading_t>(sample));
+		break;
+	case SENSOR_CHANNEL_BATTERY_VOLTAGE:
+		battery_voltage_service.set_voltage(sample.value.f);
+		break;
+	default:
+		break;
+	}
+}
+
+void init_gatt_deadbands(void) {
+	sensor_value_t db;
+
+	db.i32 = TEMP_DEADBAND;
+	gatt_coalescer.set_deadband(SENSOR_CHANNEL_BME680_TEMP, db);
+	gatt_coalescer.set_deadband(SENSOR_CHANNEL_SI7021_TEMP, db);
+
+	db.u32 = HUMIDITY_DEADBAND;
+	gatt_coalescer.set_deadband(SENSOR_CHANNEL_BME680_HUMIDITY, db);
+	gatt_coalescer.set_deadband(SENSOR_CHANNEL_SI7021_HUMIDITY, db);
+
+	db.u32 = PRESSURE_DEADBAND;
+	gatt_coalescer.set_deadband(SENSOR_CHANNEL_BME680_PRESSURE, db);
+
+	db.u32 = GAS_RESISTANCE_DEADBAND;
+	gatt_coalescer.set_deadband(SENSOR_CHANNEL_BME680_GAS_RESISTANCE, db);
+
+	db.f = CO2_DEADBAND;
+	gatt_coalescer.set_deadband(SENSOR_CHANNEL_BME680_CO2, db);
+
+	db.f = BVOC_DEADBAND;
+	gatt_coalescer.set_deadband(SENSOR_CHANNEL_BME680_BVOC, db);
+
+	db.u32 = IAQ_SCORE_DEADBAND;
+	gatt_coalescer.set_deadband(SENSOR_CHANNEL_BME680_IAQ_SCORE, db);
+
+	db.f = ALS_DEADBAND;
+	gatt_coalescer.set_deadband(SENSOR_CHANNEL_MAX44009_ALS, db);
+
+	db.u32 = DISTANCE_DEADBAND;
+	gatt_coalescer.set_deadband(SENSOR_CHANNEL_VL53L0X_DISTANCE, db);
+
+	db.vec3[0] = db.vec3[1] = db.vec3[2] = ACCEL_DEADBAND;
+	gatt_coalescer.set_deadband(SENSOR_CHANNEL_LSM9DS1_ACCEL, db);
+	gatt_coalescer.set_deadband(SENSOR_CHANNEL_ICM20602_ACCEL, db);
 
-	battery_voltage_service.set_voltage(vbat);
-	battery_mon_en = 0;
+	db.vec3[0] = db.vec3[1] = db.vec3[2] = GYRO_DEADBAND;
+	gatt_coalescer.set_deadband(SENSOR_CHANNEL_LSM9DS1_GYRO, db);
+	gatt_coalescer.set_deadband(SENSOR_CHANNEL_ICM20602_GYRO, db);
+
+	db.vec3[0] = db.vec3[1] = db.vec3[2] = MAG_DEADBAND;
+	gatt_coalescer.set_deadband(SENSOR_CHANNEL_LSM9DS1_MAG, db);
+
+	db.f = BATTERY_DEADBAND;
+	gatt_coalescer.set_deadband(SENSOR_CHANNEL_BATTERY_VOLTAGE, db);
+}
+
+/** Statistics of the BLE thread's state, runs on the BLE event queue */
+void print_ble_stats(void) {
+	if(ble_process != NULL) {
+		printf("boot: advertising %lu ms after boot\r\n", ble_process->get_boot_to_advertising_ms());
+		ble_process->get_connections().print();
+		ble_process->get_link_tuner().print_stats();
+		ble_process->get_reconnect_advertiser().print_stats();
+	}
+	if(imu_stream_source != NULL) {
+		printf("imu stream: %lu frames sent, %lu dropped, %lu skipped\r\n",
+				imu_stream_service.get_frames_sent(), imu_stream_service.get_frames_dropped(),
+				imu_stream_service.get_frames_skipped());
+		imu_stream_service.print_stats();
+		printf("imu features: %lu notified, %lu dropped\r\n", imu_feature_service.get_updates(),
+				imu_feature_service.get_dropped());
+	}
+	if(vl53l0x_online) {
+		printf("vl53l0x: %lu notified, %lu dropped\r\n", vl53l0x_ranging_service.get_updates(),
+				vl53l0x_ranging_service.get_dropped());
+	}
+	sample_handoff.print_stats();
+	gatt_coalescer.print_stats();
+	sensor_broadcast.print_stats();
+	printf("snapshot: %lu published\r\n", sensor_snapshot_service.get_updates());
+	printf("time sync: %lu syncs, %s\r\n", time_sync_service.get_syncs(),
+			time_sync_service.is_synced()? "synced" : "device time only");
+	if(bond_store.is_attached()) {
+		bond_store.print_stats();
+	}
+	if(sensor_log != NULL) {
+		sensor_log->print_stats();
+		log_transfer_service.print_stats();
+	}
+}
+
+/** Statistics of the sensor thread's state, runs on the sensor event queue */
+void print_sensor_stats(void) {
+	sensor_scheduler.print_stats();
+	sensor_i2c_engine.print_stats();
+	printf("i2c: %lu polled reads timed out\r\n", i2c_read_timeouts);
+	if(imu_stream_source != NULL) {
+		printf("imu stream: %s - %lu samples, %lu overruns\r\n", imu_stream_source->get_name(),
+				imu_stream_source->get_sample_count(), imu_stream_source->get_overruns());
+		printf("imu features: %lu windows (%lu discarded), %lu us per window\r\n",
+				imu_features.get_windows(), imu_features.get_discarded(), imu_features_compute_us);
+	}
+	if(vl53l0x_online) {
+		printf("vl53l0x: %s every %lu ms - %lu measurements, %lu misses, %lu errors\r\n",
+				VL53L0XRanging::get_profile_name(vl53l0x_ranging.get_profile()),
+				vl53l0x_ranging.get_period_ms(), vl53l0x_ranging.get_measurements(),
+				vl53l0x_ranging.get_misses(), vl53l0x_ranging.get_errors());
+	}
+	telemetry.print_stats();
+	sensor_power.print_stats();
+	sensor_interrupts.print_stats();
+
+	// The BLE half follows once this one is out, the lines do not interleave
+	event_queue.call(print_ble_stats);
+}
+
+/**
+ * Print the statistics, from any thread (console 's')
+ *
+ * Each part is printed on the queue of the thread that owns its state.
+ */
+void print_scheduler_stats(void) {
+	sensor_event_queue.call(print_sensor_stats);
+}
+
+/**
+ * Switch binary telemetry on or off, runs on the console thread
+ *
+ * The console UART runs at TELEMETRY_BAUD_RATE while telemetry is on, so
+ * the same key typed at that rate switches it off again.
+ */
+void toggle_telemetry(void) {
+	if(!telemetry.is_enabled()) {
+		printf("telemetry: on at %d baud\r\n", TELEMETRY_BAUD_RATE);
+		console_uart.baud(TELEMETRY_BAUD_RATE);
+		telemetry.set_enabled(true);
+		return;
+	}
+
+	telemetry.set_enabled(false);
+	for(int waited = 0; telemetry_writer.pending() != 0 && waited < TELEMETRY_DRAIN_TIMEOUT_MS; waited++) {
+		rtos::ThisThread::sleep_for(1);
+	}
+	console_uart.baud(MBED_CONF_PLATFORM_STDIO_BAUD_RATE);
+	telemetry.print_stats();
+}
+
+/** Print the trace ring, preceded by the scheduler task names the poll events refer to */
+void dump_trace(void) {
+	for(int i = 0; i < sensor_scheduler.get_task_count(); i++) {
+		printf("trace: label poll %x %s\r\n", i, sensor_scheduler.get_name(i));
+	}
+	trace_dump();
+}
+
+void init_sensor_scheduler(void) {
+	// Offsets stagger the first releases so the sensors do not all start on the same tick
+	bme680_task = sensor_scheduler.add_task("bme680", BME680_POLL_INTERVAL_MS, 0,
+			mbed::callback(poll_bme680), BME680_POLL_INTERVAL_MS);
+	max44009_task = sensor_scheduler.add_task("max44009", MAX44009_POLL_INTERVAL_MS, 0,
+			mbed::callback(poll_max44009), 100);
+	si7021_task = sensor_scheduler.add_task("si7021", SI7021_POLL_INTERVAL_MS, 0,
+			mbed::callback(poll_si7021), 200);
+	vl53l0x_task = sensor_scheduler.add_task("vl53l0x", VL53L0X_POLL_INTERVAL_MS, 0,
+			mbed::callback(poll_vl53l0x), 300);
+	lsm9ds1_task = sensor_scheduler.add_task("lsm9ds1", LSM9DS1_POLL_INTERVAL_MS,
+			LSM9DS1_POLL_DEADLINE_MS, mbed::callback(poll_lsm9ds1), 0);
+	battery_task = sensor_scheduler.add_task("battery", BATTERY_POLL_INTERVAL_MS, 0,
+			mbed::callback(poll_battery), 400);
+
+	if(icm20602_online) {
+		icm20602_task = sensor_scheduler.add_task("icm20602", ICM20602_POLL_INTERVAL_MS,
+				ICM20602_POLL_DEADLINE_MS, mbed::callback(poll_icm20602), ICM20602_POLL_INTERVAL_MS / 2);
+	}
+
+	// Only runs while a client is subscribed to the IMU stream
+	if(imu_stream_source != NULL) {
+		imu_stream_source->set_frame_sink(mbed::callback(on_imu_stream_frame));
+		imu_stream_task = sensor_scheduler.add_task("imu stream", LSM9DS1_POLL_INTERVAL_MS, 0,
+				mbed::callback(poll_imu_stream));
+		sensor_scheduler.set_active(imu_stream_task, false);
+	}
 
 #if DEBUG_SENSOR_POLLING
-	printf("\n");
+	sensor_scheduler.add_task("stats", SCHEDULER_STATS_INTERVAL_MS, 0,
+			mbed::callback(print_scheduler_stats), SCHEDULER_STATS_INTERVAL_MS);
 #endif
+}
+
+/** Charge of a VL53L0X measurement at the current timing budget */
+static uint32_t vl53l0x_ranging_nc(void) {
+	return (uint32_t) (((uint64_t) VL53L0X_RANGING_UA * vl53l0x_ranging.get_timing_budget_us()) / 1000);
+}
+
+/** Describe the sensors' power states to the power manager, after init_sensor_scheduler() */
+void init_sensor_power(void) {
+	sensor_power_domain_t domain;
+	domain.power_up_ms = SENSOR_POWER_UP_MS;
+	domain.reinit_ms = SENSOR_REINIT_ESTIMATE_MS;
+	domain.settle_ms = SENSOR_SETTLE_MS;
+	domain.on_ua = SENSOR_DOMAIN_ON_UA;
+	domain.off_ua = SENSOR_DOMAIN_OFF_UA;
+	sensor_power.set_domain(domain, mbed::callback(reinit_sensors));
+
+	// BSEC drives the BME680 on its own and would lose its state, it pins the domain on
+	sensor_power.add_task(bme680_task, !bme680_online);
+	sensor_power.add_task(max44009_task, true);
+	sensor_power.add_task(si7021_task, true, SI7021_MEASUREMENT_NC);
+	sensor_power.add_task(vl53l0x_task, true, vl53l0x_ranging_nc());
+	sensor_power.add_task(lsm9ds1_task, true);
+	sensor_power.add_task(icm20602_task, true);
+	sensor_power.add_task(imu_stream_task, false);
+
+	if(lsm9ds1_calibrated) {
+		sensor_power.add_device("lsm9ds1", lsm9ds1_task, mbed::callback(set_lsm9ds1_low_power),
+				LSM9DS1_GYRO_WAKE_MS, LSM9DS1_ACTIVE_UA, LSM9DS1_LOW_POWER_UA);
+	}
+	if(icm20602_online) {
+		sensor_power.add_device("icm20602", icm20602_task, mbed::callback(set_icm20602_low_power),
+				ICM20602_WAKE_MS, ICM20602_ACTIVE_UA, ICM20602_LOW_POWER_UA);
+	}
+
+	sensor_scheduler.set_idle_handler(&sensor_power);
+}
+
+/**
+ * Apply the poll periods of the current profile and sensing mode, on the sensor thread
+ *
+ * While event-driven sensing is on, the IMUs drop to the keep-alive interval
+ * unless motion was seen within EVENT_MOTION_HOLD_MS, and the MAX44009 only
+ * runs on its interrupt and the keep-alive. Sensors without a wired interrupt
+ * keep their normal periods.
+ */
+void apply_poll_periods(void) {
+	bool low_power = low_power_profile;
+	bool motion_idle = sensor_interrupts.is_enabled() && sensor_interrupts.has_motion_line() &&
+			!motion_active;
+	bool light_idle = sensor_interrupts.is_enabled() && sensor_interrupts.has_light_line();
+
+	uint32_t lsm9ds1_ms = LSM9DS1_POLL_INTERVAL_MS;
+	uint32_t icm20602_ms = ICM20602_POLL_INTERVAL_MS;
+	if(motion_idle) {
+		lsm9ds1_ms = EVENT_KEEPALIVE_INTERVAL_MS;
+		icm20602_ms = EVENT_KEEPALIVE_INTERVAL_MS;
+	} else if(low_power) {
+		lsm9ds1_ms = LOW_POWER_IMU_POLL_INTERVAL_MS;
+		icm20602_ms = LOW_POWER_IMU_POLL_INTERVAL_MS;
+	}
+
+	sensor_scheduler.set_period(lsm9ds1_task, lsm9ds1_ms);
+	sensor_scheduler.set_period(icm20602_task, icm20602_ms);
+	sensor_scheduler.set_period(max44009_task,
+			light_idle? EVENT_KEEPALIVE_INTERVAL_MS : MAX44009_POLL_INTERVAL_MS);
+
+	// The part ranges on the poll period, each poll picks up the measurement just finished
+	uint32_t vl53l0x_ms = low_power? LOW_POWER_VL53L0X_POLL_INTERVAL_MS : VL53L0X_POLL_INTERVAL_MS;
+	if(vl53l0x_ranging.get_profile() == VL53L0X_PROFILE_HIGH_SPEED) {
+		vl53l0x_ms = VL53L0X_HIGH_SPEED_POLL_INTERVAL_MS;
+	}
+	sensor_scheduler.set_period(vl53l0x_task, vl53l0x_ms);
+	if(vl53l0x_online && vl53l0x_ranging.get_period_ms() != vl53l0x_ms) {
+		vl53l0x_ranging.start(vl53l0x_ms);
+	}
 
+	update_imu_feature_rate();
 }
 
+/**
+ * Switch between the default poll intervals and the low power profile, on the sensor thread
+ *
+ * The low power profile polls the IMUs and the VL53L0X less often so they sleep in between,
+ * and lets the whole domain be switched off when nothing pins it. The power
+ * statistics restart so the estimate covers a single profile.
+ */
+void set_low_power_profile(bool enabled) {
+	apply_poll_periods();
+	sensor_power.set_domain_cycling(enabled);
+	sensor_power.reset_stats();
+	printf("power: low power profile %s\r\n", enabled? "on" : "off");
+}
+
+/** Runs on the console thread */
+void toggle_low_power_profile(void) {
+	bool enabled = !low_power_profile.load();
+	low_power_profile = enabled;
+	sensor_event_queue.call(set_low_power_profile, enabled);
+}
+
+/**
+ * Switch the VL53L0X ranging profile, on the sensor thread
+ *
+ * The high speed profile ranges at VL53L0X_HIGH_SPEED_POLL_INTERVAL_MS
+ * whatever the power profile, the others on the usual poll period.
+ */
+void set_vl53l0x_profile(int profile) {
+	if(!vl53l0x_online) {
+		return;
+	}
+	if(!vl53l0x_ranging.configure((vl53l0x_profile_t) profile)) {
+		printf("vl53l0x: failed to apply the %s profile\r\n",
+				VL53L0XRanging::get_profile_name((vl53l0x_profile_t) profile));
+		return;
+	}
+	sensor_power.set_run_charge(vl53l0x_task, vl53l0x_ranging_nc());
+	apply_poll_periods();
+	printf("vl53l0x: %s profile, %lu us timing budget, every %lu ms\r\n",
+			VL53L0XRanging::get_profile_name(vl53l0x_ranging.get_profile()),
+			vl53l0x_ranging.get_timing_budget_us(), vl53l0x_ranging.get_period_ms());
+}
+
+/** Runs on the console thread */
+void cycle_vl53l0x_profile(void) {
+	int profile = (vl53l0x_profile.load() + 1) % VL53L0X_PROFILE_COUNT;
+	vl53l0x_profile = profile;
+	sensor_event_queue.call(set_vl53l0x_profile, profile);
+}
+
+/** The motion hold expired, back to the keep-alive poll (sensor thread) */
+void end_motion(void) {
+	motion_hold_event = 0;
+	motion_active = false;
+	apply_poll_periods();
+}
+
+/** A sensor interrupt fired, on the sensor thread (deferred out of the ISR by SensorInterrupts) */
+void on_sensor_interrupt(sensor_interrupt_t source) {
+	if(source == SENSOR_INTERRUPT_LIGHT) {
+		// Fresh reading, which also moves the lux window
+		sensor_scheduler.trigger(max44009_task);
+		return;
+	}
+
+	// Every interrupt extends the hold
+	if(motion_hold_event != 0) {
+		sensor_event_queue.cancel(motion_hold_event);
+	}
+	motion_hold_event = sensor_event_queue.call_in(EVENT_MOTION_HOLD_MS, end_motion);
+
+	if(!motion_active) {
+		motion_active = true;
+		apply_poll_periods();
+		sensor_scheduler.trigger(lsm9ds1_task);
+		sensor_scheduler.trigger(icm20602_task);
+	}
+}
+
+/**
+ * Switch event-driven sensing on or off, on the sensor thread
+ *
+ * The sensors whose interrupt is wired pin the power domain on while it is on,
+ * a sensor that is switched off cannot raise one.
+ */
+void set_event_driven(bool enabled) {
+	if(!sensor_interrupts.has_motion_line() && !sensor_interrupts.has_light_line()) {
+		printf("interrupts: no sensor interrupt is wired (mbed_app.json), polling\r\n");
+		return;
+	}
+
+	if(enabled) {
+		// Wake-on-motion needs the accelerometer even if the power manager put the part to sleep
+		if(sensor_interrupts.has_icm20602_line()) {
+			icm20602_stream.set_sleep(false);
+		}
+		sensor_interrupts.enable(EVENT_MOTION_THRESHOLD_MG, (uint8_t) lsm9ds1.settings.accel.scale);
+	} else {
+		sensor_interrupts.disable();
+	}
+
+	bool motion_pinned = enabled && sensor_interrupts.has_motion_line();
+	sensor_power.set_power_cycle_ok(lsm9ds1_task, !motion_pinned);
+	sensor_power.set_power_cycle_ok(icm20602_task, !motion_pinned);
+	sensor_power.set_power_cycle_ok(max44009_task, !(enabled && sensor_interrupts.has_light_line()));
+
+	if(motion_hold_event != 0) {
+		sensor_event_queue.cancel(motion_hold_event);
+		motion_hold_event = 0;
+	}
+	motion_active = false;
+	apply_poll_periods();
+	sensor_power.reset_stats();
+
+	// A first reading centers the lux window
+	if(enabled) {
+		sensor_scheduler.trigger(max44009_task);
+	}
+
+	printf("interrupts: event-driven sensing %s\r\n", enabled? "on" : "off");
+}
+
+/** Attach the interrupt lines wired in mbed_app.json, sensors that did not come up are left out */
+void init_sensor_interrupts(void) {
+	sensor_interrupt_pins_t pins;
+	pins.icm20602 = icm20602_online? MBED_CONF_APP_ICM20602_INT_PIN : NC;
+	pins.lsm9ds1 = lsm9ds1_calibrated? MBED_CONF_APP_LSM9DS1_INT_PIN : NC;
+	pins.max44009 = MBED_CONF_APP_MAX44009_INT_PIN;
+	sensor_interrupts.init(pins, mbed::callback(on_sensor_interrupt));
+}
+
+/** Runs on the console thread */
+void toggle_event_driven(void) {
+	bool enabled = !event_driven.load();
+	event_driven = enabled;
+	sensor_event_queue.call(set_event_driven, enabled);
+}
+
+/** Runs on the console thread */
+void toggle_sensor_broadcast(void) {
+	bool enabled = !broadcast_enabled.load();
+	broadcast_enabled = enabled;
+	event_queue.call(mbed::callback(&sensor_broadcast, &SensorBroadcast::set_enabled), enabled);
+}
+
+#if DSP_BENCHMARK_COMMAND
+/** Time the feature kernels against their reference versions, runs on the console thread */
+void run_dsp_benchmark(void) {
+	imu_dsp_benchmark_result_t result;
+	bool ok = imu_dsp_benchmark(IMU_FEATURES_WINDOW_SIZE, DSP_BENCHMARK_ITERATIONS, us_ticker_read,
+			result);
+	imu_dsp_benchmark_print(result);
+	printf("dsp: %s\r\n", ok? "results match the reference" : "results differ from the reference");
+}
+#endif
+
 void start_advertising(void) {
 	//TODO - clear the bonding credentials storage
 	printf("ble: pairing button pressed\n");
 	if(ble_process->is_connected()) {
+		// Every central, the disconnect handler restarts advertising
 		ble_process->disconnect();
-		// Disconnect handler will start advertising
 	}
 }
 
@@ -323,14 +1572,55 @@ void pb_long_press_handler(ep::ButtonIn* btn) {
 
 void sensor_poll_main(void) {
 
-	while(true) {
-		rtos::ThisThread::sleep_for(POLL_INTERVAL_MS);
-		poll_sensors();
+	if(!init_graph.run(boot_sensors, mbed::callback(init_sensors))) {
+		printf("sensors: not every sensor came up\r\n");
+	}
+
+	init_sensor_scheduler();
+	init_sensor_power();
+	init_sensor_interrupts();
+	imu_features.init();
+	apply_poll_periods();
+	if(low_power_profile) {
+		set_low_power_profile(true);
 	}
+	if(event_driven) {
+		set_event_driven(true);
+	}
+
+	// Each sensor is polled on its own period from here on
+	sensor_scheduler.run_forever();
 
 }
 
-bool create_filesystem()
+/**
+ * Check whether the push button is held at boot
+ *
+ * Only costs a pin read when the button is not pressed.
+ */
+bool filesystem_erase_requested(void)
+{
+	mbed::DigitalIn button(PIN_NAME_PUSH_BUTTON);
+
+	if(button.read() != PUSH_BUTTON_PRESSED_LEVEL) {
+		return false;
+	}
+
+	printf("filesystem: keep the button pressed to erase the filesystem...\r\n");
+
+	uint64_t start = rtos::Kernel::get_ms_count();
+	while((rtos::Kernel::get_ms_count() - start) < FILESYSTEM_ERASE_HOLD_MS) {
+		if(button.read() != PUSH_BUTTON_PRESSED_LEVEL) {
+			printf("filesystem: released, keeping the filesystem\r\n");
+			return false;
+		}
+		rtos::ThisThread::sleep_for(10);
+	}
+
+	return true;
+}
+
+bool create_filesystem(bool erase)
 {
 
 	printf("filesystem - initializing...\n");
@@ -339,42 +1629,99 @@ bool create_filesystem()
 
 	/** Slice it so we only use part of it for the filesystem */
 	static SlicingBlockDevice sbd(BlockDevice::get_default_instance(),
-			0, (128*1024));
+			0, FILESYSTEM_SIZE);
 	fsbd = &sbd;
-    BlockDevice& bd = *fsbd;
 
-    int err = bd.init();
+    static LittleFileSystem fs("fs");
 
-    if (err) {
-    	printf("filesystem: failed to initialize block device\r\n");
-        return false;
+    filesystem_boot_stats_t stats;
+    bool ok = filesystem_boot(fs, sbd, erase, stats);
+    if(ok) {
+    	filesystem = &fs;
     }
 
-#if ERASE_BLOCK_DEVICE
+    printf("filesystem: %s in %lu ms (init %lu, erase %lu, mount %lu, format %lu)\r\n",
+    		filesystem_boot_result_name(stats.result), stats.total_ms, stats.init_ms,
+			stats.erase_ms, stats.mount_ms, stats.format_ms);
 
-    err = bd.erase(0, bd.size());
-    if(err) {
-    	printf("filesystem: could not erase block device\r\n");
-    	return false;
-    }
-#endif
+    return ok;
+}
 
-    static LittleFileSystem fs("fs");
+/** Runs on the BLE event queue */
+void attach_sensor_log(SensorLog* log) {
+	sensor_log = log;
+	log_transfer_service.set_log(*log);
+}
 
-    err = fs.mount(&bd);
+bool init_sensor_log(void) {
+	/** Raw slice right after the filesystem, the log manages its own layout */
+	static SlicingBlockDevice log_bd(BlockDevice::get_default_instance(),
+			FILESYSTEM_SIZE, FILESYSTEM_SIZE + SENSOR_LOG_SIZE);
+	static SensorLog log(log_bd);
 
-    if (err) {
-        /* Reformat if we can't mount the filesystem */
-        printf("filesystem: no filesystem found, formatting...\r\n");
+	if(log.init() != 0) {
+		return false;
+	}
 
-        err = fs.reformat(&bd);
+	log.set_min_interval(SENSOR_CHANNEL_LSM9DS1_ACCEL, SENSOR_LOG_IMU_INTERVAL_MS);
+	log.set_min_interval(SENSOR_CHANNEL_LSM9DS1_GYRO, SENSOR_LOG_IMU_INTERVAL_MS);
+	log.set_min_interval(SENSOR_CHANNEL_LSM9DS1_MAG, SENSOR_LOG_IMU_INTERVAL_MS);
+	log.set_min_interval(SENSOR_CHANNEL_ICM20602_ACCEL, SENSOR_LOG_IMU_INTERVAL_MS);
+	log.set_min_interval(SENSOR_CHANNEL_ICM20602_GYRO, SENSOR_LOG_IMU_INTERVAL_MS);
 
-        if (err) {
-            return false;
-        }
-    }
+	// The log is appended to from the BLE thread, hand it over there
+	event_queue.call(attach_sensor_log, &log);
+	return true;
+}
+
+/** Filesystem boot step, on the boot thread */
+bool init_filesystem(void) {
+	/* if filesystem creation fails or there is no filesystem the security manager
+	 * will fallback to storing the security database in memory */
+	bool ok = create_filesystem(filesystem_erase_requested());
+	if(!ok) {
+		printf("filesystem: initialization failed!\r\n");
+	} else {
+		printf("filesystem: initialization succeeded!\r\n");
+	}
+
+	status_service.set_ready(STATUS_COMPONENT_FILESYSTEM, ok);
+	return ok;
+}
+
+/** Sensor log boot step, on the boot thread after the filesystem (same flash device) */
+bool init_sensor_log_step(void) {
+	bool ok = init_sensor_log();
+	if(!ok) {
+		printf("sensor log: initialization failed, samples will not be logged\r\n");
+	}
+
+	status_service.set_ready(STATUS_COMPONENT_SENSOR_LOG, ok);
+	return ok;
+}
+
+/** The filesystem step is done, runs on the BLE event queue */
+void on_filesystem_ready(bool ok) {
+	// The bond store loads the database, then the security manager can open it
+	ok = ok && bond_store.attach(*filesystem, bond_store_dir, legacy_pairing_file_name) == 0;
+	ble_process->storage_ready(ok);
+}
+
+/** Storage bring-up, overlapping with the BLE stack and the sensors */
+void boot_main(void) {
+	bool fs_ok = init_graph.run(boot_filesystem, mbed::callback(init_filesystem));
+	event_queue.call(on_filesystem_ready, fs_ok);
+	init_graph.run(boot_sensor_log, mbed::callback(init_sensor_log_step));
+
+	if(!init_graph.wait_all(BOOT_TIMELINE_TIMEOUT_MS)) {
+		printf("boot: not every step completed\r\n");
+	}
+	init_graph.print_timeline();
+}
 
-    return true;
+void on_att_mtu_change(uint16_t att_mtu) {
+	imu_stream_service.set_att_mtu(att_mtu);
+	log_transfer_service.set_att_mtu(att_mtu);
 }
 
 void blink_led(void) {
@@ -388,26 +1735,56 @@ void on_ble_connect(void) {
 	led_event.call();
 }
 
+/** A central disconnected, the others keep their stream and transfer */
+void on_ble_connection_closed(ble::connection_handle_t handle) {
+	imu_stream_service.on_disconnect(handle);
+	log_transfer_service.on_disconnect(handle);
+}
+
+/** The last central disconnected */
 void on_ble_disconnect(void) {
+	imu_stream_service.stop_streaming();
+	log_transfer_service.stop_transfer();
+
 	// Update the period of the event
 	led_event.cancel();
 	led_event.period(LED_BLINK_SLOW_MS);
 	led_event.call();
 }
 
+/** Register a console command, a full table is a build configuration error */
+void add_console_command(char key, const char* help, mbed::Callback<void()> cb) {
+	bool added = console.add_command(key, help, cb);
+	if(!added) {
+		printf("console: no room for '%c', raise SERIAL_CONSOLE_MAX_COMMANDS\r\n", key);
+	}
+	MBED_ASSERT(added);
+}
+
 int main() {
+	trace_init();
 	printf("agora: BLE application begin\r\n");
     BLE &ble_interface = BLE::Instance();
 
-    /* if filesystem creation fails or there is no filesystem the security manager
-     * will fallback to storing the security database in memory */
-    if (!create_filesystem()) {
-        printf("filesystem: initialization failed!\r\n");
-    } else {
-    	printf("filesystem: initialization succeeded!\r\n");
-    }
-
-    init_sensors();
+    /*
+     * BLE comes up right away, storage and sensors in parallel on their own threads:
+     *
+     *   ble -> advertising, services ------(security manager after the filesystem)
+     *   filesystem -> sensor log                                      (boot thread)
+     *   sensors -> scheduler                                          (sensor thread)
+     *
+     * Until a component is up its services report it as not ready (StatusService).
+     */
+    boot_ble = init_graph.add_step("ble");
+    boot_filesystem = init_graph.add_step("filesystem");
+    boot_sensor_log = init_graph.add_step("sensor log", InitGraph::after(boot_filesystem));
+    boot_sensors = init_graph.add_step("sensors");
+
+    init_gatt_deadbands();
+
+    // Attach LED to BLE service
+    led_service.bind(&board_led);
+    led_service.set_led_status(0);
 
     BLEProcess main_ble_process(event_queue, ble_interface);
     ble_process = &main_ble_process;
@@ -415,19 +1792,48 @@ int main() {
     ble_process->on_init(mbed::callback(start_services));
     ble_process->on_connect_event().attach(on_ble_connect);
     ble_process->on_disconnect_event().attach(on_ble_disconnect);
+    ble_process->on_connection_closed().attach(on_ble_connection_closed);
+    ble_process->on_att_mtu_change(mbed::callback(on_att_mtu_change));
+    ble_process->defer_security_until_storage();
+    ble_process->get_link_tuner().set_bytes_source(mbed::callback(get_link_bytes_sent));
+    imu_stream_service.on_stream_control(mbed::callback(on_imu_stream_control));
+    log_transfer_service.on_transfer_active(mbed::callback(on_log_transfer_active));
+    ble_process->get_connections().on_subscriptions_changed().attach(
+    		mbed::callback(on_link_subscriptions_changed));
+    sensor_broadcast.set_enabled(SENSOR_BROADCAST_AT_BOOT);
 
     // bind the event queue to the ble interface, initialize the interface
     // and start advertising
+    init_graph.begin(boot_ble);
     ble_process->start(pairing_file_name);
 
+    rtos::Thread boot_thread(osPriorityNormal, BOOT_THREAD_STACK_SIZE, NULL, "boot");
+    boot_thread.start(mbed::callback(boot_main));
+
     // Attach a long press callback to the backside reset button -- starts repairing
     push_button_in.attach_long_press_callback(mbed::callback(pb_long_press_handler));
 
+    // Start the I2C transaction engine used for non-blocking sensor reads
+    sensor_i2c_engine.start();
+
     // Spin off the sensor polling thread
     // need this to be separate from BLE processing since BLE requires higher priority processing
-    rtos::Thread sensor_thread(osPriorityBelowNormal);
+    rtos::Thread sensor_thread(osPriorityBelowNormal, OS_STACK_SIZE, NULL, "sensor");
     sensor_thread.start(mbed::callback(sensor_poll_main));
 
+    add_console_command('d', "dump the trace", mbed::callback(dump_trace));
+    add_console_command('c', "clear the trace", mbed::callback(trace_clear));
+    add_console_command('s', "print statistics", mbed::callback(print_scheduler_stats));
+    add_console_command('t', "binary sensor telemetry on/off", mbed::callback(toggle_telemetry));
+    add_console_command('p', "low power profile on/off", mbed::callback(toggle_low_power_profile));
+    add_console_command('b', "sensor broadcast on/off", mbed::callback(toggle_sensor_broadcast));
+#if DSP_BENCHMARK_COMMAND
+    add_console_command('f', "DSP benchmark", mbed::callback(run_dsp_benchmark));
+#endif
+    add_console_command('i', "event-driven sensing on/off", mbed::callback(toggle_event_driven));
+    add_console_command('r', "VL53L0X ranging profile", mbed::callback(cycle_vl53l0x_profile));
+    console.start();
+
     // Until Bluetooth is connected, blink slowly
     led_event.period(LED_BLINK_SLOW_MS);
     led_event.call();
@@ -0,0 +1,124 @@
+/*
+ * mbed_i2c_bus.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef MBED_I2C_BUS_H_
+#define MBED_I2C_BUS_H_
+
+#include "drivers/I2C.h"
+#include "platform/NonCopyable.h"
+#include "rtos/EventFlags.h"
+
+#include "i2c_bus.h"
+
+/**
+ * I2CBus implementation on top of mbed::I2C
+ *
+ * When the target supports asynchronous I2C the transfer is handed off
+ * to the peripheral (EasyDMA on the nRF52) and the calling thread sleeps
+ * until the completion interrupt fires. Otherwise it falls back to the
+ * blocking write/read API.
+ *
+ * The bus is shared with the blocking sensor drivers, which serialize
+ * through the same mbed::I2C lock.
+ *
+ * An asynchronous transfer that has not completed within a few times its
+ * duration at the bus clock (eg: a slave holding SCL low) is aborted and
+ * fails with I2C_BUS_TIMEOUT instead of blocking the engine forever.
+ */
+class MbedI2CBus : public I2CBus, private mbed::NonCopyable<MbedI2CBus> {
+public:
+
+	MbedI2CBus(mbed::I2C& i2c) : i2c(i2c), flags(), event(0),
+			frequency_hz(DEFAULT_FREQUENCY_HZ) {
+	}
+
+	/** Set the bus clock, use instead of mbed::I2C::frequency() so the timeouts follow it */
+	void frequency(int hz) {
+		i2c.frequency(hz);
+		frequency_hz = hz;
+	}
+
+	virtual void lock(void) {
+		i2c.lock();
+	}
+
+	virtual void unlock(void) {
+		i2c.unlock();
+	}
+
+	virtual int transfer(int address, const uint8_t* tx, size_t tx_len,
+			uint8_t* rx, size_t rx_len) {
+#if DEVICE_I2C_ASYNCH
+		flags.clear(TRANSFER_DONE_FLAG);
+		int err = i2c.transfer(address, (const char*) tx, (int) tx_len, (char*) rx, (int) rx_len,
+				mbed::callback(this, &MbedI2CBus::on_transfer_event), I2C_EVENT_ALL, false);
+		if(err) {
+			return -1;
+		}
+
+		uint32_t result = flags.wait_any(TRANSFER_DONE_FLAG, transfer_timeout_ms(tx_len + rx_len));
+		if(result & osFlagsError) {
+			// Frees the peripheral, a late completion only sets the flag the next transfer clears
+			i2c.abort_transfer();
+			return I2C_BUS_TIMEOUT;
+		}
+
+		return (event & I2C_EVENT_TRANSFER_COMPLETE)? 0 : -1;
+#else
+		if(tx_len != 0) {
+			// Keep the bus with a repeated start if a read follows
+			if(i2c.write(address, (const char*) tx, (int) tx_len, (rx_len != 0))) {
+				return -1;
+			}
+		}
+
+		if(rx_len != 0) {
+			if(i2c.read(address, (char*) rx, (int) rx_len)) {
+				return -1;
+			}
+		}
+
+		return 0;
+#endif
+	}
+
+private:
+
+#if DEVICE_I2C_ASYNCH
+	/** Longest a transfer of len data bytes may take, with the address bytes of a repeated start */
+	uint32_t transfer_timeout_ms(size_t len) const {
+		// 9 clocks per byte, microseconds rounded up
+		uint32_t bits = (uint32_t) (len + 2) * 9;
+		uint32_t duration_us = (uint32_t) (((uint64_t) bits * 1000000 + frequency_hz - 1) / frequency_hz);
+		return (duration_us * TIMEOUT_FACTOR + 999) / 1000 + TIMEOUT_SLACK_MS;
+	}
+
+	/** Called from interrupt context when the asynchronous transfer ends */
+	void on_transfer_event(int evt) {
+		event = evt;
+		flags.set(TRANSFER_DONE_FLAG);
+	}
+#endif
+
+	static const uint32_t TRANSFER_DONE_FLAG = (1 << 0);
+
+	/** mbed::I2C's clock until frequency() is called */
+	static const int DEFAULT_FREQUENCY_HZ = 100000;
+
+	/** Timeout in multiples of the transfer's duration, covers clock stretching */
+	static const uint32_t TIMEOUT_FACTOR = 4;
+
+	/** Added to every timeout, covers the interrupt latency and the tick resolution */
+	static const uint32_t TIMEOUT_SLACK_MS = 10;
+
+	mbed::I2C& i2c;
+	rtos::EventFlags flags;
+	volatile int event;
+	int frequency_hz;
+
+};
+
+#endif /* MBED_I2C_BUS_H_ */
@@ -0,0 +1,175 @@
+/*
+ * reconnect_advertiser.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "reconnect_advertiser.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ble/gap/AdvertisingParameters.h"
+#include "rtos/Kernel.h"
+
+ReconnectAdvertiser::ReconnectAdvertiser(events::EventQueue& queue, BLE& ble) :
+	queue(queue), ble(ble), burst_end_cb(), whitelist_addrs(), whitelist(), burst_event(0),
+	bursts(0), burst_connections(0), measuring(false), disconnect_ms(0), measured_handle(0),
+	measured_handle_valid(false), connect_latency_ms(0), connect_stats(), encrypted_stats() {
+	whitelist.addresses = whitelist_addrs;
+	whitelist.size = 0;
+	whitelist.capacity = RECONNECT_WHITELIST_CAPACITY;
+}
+
+ReconnectAdvertiser::~ReconnectAdvertiser() {
+	if(burst_event != 0) {
+		queue.cancel(burst_event);
+	}
+}
+
+void ReconnectAdvertiser::set_whitelist(const Gap::Whitelist_t& bonded) {
+	whitelist.size = (bonded.size < RECONNECT_WHITELIST_CAPACITY)? bonded.size : RECONNECT_WHITELIST_CAPACITY;
+	memcpy(whitelist_addrs, bonded.addresses, whitelist.size * sizeof(whitelist_addrs[0]));
+}
+
+bool ReconnectAdvertiser::set_default_parameters(void) {
+	stop_advertising();
+
+	ble_error_t error = ble.gap().setAdvertisingParameters(ble::LEGACY_ADVERTISING_HANDLE,
+			ble::AdvertisingParameters());
+	if(error) {
+		printf("reconnect: setting the advertising parameters failed - 0x%X\r\n", error);
+		return false;
+	}
+	return true;
+}
+
+bool ReconnectAdvertiser::on_bonded_disconnect(void) {
+	measuring = true;
+	disconnect_ms = rtos::Kernel::get_ms_count();
+	measured_handle_valid = false;
+
+	if(whitelist.size == 0) {
+		return false;
+	}
+
+	Gap& gap = ble.gap();
+	stop_advertising();
+
+	// The controller's whitelist cannot change while a filtering set is running
+	ble_error_t error = gap.setWhitelist(whitelist);
+	if(!error) {
+		error = gap.setAdvertisingParameters(ble::LEGACY_ADVERTISING_HANDLE,
+				ble::AdvertisingParameters(ble::advertising_type_t::CONNECTABLE_UNDIRECTED,
+						ble::adv_interval_t(RECONNECT_BURST_INTERVAL),
+						ble::adv_interval_t(RECONNECT_BURST_INTERVAL))
+				.setFilter(ble::advertising_filter_policy_t::FILTER_CONNECTION_REQUESTS));
+	}
+	if(error) {
+		printf("reconnect: starting the burst failed - 0x%X\r\n", error);
+		set_default_parameters();
+		return false;
+	}
+
+	if(burst_event != 0) {
+		queue.cancel(burst_event);
+	}
+	burst_event = queue.call_in(RECONNECT_BURST_MS, this, &ReconnectAdvertiser::on_burst_timeout);
+	bursts++;
+	printf("reconnect: %d bonded central%s whitelisted for %d ms\r\n", whitelist.size,
+			(whitelist.size == 1)? "" : "s", RECONNECT_BURST_MS);
+	return true;
+}
+
+void ReconnectAdvertiser::on_connect(ble::connection_handle_t handle) {
+	if(measuring && !measured_handle_valid) {
+		measured_handle = handle;
+		measured_handle_valid = true;
+		connect_latency_ms = (uint32_t) (rtos::Kernel::get_ms_count() - disconnect_ms);
+	}
+
+	if(is_bursting()) {
+		// Only whitelisted centrals get through, the burst did its job
+		burst_connections++;
+		end_burst();
+	}
+}
+
+void ReconnectAdvertiser::on_disconnect(ble::connection_handle_t handle) {
+	if(measured_handle_valid && handle == measured_handle) {
+		// Left before encrypting, wait for the next one
+		measured_handle_valid = false;
+	}
+}
+
+void ReconnectAdvertiser::on_encrypted(ble::connection_handle_t handle, bool bonded) {
+	if(!measured_handle_valid || handle != measured_handle) {
+		return;
+	}
+
+	measured_handle_valid = false;
+	if(!bonded) {
+		// A central pairing from scratch, not the one that left
+		return;
+	}
+
+	measuring = false;
+	uint32_t encrypted_latency_ms = (uint32_t) (rtos::Kernel::get_ms_count() - disconnect_ms);
+	record(connect_stats, connect_latency_ms);
+	record(encrypted_stats, encrypted_latency_ms);
+	printf("reconnect: %u back after %lu ms, encrypted after %lu ms\r\n", handle,
+			(unsigned long) connect_latency_ms, (unsigned long) encrypted_latency_ms);
+}
+
+void ReconnectAdvertiser::print_stats(void) {
+	printf("reconnect: %d bonded, %lu bursts (%lu connected during the burst)%s\r\n", whitelist.size,
+			(unsigned long) bursts, (unsigned long) burst_connections, measuring? ", waiting" : "");
+	print_latency("connected", connect_stats);
+	print_latency("encrypted", encrypted_stats);
+}
+
+void ReconnectAdvertiser::end_burst(void) {
+	if(burst_event != 0) {
+		queue.cancel(burst_event);
+		burst_event = 0;
+	}
+
+	set_default_parameters();
+	if(burst_end_cb) {
+		burst_end_cb();
+	}
+}
+
+void ReconnectAdvertiser::on_burst_timeout(void) {
+	burst_event = 0;
+	printf("reconnect: burst over, advertising to anyone\r\n");
+	end_burst();
+}
+
+void ReconnectAdvertiser::stop_advertising(void) {
+	Gap& gap = ble.gap();
+	if(gap.isAdvertisingActive(ble::LEGACY_ADVERTISING_HANDLE)) {
+		gap.stopAdvertising(ble::LEGACY_ADVERTISING_HANDLE);
+	}
+}
+
+void ReconnectAdvertiser::record(latency_stats_t& stats, uint32_t latency_ms) {
+	if(stats.count == 0 || latency_ms < stats.min) {
+		stats.min = latency_ms;
+	}
+	if(latency_ms > stats.max) {
+		stats.max = latency_ms;
+	}
+	stats.last = latency_ms;
+	stats.total += latency_ms;
+	stats.count++;
+}
+
+void ReconnectAdvertiser::print_latency(const char* what, const latency_stats_t& stats) {
+	if(stats.count == 0) {
+		return;
+	}
+	printf("\t%s %lu times after the disconnection: last %lu ms, min %lu, avg %lu, max %lu\r\n",
+			what, (unsigned long) stats.count, (unsigned long) stats.last, (unsigned long) stats.min,
+			(unsigned long) (stats.total / stats.count), (unsigned long) stats.max);
+}
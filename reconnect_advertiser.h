@@ -0,0 +1,141 @@
+/*
+ * reconnect_advertiser.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef RECONNECT_ADVERTISER_H_
+#define RECONNECT_ADVERTISER_H_
+
+#include <stdint.h>
+
+#include "ble/BLE.h"
+#include "ble/Gap.h"
+#include "ble/gap/Types.h"
+#include "events/EventQueue.h"
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+/**
+ * Reconnect burst: 20 ms interval, only bonded centrals may connect
+ * (20 ms is the fast advertising interval of Apple's accessory guidelines)
+ */
+#define RECONNECT_BURST_INTERVAL		32		// 625 us units
+#define RECONNECT_BURST_MS				3000
+
+/** Bonded centrals the whitelist holds, see BLEProcess */
+#define RECONNECT_WHITELIST_CAPACITY	5
+
+/**
+ * Fast reconnection of bonded centrals
+ *
+ * When a bonded central disconnects, the legacy advertising set switches to
+ * a short burst of high duty cycle advertising that only accepts connection
+ * requests from the whitelist (the bonded centrals, generated from the bond
+ * table). Scan requests stay open so broadcasts can still be read. The burst
+ * ends after RECONNECT_BURST_MS or as soon as a central connects, and
+ * advertising goes back to the default, slow parameters that accept anyone.
+ *
+ * Whitelist filtering was chosen over directed advertising: centrals with
+ * resolvable private addresses may come back under a new address, and one
+ * burst covers every bonded central.
+ *
+ * The latency from a bonded central's disconnection to its next connection
+ * and to the link being encrypted again with the stored keys is measured.
+ *
+ * BLEProcess forwards the connection events and restarts advertising. All
+ * calls must come from the BLE event queue, except print_stats().
+ */
+class ReconnectAdvertiser : private mbed::NonCopyable<ReconnectAdvertiser> {
+public:
+
+	ReconnectAdvertiser(events::EventQueue& queue, BLE& ble);
+
+	~ReconnectAdvertiser();
+
+	/** Called when a burst ended, advertising is stopped and back to the default parameters */
+	void on_burst_end(mbed::Callback<void()> cb) {
+		burst_end_cb = cb;
+	}
+
+	/** Bonded centrals, from SecurityManager::generateWhitelistFromBondTable() */
+	void set_whitelist(const Gap::Whitelist_t& whitelist);
+
+	int get_whitelist_size(void) const {
+		return whitelist.size;
+	}
+
+	/** Default advertising parameters, stops advertising if needed */
+	bool set_default_parameters(void);
+
+	bool is_bursting(void) const {
+		return burst_event != 0;
+	}
+
+	/**
+	 * A central with a bond disconnected, starts a burst
+	 *
+	 * Advertising is stopped and left to the caller to restart.
+	 * @retval false if there is no bonded central to whitelist
+	 */
+	bool on_bonded_disconnect(void);
+
+	/** Events forwarded by BLEProcess */
+	void on_connect(ble::connection_handle_t handle);
+
+	void on_disconnect(ble::connection_handle_t handle);
+
+	/**
+	 * A link was encrypted
+	 * @param[in] bonded Encrypted with stored keys, without pairing
+	 */
+	void on_encrypted(ble::connection_handle_t handle, bool bonded);
+
+	void print_stats(void);
+
+private:
+
+	/** Latencies of the reconnections, in ms */
+	typedef struct {
+		uint32_t count;
+		uint32_t last;
+		uint32_t min;
+		uint32_t max;
+		uint64_t total;
+	} latency_stats_t;
+
+	void end_burst(void);
+
+	void on_burst_timeout(void);
+
+	/** Stop the legacy set so its parameters can change */
+	void stop_advertising(void);
+
+	static void record(latency_stats_t& stats, uint32_t latency_ms);
+
+	static void print_latency(const char* what, const latency_stats_t& stats);
+
+	events::EventQueue& queue;
+	BLE& ble;
+	mbed::Callback<void()> burst_end_cb;
+
+	BLEProtocol::Address_t whitelist_addrs[RECONNECT_WHITELIST_CAPACITY];
+	Gap::Whitelist_t whitelist;
+
+	int burst_event;
+	uint32_t bursts;
+	uint32_t burst_connections;		/** Bursts a central connected during */
+
+	/** Reconnection being measured, from the last bonded disconnection */
+	bool measuring;
+	uint64_t disconnect_ms;
+	ble::connection_handle_t measured_handle;
+	bool measured_handle_valid;
+	uint32_t connect_latency_ms;	/** Of measured_handle */
+
+	latency_stats_t connect_stats;
+	latency_stats_t encrypted_stats;
+
+};
+
+#endif /* RECONNECT_ADVERTISER_H_ */
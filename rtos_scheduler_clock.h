@@ -0,0 +1,71 @@
+/*
+ * rtos_scheduler_clock.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef RTOS_SCHEDULER_CLOCK_H_
+#define RTOS_SCHEDULER_CLOCK_H_
+
+#include "drivers/LowPowerTimer.h"
+#include "events/EventQueue.h"
+#include "rtos/ThisThread.h"
+
+#include "sensor_scheduler.h"
+
+/**
+ * SchedulerClock backed by the low power ticker
+ *
+ * The low power timer does not hold a deep sleep lock so the
+ * sensor thread can sleep tickless between releases.
+ *
+ * If an event queue is given, it is dispatched while waiting for the next
+ * release so deferred work (eg: I2C completions) runs on the scheduler's thread.
+ * That work can end the wait early with wake().
+ */
+class RtosSchedulerClock : public SchedulerClock {
+public:
+
+	RtosSchedulerClock(events::EventQueue* queue = NULL) : timer(), queue(queue) {
+		timer.start();
+	}
+
+	virtual uint64_t now_us(void) {
+		return timer.read_high_resolution_us();
+	}
+
+	virtual void sleep_until_us(uint64_t wakeup_us) {
+		uint64_t now = now_us();
+		if(wakeup_us <= now) {
+			return;
+		}
+
+		// Round up so we never wake before the release
+		uint64_t delay_ms = (wakeup_us - now + 999) / 1000;
+		if(delay_ms > MAX_SLEEP_MS) {
+			delay_ms = MAX_SLEEP_MS;
+		}
+		if(queue != NULL) {
+			queue->dispatch((int) delay_ms);
+		} else {
+			rtos::ThisThread::sleep_for((uint32_t) delay_ms);
+		}
+	}
+
+	virtual void wake(void) {
+		if(queue != NULL) {
+			queue->break_dispatch();
+		}
+	}
+
+private:
+
+	/** Longest single sleep, stays clear of osWaitForever */
+	static const uint64_t MAX_SLEEP_MS = 0x7FFFFFFF;
+
+	mbed::LowPowerTimer timer;
+	events::EventQueue* queue;
+
+};
+
+#endif /* RTOS_SCHEDULER_CLOCK_H_ */
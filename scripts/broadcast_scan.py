@@ -0,0 +1,104 @@
+#!python
+"""
+Print the sensor readings an EP Agora broadcasts in its advertising data
+
+Pages are decoded as described in sensor_broadcast.h. Legacy advertising
+carries one page per advertisement, extended advertising every page back to
+back. No connection is made.
+"""
+import asyncio
+from bleak import BleakScanner
+import argparse
+import struct
+import sys
+
+SENSOR_BROADCAST_COMPANY_ID = 0xFFFF
+SENSOR_BROADCAST_VERSION = 1
+
+PAGE_ENVIRONMENT = 0
+PAGE_MOTION = 1
+
+ENVIRONMENT_FORMAT = '<hHIHBHHH'
+MOTION_FORMAT = '<hHIH3h'
+PAGE_FORMATS = {PAGE_ENVIRONMENT: ENVIRONMENT_FORMAT, PAGE_MOTION: MOTION_FORMAT}
+
+UNKNOWN_S16 = -0x8000
+
+
+def fmt(value, scale, unit, unknown):
+    if value == unknown:
+        return '-'
+    return f'{value * scale:g} {unit}'
+
+
+def format_page(page, values):
+    if page == PAGE_ENVIRONMENT:
+        temp, humidity, pressure, iaq, accuracy, co2, bvoc, battery = values
+        return (f'temp {fmt(temp, 0.01, "C", UNKNOWN_S16)}, humidity {fmt(humidity, 0.01, "%RH", 0xFFFF)}, '
+                f'pressure {fmt(pressure, 0.1, "Pa", 0xFFFFFFFF)}, IAQ {fmt(iaq, 1, "", 0xFFFF)}'
+                f'(accuracy {fmt(accuracy, 1, "", 0xFF)}), CO2 {fmt(co2, 1, "ppm", 0xFFFF)}, '
+                f'bVOC {fmt(bvoc, 1, "ppb", 0xFFFF)}, battery {fmt(battery, 1, "mV", 0xFFFF)}')
+
+    temp, humidity, als, distance, ax, ay, az = values
+    return (f'temp {fmt(temp, 0.01, "C", UNKNOWN_S16)}, humidity {fmt(humidity, 0.01, "%RH", 0xFFFF)}, '
+            f'light {fmt(als, 0.01, "lux", 0xFFFFFFFF)}, distance {fmt(distance, 1, "mm", 0xFFFF)}, '
+            f'accel {fmt(ax, 1, "", UNKNOWN_S16)}/{fmt(ay, 1, "", UNKNOWN_S16)}/{fmt(az, 1, "mg", UNKNOWN_S16)}')
+
+
+class PageDecoder:
+
+    def __init__(self):
+        # (address, page) -> last sequence number printed
+        self.last_seq = {}
+
+    def decode(self, address, data: bytes):
+        offset = 0
+        while offset + 2 <= len(data):
+            version = data[offset] >> 4
+            page = data[offset] & 0x0F
+            seq = data[offset + 1]
+
+            if version != SENSOR_BROADCAST_VERSION or page not in PAGE_FORMATS:
+                print(f'{address}: unsupported page {data[offset]:#04x}', file=sys.stderr)
+                return
+
+            body_format = PAGE_FORMATS[page]
+            end = offset + 2 + struct.calcsize(body_format)
+            if end > len(data):
+                print(f'{address}: truncated page {page}', file=sys.stderr)
+                return
+
+            # Advertisements repeat, only print what changed
+            if self.last_seq.get((address, page)) != seq:
+                self.last_seq[(address, page)] = seq
+                values = struct.unpack_from(body_format, data, offset + 2)
+                print(f'{address} [{seq:3d}] {format_page(page, values)}')
+
+            offset = end
+
+
+async def run(args):
+    decoder = PageDecoder()
+
+    def on_advertisement(device, ad):
+        if args.address and device.address != args.address:
+            return
+        data = ad.manufacturer_data.get(SENSOR_BROADCAST_COMPANY_ID)
+        if data is not None:
+            decoder.decode(device.address, bytes(data))
+
+    async with BleakScanner(on_advertisement):
+        await asyncio.sleep(args.duration)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode the EP Agora sensor broadcast')
+    parser.add_argument('-a', '--address', help='Only decode this device (defaults to every broadcaster)')
+    parser.add_argument('-d', '--duration', type=float, default=30.0, help='Seconds to scan for')
+    args = parser.parse_args()
+
+    asyncio.run(run(args))
+
+
+if __name__ == '__main__':
+    main()
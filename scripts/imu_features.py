@@ -0,0 +1,137 @@
+#!python
+"""
+Log the vibration features an EP Agora computes from its accelerometer as CSV
+
+Feature vectors are decoded as described in imu_feature_service.h. Notifications
+carry the whole vector from an ATT MTU of 45, with a smaller MTU the
+characteristic is read whenever a (truncated) notification arrives. Sequence
+gaps are reported on stderr.
+"""
+import asyncio
+from bleak import BleakClient, BleakScanner
+import argparse
+import struct
+import sys
+
+IMU_FEATURE_CHAR_UUID = '00001013-8dd4-4087-a16a-04a7c8e01734'
+
+FEATURE_VERSION = 1
+BAND_COUNT = 8
+HEADER_FORMAT = '<BBHH'
+FEATURE_FORMAT = HEADER_FORMAT + '9H' + f'{BAND_COUNT}H' + 'H'
+FEATURE_SIZE = struct.calcsize(FEATURE_FORMAT)
+
+SOURCES = {0: 'LSM9DS1', 1: 'ICM20602'}
+
+
+class FeatureDecoder:
+
+    def __init__(self, out):
+        self.out = out
+        self.last_seq = None
+        self.windows = 0
+        self.lost_windows = 0
+
+    def decode(self, data: bytes):
+        if len(data) < FEATURE_SIZE:
+            return False
+
+        values = struct.unpack_from(FEATURE_FORMAT, data)
+        ver_src, log2_window, seq, rate = values[:4]
+        axes = values[4:13]
+        bands = values[13:13 + BAND_COUNT]
+        peak = values[13 + BAND_COUNT]
+
+        version = ver_src >> 4
+        if version == 0:
+            # No window completed yet
+            return True
+        if version != FEATURE_VERSION:
+            print(f'unsupported feature version {version}', file=sys.stderr)
+            return True
+
+        if self.last_seq is not None:
+            if seq == self.last_seq:
+                # Read back a vector that was already notified
+                return True
+            gap = (seq - self.last_seq - 1) & 0xFFFF
+            if gap:
+                self.lost_windows += gap
+                print(f'lost {gap} window(s) before {seq}', file=sys.stderr)
+        self.last_seq = seq
+
+        source = SOURCES.get(ver_src & 0x0F, 'unknown')
+        rate_hz = rate / 10.0
+        fields = [source, str(seq), str(1 << log2_window), f'{rate_hz:.1f}']
+        for axis in range(3):
+            rms, p2p, crest = axes[3 * axis:3 * axis + 3]
+            fields += [f'{rms / 1000.0:.3f}', f'{p2p / 1000.0:.3f}', f'{crest / 100.0:.2f}']
+        fields += [f'{band / 1000.0:.3f}' for band in bands]
+        fields.append(f'{peak / 10.0:.1f}')
+        self.out.write(','.join(fields) + '\n')
+
+        self.windows += 1
+        return True
+
+
+def csv_header():
+    fields = ['source', 'window', 'samples', 'rate_hz']
+    for axis in 'xyz':
+        fields += [f'{axis}_rms_g', f'{axis}_p2p_g', f'{axis}_crest']
+    fields += [f'band{i}_rms_g' for i in range(BAND_COUNT)]
+    fields.append('peak_hz')
+    return ','.join(fields) + '\n'
+
+
+async def run(args):
+    device = await BleakScanner.find_device_by_filter(
+        lambda d, ad: d.name == args.name or d.address == args.address, timeout=args.timeout)
+    if device is None:
+        print(f'could not find {args.address or args.name}', file=sys.stderr)
+        return
+
+    out = open(args.output, 'w') if args.output else sys.stdout
+    out.write(csv_header())
+    decoder = FeatureDecoder(out)
+
+    async with BleakClient(device) as client:
+        reads = asyncio.Queue()
+
+        def on_notify(_, data):
+            if not decoder.decode(bytes(data)):
+                reads.put_nowait(True)
+
+        async def read_truncated():
+            while True:
+                await reads.get()
+                decoder.decode(bytes(await client.read_gatt_char(IMU_FEATURE_CHAR_UUID)))
+
+        decoder.decode(bytes(await client.read_gatt_char(IMU_FEATURE_CHAR_UUID)))
+        await client.start_notify(IMU_FEATURE_CHAR_UUID, on_notify)
+        reader = asyncio.ensure_future(read_truncated())
+        try:
+            await asyncio.sleep(args.duration)
+        finally:
+            reader.cancel()
+            await client.stop_notify(IMU_FEATURE_CHAR_UUID)
+
+    if out is not sys.stdout:
+        out.close()
+
+    print(f'{decoder.windows} windows, {decoder.lost_windows} lost', file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Log the EP Agora IMU vibration features')
+    parser.add_argument('-a', '--address', help='Device address (defaults to the first "EP Agora" found)')
+    parser.add_argument('-n', '--name', default='EP Agora', help='Device name to scan for')
+    parser.add_argument('-d', '--duration', type=float, default=60.0, help='Seconds to log for')
+    parser.add_argument('-o', '--output', help='CSV file to write (defaults to stdout)')
+    parser.add_argument('-t', '--timeout', type=float, default=10.0, help='Scan timeout in seconds')
+    args = parser.parse_args()
+
+    asyncio.run(run(args))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,130 @@
+#!python
+"""
+Subscribe to the high rate IMU stream of an EP Agora and log it as CSV
+
+Frames are decoded as described in imu_stream_frame.h. Sequence gaps (frames
+dropped on the device or lost over the air) are reported on stderr.
+"""
+import asyncio
+from bleak import BleakClient, BleakScanner
+import argparse
+import struct
+import sys
+
+IMU_STREAM_DATA_CHAR_UUID = '00001010-8dd4-4087-a16a-04a7c8e01734'
+IMU_STREAM_ODR_CHAR_UUID = '00002010-8dd4-4087-a16a-04a7c8e01734'
+IMU_STREAM_RANGE_CHAR_UUID = '00003010-8dd4-4087-a16a-04a7c8e01734'
+
+FRAME_VERSION = 1
+HEADER_FORMAT = '<BBHHBB'
+HEADER_SIZE = struct.calcsize(HEADER_FORMAT)
+SAMPLE_FORMAT = '<6h'
+SAMPLE_SIZE = struct.calcsize(SAMPLE_FORMAT)
+
+SOURCES = {0: 'LSM9DS1', 1: 'ICM20602'}
+
+GYRO_RANGES_DPS = {0: 245, 1: 500, 2: 2000, 3: 250, 4: 1000}
+
+
+class FrameDecoder:
+
+    def __init__(self, out):
+        self.out = out
+        self.last_seq = None
+        self.frames = 0
+        self.samples = 0
+        self.lost_frames = 0
+
+    def decode(self, data: bytes):
+        if len(data) < HEADER_SIZE:
+            print(f'short frame ({len(data)} bytes)', file=sys.stderr)
+            return
+
+        ver_src, count, seq, odr_hz, accel_g, gyro_range = struct.unpack_from(HEADER_FORMAT, data)
+        version = ver_src >> 4
+        source = SOURCES.get(ver_src & 0x0F, 'unknown')
+
+        if version != FRAME_VERSION:
+            print(f'unsupported frame version {version}', file=sys.stderr)
+            return
+
+        if len(data) < HEADER_SIZE + count * SAMPLE_SIZE:
+            print(f'truncated frame {seq}', file=sys.stderr)
+            return
+
+        if self.last_seq is not None:
+            gap = (seq - self.last_seq - 1) & 0xFFFF
+            if gap:
+                self.lost_frames += gap
+                print(f'lost {gap} frame(s) before {seq}', file=sys.stderr)
+        self.last_seq = seq
+
+        accel_scale = accel_g / 32768.0
+        gyro_scale = GYRO_RANGES_DPS.get(gyro_range, 0) / 32768.0
+
+        for i in range(count):
+            ax, ay, az, gx, gy, gz = struct.unpack_from(SAMPLE_FORMAT, data, HEADER_SIZE + i * SAMPLE_SIZE)
+            self.out.write(f'{source},{seq},{i},{odr_hz},'
+                           f'{ax * accel_scale:.5f},{ay * accel_scale:.5f},{az * accel_scale:.5f},'
+                           f'{gx * gyro_scale:.4f},{gy * gyro_scale:.4f},{gz * gyro_scale:.4f}\n')
+
+        self.frames += 1
+        self.samples += count
+
+
+async def run(args):
+    device = await BleakScanner.find_device_by_filter(
+        lambda d, ad: d.name == args.name or d.address == args.address, timeout=args.timeout)
+    if device is None:
+        print(f'could not find {args.address or args.name}', file=sys.stderr)
+        return
+
+    out = open(args.output, 'w') if args.output else sys.stdout
+    out.write('source,frame,sample,odr_hz,ax_g,ay_g,az_g,gx_dps,gy_dps,gz_dps\n')
+    decoder = FrameDecoder(out)
+
+    async with BleakClient(device) as client:
+        if args.odr:
+            await client.write_gatt_char(IMU_STREAM_ODR_CHAR_UUID, struct.pack('<H', args.odr), response=True)
+
+        if args.accel_range or args.gyro_range:
+            current = await client.read_gatt_char(IMU_STREAM_RANGE_CHAR_UUID)
+            accel_g = args.accel_range or current[0]
+            gyro_range = current[1]
+            if args.gyro_range:
+                gyro_range = next(code for code, dps in GYRO_RANGES_DPS.items() if dps == args.gyro_range)
+            await client.write_gatt_char(IMU_STREAM_RANGE_CHAR_UUID, bytes([accel_g, gyro_range]), response=True)
+
+        await client.start_notify(IMU_STREAM_DATA_CHAR_UUID, lambda _, data: decoder.decode(bytes(data)))
+        try:
+            await asyncio.sleep(args.duration)
+        finally:
+            await client.stop_notify(IMU_STREAM_DATA_CHAR_UUID)
+
+    if out is not sys.stdout:
+        out.close()
+
+    print(f'{decoder.frames} frames, {decoder.samples} samples '
+          f'({decoder.samples / args.duration:.1f} samples/s), {decoder.lost_frames} frames lost',
+          file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Log the EP Agora high rate IMU stream')
+    parser.add_argument('-a', '--address', help='Device address (defaults to the first "EP Agora" found)')
+    parser.add_argument('-n', '--name', default='EP Agora', help='Device name to scan for')
+    parser.add_argument('-r', '--odr', type=int, default=0, help='Requested output data rate in Hz')
+    parser.add_argument('--accel-range', type=int, default=0, choices=[2, 4, 8, 16],
+                        help='Requested accelerometer full scale in g')
+    parser.add_argument('--gyro-range', type=int, default=0, choices=sorted(GYRO_RANGES_DPS.values()),
+                        help='Requested gyroscope full scale in dps')
+    parser.add_argument('-d', '--duration', type=float, default=10.0, help='Seconds to stream for')
+    parser.add_argument('-o', '--output', help='CSV file to write (defaults to stdout)')
+    parser.add_argument('-t', '--timeout', type=float, default=10.0, help='Scan timeout in seconds')
+    args = parser.parse_args()
+
+    asyncio.run(run(args))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,329 @@
+#!python
+"""
+Download the sensor log of an EP Agora over BLE and write it as CSV
+
+Implements the client side of the bulk transfer protocol described in
+log_transfer_session.h. The position after the last complete record is kept
+in a state file, so running the script again only fetches what was logged
+since (or picks up where an interrupted download stopped).
+"""
+import asyncio
+from bleak import BleakClient, BleakScanner
+import argparse
+import json
+import os
+import struct
+import sys
+import time
+
+LOG_TRANSFER_CONTROL_CHAR_UUID = '00001011-8dd4-4087-a16a-04a7c8e01734'
+LOG_TRANSFER_DATA_CHAR_UUID = '00002011-8dd4-4087-a16a-04a7c8e01734'
+
+CMD_GET_INFO = 0x01
+CMD_START = 0x02
+CMD_ACK = 0x03
+CMD_ABORT = 0x04
+
+PACKET_DATA = 0x01
+PACKET_END = 0x02
+PACKET_INFO = 0x03
+PACKET_RESUME = 0x04
+
+PACKET_HEADER_FORMAT = '<BH'
+PACKET_HEADER_SIZE = struct.calcsize(PACKET_HEADER_FORMAT)
+INFO_FORMAT = '<IIIHBB'
+RESUME_FORMAT = '<IH'  # segment sequence, first record not sent
+BLOCK_HEADER_FORMAT = '<IIHH'
+BLOCK_HEADER_SIZE = struct.calcsize(BLOCK_HEADER_FORMAT)
+RECORD_FORMAT = '<IBBH12s'  # time_ms, channel, readings skipped, sensor reading sequence, value
+RECORD_SIZE = struct.calcsize(RECORD_FORMAT)
+
+# Indexed by sensor_channel_t (sensor_sample.h): name, value format
+CHANNELS = [
+    ('bme680 temp', '<i'),
+    ('bme680 pressure', '<I'),
+    ('bme680 humidity', '<I'),
+    ('bme680 gas res', '<I'),
+    ('bme680 co2', '<f'),
+    ('bme680 bvoc', '<f'),
+    ('bme680 iaq', '<I'),
+    ('bme680 iaq acc', '<I'),
+    ('max44009 als', '<f'),
+    ('si7021 temp', '<i'),
+    ('si7021 humidity', '<I'),
+    ('vl53l0x distance', '<I'),
+    ('lsm9ds1 accel', '<3f'),
+    ('lsm9ds1 gyro', '<3f'),
+    ('lsm9ds1 mag', '<3f'),
+    ('icm20602 accel', '<3f'),
+    ('icm20602 gyro', '<3f'),
+    ('battery', '<f'),
+]
+
+# Erased (never written) records read back as 0xFF
+CHANNEL_ERASED = 0xFF
+
+# Wall clock set by a host (sensor_log.h): the value is the Unix time in ms at time_ms
+CHANNEL_TIME_SYNC = 0xFE
+
+
+class StreamDecoder:
+    """Splits the transfer stream into blocks and records"""
+
+    def __init__(self, out, sequence=0, record=0):
+        self.out = out
+        self.buffer = bytearray()
+        self.block = None       # (sequence, boot count, next record, records left)
+        self.sequence = sequence
+        self.record = record
+        self.records = 0
+        self.wall_offsets = {}  # boot count: Unix ms - device ms, from the latest time sync
+        self.last_readings = {}  # (boot count, channel): sequence of the last record
+        self.lost = 0           # readings missing from the sequence and not skipped on purpose
+
+    def feed(self, data: bytes):
+        self.buffer += data
+        offset = 0
+
+        while True:
+            if self.block is None:
+                if len(self.buffer) - offset < BLOCK_HEADER_SIZE:
+                    break
+                sequence, boot, first, count = struct.unpack_from(BLOCK_HEADER_FORMAT, self.buffer, offset)
+                offset += BLOCK_HEADER_SIZE
+                self.block = [sequence, boot, first, count]
+                self.sequence, self.record = sequence, first
+                if count == 0:
+                    self.end_block()
+                continue
+
+            if len(self.buffer) - offset < RECORD_SIZE:
+                break
+
+            time_ms, channel, skipped, reading, value = struct.unpack_from(RECORD_FORMAT, self.buffer, offset)
+            offset += RECORD_SIZE
+            self.write_record(time_ms, channel, skipped, reading, value)
+
+            self.block[2] += 1
+            self.block[3] -= 1
+            self.record = self.block[2]
+            if self.block[3] == 0:
+                self.end_block()
+
+        del self.buffer[:offset]
+
+    def end_block(self):
+        # Resume from the start of the next segment
+        self.sequence, self.record = self.block[0] + 1, 0
+        self.block = None
+
+    def reset(self):
+        """Throw away a partial block, the next START resumes at the last complete record"""
+        self.buffer = bytearray()
+        self.block = None
+
+    def write_record(self, time_ms, channel, skipped, reading, value):
+        if channel == CHANNEL_ERASED:
+            return
+        boot = self.block[1]
+        if channel == CHANNEL_TIME_SYNC:
+            # Records of this boot from here on can be converted
+            self.wall_offsets[boot] = struct.unpack_from('<q', value)[0] - time_ms
+            return
+        last = self.last_readings.get((boot, channel))
+        if last is not None:
+            # Only what the record's skip count does not cover went missing (it saturates at 255)
+            gap = (reading - last - 1) & 0xFFFF
+            if gap > skipped and skipped < 0xFF:
+                self.lost += gap - skipped
+        self.last_readings[(boot, channel)] = reading
+        name, fmt = CHANNELS[channel] if channel < len(CHANNELS) else (f'channel {channel}', '<I')
+        values = struct.unpack_from(fmt, value)
+        columns = ','.join(f'{v:.6g}' if isinstance(v, float) else str(v) for v in values)
+        wall = self.wall_offsets.get(boot)
+        wall_time = f'{(time_ms + wall) / 1000.0:.3f}' if wall is not None else ''
+        self.out.write(f'{boot},{self.block[0]},{time_ms},{wall_time},{name},{reading},{skipped},{columns}\n')
+        self.records += 1
+
+
+class LogDownloader:
+    """Client side of the windowed transfer: in order delivery and cumulative acks"""
+
+    def __init__(self, client, decoder, window):
+        self.client = client
+        self.decoder = decoder
+        self.window = window
+        self.expected = 0
+        self.unacked = 0
+        self.info = None
+        self.info_event = asyncio.Event()
+        self.done = asyncio.Event()
+        self.resume_at = None   # Where the device broke off the stream, if it did
+        self.last_packet = time.monotonic()
+        self.packets = 0
+        self.duplicates = 0
+        self.bytes = 0
+
+    async def command(self, data: bytes):
+        await self.client.write_gatt_char(LOG_TRANSFER_CONTROL_CHAR_UUID, data, response=False)
+
+    async def ack(self):
+        self.unacked = 0
+        await self.command(struct.pack('<BH', CMD_ACK, (self.expected - 1) & 0xFFFF))
+
+    async def on_packet(self, data: bytes):
+        if len(data) < PACKET_HEADER_SIZE:
+            return
+        packet_type, sequence = struct.unpack_from(PACKET_HEADER_FORMAT, data)
+        payload = data[PACKET_HEADER_SIZE:]
+
+        if packet_type == PACKET_INFO:
+            self.info = struct.unpack_from(INFO_FORMAT, payload)
+            self.info_event.set()
+            return
+
+        self.last_packet = time.monotonic()
+        if sequence != self.expected:
+            # Go-back-N: anything out of order is sent again
+            self.duplicates += 1
+            return
+
+        self.expected = (self.expected + 1) & 0xFFFF
+        self.packets += 1
+        self.unacked += 1
+
+        if packet_type == PACKET_END:
+            await self.ack()
+            self.done.set()
+            return
+
+        if packet_type == PACKET_RESUME:
+            # The segment went away mid block: drop the partial block and start again
+            self.resume_at = struct.unpack_from(RESUME_FORMAT, payload)
+            await self.ack()
+            self.done.set()
+            return
+
+        self.bytes += len(payload)
+        self.decoder.feed(payload)
+        if self.unacked >= max(1, self.window // 2):
+            await self.ack()
+
+    async def get_info(self, timeout):
+        self.info_event.clear()
+        await self.command(bytes([CMD_GET_INFO]))
+        await asyncio.wait_for(self.info_event.wait(), timeout)
+        return self.info
+
+    async def download(self, stall_timeout):
+        last_break = None
+        while True:
+            await self.transfer(stall_timeout)
+            if self.resume_at is None:
+                return
+
+            sequence, record = self.resume_at
+            print(f'log: stream broke off at {sequence}/{record}, resuming', file=sys.stderr)
+            if self.resume_at == last_break:
+                # Broke off at the same place twice: the segment cannot be read, skip it
+                print(f'log: skipping unreadable segment {sequence}', file=sys.stderr)
+                self.decoder.sequence, self.decoder.record = sequence + 1, 0
+            last_break = self.resume_at
+
+    async def transfer(self, stall_timeout):
+        self.expected = 0
+        self.unacked = 0
+        self.resume_at = None
+        self.done.clear()
+        self.decoder.reset()
+        self.last_packet = time.monotonic()
+        await self.command(struct.pack('<BIHB', CMD_START, self.decoder.sequence,
+                                       self.decoder.record, self.window))
+
+        while not self.done.is_set():
+            try:
+                await asyncio.wait_for(self.done.wait(), 0.5)
+            except asyncio.TimeoutError:
+                pass
+            if self.unacked and time.monotonic() - self.last_packet > 0.2:
+                # Flush a partial window instead of waiting for the device to time out
+                await self.ack()
+            if time.monotonic() - self.last_packet > stall_timeout:
+                raise TimeoutError('transfer stalled')
+
+
+def load_state(path):
+    if path and os.path.exists(path):
+        with open(path) as f:
+            state = json.load(f)
+        return state['sequence'], state['record']
+    return 0, 0
+
+
+def save_state(path, decoder):
+    if path:
+        with open(path, 'w') as f:
+            json.dump({'sequence': decoder.sequence, 'record': decoder.record}, f)
+
+
+async def run(args):
+    device = await BleakScanner.find_device_by_filter(
+        lambda d, ad: d.name == args.name or d.address == args.address, timeout=args.timeout)
+    if device is None:
+        print(f'could not find {args.address or args.name}', file=sys.stderr)
+        return
+
+    sequence, record = (0, 0) if args.all else load_state(args.state)
+
+    append = args.output and os.path.exists(args.output) and not args.all
+    out = open(args.output, 'a' if append else 'w') if args.output else sys.stdout
+    if not append:
+        out.write('boot,segment,time_ms,unix_time,channel,reading,skipped,value0,value1,value2\n')
+    decoder = StreamDecoder(out, sequence, record)
+
+    try:
+        async with BleakClient(device) as client:
+            downloader = LogDownloader(client, decoder, args.window)
+            await client.start_notify(LOG_TRANSFER_DATA_CHAR_UUID,
+                                      lambda _, data: asyncio.ensure_future(downloader.on_packet(bytes(data))))
+
+            oldest, newest, boot, records_per_segment, record_size, max_window = \
+                await downloader.get_info(args.timeout)
+            if record_size != RECORD_SIZE:
+                print(f'unsupported record size {record_size}', file=sys.stderr)
+                return
+            downloader.window = min(args.window, max_window)
+            print(f'log: segments {oldest}-{newest}, boot {boot}, resuming at {decoder.sequence}/{decoder.record}',
+                  file=sys.stderr)
+
+            start = time.monotonic()
+            try:
+                await downloader.download(args.timeout)
+            finally:
+                elapsed = time.monotonic() - start
+                save_state(args.state, decoder)
+                print(f'{decoder.records} records ({decoder.lost} readings lost), {downloader.bytes} bytes in {elapsed:.1f} s '
+                      f'({downloader.bytes / max(elapsed, 1e-3) / 1024:.1f} KiB/s), '
+                      f'{downloader.duplicates} packets out of order', file=sys.stderr)
+    finally:
+        if out is not sys.stdout:
+            out.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Download the EP Agora sensor log')
+    parser.add_argument('-a', '--address', help='Device address (defaults to the first "EP Agora" found)')
+    parser.add_argument('-n', '--name', default='EP Agora', help='Device name to scan for')
+    parser.add_argument('-o', '--output', help='CSV file to write or append to (defaults to stdout)')
+    parser.add_argument('-s', '--state', default='log_download.json',
+                        help='File keeping the resume position between runs')
+    parser.add_argument('--all', action='store_true', help='Ignore the resume position and fetch the whole log')
+    parser.add_argument('-w', '--window', type=int, default=16, help='Packets in flight before an ack')
+    parser.add_argument('-t', '--timeout', type=float, default=10.0, help='Scan and stall timeout in seconds')
+    args = parser.parse_args()
+
+    asyncio.run(run(args))
+
+
+if __name__ == '__main__':
+    main()
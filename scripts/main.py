@@ -11,47 +11,115 @@ import logging
 import math
 import sys
 import struct
+import time
 
 # The state is what is printed by a simple text animation loading thingy (below)
 state_lock = asyncio.Lock()
 state = ''
 
-uuid_map = {  # UUID: Name, struct format, scaling factor
-    "00002a6e-0000-1000-8000-00805f9b34fb": ('Temperature', '<h', 0.01),   # int16_t
-    '00002a6f-0000-1000-8000-00805f9b34fb': ('Humidity', '<H', 0.01),      # uint16_t
-    '00002a6d-0000-1000-8000-00805f9b34fb': ('Pressure', '<I', 0.1),       # uint32_t
-    '00001001-8dd4-4087-a16a-04a7c8e01734': ('CO2', '<f', 1.0),            # float
-    '00002001-8dd4-4087-a16a-04a7c8e01734': ('bVOC', '<f', 1.0),           # float
-    '00005001-8dd4-4087-a16a-04a7c8e01734': ('Gas Resistance', '<I', 1.0)  # uint32_t
-}
+# Every sensor's latest value in one characteristic, see sensor_snapshot_service.h
+SNAPSHOT_CHAR_UUID = '00001015-8dd4-4087-a16a-04a7c8e01734'
+SNAPSHOT_VERSION = 2
+SNAPSHOT_HEADER = struct.Struct('<BHI')  # version, sequence, ms since boot
+SNAPSHOT_READING = struct.Struct('<HI')  # per sensor: reading sequence, ms since boot it was read at
+SNAPSHOT_SENSORS = ['BME680', 'MAX44009', 'Si7021', 'VL53L0X', 'LSM9DS1', 'ICM20602', 'Battery']  # sensor_id_t
+
+# Device time to wall time mapping, see time_sync_service.h
+TIME_SYNC_CHAR_UUID = '00001016-8dd4-4087-a16a-04a7c8e01734'
+TIME_SYNC_UNSYNCED = -(1 << 63)
+
+snapshot_fields = [  # Name, struct format, scaling factor, raw value while unknown
+    ('Temperature', 'h', 0.01, -0x8000),
+    ('Humidity', 'H', 0.01, 0xFFFF),
+    ('Pressure', 'I', 0.1, 0xFFFFFFFF),
+    ('Gas Resistance', 'I', 1.0, 0xFFFFFFFF),
+    ('IAQ', 'H', 1.0, 0xFFFF),
+    ('IAQ Accuracy', 'B', 1.0, 0xFF),
+    ('CO2', 'H', 1.0, 0xFFFF),
+    ('bVOC', 'H', 0.001, 0xFFFF),
+    ('Si7021 Temperature', 'h', 0.01, -0x8000),
+    ('Si7021 Humidity', 'H', 0.01, 0xFFFF),
+    ('Light', 'I', 0.01, 0xFFFFFFFF),
+    ('Distance', 'H', 1.0, 0xFFFF),
+] + [(f'LSM9DS1 {quantity} {axis}', 'h', scaling, -0x8000)
+     for quantity, scaling in (('Accel', 0.001), ('Gyro', 0.1), ('Mag', 0.001))
+     for axis in 'XYZ'] + [(f'ICM20602 {quantity} {axis}', 'h', scaling, -0x8000)
+                           for quantity, scaling in (('Accel', 0.001), ('Gyro', 0.1))
+                           for axis in 'XYZ'] + [
+    ('Battery', 'H', 0.001, 0xFFFF),
+]
+
+SNAPSHOT_BODY = struct.Struct('<' + ''.join(fmt for name, fmt, scaling, unknown in snapshot_fields))
+
+
+def snapshot_header() -> str:
+    """
+    CSV header matching decode_snapshot()
+    """
+    readings = [f'{sensor} {column}' for sensor in SNAPSHOT_SENSORS for column in ('Reading', 'Time (s)')]
+    return ','.join(['Sequence', 'Device Time (s)', 'Unix Time (s)'] +
+                    [name for name, fmt, scaling, unknown in snapshot_fields] + readings)
 
 
-class DataEntry:
+def decode_readings(data: bytes) -> list:
+    """
+    Latest reading of every sensor in a snapshot
+    :param data: Characteristic value
+    :return: (sequence, ms since boot) per sensor, None for sensors that were not read yet
+    """
+    offset = SNAPSHOT_HEADER.size + SNAPSHOT_BODY.size
+    readings = []
+    for i in range(len(SNAPSHOT_SENSORS)):
+        sequence, time_ms = SNAPSHOT_READING.unpack_from(data, offset + i * SNAPSHOT_READING.size)
+        readings.append(None if time_ms == 0xFFFFFFFF else (sequence, time_ms))
+    return readings
 
-    def __init__(self):
 
-        self.values = {}
-        for key, val in uuid_map.items():
-            name, fmt, scaling = val
-            self.values[name] = math.nan
+def decode_snapshot(data: bytes, wall_offset_ms=None) -> str:
+    """
+    Decodes a snapshot into a CSV row, unknown values are left empty
+    :param data: Characteristic value
+    :param wall_offset_ms: Unix time - device time in ms, None to leave the Unix time out
+    :return: CSV row, None if the version is not supported
+    """
+    version, sequence, timestamp_ms = SNAPSHOT_HEADER.unpack_from(data)
+    if version != SNAPSHOT_VERSION:
+        return None
 
-    def is_complete(self) -> bool:
-        for key, val in self.values.items():
-            if math.isnan(val):
-                return False
+    values = SNAPSHOT_BODY.unpack_from(data, SNAPSHOT_HEADER.size)
+    row = [str(sequence), f'{timestamp_ms / 1000.0:.3f}',
+           f'{(timestamp_ms + wall_offset_ms) / 1000.0:.3f}' if wall_offset_ms is not None else '']
+    for (name, fmt, scaling, unknown), raw in zip(snapshot_fields, values):
+        row.append('' if raw == unknown else f'{raw * scaling:g}')
+    for reading in decode_readings(data):
+        row += [str(reading[0]), f'{reading[1] / 1000.0:.3f}'] if reading is not None else ['', '']
 
-        return True
+    return ','.join(row)
 
-    def clear(self):
-        for val in self.values:
-            val = math.nan
 
-    def to_string(self) -> str:
-        result = ''
-        for key, val in self.values.items():
-            result += f'{val},'
+async def sync_time(client, set_device_clock: bool):
+    """
+    Maps the device's monotonic clock to wall time
+    :param client: Connected client
+    :param set_device_clock: Write our wall clock so the device logs the mapping too
+    :return: Unix time - device time in ms, None if the firmware has no time sync
+    """
+    char = client.services.get_characteristic(TIME_SYNC_CHAR_UUID)
+    if char is None:
+        return None
+
+    if set_device_clock:
+        await client.write_gatt_char(char, struct.pack('<q', round(time.time() * 1000)), response=True)
 
-        return result
+    start = time.time()
+    data = await client.read_gatt_char(char)
+    end = time.time()
+    device_ms, offset_ms = struct.unpack_from('<Qq', data)
+    if offset_ms == TIME_SYNC_UNSYNCED:
+        # The device time was taken somewhere within the read
+        offset_ms = round((start + end) / 2 * 1000) - device_ms
+
+    return offset_ms
 
 
 class DummySignal:
@@ -137,57 +205,67 @@ async def connect_main(args):
 
     debug_logger.info(f'Connected to {target_address}')
 
-    # Discover characteristics we want to collect
-    chars_to_collect = []
-
-    for service in client.services:
-        if service.uuid == '00000001-8dd4-4087-a16a-04a7c8e01734':
-            for char in service.characteristics:
-                if char.uuid == '00002a6e-0000-1000-8000-00805f9b34fb':  # Temperature
-                    chars_to_collect.append(char)
-                elif char.uuid == '00002a6d-0000-1000-8000-00805f9b34fb':  # Pressure
-                    chars_to_collect.append(char)
-                elif char.uuid == '00002a6f-0000-1000-8000-00805f9b34fb':  # Humidity
-                    chars_to_collect.append(char)
-                elif char.uuid == '00001001-8dd4-4087-a16a-04a7c8e01734':  # CO2
-                    chars_to_collect.append(char)
-                elif char.uuid == '00002001-8dd4-4087-a16a-04a7c8e01734':  # bVOC
-                    chars_to_collect.append(char)
-                elif char.uuid == '00005001-8dd4-4087-a16a-04a7c8e01734':  # Gas resistance
-                    chars_to_collect.append(char)
-
-    # Now enable notifications for the characteristics we want to read
-    # TODO - notifications not working for more than 1 characteristic
-    #    for char in chars_to_collect:
-    #        await client.start_notify(char, notification_handler)
+    # Every reading comes in a single snapshot notification, once per poll cycle
+    snapshot_char = client.services.get_characteristic(SNAPSHOT_CHAR_UUID)
+    if snapshot_char is None:
+        debug_logger.error('Snapshot characteristic not found, the firmware is too old')
+        await client.disconnect()
+        return
+
+    wall_offset_ms = await sync_time(client, not args.no_time_sync)
+    if wall_offset_ms is None:
+        debug_logger.info('No time sync characteristic, logging device time only')
+
+    last_sequence = None
+    last_readings = [None] * len(SNAPSHOT_SENSORS)
+
+    def on_snapshot(sender, data: bytearray):
+        nonlocal last_sequence, last_readings
+        row = decode_snapshot(bytes(data), wall_offset_ms)
+        if row is None:
+            debug_logger.warning(f'Unsupported snapshot version {data[0]}')
+            return
+
+        # Snapshots are only published when a value changed, gaps are missed notifications
+        sequence = SNAPSHOT_HEADER.unpack_from(data)[1]
+        if sequence == last_sequence:
+            # The initial read caught the first notification
+            return
+        if last_sequence is not None and sequence != (last_sequence + 1) & 0xFFFF:
+            debug_logger.info(f'Missed {(sequence - last_sequence - 1) & 0xFFFF} snapshots')
+        last_sequence = sequence
+
+        # Readings superseded between snapshots (the snapshot only holds the latest of each sensor), not lost
+        readings = decode_readings(bytes(data))
+        for sensor, last, reading in zip(SNAPSHOT_SENSORS, last_readings, readings):
+            if last is not None and reading is not None and reading[0] != last[0]:
+                skipped = (reading[0] - last[0] - 1) & 0xFFFF
+                if skipped:
+                    debug_logger.debug(f'{sensor}: {skipped} readings between snapshots')
+        last_readings = readings
+
+        data_logger.info(row)
+
+    data_logger.info(snapshot_header())
+
+    # The current value first, then every update
+    on_snapshot(snapshot_char, await client.read_gatt_char(snapshot_char))
+    await client.start_notify(snapshot_char, on_snapshot)
 
     # Clear the state (silence spinbar message)
     async with state_lock:
         state = 'Logging'
 
-    cancelled = False
-    while not cancelled:
-        data_entry = DataEntry()
-        try:
-            # Read every characteristic and log the record
-            for char in chars_to_collect:
-                data = await client.read_gatt_char(char)
-                name, fmt, scaling_factor = uuid_map[char.uuid]
-                unpacked = struct.unpack(fmt, data)[0]
-                unpacked *= scaling_factor
-                data_entry.values[name] = unpacked
-                if data_entry.is_complete():
-                    data_logger.info(data_entry.to_string())
-                    data_entry.clear()
-            await asyncio.sleep(3.0)
-        except asyncio.CancelledError as e:
-            cancelled = True
+    try:
+        while True:
+            await asyncio.sleep(1.0)
+    except asyncio.CancelledError as e:
+        pass
 
     async with state_lock:
         state = 'Disconnecting'
 
-    #for char in chars_to_collect:
-    #    await client.stop_notify(char)
+    await client.stop_notify(snapshot_char)
 
     await client.disconnect()
 
@@ -253,6 +331,8 @@ if __name__ == '__main__':
     parser.add_argument('--log-file', dest='log_file',
                         help='File to log debug information of this program to. '
                              'By default it is printed to the terminal')
+    parser.add_argument('--no-time-sync', dest='no_time_sync', action='store_true',
+                        help='Do not set the device clock, only map its time to ours')
     parser.add_argument('-s', '--scan-duration', dest='scan_duration', default=20.0, type=int,
                         help='Duration to scan for in seconds. Defaults to 20 seconds')
     args = parser.parse_args()
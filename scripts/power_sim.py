@@ -0,0 +1,317 @@
+#!python
+"""
+Simulate the sensor power states of EP Agora poll configurations
+
+Models the sensor scheduler (earliest deadline first, sleeping between
+releases with millisecond rounding) and the policy of SensorPowerManager:
+IMUs sleep between polls when their task is not due within their wake-up time,
+and the whole sensor domain is switched off when no task on it is due within
+the power-up, re-init and settling time (never while BSEC runs on the BME680).
+
+For every configuration it checks that
+  - no task runs while the domain is off, powering up or settling,
+  - no IMU is read before it was awake for its wake-up time,
+  - power management does not make any release later than the clock rounding,
+and prints the time spent in each state and the estimated average current.
+The figures mirror main.cpp and sensor_power_manager.h, keep them in sync.
+Exits with 1 if any check failed.
+"""
+import argparse
+import sys
+
+# sensor_power_manager.h
+MIN_OFF_MS = 20
+WAKE_MARGIN_MS = 5
+BUSY_RETRY_MS = 2
+
+# main.cpp
+SENSOR_POWER_UP_MS = 100
+SENSOR_REINIT_MS = 50
+SENSOR_SETTLE_MS = 800
+DOMAIN_ON_UA = 110
+DOMAIN_OFF_UA = 1
+
+# name: (wake-up ms, active uA, low power uA)
+DEVICES = {
+    'lsm9ds1': (100, 4600, 1200),
+    'icm20602': (50, 2800, 6),
+}
+
+# name: (offset ms, deadline ms or 0, runtime ms, charge per run nC, I2C busy after the run ms)
+TASKS = {
+    'bme680': (3000, 0, 1, 0, 0),
+    'max44009': (100, 0, 1, 0, 0),
+    'si7021': (200, 0, 12, 1800, 0),
+    'vl53l0x': (300, 0, 33, 627000, 0),
+    'lsm9ds1': (0, 10, 1, 0, 1),
+    'battery': (400, 0, 1, 0, 0),
+    'icm20602': (25, 10, 1, 0, 1),
+}
+
+DEFAULT_PERIODS = {'bme680': 3000, 'max44009': 1000, 'si7021': 5000, 'vl53l0x': 1000,
+                   'lsm9ds1': 50, 'battery': 60000, 'icm20602': 50}
+
+LOW_POWER_PERIODS = dict(DEFAULT_PERIODS, lsm9ds1=1000, icm20602=1000, vl53l0x=5000)
+
+# name: (periods, BSEC running, domain cycling)
+CONFIGURATIONS = {
+    'default': (DEFAULT_PERIODS, True, False),
+    'low_power': (LOW_POWER_PERIODS, True, True),
+    'low_power_no_bsec': (LOW_POWER_PERIODS, False, True),
+    'slow_logging': ({'bme680': 60000, 'max44009': 60000, 'si7021': 60000, 'vl53l0x': 60000,
+                      'lsm9ds1': 60000, 'battery': 60000, 'icm20602': 60000}, False, True),
+}
+
+NEVER = float('inf')
+
+
+def ms(x):
+    return int(x * 1000)
+
+
+class Task:
+    def __init__(self, name, period_ms, offset_ms, deadline_ms, runtime_ms, charge_nc, busy_ms):
+        self.name = name
+        self.period = ms(period_ms)
+        self.deadline = ms(deadline_ms or period_ms)
+        self.release = ms(offset_ms)
+        self.runtime = ms(runtime_ms)
+        self.charge_nc = charge_nc
+        self.busy = ms(busy_ms)
+        self.active = True
+        self.runs = 0
+        self.max_lateness = 0
+        self.misses = 0
+
+
+class Device:
+    def __init__(self, name, wake_ms, active_ua, low_power_ua):
+        self.name = name
+        self.wake = ms(wake_ms + WAKE_MARGIN_MS)
+        self.wake_ms = ms(wake_ms)
+        self.active_ua = active_ua
+        self.low_power_ua = low_power_ua
+        self.low_power = False
+        self.awake_since = -NEVER
+        self.low_power_us = 0
+        self.entries = 0
+
+
+class Simulation:
+    def __init__(self, periods, bsec, cycling, reinit_ms, log):
+        self.now = 0
+        self.tasks = {}
+        for name, (offset, deadline, runtime, charge, busy) in TASKS.items():
+            self.tasks[name] = Task(name, periods[name], offset, deadline, runtime, charge, busy)
+        self.pinned = bsec
+        self.domain_tasks = [t for n, t in self.tasks.items() if n != 'battery']
+        self.devices = {n: Device(n, *DEVICES[n]) for n in DEVICES}
+        self.cycling = cycling
+        self.reinit = ms(reinit_ms)
+        self.max_reinit = ms(SENSOR_REINIT_MS)
+        self.domain_on = True
+        self.ready_at = 0
+        self.busy_until = 0
+        self.cycles = 0
+        self.off_us = 0
+        self.charge_pc = 0
+        self.last_account = 0
+        self.violations = []
+        self.log = log
+
+    # SensorPowerManager
+
+    def lead(self):
+        return ms(SENSOR_POWER_UP_MS + SENSOR_SETTLE_MS + WAKE_MARGIN_MS) + self.max_reinit
+
+    def current_ua(self):
+        if not self.domain_on:
+            return DOMAIN_OFF_UA
+        return DOMAIN_ON_UA + sum(d.low_power_ua if d.low_power else d.active_ua
+                                  for d in self.devices.values())
+
+    def account(self, now):
+        if now <= self.last_account:
+            return
+        elapsed = now - self.last_account
+        self.charge_pc += self.current_ua() * elapsed
+        if not self.domain_on:
+            self.off_us += elapsed
+        for d in self.devices.values():
+            if d.low_power:
+                d.low_power_us += elapsed
+        self.last_account = now
+
+    def next_domain_release(self):
+        return min((t.release for t in self.domain_tasks if t.active), default=NEVER)
+
+    def device_can_sleep(self, device, now):
+        if device.low_power:
+            return False
+        release = self.tasks[device.name].release
+        return release == NEVER or release >= now + device.wake + ms(MIN_OFF_MS)
+
+    def set_low_power(self, device, low_power, now):
+        self.account(now)
+        device.low_power = low_power
+        if low_power:
+            device.entries += 1
+        else:
+            device.awake_since = now
+        self.trace(now, '%s %s' % (device.name, 'low power' if low_power else 'awake'))
+
+    def enter_idle(self, now, next_release):
+        self.account(now)
+        domain_release = self.next_domain_release()
+        if not self.domain_on:
+            return min(next_release, max(domain_release - self.lead(), 0))
+
+        cut = (self.cycling and not self.pinned and
+               domain_release >= now + self.lead() + ms(MIN_OFF_MS))
+        sleep = any(self.device_can_sleep(d, now) for d in self.devices.values())
+        if (cut or sleep) and now < self.busy_until:
+            return min(next_release, now + ms(BUSY_RETRY_MS))
+
+        if cut:
+            self.account(now)
+            for d in self.devices.values():
+                d.low_power = False
+            self.domain_on = False
+            self.cycles += 1
+            self.trace(now, 'domain off')
+            return min(next_release, max(domain_release - self.lead(), 0))
+
+        wakeup = next_release
+        for d in self.devices.values():
+            if self.device_can_sleep(d, now):
+                self.set_low_power(d, True, now)
+            if d.low_power:
+                wakeup = min(wakeup, max(self.tasks[d.name].release - d.wake, 0))
+        return wakeup
+
+    def exit_idle(self, now):
+        if not self.domain_on:
+            if now >= self.next_domain_release() - self.lead():
+                self.power_up(now)
+            return
+        for d in self.devices.values():
+            if d.low_power and now >= self.tasks[d.name].release - d.wake:
+                self.set_low_power(d, False, now)
+
+    def power_up(self, now):
+        self.account(now)
+        self.domain_on = True
+        self.trace(now, 'domain on')
+        # Blocking power-up and re-init, the devices come up awake
+        self.now = now + ms(SENSOR_POWER_UP_MS) + self.reinit
+        self.max_reinit = max(self.max_reinit, self.reinit)
+        self.ready_at = self.now + ms(SENSOR_SETTLE_MS)
+        for d in self.devices.values():
+            d.awake_since = now + ms(SENSOR_POWER_UP_MS)
+
+    # SensorScheduler
+
+    def run_pending(self):
+        while True:
+            due = [t for t in self.tasks.values() if t.active and t.release <= self.now]
+            if not due:
+                return
+            task = min(due, key=lambda t: t.release + t.deadline)
+            self.execute(task)
+
+    def execute(self, task):
+        start = self.now
+        release = task.release
+        self.check(task, start)
+        task.release += task.period
+        while task.release <= start:
+            task.release += task.period
+        self.now += task.runtime
+        if task.busy:
+            self.busy_until = self.now + task.busy
+        task.runs += 1
+        task.max_lateness = max(task.max_lateness, start - release)
+        if self.now > release + task.deadline:
+            task.misses += 1
+
+    def check(self, task, now):
+        if task not in self.domain_tasks:
+            return
+        if not self.domain_on:
+            self.violate(now, '%s ran with the domain off' % task.name)
+        elif now < self.ready_at:
+            self.violate(now, '%s ran %d us before the sensors settled' % (task.name, self.ready_at - now))
+        device = self.devices.get(task.name)
+        if device is not None:
+            if device.low_power:
+                self.violate(now, '%s read while in low power mode' % task.name)
+            elif now - device.awake_since < device.wake_ms:
+                self.violate(now, '%s read %d us after waking' % (task.name, now - device.awake_since))
+
+    def violate(self, now, what):
+        self.violations.append((now, what))
+        self.trace(now, 'VIOLATION ' + what)
+
+    def trace(self, now, what):
+        if self.log:
+            sys.stdout.write('%12.3f ms  %s\n' % (now / 1000.0, what))
+
+    def run(self, duration_s):
+        end = duration_s * 1000000
+        while self.now < end:
+            self.run_pending()
+            next_release = min(t.release for t in self.tasks.values() if t.active)
+            wakeup = min(next_release, self.enter_idle(self.now, next_release))
+            if wakeup > self.now:
+                # RtosSchedulerClock rounds sleeps up to whole milliseconds
+                self.now += -(-(wakeup - self.now) // 1000) * 1000
+            self.exit_idle(self.now)
+        self.account(self.now)
+
+    def average_ua(self):
+        charge = self.charge_pc + sum(t.runs * t.charge_nc * 1000 for t in self.tasks.values())
+        return charge / float(self.now)
+
+
+def report(name, sim):
+    print('%s:' % name)
+    for task in sim.tasks.values():
+        print('  %-10s %7d runs, %4d misses, max lateness %6d us' %
+              (task.name, task.runs, task.misses, task.max_lateness))
+    print('  domain off %.2f%%, %d power cycles' % (100.0 * sim.off_us / sim.now, sim.cycles))
+    for d in sim.devices.values():
+        print('  %-10s low power %.2f%%, entered %d times' %
+              (d.name, 100.0 * d.low_power_us / sim.now, d.entries))
+    print('  estimated average %.0f uA' % sim.average_ua())
+    for now, what in sim.violations[:10]:
+        print('  VIOLATION at %.3f ms: %s' % (now / 1000.0, what))
+    if len(sim.violations) > 10:
+        print('  ... %d more' % (len(sim.violations) - 10))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Simulate the sensor power states of poll configurations')
+    parser.add_argument('configs', nargs='*',
+                        help='Configurations to simulate: %s (default: all)' % ', '.join(sorted(CONFIGURATIONS)))
+    parser.add_argument('-t', '--time', type=float, default=600.0, help='Simulated seconds')
+    parser.add_argument('--reinit-ms', type=float, default=SENSOR_REINIT_MS,
+                        help='Re-init time after a power cycle (the manager learns it)')
+    parser.add_argument('-l', '--log', action='store_true', help='Print every power state transition')
+    args = parser.parse_args()
+    for name in args.configs:
+        if name not in CONFIGURATIONS:
+            parser.error('unknown configuration %s' % name)
+
+    failed = False
+    for name in args.configs or sorted(CONFIGURATIONS):
+        periods, bsec, cycling = CONFIGURATIONS[name]
+        sim = Simulation(periods, bsec, cycling, args.reinit_ms, args.log)
+        sim.run(args.time)
+        report(name, sim)
+        failed |= bool(sim.violations)
+
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()
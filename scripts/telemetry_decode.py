@@ -0,0 +1,219 @@
+#!python
+"""
+Convert EP Agora binary sensor telemetry to CSV
+
+The frame format is described in sensor_telemetry.h. Reads a raw capture of
+the console UART, or switches telemetry on over the serial port ('t' on the
+console) and records it for a while. Writes one CSV per sensor, or every
+value in long format (time, sensor, field, value) to stdout.
+"""
+import argparse
+import csv
+import struct
+import sys
+import time
+
+CONSOLE_BAUD = 9600
+TELEMETRY_BAUD = 230400
+
+HEADER_FORMAT = '<BBI'
+HEADER_SIZE = struct.calcsize(HEADER_FORMAT)
+CRC_SIZE = 2
+
+# telemetry_record_type_t: name, struct format, field names
+RECORDS = {
+    1: ('bme680', '<7fB', ['temperature_c', 'pressure_pa', 'humidity_rh', 'gas_resistance_ohm',
+                           'co2_ppm', 'breath_voc_ppm', 'iaq_score', 'iaq_accuracy']),
+    2: ('max44009', '<f', ['lux']),
+    3: ('si7021', '<iI', ['temperature_centi_c', 'humidity_centi_rh']),
+    4: ('vl53l0x', '<IBH', ['distance_mm', 'range_status', 'signal_rate_mcps_x128']),
+    5: ('lsm9ds1', '<B9f', ['valid_mask', 'accel_x_g', 'accel_y_g', 'accel_z_g',
+                            'gyro_x_dps', 'gyro_y_dps', 'gyro_z_dps',
+                            'mag_x_gauss', 'mag_y_gauss', 'mag_z_gauss']),
+    6: ('icm20602', '<6f', ['accel_x_g', 'accel_y_g', 'accel_z_g',
+                            'gyro_x_dps', 'gyro_y_dps', 'gyro_z_dps']),
+    7: ('battery', '<f', ['voltage_v']),
+}
+
+
+def cobs_decode(data):
+    out = bytearray()
+    index = 0
+    while index < len(data):
+        code = data[index]
+        if code == 0 or index + code > len(data):
+            return None
+        out += data[index + 1:index + code]
+        index += code
+        if code != 0xFF and index != len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+class TelemetryDecoder:
+    """Splits the byte stream on delimiters and unpacks the frames"""
+
+    def __init__(self, sink):
+        self.sink = sink
+        self.buffer = bytearray()
+        self.last_raw = None
+        self.time_us = 0
+        self.sequence = None
+        self.frames = 0
+        self.lost = 0
+        self.bad = 0
+
+    def feed(self, data):
+        self.buffer += data
+        while True:
+            end = self.buffer.find(b'\x00')
+            if end < 0:
+                return
+            frame = bytes(self.buffer[:end])
+            del self.buffer[:end + 1]
+            if frame:
+                self.decode(frame)
+
+    def decode(self, encoded):
+        frame = cobs_decode(encoded)
+        if frame is None or len(frame) < HEADER_SIZE + CRC_SIZE:
+            # Console text between frames ends up here as well
+            self.bad += 1
+            return
+
+        crc, = struct.unpack_from('<H', frame, len(frame) - CRC_SIZE)
+        if crc16_ccitt(frame[:-CRC_SIZE]) != crc:
+            self.bad += 1
+            return
+
+        record_type, sequence, raw_us = struct.unpack_from(HEADER_FORMAT, frame)
+        record = RECORDS.get(record_type)
+        if record is None:
+            self.bad += 1
+            return
+        name, fmt, fields = record
+        payload = frame[HEADER_SIZE:-CRC_SIZE]
+        if len(payload) != struct.calcsize(fmt):
+            self.bad += 1
+            return
+
+        if self.sequence is not None:
+            self.lost += (sequence - self.sequence - 1) & 0xFF
+        self.sequence = sequence
+
+        # Microsecond timestamps wrap every 71 minutes
+        if self.last_raw is not None:
+            self.time_us += (raw_us - self.last_raw) & 0xFFFFFFFF
+        self.last_raw = raw_us
+
+        self.frames += 1
+        self.sink.write(self.time_us / 1e6, name, fields, struct.unpack(fmt, payload))
+
+
+class LongCsvSink:
+    """time, sensor, field, value rows on a single stream"""
+
+    def __init__(self, out):
+        self.writer = csv.writer(out)
+        self.writer.writerow(['time_s', 'sensor', 'field', 'value'])
+
+    def write(self, time_s, name, fields, values):
+        for field, value in zip(fields, values):
+            self.writer.writerow(['%.6f' % time_s, name, field, value])
+
+    def close(self):
+        pass
+
+
+class SplitCsvSink:
+    """One file per sensor, one row per reading"""
+
+    def __init__(self, prefix):
+        self.prefix = prefix
+        self.files = {}
+
+    def write(self, time_s, name, fields, values):
+        if name not in self.files:
+            f = open('%s_%s.csv' % (self.prefix, name), 'w', newline='')
+            writer = csv.writer(f)
+            writer.writerow(['time_s'] + fields)
+            self.files[name] = (f, writer)
+        self.files[name][1].writerow(['%.6f' % time_s] + list(values))
+
+    def close(self):
+        for f, _ in self.files.values():
+            f.close()
+
+
+def record_serial(port, console_baud, telemetry_baud, duration, decoder, raw_out):
+    import serial
+
+    with serial.Serial(port, console_baud, timeout=0.1) as link:
+        link.write(b't')
+        link.flush()
+        # Let the acknowledgment go out before the device changes baud rate
+        time.sleep(0.2)
+        link.baudrate = telemetry_baud
+        link.reset_input_buffer()
+
+        end = time.time() + duration
+        try:
+            while time.time() < end:
+                data = link.read(4096)
+                if data:
+                    if raw_out:
+                        raw_out.write(data)
+                    decoder.feed(data)
+        except KeyboardInterrupt:
+            pass
+        finally:
+            link.write(b't')
+            link.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert EP Agora binary sensor telemetry to CSV')
+    parser.add_argument('input', nargs='?', help='Raw capture of the console UART (defaults to stdin)')
+    parser.add_argument('-p', '--port', help='Record from this serial port instead')
+    parser.add_argument('-d', '--duration', type=float, default=10.0, help='Seconds to record for')
+    parser.add_argument('--console-baud', type=int, default=CONSOLE_BAUD, help='Console baud rate')
+    parser.add_argument('--telemetry-baud', type=int, default=TELEMETRY_BAUD,
+                        help='Baud rate while telemetry is on (TELEMETRY_BAUD_RATE)')
+    parser.add_argument('-r', '--raw', help='Also save the raw stream to this file')
+    parser.add_argument('-o', '--output', help='Write <OUTPUT>_<sensor>.csv files instead of long CSV to stdout')
+    args = parser.parse_args()
+
+    sink = SplitCsvSink(args.output) if args.output else LongCsvSink(sys.stdout)
+    decoder = TelemetryDecoder(sink)
+
+    try:
+        if args.port:
+            raw_out = open(args.raw, 'wb') if args.raw else None
+            try:
+                record_serial(args.port, args.console_baud, args.telemetry_baud, args.duration,
+                              decoder, raw_out)
+            finally:
+                if raw_out:
+                    raw_out.close()
+        elif args.input:
+            with open(args.input, 'rb') as f:
+                decoder.feed(f.read())
+        else:
+            decoder.feed(sys.stdin.buffer.read())
+    finally:
+        sink.close()
+
+    sys.stderr.write('%d frames, %d lost, %d rejected\n' % (decoder.frames, decoder.lost, decoder.bad))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,217 @@
+#!python
+"""
+Per-stage latency histograms from an EP Agora trace dump
+
+Reads the output of the 'd' console command (see trace.h) from a capture of
+the debug UART, or fetches it directly from the serial port. Every dump in the
+input is decoded and the results are combined.
+
+Stages:
+  - duration of every begin/end pair, per event and argument
+    (each sensor poll task, each I2C address, BLE event processing, ...)
+  - queueing latency from an I2C submission to the start of its transfer
+  - queueing latency from the BLE stack scheduling its events to processing them
+"""
+import argparse
+import math
+import re
+import sys
+from collections import defaultdict, deque
+
+DUMP_BEGIN = re.compile(r'trace: begin (\d+) (\d+) (\d+)')
+DUMP_END = re.compile(r'trace: end')
+LABEL = re.compile(r'trace: label (\w+) ([0-9a-fA-F]+) (.+)')
+EVENT = re.compile(r'T ([0-9a-fA-F]{8}) (\w+) ([IBE?]) ([0-9a-fA-F]+)')
+
+# Instant event -> begin event it is queued in front of, matched first in first out per argument
+QUEUES = {
+    'i2c_submit': 'i2c_transfer',
+    'ble_schedule': 'ble_process',
+}
+
+
+class Histogram:
+    """Power of two buckets in microseconds"""
+
+    def __init__(self):
+        self.values = []
+
+    def add(self, us):
+        self.values.append(us)
+
+    def percentile(self, p):
+        ordered = sorted(self.values)
+        index = min(len(ordered) - 1, int(math.ceil(p / 100.0 * len(ordered))) - 1)
+        return ordered[max(0, index)]
+
+    def print(self, name, out, width=40):
+        values = self.values
+        out.write('%s: %d samples, min %.1f us, p50 %.1f us, p99 %.1f us, max %.1f us\n' % (
+            name, len(values), min(values), self.percentile(50), self.percentile(99), max(values)))
+
+        buckets = defaultdict(int)
+        for value in values:
+            buckets[0 if value < 1 else int(math.log2(value)) + 1] += 1
+
+        peak = max(buckets.values())
+        for bucket in range(min(buckets), max(buckets) + 1):
+            low = 0 if bucket == 0 else 2 ** (bucket - 1)
+            count = buckets.get(bucket, 0)
+            bar = '#' * int(math.ceil(count * width / peak)) if count else ''
+            out.write('  %8d us | %-*s %d\n' % (low, width, bar, count))
+        out.write('\n')
+
+
+class DumpDecoder:
+    """Pairs the events of one dump and adds the durations to the stages"""
+
+    def __init__(self, stages, labels, hz):
+        self.stages = stages
+        self.labels = labels
+        self.hz = hz
+        self.last_raw = None
+        self.now = 0
+        self.open = {}                      # (event, arg) -> begin time
+        self.queued = defaultdict(deque)    # (begin event, arg) -> instant times
+        self.unmatched = 0
+
+    def stage_name(self, event, arg):
+        label = self.labels.get((event, arg))
+        if label is not None:
+            return '%s %s' % (event, label)
+        if event.startswith('i2c'):
+            return '%s 0x%02X' % (event, arg)
+        if event == 'poll':
+            return '%s %d' % (event, arg)
+        return event
+
+    def add(self, stage, ticks):
+        self.stages[stage].add(ticks * 1e6 / self.hz)
+
+    def feed(self, raw, event, phase, arg):
+        # Events are in ring order, small steps backwards come from preemption
+        if self.last_raw is not None:
+            delta = (raw - self.last_raw) & 0xFFFFFFFF
+            if delta & 0x80000000:
+                delta -= 1 << 32
+            self.now += delta
+        self.last_raw = raw
+        now = self.now
+
+        if phase == 'I':
+            if event in QUEUES:
+                self.queued[(QUEUES[event], arg)].append(now)
+            return
+
+        key = (event, arg)
+        if phase == 'B':
+            queue = self.queued.get(key)
+            if queue:
+                self.add('%s wait' % self.stage_name(event, arg), now - queue.popleft())
+            if key in self.open:
+                self.unmatched += 1
+            self.open[key] = now
+        elif phase == 'E':
+            start = self.open.pop(key, None)
+            if start is None:
+                # Began before the oldest event still in the ring
+                self.unmatched += 1
+                return
+            self.add(self.stage_name(event, arg), now - start)
+
+
+def decode(lines, out):
+    stages = defaultdict(Histogram)
+    labels = {}
+    decoder = None
+    dumps = 0
+    overwritten = 0
+    unmatched = 0
+
+    for line in lines:
+        line = line.strip()
+
+        match = LABEL.search(line)
+        if match:
+            labels[(match.group(1), int(match.group(2), 16))] = match.group(3)
+            continue
+
+        match = DUMP_BEGIN.search(line)
+        if match:
+            decoder = DumpDecoder(stages, labels, int(match.group(3)))
+            overwritten += int(match.group(2))
+            dumps += 1
+            continue
+
+        if decoder is None:
+            continue
+
+        if DUMP_END.search(line):
+            unmatched += decoder.unmatched
+            decoder = None
+            labels = {}
+            continue
+
+        match = EVENT.search(line)
+        if match:
+            decoder.feed(int(match.group(1), 16), match.group(2), match.group(3), int(match.group(4), 16))
+
+    if dumps == 0:
+        sys.stderr.write('no trace dump found\n')
+        return False
+
+    out.write('%d dump(s), %d events overwritten before dumping, %d unmatched begin/end\n\n' % (
+        dumps, overwritten, unmatched))
+    for name in sorted(stages):
+        stages[name].print(name, out)
+    return True
+
+
+def read_serial(port, baud, timeout):
+    import serial
+
+    with serial.Serial(port, baud, timeout=timeout) as link:
+        link.reset_input_buffer()
+        link.write(b'd')
+        lines = []
+        while True:
+            line = link.readline()
+            if not line:
+                sys.stderr.write('timed out waiting for the end of the dump\n')
+                break
+            line = line.decode('ascii', errors='replace')
+            lines.append(line)
+            if DUMP_END.search(line):
+                break
+        return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Latency histograms from an EP Agora trace dump')
+    parser.add_argument('input', nargs='?', help='Captured console output (defaults to stdin)')
+    parser.add_argument('-p', '--port', help='Request a dump from this serial port instead')
+    parser.add_argument('-b', '--baud', type=int, default=9600, help='Serial port baud rate')
+    parser.add_argument('-t', '--timeout', type=float, default=5.0, help='Serial read timeout in seconds')
+    parser.add_argument('-o', '--output', help='File to write the histograms to (defaults to stdout)')
+    args = parser.parse_args()
+
+    if args.port:
+        lines = read_serial(args.port, args.baud, args.timeout)
+    elif args.input:
+        with open(args.input, errors='replace') as f:
+            lines = f.readlines()
+    else:
+        lines = sys.stdin.readlines()
+
+    out = open(args.output, 'w') if args.output else sys.stdout
+    try:
+        ok = decode(lines, out)
+    finally:
+        if args.output:
+            out.close()
+
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,373 @@
+/*
+ * sensor_broadcast.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "sensor_broadcast.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ble/gap/AdvertisingDataBuilder.h"
+#include "ble/gap/AdvertisingParameters.h"
+
+#include "gatt_units.h"
+
+/** Company ID in front of the pages */
+#define MANUFACTURER_DATA_HEADER_SIZE 2
+
+/** Extended payload: flags, manufacturer data (company ID and every page) and the name */
+#define EXTENDED_PAYLOAD_SIZE 64
+
+/** Body offsets, see sensor_broadcast.h */
+#define ENV_TEMP			0
+#define ENV_HUMIDITY		2
+#define ENV_PRESSURE		4
+#define ENV_IAQ_SCORE		8
+#define ENV_IAQ_ACCURACY	10
+#define ENV_CO2				11
+#define ENV_BVOC			13
+#define ENV_BATTERY			15
+
+#define MOTION_TEMP			0
+#define MOTION_HUMIDITY		2
+#define MOTION_ALS			4
+#define MOTION_DISTANCE		8
+#define MOTION_ACCEL		10
+
+static void put_u16(uint8_t* p, uint16_t value) {
+	p[0] = (uint8_t) (value & 0xFF);
+	p[1] = (uint8_t) (value >> 8);
+}
+
+static void put_u32(uint8_t* p, uint32_t value) {
+	put_u16(p, (uint16_t) (value & 0xFFFF));
+	put_u16(p + 2, (uint16_t) (value >> 16));
+}
+
+/** Write a field, true if it changed */
+static bool set_u16(uint8_t* p, uint16_t value) {
+	uint8_t encoded[2];
+	put_u16(encoded, value);
+	if(memcmp(p, encoded, sizeof(encoded)) == 0) {
+		return false;
+	}
+	memcpy(p, encoded, sizeof(encoded));
+	return true;
+}
+
+static bool set_u32(uint8_t* p, uint32_t value) {
+	uint8_t encoded[4];
+	put_u32(encoded, value);
+	if(memcmp(p, encoded, sizeof(encoded)) == 0) {
+		return false;
+	}
+	memcpy(p, encoded, sizeof(encoded));
+	return true;
+}
+
+static bool set_u8(uint8_t* p, uint8_t value) {
+	if(*p == value) {
+		return false;
+	}
+	*p = value;
+	return true;
+}
+
+/** Unknown values: 0x8000 for the signed fields, all ones otherwise */
+static void init_environment(uint8_t* body) {
+	memset(body, 0xFF, SENSOR_BROADCAST_ENVIRONMENT_SIZE);
+	put_u16(&body[ENV_TEMP], 0x8000);
+}
+
+static void init_motion(uint8_t* body) {
+	memset(body, 0xFF, SENSOR_BROADCAST_MOTION_SIZE);
+	put_u16(&body[MOTION_TEMP], 0x8000);
+	for(int i = 0; i < 3; i++) {
+		put_u16(&body[MOTION_ACCEL + 2*i], 0x8000);
+	}
+}
+
+SensorBroadcast::SensorBroadcast(events::EventQueue& queue) :
+	queue(queue),
+	ble(NULL),
+	legacy_payload_cb(),
+	enabled(false),
+	tick_event(0),
+	environment(),
+	motion(),
+	icm20602_accel(false),
+	legacy_page(SENSOR_BROADCAST_PAGE_ENVIRONMENT),
+	legacy_updates(0),
+	extended(false),
+	periodic(false),
+	extended_handle(ble::INVALID_ADVERTISING_HANDLE),
+	extended_dirty(false),
+	extended_updates(0) {
+	environment[0] = (uint8_t) ((SENSOR_BROADCAST_VERSION << 4) | SENSOR_BROADCAST_PAGE_ENVIRONMENT);
+	motion[0] = (uint8_t) ((SENSOR_BROADCAST_VERSION << 4) | SENSOR_BROADCAST_PAGE_MOTION);
+	init_environment(&environment[SENSOR_BROADCAST_HEADER_SIZE]);
+	init_motion(&motion[SENSOR_BROADCAST_HEADER_SIZE]);
+}
+
+SensorBroadcast::~SensorBroadcast() {
+	if(tick_event != 0) {
+		queue.cancel(tick_event);
+	}
+}
+
+void SensorBroadcast::start(BLE& ble) {
+	this->ble = &ble;
+
+	if(enabled) {
+		enabled = false;
+		set_enabled(true);
+	}
+}
+
+void SensorBroadcast::set_enabled(bool enabled) {
+	if(enabled == this->enabled) {
+		return;
+	}
+
+	this->enabled = enabled;
+	printf("broadcast: %s\r\n", enabled? "on" : "off");
+
+	if(ble == NULL) {
+		// Applied by start()
+		return;
+	}
+
+	if(enabled) {
+		legacy_page = SENSOR_BROADCAST_PAGE_ENVIRONMENT;
+		start_extended();
+		tick();
+		tick_event = queue.call_every(SENSOR_BROADCAST_PAGE_INTERVAL_MS, this, &SensorBroadcast::tick);
+		return;
+	}
+
+	if(tick_event != 0) {
+		queue.cancel(tick_event);
+		tick_event = 0;
+	}
+	stop_extended();
+	if(legacy_payload_cb) {
+		legacy_payload_cb(NULL, 0);
+	}
+}
+
+void SensorBroadcast::update(const sensor_sample_t& sample) {
+	uint8_t* env = &environment[SENSOR_BROADCAST_HEADER_SIZE];
+	uint8_t* mot = &motion[SENSOR_BROADCAST_HEADER_SIZE];
+	bool env_changed = false;
+	bool motion_changed = false;
+
+	switch(sample.channel) {
+	case SENSOR_CHANNEL_BME680_TEMP:
+		env_changed = set_u16(&env[ENV_TEMP], (uint16_t) (int16_t) sample.value.i32);
+		break;
+	case SENSOR_CHANNEL_BME680_HUMIDITY:
+		env_changed = set_u16(&env[ENV_HUMIDITY], (uint16_t) sample.value.u32);
+		break;
+	case SENSOR_CHANNEL_BME680_PRESSURE:
+		env_changed = set_u32(&env[ENV_PRESSURE], sample.value.u32);
+		break;
+	case SENSOR_CHANNEL_BME680_IAQ_SCORE:
+		env_changed = set_u16(&env[ENV_IAQ_SCORE], (uint16_t) sample.value.u32);
+		break;
+	case SENSOR_CHANNEL_BME680_IAQ_ACCURACY:
+		env_changed = set_u8(&env[ENV_IAQ_ACCURACY], (uint8_t) sample.value.u32);
+		break;
+	case SENSOR_CHANNEL_BME680_CO2:
+		env_changed = set_u16(&env[ENV_CO2], Co2FromPpm::from_float(sample.value.f));
+		break;
+	case SENSOR_CHANNEL_BME680_BVOC:
+		env_changed = set_u16(&env[ENV_BVOC], VocPpbFromPpm::from_float(sample.value.f));
+		break;
+	case SENSOR_CHANNEL_BATTERY_VOLTAGE:
+		env_changed = set_u16(&env[ENV_BATTERY], MillivoltFromVolt::from_float(sample.value.f));
+		break;
+	case SENSOR_CHANNEL_SI7021_TEMP:
+		motion_changed = set_u16(&mot[MOTION_TEMP], (uint16_t) (int16_t) sample.value.i32);
+		break;
+	case SENSOR_CHANNEL_SI7021_HUMIDITY:
+		motion_changed = set_u16(&mot[MOTION_HUMIDITY], (uint16_t) sample.value.u32);
+		break;
+	case SENSOR_CHANNEL_MAX44009_ALS:
+		motion_changed = set_u32(&mot[MOTION_ALS], LuxHundredthsFromLux::from_float(sample.value.f));
+		break;
+	case SENSOR_CHANNEL_VL53L0X_DISTANCE:
+		motion_changed = set_u16(&mot[MOTION_DISTANCE], (uint16_t) sample.value.u32);
+		break;
+	case SENSOR_CHANNEL_ICM20602_ACCEL:
+	case SENSOR_CHANNEL_LSM9DS1_ACCEL:
+		if(sample.channel == SENSOR_CHANNEL_ICM20602_ACCEL) {
+			icm20602_accel = true;
+		} else if(icm20602_accel) {
+			// The ICM20602 is the better accelerometer, the LSM9DS1 fills in without it
+			break;
+		}
+		for(int i = 0; i < 3; i++) {
+			motion_changed |= set_u16(&mot[MOTION_ACCEL + 2*i],
+					(uint16_t) MilliGFromG::from_float(sample.value.vec3[i]));
+		}
+		break;
+	default:
+		break;
+	}
+
+	if(env_changed) {
+		page_changed(SENSOR_BROADCAST_PAGE_ENVIRONMENT);
+	}
+	if(motion_changed) {
+		page_changed(SENSOR_BROADCAST_PAGE_MOTION);
+	}
+}
+
+size_t SensorBroadcast::get_page(sensor_broadcast_page_t page, uint8_t* out, size_t size) const {
+	const uint8_t* data = (page == SENSOR_BROADCAST_PAGE_ENVIRONMENT)? environment : motion;
+	size_t len = (page == SENSOR_BROADCAST_PAGE_ENVIRONMENT)? sizeof(environment) : sizeof(motion);
+	if(size < len) {
+		return 0;
+	}
+
+	memcpy(out, data, len);
+	return len;
+}
+
+void SensorBroadcast::print_stats(void) {
+	printf("broadcast: %s, %lu legacy page updates, extended %s%s, %lu updates\r\n",
+			enabled? "on" : "off", (unsigned long) legacy_updates,
+			extended? "on" : "not supported/off", periodic? " with periodic" : "",
+			(unsigned long) extended_updates);
+}
+
+void SensorBroadcast::tick(void) {
+	if(!enabled) {
+		return;
+	}
+
+	// Legacy PDUs fit one page, scanners see them all over a rotation
+	uint8_t data[MANUFACTURER_DATA_HEADER_SIZE + SENSOR_BROADCAST_MAX_PAGE_SIZE];
+	put_u16(data, SENSOR_BROADCAST_COMPANY_ID);
+	size_t len = get_page(legacy_page, &data[MANUFACTURER_DATA_HEADER_SIZE],
+			sizeof(data) - MANUFACTURER_DATA_HEADER_SIZE);
+	legacy_page = (sensor_broadcast_page_t) ((legacy_page + 1) % SENSOR_BROADCAST_PAGE_COUNT);
+
+	if(legacy_payload_cb && legacy_payload_cb(data, MANUFACTURER_DATA_HEADER_SIZE + len)) {
+		legacy_updates++;
+	}
+
+	if(extended_dirty) {
+		refresh_extended();
+	}
+}
+
+void SensorBroadcast::start_extended(void) {
+	Gap& gap = ble->gap();
+
+	if(!gap.isFeatureSupported(ble::controller_supported_features_t::LE_EXTENDED_ADVERTISING)) {
+		return;
+	}
+
+	if(extended_handle == ble::INVALID_ADVERTISING_HANDLE) {
+		ble::AdvertisingParameters params(ble::advertising_type_t::NON_CONNECTABLE_UNDIRECTED,
+				ble::adv_interval_t(SENSOR_BROADCAST_EXT_INTERVAL));
+		params.setUseLegacyPDU(false);
+
+		ble_error_t error = gap.createAdvertisingSet(&extended_handle, params);
+		if(error) {
+			printf("broadcast: creating the extended advertising set failed - 0x%X\r\n", error);
+			extended_handle = ble::INVALID_ADVERTISING_HANDLE;
+			return;
+		}
+	}
+
+	extended_dirty = true;
+	refresh_extended();
+
+	ble_error_t error = gap.startAdvertising(extended_handle);
+	if(error) {
+		printf("broadcast: extended advertising failed - 0x%X\r\n", error);
+		return;
+	}
+	extended = true;
+
+	if(!gap.isFeatureSupported(ble::controller_supported_features_t::LE_PERIODIC_ADVERTISING)) {
+		return;
+	}
+
+	error = gap.setPeriodicAdvertisingParameters(extended_handle,
+			ble::periodic_interval_t(SENSOR_BROADCAST_PERIODIC_INTERVAL),
+			ble::periodic_interval_t(SENSOR_BROADCAST_PERIODIC_INTERVAL));
+	if(!error) {
+		periodic = true;
+		refresh_extended();
+		error = gap.startPeriodicAdvertising(extended_handle);
+	}
+	if(error) {
+		printf("broadcast: periodic advertising failed - 0x%X\r\n", error);
+		periodic = false;
+	}
+}
+
+void SensorBroadcast::stop_extended(void) {
+	if(extended_handle == ble::INVALID_ADVERTISING_HANDLE) {
+		return;
+	}
+
+	Gap& gap = ble->gap();
+	if(periodic) {
+		gap.stopPeriodicAdvertising(extended_handle);
+		periodic = false;
+	}
+	if(extended) {
+		gap.stopAdvertising(extended_handle);
+		extended = false;
+	}
+}
+
+void SensorBroadcast::refresh_extended(void) {
+	if(extended_handle == ble::INVALID_ADVERTISING_HANDLE) {
+		return;
+	}
+	extended_dirty = false;
+
+	// Every page in one manufacturer data structure
+	uint8_t pages[MANUFACTURER_DATA_HEADER_SIZE + SENSOR_BROADCAST_ALL_PAGES_SIZE];
+	put_u16(pages, SENSOR_BROADCAST_COMPANY_ID);
+	size_t len = MANUFACTURER_DATA_HEADER_SIZE;
+	len += get_page(SENSOR_BROADCAST_PAGE_ENVIRONMENT, &pages[len], sizeof(pages) - len);
+	len += get_page(SENSOR_BROADCAST_PAGE_MOTION, &pages[len], sizeof(pages) - len);
+	mbed::Span<const uint8_t> manufacturer_data(pages, len);
+
+	Gap& gap = ble->gap();
+
+	uint8_t buffer[EXTENDED_PAYLOAD_SIZE];
+	ble::AdvertisingDataBuilder builder(buffer, sizeof(buffer));
+	builder.setFlags(ble::adv_data_flags_t::BREDR_NOT_SUPPORTED);
+	builder.setManufacturerSpecificData(manufacturer_data);
+	builder.setName("EP Agora");
+
+	ble_error_t error = gap.setAdvertisingPayload(extended_handle, builder.getAdvertisingData());
+	if(error) {
+		printf("broadcast: extended payload update failed - 0x%X\r\n", error);
+		return;
+	}
+	extended_updates++;
+
+	if(periodic) {
+		// Periodic advertising carries no flags or name
+		uint8_t periodic_buffer[EXTENDED_PAYLOAD_SIZE];
+		ble::AdvertisingDataBuilder periodic_builder(periodic_buffer, sizeof(periodic_buffer));
+		periodic_builder.setManufacturerSpecificData(manufacturer_data);
+		gap.setPeriodicAdvertisingPayload(extended_handle, periodic_builder.getAdvertisingData());
+	}
+}
+
+void SensorBroadcast::page_changed(sensor_broadcast_page_t page) {
+	uint8_t* header = (page == SENSOR_BROADCAST_PAGE_ENVIRONMENT)? environment : motion;
+	header[1]++;
+	extended_dirty = true;
+}
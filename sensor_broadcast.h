@@ -0,0 +1,175 @@
+/*
+ * sensor_broadcast.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef SENSOR_BROADCAST_H_
+#define SENSOR_BROADCAST_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "ble/BLE.h"
+#include "ble/Gap.h"
+#include "ble/gap/Types.h"
+#include "events/EventQueue.h"
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+#include "sensor_sample.h"
+
+/**
+ * Sensor readings in the advertising data, for passive scanners
+ *
+ * Pages are carried in manufacturer specific data. There is no company or
+ * 16-bit service UUID assigned to the Agora, so the company ID is the one
+ * the Bluetooth SIG reserves for testing. Each page (all fields little endian):
+ *
+ *   [0]    version (high nibble), sensor_broadcast_page_t (low nibble)
+ *   [1]    sequence, increments whenever a value on the page changes
+ *   [2:]   page body, below
+ *
+ * Values that are not known yet read as 0x8000 (signed) or all ones.
+ */
+#define SENSOR_BROADCAST_COMPANY_ID		0xFFFF
+#define SENSOR_BROADCAST_VERSION		1
+#define SENSOR_BROADCAST_HEADER_SIZE	2
+
+/**
+ * Environment page body, 17 bytes:
+ *
+ *   [0:1]   BME680 temperature, sint16 0.01 degC
+ *   [2:3]   BME680 humidity, uint16 0.01 %RH
+ *   [4:7]   BME680 pressure, uint32 0.1 Pa
+ *   [8:9]   IAQ score, uint16
+ *   [10]    IAQ accuracy, uint8
+ *   [11:12] CO2 equivalent, uint16 ppm
+ *   [13:14] breath VOC equivalent, uint16 ppb
+ *   [15:16] battery, uint16 mV
+ */
+#define SENSOR_BROADCAST_ENVIRONMENT_SIZE	17
+
+/**
+ * Motion and light page body, 16 bytes:
+ *
+ *   [0:1]   Si7021 temperature, sint16 0.01 degC
+ *   [2:3]   Si7021 humidity, uint16 0.01 %RH
+ *   [4:7]   ambient light, uint32 0.01 lux
+ *   [8:9]   distance, uint16 mm (0xFFFF out of range)
+ *   [10:15] acceleration x, y, z, sint16 mg (ICM20602, or the LSM9DS1 without it)
+ */
+#define SENSOR_BROADCAST_MOTION_SIZE		16
+
+typedef enum {
+	SENSOR_BROADCAST_PAGE_ENVIRONMENT = 0,
+	SENSOR_BROADCAST_PAGE_MOTION,
+	SENSOR_BROADCAST_PAGE_COUNT
+} sensor_broadcast_page_t;
+
+/** Largest page, header included */
+#define SENSOR_BROADCAST_MAX_PAGE_SIZE	(SENSOR_BROADCAST_HEADER_SIZE + SENSOR_BROADCAST_ENVIRONMENT_SIZE)
+
+/** Every page back to back, the extended and periodic advertising payload */
+#define SENSOR_BROADCAST_ALL_PAGES_SIZE	(2 * SENSOR_BROADCAST_HEADER_SIZE + \
+		SENSOR_BROADCAST_ENVIRONMENT_SIZE + SENSOR_BROADCAST_MOTION_SIZE)
+
+/** Legacy advertising shows the next page this often */
+#define SENSOR_BROADCAST_PAGE_INTERVAL_MS		1000
+
+/** Extended advertising interval (625 us units) */
+#define SENSOR_BROADCAST_EXT_INTERVAL			1600	// 1 s
+
+/** Periodic advertising interval (1.25 ms units) */
+#define SENSOR_BROADCAST_PERIODIC_INTERVAL		800		// 1 s
+
+/**
+ * Connectionless broadcast of the latest sensor readings
+ *
+ * Published samples are handed to update(), which encodes them straight
+ * into their page. While broadcasting is enabled:
+ *
+ * - the legacy advertising set (connectable, owned by BLEProcess) carries
+ *   one page at a time, the next one every SENSOR_BROADCAST_PAGE_INTERVAL_MS,
+ *   through the legacy payload callback
+ * - where the controller supports BLE 5 extended advertising, a second,
+ *   non-connectable set carries every page in a single PDU, refreshed when
+ *   a value changed. Periodic advertising, where supported, repeats the
+ *   same payload so synchronized scanners receive it without scanning.
+ *
+ * All calls must come from the BLE event queue.
+ */
+class SensorBroadcast : private mbed::NonCopyable<SensorBroadcast> {
+public:
+
+	/**
+	 * Replaces the legacy advertising payload with manufacturer specific data
+	 * (data, len), or restores the default payload with (NULL, 0)
+	 */
+	typedef mbed::Callback<bool(const uint8_t*, size_t)> legacy_payload_cb_t;
+
+	SensorBroadcast(events::EventQueue& queue);
+
+	~SensorBroadcast();
+
+	void on_legacy_payload(legacy_payload_cb_t cb) {
+		legacy_payload_cb = cb;
+	}
+
+	/** The stack is initialized, starts broadcasting if it was enabled before */
+	void start(BLE& ble);
+
+	void set_enabled(bool enabled);
+
+	bool is_enabled(void) const {
+		return enabled;
+	}
+
+	/** Encode a published sample into its page */
+	void update(const sensor_sample_t& sample);
+
+	/**
+	 * Copy a page, header included
+	 * @retval Bytes written
+	 */
+	size_t get_page(sensor_broadcast_page_t page, uint8_t* out, size_t size) const;
+
+	void print_stats(void);
+
+private:
+
+	/** Show the next page on the legacy set, refresh the extended set */
+	void tick(void);
+
+	void start_extended(void);
+
+	void stop_extended(void);
+
+	void refresh_extended(void);
+
+	void page_changed(sensor_broadcast_page_t page);
+
+	events::EventQueue& queue;
+	BLE* ble;
+	legacy_payload_cb_t legacy_payload_cb;
+	bool enabled;
+	int tick_event;
+
+	uint8_t environment[SENSOR_BROADCAST_HEADER_SIZE + SENSOR_BROADCAST_ENVIRONMENT_SIZE];
+	uint8_t motion[SENSOR_BROADCAST_HEADER_SIZE + SENSOR_BROADCAST_MOTION_SIZE];
+	bool icm20602_accel;			/** The motion page carries ICM20602 acceleration */
+
+	/** Legacy rotation */
+	sensor_broadcast_page_t legacy_page;
+	uint32_t legacy_updates;
+
+	/** Extended and periodic set */
+	bool extended;
+	bool periodic;
+	ble::advertising_handle_t extended_handle;
+	bool extended_dirty;
+	uint32_t extended_updates;
+
+};
+
+#endif /* SENSOR_BROADCAST_H_ */
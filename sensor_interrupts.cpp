@@ -0,0 +1,335 @@
+/*
+ * sensor_interrupts.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "sensor_interrupts.h"
+
+#include <stdio.h>
+
+#include "agora_components.h"
+
+/** ICM-20602 wake-on-motion registers */
+#define ICM20602_ACCEL_WOM_X_THR	0x20
+#define ICM20602_ACCEL_WOM_Y_THR	0x21
+#define ICM20602_ACCEL_WOM_Z_THR	0x22
+#define ICM20602_INT_ENABLE			0x38
+#define ICM20602_ACCEL_INTEL_CTRL	0x69
+
+#define ICM20602_INT_ENABLE_WOM			0xE0	// X, Y and Z
+#define ICM20602_ACCEL_INTEL_ENABLE		0xC0	// Compare each sample with the previous one
+#define ICM20602_WOM_MG_PER_LSB			4
+
+/** LSM9DS1 accelerometer interrupt generator registers */
+#define LSM9DS1_INT_GEN_CFG_XL		0x06
+#define LSM9DS1_INT_GEN_THS_X_XL	0x07
+#define LSM9DS1_INT_GEN_THS_Y_XL	0x08
+#define LSM9DS1_INT_GEN_THS_Z_XL	0x09
+#define LSM9DS1_INT_GEN_DUR_XL		0x0A
+#define LSM9DS1_INT1_CTRL			0x0C
+#define LSM9DS1_CTRL_REG7_XL		0x21
+#define LSM9DS1_INT_GEN_SRC_XL		0x26
+
+#define LSM9DS1_INT_GEN_CFG_XL_HIGH		0x2A	// X, Y or Z above the threshold
+#define LSM9DS1_INT1_CTRL_IG_XL			(1 << 6)
+#define LSM9DS1_CTRL_REG7_XL_HPIS1		(1 << 0)	// High-pass filter on the interrupt path
+#define LSM9DS1_THS_XL_STEPS			128		// Threshold LSB is the full scale / 128
+
+/** MAX44009 registers */
+#define MAX44009_INT_STATUS			0x00
+#define MAX44009_INT_ENABLE			0x01
+#define MAX44009_THRESHOLD_UPPER	0x05
+#define MAX44009_THRESHOLD_LOWER	0x06
+#define MAX44009_THRESHOLD_TIMER	0x07
+
+#define MAX44009_LUX_PER_COUNT		0.045f
+#define MAX44009_MAX_LUX			188006.0f
+#define MAX44009_MAX_EXPONENT		14
+#define MAX44009_TIMER_STEP_MS		100
+
+SensorInterrupts::SensorInterrupts(I2CTransactionEngine& engine, events::EventQueue& queue) :
+	engine(engine), queue(queue), handler(), lines(), enabled(false), motion_threshold_mg(0),
+	lsm9ds1_range_g(0), light_window(), write_failures(0), latch_failures(0) {
+	for(int i = 0; i < LINE_COUNT; i++) {
+		lines[i].in = NULL;
+		lines[i].pending.store(false);
+	}
+
+	// Until the first reading, a window no lux can leave
+	light_window[0] = encode_lux_threshold(MAX44009_MAX_LUX);
+	light_window[1] = 0;
+}
+
+SensorInterrupts::~SensorInterrupts() {
+	for(int i = 0; i < LINE_COUNT; i++) {
+		delete lines[i].in;
+	}
+}
+
+void SensorInterrupts::init(const sensor_interrupt_pins_t& pins, handler_t handler) {
+	this->handler = handler;
+
+	// Lines are only claimed if they are wired, InterruptIn cannot be built on NC
+	if(pins.icm20602 != NC) {
+		lines[LINE_ICM20602].in = new mbed::InterruptIn(pins.icm20602);
+		lines[LINE_ICM20602].in->rise(mbed::callback(this, &SensorInterrupts::on_icm20602_edge));
+	}
+	if(pins.lsm9ds1 != NC) {
+		lines[LINE_LSM9DS1].in = new mbed::InterruptIn(pins.lsm9ds1);
+		lines[LINE_LSM9DS1].in->rise(mbed::callback(this, &SensorInterrupts::on_lsm9ds1_edge));
+	}
+	if(pins.max44009 != NC) {
+		lines[LINE_MAX44009].in = new mbed::InterruptIn(pins.max44009);
+		lines[LINE_MAX44009].in->mode(PullUp);
+		lines[LINE_MAX44009].in->fall(mbed::callback(this, &SensorInterrupts::on_max44009_edge));
+	}
+
+	set_lines_enabled(false);
+}
+
+void SensorInterrupts::enable(uint16_t motion_threshold_mg, uint8_t lsm9ds1_range_g) {
+	this->motion_threshold_mg = motion_threshold_mg;
+	this->lsm9ds1_range_g = lsm9ds1_range_g;
+	enabled = true;
+	reconfigure();
+	set_lines_enabled(true);
+}
+
+void SensorInterrupts::disable(void) {
+	enabled = false;
+	set_lines_enabled(false);
+	configure_icm20602(false);
+	configure_lsm9ds1(false);
+	configure_max44009(false);
+}
+
+void SensorInterrupts::reconfigure(void) {
+	if(!enabled) {
+		return;
+	}
+	configure_icm20602(true);
+	configure_lsm9ds1(true);
+	configure_max44009(true);
+}
+
+void SensorInterrupts::set_light_window(float lux) {
+	if(!enabled || !has_light_line()) {
+		return;
+	}
+
+	uint8_t upper = encode_lux_threshold(lux * (100 + SENSOR_INTERRUPTS_LIGHT_WINDOW_PERCENT) / 100);
+	uint8_t lower = encode_lux_threshold(lux * (100 - SENSOR_INTERRUPTS_LIGHT_WINDOW_PERCENT) / 100);
+	if(upper == light_window[0] && lower == light_window[1]) {
+		return;
+	}
+
+	light_window[0] = upper;
+	light_window[1] = lower;
+	write(MAX44009_I2C_ADDR, MAX44009_THRESHOLD_UPPER, upper);
+	write(MAX44009_I2C_ADDR, MAX44009_THRESHOLD_LOWER, lower);
+}
+
+void SensorInterrupts::print_stats(void) {
+	static const char* const names[LINE_COUNT] = { "icm20602", "lsm9ds1", "max44009" };
+
+	printf("interrupts: %s, %lu writes dropped, %lu latch reads failed\r\n",
+			enabled? "enabled" : "disabled", (unsigned long) write_failures,
+			(unsigned long) latch_failures);
+	for(int i = 0; i < LINE_COUNT; i++) {
+		if(lines[i].in == NULL) {
+			continue;
+		}
+		printf("interrupts: %-10s %lu posted, %lu handled, %lu queue full\r\n", names[i],
+				(unsigned long) lines[i].posted, (unsigned long) lines[i].handled,
+				(unsigned long) lines[i].queue_full);
+	}
+}
+
+void SensorInterrupts::on_icm20602_edge(void) {
+	post(LINE_ICM20602);
+}
+
+void SensorInterrupts::on_lsm9ds1_edge(void) {
+	post(LINE_LSM9DS1);
+}
+
+void SensorInterrupts::on_max44009_edge(void) {
+	post(LINE_MAX44009);
+}
+
+void SensorInterrupts::post(line_t line) {
+	line_state_t& state = lines[line];
+	if(state.pending.exchange(true)) {
+		// The sensor thread has not run the previous call yet
+		return;
+	}
+
+	if(queue.call(mbed::callback(this, &SensorInterrupts::dispatch), line) == 0) {
+		state.pending.store(false);
+		state.queue_full++;
+		return;
+	}
+	state.posted++;
+}
+
+void SensorInterrupts::dispatch(line_t line) {
+	line_state_t& state = lines[line];
+	state.pending.store(false);
+	state.handled++;
+
+	clear_latch(line);
+
+	if(!enabled || !handler) {
+		// Raced with disable()
+		return;
+	}
+	handler((line == LINE_MAX44009)? SENSOR_INTERRUPT_LIGHT : SENSOR_INTERRUPT_MOTION);
+}
+
+void SensorInterrupts::clear_latch(line_t line) {
+	bool queued = true;
+	if(line == LINE_LSM9DS1) {
+		queued = engine.read_registers(LSM9DS1_ACC_GYRO_I2C_ADDR, LSM9DS1_INT_GEN_SRC_XL,
+				&lines[line].status_raw, 1, &queue,
+				mbed::callback(this, &SensorInterrupts::on_lsm9ds1_latch_cleared));
+	} else if(line == LINE_MAX44009) {
+		queued = engine.read_registers(MAX44009_I2C_ADDR, MAX44009_INT_STATUS,
+				&lines[line].status_raw, 1, &queue,
+				mbed::callback(this, &SensorInterrupts::on_max44009_latch_cleared));
+	}
+
+	// The ICM-20602 pulses its line, there is nothing to release
+	if(!queued) {
+		latch_failures++;
+	}
+}
+
+void SensorInterrupts::on_lsm9ds1_latch_cleared(i2c_transaction_result_t result) {
+	if(result.status != 0) {
+		latch_failures++;
+	}
+}
+
+void SensorInterrupts::on_max44009_latch_cleared(i2c_transaction_result_t result) {
+	if(result.status != 0) {
+		latch_failures++;
+	}
+}
+
+void SensorInterrupts::set_lines_enabled(bool enable) {
+	for(int i = 0; i < LINE_COUNT; i++) {
+		if(lines[i].in == NULL) {
+			continue;
+		}
+		if(enable) {
+			lines[i].in->enable_irq();
+		} else {
+			lines[i].in->disable_irq();
+		}
+	}
+}
+
+void SensorInterrupts::configure_icm20602(bool enable) {
+	if(lines[LINE_ICM20602].in == NULL) {
+		return;
+	}
+
+	if(!enable) {
+		write(ICM20602_I2C_ADDR, ICM20602_INT_ENABLE, 0);
+		write(ICM20602_I2C_ADDR, ICM20602_ACCEL_INTEL_CTRL, 0);
+		return;
+	}
+
+	uint32_t threshold = motion_threshold_mg / ICM20602_WOM_MG_PER_LSB;
+	if(threshold == 0) {
+		threshold = 1;
+	} else if(threshold > 0xFF) {
+		threshold = 0xFF;
+	}
+
+	write(ICM20602_I2C_ADDR, ICM20602_ACCEL_WOM_X_THR, (uint8_t) threshold);
+	write(ICM20602_I2C_ADDR, ICM20602_ACCEL_WOM_Y_THR, (uint8_t) threshold);
+	write(ICM20602_I2C_ADDR, ICM20602_ACCEL_WOM_Z_THR, (uint8_t) threshold);
+	write(ICM20602_I2C_ADDR, ICM20602_ACCEL_INTEL_CTRL, ICM20602_ACCEL_INTEL_ENABLE);
+	write(ICM20602_I2C_ADDR, ICM20602_INT_ENABLE, ICM20602_INT_ENABLE_WOM);
+}
+
+void SensorInterrupts::configure_lsm9ds1(bool enable) {
+	if(lines[LINE_LSM9DS1].in == NULL) {
+		return;
+	}
+
+	if(!enable) {
+		write(LSM9DS1_ACC_GYRO_I2C_ADDR, LSM9DS1_INT1_CTRL, 0);
+		write(LSM9DS1_ACC_GYRO_I2C_ADDR, LSM9DS1_INT_GEN_CFG_XL, 0);
+		write(LSM9DS1_ACC_GYRO_I2C_ADDR, LSM9DS1_CTRL_REG7_XL, 0);
+		return;
+	}
+
+	uint32_t full_scale_mg = (lsm9ds1_range_g != 0)? lsm9ds1_range_g * 1000UL : 2000UL;
+	uint32_t threshold = (motion_threshold_mg * LSM9DS1_THS_XL_STEPS) / full_scale_mg;
+	if(threshold == 0) {
+		threshold = 1;
+	} else if(threshold > 0xFF) {
+		threshold = 0xFF;
+	}
+
+	// The driver leaves the other CTRL_REG7_XL bits (high resolution, output filter) cleared
+	write(LSM9DS1_ACC_GYRO_I2C_ADDR, LSM9DS1_CTRL_REG7_XL, LSM9DS1_CTRL_REG7_XL_HPIS1);
+	write(LSM9DS1_ACC_GYRO_I2C_ADDR, LSM9DS1_INT_GEN_THS_X_XL, (uint8_t) threshold);
+	write(LSM9DS1_ACC_GYRO_I2C_ADDR, LSM9DS1_INT_GEN_THS_Y_XL, (uint8_t) threshold);
+	write(LSM9DS1_ACC_GYRO_I2C_ADDR, LSM9DS1_INT_GEN_THS_Z_XL, (uint8_t) threshold);
+	write(LSM9DS1_ACC_GYRO_I2C_ADDR, LSM9DS1_INT_GEN_DUR_XL, 0);
+	write(LSM9DS1_ACC_GYRO_I2C_ADDR, LSM9DS1_INT_GEN_CFG_XL, LSM9DS1_INT_GEN_CFG_XL_HIGH);
+	write(LSM9DS1_ACC_GYRO_I2C_ADDR, LSM9DS1_INT1_CTRL, LSM9DS1_INT1_CTRL_IG_XL);
+
+	// A line latched before now would never produce another edge
+	clear_latch(LINE_LSM9DS1);
+}
+
+void SensorInterrupts::configure_max44009(bool enable) {
+	if(lines[LINE_MAX44009].in == NULL) {
+		return;
+	}
+
+	if(!enable) {
+		write(MAX44009_I2C_ADDR, MAX44009_INT_ENABLE, 0);
+		return;
+	}
+
+	write(MAX44009_I2C_ADDR, MAX44009_THRESHOLD_UPPER, light_window[0]);
+	write(MAX44009_I2C_ADDR, MAX44009_THRESHOLD_LOWER, light_window[1]);
+	write(MAX44009_I2C_ADDR, MAX44009_THRESHOLD_TIMER,
+			SENSOR_INTERRUPTS_LIGHT_TIMER_MS / MAX44009_TIMER_STEP_MS);
+	write(MAX44009_I2C_ADDR, MAX44009_INT_ENABLE, 1);
+
+	clear_latch(LINE_MAX44009);
+}
+
+void SensorInterrupts::write(uint8_t address, uint8_t reg, uint8_t value) {
+	if(!engine.write_register(address, reg, value)) {
+		write_failures++;
+	}
+}
+
+uint8_t SensorInterrupts::encode_lux_threshold(float lux) {
+	// Threshold registers hold the exponent and the upper nibble of the mantissa
+	if(lux > MAX44009_MAX_LUX) {
+		lux = MAX44009_MAX_LUX;
+	} else if(lux < 0.0f) {
+		lux = 0.0f;
+	}
+
+	uint32_t mantissa = (uint32_t) (lux / MAX44009_LUX_PER_COUNT);
+	uint8_t exponent = 0;
+	while(mantissa > 0xFF && exponent < MAX44009_MAX_EXPONENT) {
+		mantissa >>= 1;
+		exponent++;
+	}
+	if(mantissa > 0xFF) {
+		mantissa = 0xFF;
+	}
+
+	return (uint8_t) ((exponent << 4) | (mantissa >> 4));
+}
@@ -0,0 +1,177 @@
+/*
+ * sensor_interrupts.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef SENSOR_INTERRUPTS_H_
+#define SENSOR_INTERRUPTS_H_
+
+#include <stdint.h>
+#include <atomic>
+
+#include "PinNames.h"
+#include "drivers/InterruptIn.h"
+#include "events/EventQueue.h"
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+#include "i2c_transaction_engine.h"
+
+/** MAX44009 threshold timer, lux has to stay outside the window this long (100 ms steps) */
+#define SENSOR_INTERRUPTS_LIGHT_TIMER_MS	100
+
+/** Width of the lux window around the last reading, either side */
+#define SENSOR_INTERRUPTS_LIGHT_WINDOW_PERCENT	25
+
+typedef enum {
+	SENSOR_INTERRUPT_MOTION = 0,	/** Either IMU saw a change of acceleration above the threshold */
+	SENSOR_INTERRUPT_LIGHT,			/** Lux left the window around the last reading */
+} sensor_interrupt_t;
+
+/** MCU pins the sensors' interrupt outputs are wired to, NC if not connected */
+typedef struct {
+	PinName icm20602;	/** INT, push-pull active high pulse */
+	PinName lsm9ds1;	/** INT1_A/G, push-pull active high, latched */
+	PinName max44009;	/** INT, open drain active low, held until the status is read */
+} sensor_interrupt_pins_t;
+
+/**
+ * Threshold and motion interrupts of the sensors
+ *
+ * Programs the ICM-20602 wake-on-motion, the LSM9DS1 accelerometer
+ * high-g interrupt (high-pass filtered, so gravity does not count) and the
+ * MAX44009 lux window, and turns their interrupt lines into calls of a
+ * handler on the sensor thread. The ISRs only post to the sensor event
+ * queue; a burst of edges while a call is pending is folded into that call.
+ *
+ * Register writes are queued on the I2C engine like every other sensor
+ * access. Sources without a connected line are never programmed, their
+ * sensors are simply polled. The sensors must be awake for their interrupts
+ * to fire: the ICM-20602 may only put its gyro in standby (see
+ * ICM20602Stream::set_gyro_standby()), the LSM9DS1 accelerometer keeps
+ * running while its gyro sleeps.
+ *
+ * All methods run on the sensor thread.
+ */
+class SensorInterrupts : private mbed::NonCopyable<SensorInterrupts> {
+public:
+
+	typedef mbed::Callback<void(sensor_interrupt_t)> handler_t;
+
+	/**
+	 * @param[in] engine I2C transaction engine shared with the other sensors
+	 * @param[in] queue Event queue of the sensor thread
+	 */
+	SensorInterrupts(I2CTransactionEngine& engine, events::EventQueue& queue);
+
+	~SensorInterrupts();
+
+	/** Attach the lines, call once. Interrupts stay masked until enable() */
+	void init(const sensor_interrupt_pins_t& pins, handler_t handler);
+
+	bool has_icm20602_line(void) const {
+		return lines[LINE_ICM20602].in != NULL;
+	}
+
+	bool has_lsm9ds1_line(void) const {
+		return lines[LINE_LSM9DS1].in != NULL;
+	}
+
+	/** True if a motion interrupt is wired from either IMU */
+	bool has_motion_line(void) const {
+		return has_icm20602_line() || has_lsm9ds1_line();
+	}
+
+	bool has_light_line(void) const {
+		return lines[LINE_MAX44009].in != NULL;
+	}
+
+	/**
+	 * Program the sensors and unmask the lines
+	 * @param[in] motion_threshold_mg Change of acceleration that counts as motion
+	 * @param[in] lsm9ds1_range_g Full scale the LSM9DS1 accelerometer runs at
+	 */
+	void enable(uint16_t motion_threshold_mg, uint8_t lsm9ds1_range_g);
+
+	/** Mask the lines and switch the sensors' interrupts off */
+	void disable(void);
+
+	bool is_enabled(void) const {
+		return enabled;
+	}
+
+	/** Program the sensors again after they lost their configuration (eg: power cycled) */
+	void reconfigure(void);
+
+	/** Center the lux window on a reading, no-op unless enabled */
+	void set_light_window(float lux);
+
+	/** Print the interrupts taken per line */
+	void print_stats(void);
+
+private:
+
+	typedef enum {
+		LINE_ICM20602 = 0,
+		LINE_LSM9DS1,
+		LINE_MAX44009,
+		LINE_COUNT
+	} line_t;
+
+	typedef struct {
+		mbed::InterruptIn* in;
+		std::atomic<bool> pending;	/** Posted to the queue, not handled yet */
+		uint32_t posted;			/** ISR side */
+		uint32_t queue_full;		/** ISR side */
+		uint32_t handled;
+		uint8_t status_raw;			/** Source register read to clear a latched line */
+	} line_state_t;
+
+	void on_icm20602_edge(void);
+
+	void on_lsm9ds1_edge(void);
+
+	void on_max44009_edge(void);
+
+	/** ISR: hand the edge to the sensor thread unless a call is already pending */
+	void post(line_t line);
+
+	/** Sensor thread */
+	void dispatch(line_t line);
+
+	/** Read the source register of a latched line, which releases it */
+	void clear_latch(line_t line);
+
+	void on_lsm9ds1_latch_cleared(i2c_transaction_result_t result);
+
+	void on_max44009_latch_cleared(i2c_transaction_result_t result);
+
+	void set_lines_enabled(bool enable);
+
+	void configure_icm20602(bool enable);
+
+	void configure_lsm9ds1(bool enable);
+
+	void configure_max44009(bool enable);
+
+	void write(uint8_t address, uint8_t reg, uint8_t value);
+
+	/** MAX44009 threshold register for a lux value */
+	static uint8_t encode_lux_threshold(float lux);
+
+	I2CTransactionEngine& engine;
+	events::EventQueue& queue;
+	handler_t handler;
+	line_state_t lines[LINE_COUNT];
+
+	bool enabled;
+	uint16_t motion_threshold_mg;
+	uint8_t lsm9ds1_range_g;
+	uint8_t light_window[2];		/** Upper and lower threshold registers */
+	uint32_t write_failures;		/** Engine queue full */
+	uint32_t latch_failures;		/** Source register reads that failed, the line stays asserted */
+
+};
+
+#endif /* SENSOR_INTERRUPTS_H_ */
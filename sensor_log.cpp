@@ -0,0 +1,409 @@
+/*
+ * sensor_log.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "sensor_log.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "drivers/MbedCRC.h"
+#include "rtos/ThisThread.h"
+
+#define WRITER_FLAG_SEGMENT_READY	(1 << 0)
+
+/** Records are read back this many bytes at a time to check their CRC */
+#define CRC_CHUNK_SIZE				128
+
+static_assert(sizeof(sensor_log_segment_header_t) == SENSOR_LOG_HEADER_SIZE,
+		"sensor log header size mismatch");
+static_assert(sizeof(sensor_log_record_t) == 20, "sensor log record layout changed");
+
+static uint32_t records_crc(const uint8_t* records, size_t len) {
+	mbed::MbedCRC<POLY_32BIT_ANSI, 32> ct;
+	uint32_t crc = 0;
+	ct.compute((void*) records, len, &crc);
+	return crc;
+}
+
+static bool header_valid(const sensor_log_segment_header_t& header) {
+	// Version 1 records only differ in the (zero) sequence number
+	return header.magic == SENSOR_LOG_MAGIC &&
+			header.version >= 1 && header.version <= SENSOR_LOG_VERSION &&
+			header.record_size == sizeof(sensor_log_record_t) &&
+			header.record_count <= SENSOR_LOG_RECORDS_PER_SEGMENT;
+}
+
+SensorLog::SensorLog(BlockDevice& bd, osPriority priority) :
+	bd(bd), thread(priority, SENSOR_LOG_WRITER_STACK_SIZE, NULL, "log"), flags(),
+	initialized(false), segment_count(0), boot_count(0), next_sequence(0),
+	have_segments(false), first_sequence(0), newest_sequence(0), verified(false),
+	verified_sequence(0), verified_header(), buffers(), active(0), active_count(0),
+	last_logged_ms(), min_interval_ms(), logged_once(), skipped(), pending(-1), records_logged(0),
+	records_dropped(0), segments_written(0), write_errors(0), corrupt_segments(0) {
+}
+
+int SensorLog::init(void) {
+	int err = bd.init();
+	if(err) {
+		printf("sensor log: failed to initialize block device\r\n");
+		return err;
+	}
+
+	if((SENSOR_LOG_SEGMENT_SIZE % bd.get_erase_size()) != 0 ||
+			(SENSOR_LOG_SEGMENT_SIZE % bd.get_program_size()) != 0 ||
+			(SENSOR_LOG_HEADER_SIZE % bd.get_read_size()) != 0) {
+		printf("sensor log: segment size does not fit the block device geometry\r\n");
+		return BD_ERROR_DEVICE_ERROR;
+	}
+
+	segment_count = (uint32_t) (bd.size() / SENSOR_LOG_SEGMENT_SIZE);
+	if(segment_count < 2) {
+		printf("sensor log: block device too small\r\n");
+		return BD_ERROR_DEVICE_ERROR;
+	}
+
+	// Find the newest and oldest valid segments, a segment whose records do
+	// not match the CRC (eg: the newest one, torn by a reset) does not count
+	bool found = false;
+	uint32_t newest = 0;
+	uint32_t oldest = 0;
+	uint32_t newest_boot = 0;
+	for(uint32_t i = 0; i < segment_count; i++) {
+		sensor_log_segment_header_t header;
+		err = bd.read(&header, (bd_addr_t) i * SENSOR_LOG_SEGMENT_SIZE, sizeof(header));
+		if(err || !header_valid(header) || (header.sequence % segment_count) != i) {
+			continue;
+		}
+		if(!check_segment(header.sequence, header)) {
+			corrupt_segments++;
+			continue;
+		}
+
+		if(!found || header.sequence > newest) {
+			newest = header.sequence;
+			newest_boot = header.boot_count;
+		}
+		if(!found || header.sequence < oldest) {
+			oldest = header.sequence;
+		}
+		found = true;
+	}
+
+	if(found) {
+		first_sequence.store(oldest);
+		next_sequence = newest + 1;
+		boot_count = newest_boot + 1;
+		newest_sequence.store(newest);
+		have_segments.store(true);
+	}
+
+	printf("sensor log: %lu segments, %s, boot %lu\r\n", segment_count,
+			found? "resuming" : "empty", boot_count);
+	if(corrupt_segments != 0) {
+		printf("sensor log: skipped %lu segments failing their CRC\r\n", corrupt_segments);
+	}
+
+	initialized = true;
+	thread.start(mbed::callback(this, &SensorLog::writer_thread_main));
+
+	return 0;
+}
+
+void SensorLog::set_min_interval(sensor_channel_t channel, uint32_t interval_ms) {
+	if(channel < SENSOR_CHANNEL_COUNT) {
+		min_interval_ms[channel] = interval_ms;
+	}
+}
+
+bool SensorLog::append(const sensor_sample_t& sample) {
+	if(!initialized || sample.channel >= SENSOR_CHANNEL_COUNT) {
+		return false;
+	}
+
+	// Samples carry the time they were read at, which is what gets logged
+	uint32_t now = sample.time_ms;
+	uint8_t ch = sample.channel;
+	if(logged_once[ch] && (now - last_logged_ms[ch]) < min_interval_ms[ch]) {
+		skipped[ch] += 1 + sample.skipped;
+		return false;
+	}
+
+	sensor_log_record_t record;
+	memset(&record, 0, sizeof(record));
+	record.time_ms = now;
+	record.channel = ch;
+	record.skipped = sensor_sample_add_skipped(sample.skipped, skipped[ch]);
+	record.sequence = sample.sequence;
+	record.value = sample.value;
+	if(!append_record(record)) {
+		// Lost, unlike the readings it skipped
+		skipped[ch] += sample.skipped;
+		return false;
+	}
+
+	last_logged_ms[ch] = now;
+	logged_once[ch] = true;
+	skipped[ch] = 0;
+
+	return true;
+}
+
+bool SensorLog::append_time_sync(uint32_t time_ms, int64_t wall_ms) {
+	if(!initialized) {
+		return false;
+	}
+
+	sensor_log_record_t record;
+	memset(&record, 0, sizeof(record));
+	record.time_ms = time_ms;
+	record.channel = SENSOR_LOG_CHANNEL_TIME_SYNC;
+	uint8_t* value = (uint8_t*) &record.value;
+	for(int i = 0; i < 8; i++) {
+		value[i] = (uint8_t) ((uint64_t) wall_ms >> (8 * i));
+	}
+	return append_record(record);
+}
+
+bool SensorLog::append_record(const sensor_log_record_t& record) {
+	// A full buffer stays put until the writer takes it
+	if(active_count == SENSOR_LOG_RECORDS_PER_SEGMENT && !submit_active()) {
+		records_dropped++;
+		return false;
+	}
+
+	memcpy(&buffers[active][SENSOR_LOG_HEADER_SIZE + active_count * sizeof(record)],
+			&record, sizeof(record));
+	active_count++;
+	records_logged++;
+
+	if(active_count == SENSOR_LOG_RECORDS_PER_SEGMENT) {
+		submit_active();
+	}
+
+	return true;
+}
+
+bool SensorLog::submit_active(void) {
+	if(pending.load() != -1) {
+		return false;
+	}
+
+	uint8_t* buffer = buffers[active];
+	size_t records_len = active_count * sizeof(sensor_log_record_t);
+
+	// Leave the unused tail in the erased state
+	memset(&buffer[SENSOR_LOG_HEADER_SIZE + records_len], 0xFF,
+			SENSOR_LOG_SEGMENT_SIZE - SENSOR_LOG_HEADER_SIZE - records_len);
+
+	sensor_log_segment_header_t header;
+	memset(&header, 0xFF, sizeof(header));
+	header.magic = SENSOR_LOG_MAGIC;
+	header.version = SENSOR_LOG_VERSION;
+	header.record_size = sizeof(sensor_log_record_t);
+	header.record_count = active_count;
+	header.sequence = next_sequence++;
+	header.boot_count = boot_count;
+	header.crc = records_crc(&buffer[SENSOR_LOG_HEADER_SIZE], records_len);
+	memcpy(buffer, &header, sizeof(header));
+
+	pending.store(active);
+	flags.set(WRITER_FLAG_SEGMENT_READY);
+
+	active ^= 1;
+	active_count = 0;
+
+	return true;
+}
+
+void SensorLog::sync(void) {
+	if(!initialized) {
+		return;
+	}
+
+	while(active_count != 0 && !submit_active()) {
+		rtos::ThisThread::sleep_for(1);
+	}
+
+	while(pending.load() != -1) {
+		rtos::ThisThread::sleep_for(1);
+	}
+}
+
+bool SensorLog::flush(uint32_t& sequence) {
+	if(!initialized || (active_count != 0 && !submit_active())) {
+		return false;
+	}
+
+	sequence = next_sequence - 1;
+	return true;
+}
+
+void SensorLog::writer_thread_main(void) {
+
+	while(true) {
+		flags.wait_any(WRITER_FLAG_SEGMENT_READY);
+
+		int index = pending.load();
+		if(index < 0) {
+			continue;
+		}
+
+		const sensor_log_segment_header_t* header =
+				(const sensor_log_segment_header_t*) buffers[index];
+		uint32_t sequence = header->sequence;
+		bd_addr_t addr = segment_address(sequence);
+
+		// One erase and one program per segment
+		int err = bd.erase(addr, SENSOR_LOG_SEGMENT_SIZE);
+		if(!err) {
+			err = bd.program(buffers[index], addr, SENSOR_LOG_SEGMENT_SIZE);
+		}
+
+		if(err) {
+			write_errors++;
+		} else {
+			segments_written++;
+			if(!have_segments.load()) {
+				first_sequence.store(sequence);
+			}
+			newest_sequence.store(sequence);
+			have_segments.store(true);
+		}
+
+		pending.store(-1);
+	}
+}
+
+bool SensorLog::get_sequence_range(uint32_t& oldest, uint32_t& newest) const {
+	if(!have_segments.load()) {
+		return false;
+	}
+
+	newest = newest_sequence.load();
+	oldest = first_sequence.load();
+
+	// The segment after the newest may be in the middle of being erased
+	if(newest + 2 > segment_count && newest + 2 - segment_count > oldest) {
+		oldest = newest + 2 - segment_count;
+	}
+
+	return true;
+}
+
+bool SensorLog::check_segment(uint32_t sequence, sensor_log_segment_header_t& header) {
+	bd_addr_t addr = segment_address(sequence);
+	if(bd.read(&header, addr, sizeof(header)) != 0 || !header_valid(header) ||
+			header.sequence != sequence) {
+		return false;
+	}
+
+	// In chunks, the segment buffers belong to the producer and the writer
+	mbed::MbedCRC<POLY_32BIT_ANSI, 32> ct;
+	uint8_t chunk[CRC_CHUNK_SIZE];
+	size_t records_len = header.record_count * sizeof(sensor_log_record_t);
+	uint32_t crc = 0;
+	ct.compute_partial_start(&crc);
+	for(size_t done = 0; done < records_len; ) {
+		size_t n = records_len - done;
+		if(n > sizeof(chunk)) {
+			n = sizeof(chunk);
+		}
+		if(bd.read(chunk, addr + SENSOR_LOG_HEADER_SIZE + done, n) != 0) {
+			return false;
+		}
+		ct.compute_partial(chunk, n, &crc);
+		done += n;
+	}
+	ct.compute_partial_stop(&crc);
+
+	return crc == header.crc;
+}
+
+bool SensorLog::verify_segment(uint32_t sequence, sensor_log_segment_header_t& header) {
+	// Sequence numbers are never reused, a segment that passed stays good
+	// until it is recycled, which in_range() catches
+	if(verified && verified_sequence == sequence) {
+		header = verified_header;
+		return true;
+	}
+
+	if(!check_segment(sequence, header)) {
+		return false;
+	}
+
+	verified = true;
+	verified_sequence = sequence;
+	verified_header = header;
+	return true;
+}
+
+bool SensorLog::in_range(uint32_t sequence) const {
+	uint32_t oldest, newest;
+	return get_sequence_range(oldest, newest) && sequence >= oldest && sequence <= newest;
+}
+
+bool SensorLog::read_header(uint32_t sequence, sensor_log_segment_header_t& header) {
+	if(!initialized || !in_range(sequence)) {
+		return false;
+	}
+
+	// The writer may have started recycling the segment while it was read
+	return verify_segment(sequence, header) && in_range(sequence);
+}
+
+int SensorLog::read_records(uint32_t sequence, uint16_t first, sensor_log_record_t* records,
+		uint16_t count) {
+	sensor_log_segment_header_t header;
+	if(!read_header(sequence, header)) {
+		return BD_ERROR_DEVICE_ERROR;
+	}
+
+	if(first >= header.record_count) {
+		return 0;
+	}
+	if(count > header.record_count - first) {
+		count = header.record_count - first;
+	}
+
+	bd_addr_t addr = segment_address(sequence) + SENSOR_LOG_HEADER_SIZE +
+			first * sizeof(sensor_log_record_t);
+	int err = bd.read(records, addr, count * sizeof(sensor_log_record_t));
+	if(err) {
+		return err;
+	}
+	if(!in_range(sequence)) {
+		return BD_ERROR_DEVICE_ERROR;
+	}
+
+	return count;
+}
+
+int SensorLog::read_record_data(uint32_t sequence, size_t offset, void* buffer, size_t len) {
+	if(offset + len > SENSOR_LOG_SEGMENT_SIZE - SENSOR_LOG_HEADER_SIZE) {
+		return BD_ERROR_DEVICE_ERROR;
+	}
+
+	sensor_log_segment_header_t header;
+	if(!read_header(sequence, header)) {
+		return BD_ERROR_DEVICE_ERROR;
+	}
+
+	int err = bd.read(buffer, segment_address(sequence) + SENSOR_LOG_HEADER_SIZE + offset, len);
+	if(err) {
+		return err;
+	}
+
+	return in_range(sequence)? 0 : BD_ERROR_DEVICE_ERROR;
+}
+
+void SensorLog::print_stats(void) {
+	uint32_t oldest = 0, newest = 0;
+	bool any = get_sequence_range(oldest, newest);
+	printf("sensor log: %lu records, %lu dropped, %lu segments written, %lu errors, "
+			"%lu corrupt, on flash %lu-%lu%s\r\n", records_logged, records_dropped,
+			segments_written, write_errors, corrupt_segments, oldest, newest,
+			any? "" : " (empty)");
+}
@@ -0,0 +1,267 @@
+/*
+ * sensor_log.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef SENSOR_LOG_H_
+#define SENSOR_LOG_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#include "BlockDevice.h"
+#include "platform/NonCopyable.h"
+#include "rtos/EventFlags.h"
+#include "rtos/Thread.h"
+
+#include "sensor_sample.h"
+
+/** Size of a segment, a multiple of the block device's erase size */
+#define SENSOR_LOG_SEGMENT_SIZE			4096
+
+#define SENSOR_LOG_HEADER_SIZE			32
+
+#define SENSOR_LOG_MAGIC				0x474F4C53	// "SLOG"
+#define SENSOR_LOG_VERSION				3	// 1 had no sequence numbers, 2 no skip counts (both read as 0)
+
+#define SENSOR_LOG_WRITER_STACK_SIZE	1024
+
+/** Fixed size log record */
+typedef struct {
+	uint32_t time_ms;		/** Milliseconds since boot the sample was read at */
+	uint8_t channel;		/** sensor_channel_t, or SENSOR_LOG_CHANNEL_TIME_SYNC */
+	uint8_t skipped;		/** Readings of the channel not logged on purpose since the previous record */
+	uint16_t sequence;		/** Reading of the channel's sensor, see sensor_sample_t */
+	sensor_value_t value;
+} sensor_log_record_t;
+
+/**
+ * Wall clock mapping set by a host (see TimeSyncService), in the record stream
+ * so downloads can convert the rest of the boot: time_ms is the device time
+ * of the sync, the value holds the wall clock at that time as a little endian
+ * sint64 of ms since the Unix epoch.
+ */
+#define SENSOR_LOG_CHANNEL_TIME_SYNC	0xFE
+
+#define SENSOR_LOG_RECORDS_PER_SEGMENT \
+	((SENSOR_LOG_SEGMENT_SIZE - SENSOR_LOG_HEADER_SIZE) / sizeof(sensor_log_record_t))
+
+/** Header at the start of every segment */
+typedef struct {
+	uint32_t magic;
+	uint8_t version;
+	uint8_t record_size;
+	uint16_t record_count;
+	uint32_t sequence;		/** Increments with every segment written */
+	uint32_t boot_count;	/** Boot the records were taken in (time_ms restarts at 0) */
+	uint32_t crc;			/** CRC32 of the records */
+	uint8_t reserved[12];
+} sensor_log_segment_header_t;
+
+/**
+ * Append-only sensor log on a raw block device
+ *
+ * The block device is divided into segments that are written round robin,
+ * so every erase block wears at the same rate and the oldest segment is
+ * overwritten once the log is full. Segment sequence number s always lives
+ * in segment s % segment count, so mounting only has to find the newest
+ * valid header.
+ *
+ * Records are collected in RAM and each segment is erased and programmed
+ * once, when it is full (or on sync()). A low priority writer thread does
+ * the flash work, double buffering lets the producer keep appending in the
+ * meantime.
+ *
+ * The header's CRC covers the records. Mounting skips segments whose CRC
+ * does not match (eg: programming was interrupted by a reset), and so do the
+ * read functions, which check a segment once before the first read of it.
+ *
+ * append(), sync() and flush() must be called from a single thread, the
+ * read functions from a single (possibly different) thread.
+ */
+class SensorLog : private mbed::NonCopyable<SensorLog> {
+public:
+
+	SensorLog(BlockDevice& bd, osPriority priority = osPriorityLow);
+
+	/**
+	 * Initialize the block device, find the newest segment and start the writer
+	 * @retval 0 on success, negative error code otherwise
+	 */
+	int init(void);
+
+	/**
+	 * Only log a channel if at least min_interval_ms passed since its last
+	 * record, the readings left out count in the next record's skipped
+	 */
+	void set_min_interval(sensor_channel_t channel, uint32_t min_interval_ms);
+
+	/**
+	 * Add a sample to the log
+	 * @retval false if the record was dropped (not initialized, rate limited or
+	 * both buffers waiting for the flash)
+	 */
+	bool append(const sensor_sample_t& sample);
+
+	/**
+	 * Record that the device time time_ms was wall_ms (ms since the Unix epoch),
+	 * never rate limited
+	 * @retval false if the record was dropped
+	 */
+	bool append_time_sync(uint32_t time_ms, int64_t wall_ms);
+
+	/**
+	 * Write the partially filled segment now (eg: before reading the log back)
+	 *
+	 * Blocks until the segment is on flash, the rest of the partial segment
+	 * is left unused.
+	 */
+	void sync(void);
+
+	/**
+	 * Hand the partially filled segment to the writer without waiting for it
+	 *
+	 * Unlike sync() this returns right away, the records can be read once
+	 * get_sequence_range() reaches the returned segment. If is_writing() is
+	 * false and it did not, the write failed.
+	 * @param[out] sequence Newest segment handed to the writer
+	 * @retval false if the writer is still busy with the previous segment, try again later
+	 */
+	bool flush(uint32_t& sequence);
+
+	/** Records appended but not on flash yet, producer thread only */
+	bool has_unsynced(void) const {
+		return active_count != 0 || pending.load() != -1;
+	}
+
+	/** The writer is busy with a segment */
+	bool is_writing(void) const {
+		return pending.load() != -1;
+	}
+
+	/** Number of segments that fit on the block device */
+	uint32_t get_segment_count(void) const {
+		return segment_count;
+	}
+
+	/**
+	 * Sequence numbers of the oldest and the newest segment on flash
+	 * @retval false if the log is empty
+	 */
+	bool get_sequence_range(uint32_t& oldest, uint32_t& newest) const;
+
+	/**
+	 * Read the header of a segment from flash
+	 * @retval false if the segment has been overwritten, is invalid or fails its CRC
+	 */
+	bool read_header(uint32_t sequence, sensor_log_segment_header_t& header);
+
+	/**
+	 * Read records of a segment from flash
+	 * @retval Number of records read, negative on error
+	 */
+	int read_records(uint32_t sequence, uint16_t first, sensor_log_record_t* records,
+			uint16_t count);
+
+	/**
+	 * Read raw bytes of the record area of a segment (records are packed back
+	 * to back, sizeof(sensor_log_record_t) each)
+	 * @retval 0 on success, negative on error
+	 */
+	int read_record_data(uint32_t sequence, size_t offset, void* buffer, size_t len);
+
+	uint32_t get_boot_count(void) const {
+		return boot_count;
+	}
+
+	uint32_t get_records_logged(void) const {
+		return records_logged;
+	}
+
+	uint32_t get_records_dropped(void) const {
+		return records_dropped;
+	}
+
+	uint32_t get_segments_written(void) const {
+		return segments_written;
+	}
+
+	uint32_t get_write_errors(void) const {
+		return write_errors;
+	}
+
+	/** Segments skipped because their records did not match the CRC */
+	uint32_t get_corrupt_segments(void) const {
+		return corrupt_segments;
+	}
+
+	void print_stats(void);
+
+private:
+
+	void writer_thread_main(void);
+
+	/** Copy a record into the active buffer */
+	bool append_record(const sensor_log_record_t& record);
+
+	/** Pass the active buffer to the writer, returns false if the writer is busy */
+	bool submit_active(void);
+
+	/**
+	 * Read the header of a segment and check its records against the CRC
+	 * @retval false if the header is invalid, for another sequence or the CRC does not match
+	 */
+	bool check_segment(uint32_t sequence, sensor_log_segment_header_t& header);
+
+	/** Read side: check_segment() unless the segment was checked already */
+	bool verify_segment(uint32_t sequence, sensor_log_segment_header_t& header);
+
+	/** Read side: true if the segment is still on flash */
+	bool in_range(uint32_t sequence) const;
+
+	bd_addr_t segment_address(uint32_t sequence) const {
+		return (bd_addr_t) (sequence % segment_count) * SENSOR_LOG_SEGMENT_SIZE;
+	}
+
+	BlockDevice& bd;
+	rtos::Thread thread;
+	rtos::EventFlags flags;
+
+	bool initialized;
+	uint32_t segment_count;
+	uint32_t boot_count;
+	uint32_t next_sequence;		/** Producer side */
+
+	/** Updated by the writer once a segment is on flash */
+	std::atomic<bool> have_segments;
+	std::atomic<uint32_t> first_sequence;	/** Oldest segment on flash (found by init() or the first written) */
+	std::atomic<uint32_t> newest_sequence;
+
+	/** Read side, the last segment that passed check_segment() */
+	bool verified;
+	uint32_t verified_sequence;
+	sensor_log_segment_header_t verified_header;
+
+	/** Producer side */
+	uint8_t buffers[2][SENSOR_LOG_SEGMENT_SIZE];
+	int active;
+	uint16_t active_count;
+	uint32_t last_logged_ms[SENSOR_CHANNEL_COUNT];
+	uint32_t min_interval_ms[SENSOR_CHANNEL_COUNT];
+	bool logged_once[SENSOR_CHANNEL_COUNT];
+	uint32_t skipped[SENSOR_CHANNEL_COUNT];		/** Rate limited since the last record */
+
+	/** Buffer handed to the writer, -1 when the writer is idle */
+	std::atomic<int> pending;
+
+	uint32_t records_logged;
+	uint32_t records_dropped;
+	uint32_t segments_written;
+	uint32_t write_errors;
+	uint32_t corrupt_segments;
+
+};
+
+#endif /* SENSOR_LOG_H_ */
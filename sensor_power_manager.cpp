@@ -0,0 +1,372 @@
+/*
+ * sensor_power_manager.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "sensor_power_manager.h"
+
+#include <stdio.h>
+
+#include "rtos/ThisThread.h"
+
+#include "trace.h"
+
+#define MS_TO_US(x) (((uint64_t) (x)) * 1000)
+
+/** When something needing lead_us to wake up has to be woken for a release */
+static uint64_t wake_time_us(uint64_t release_us, uint64_t lead_us) {
+	if(release_us == UINT64_MAX) {
+		return UINT64_MAX;
+	}
+	return (release_us > lead_us)? release_us - lead_us : 0;
+}
+
+/** Percentage in hundredths, avoids float formatting */
+static uint32_t hundredths_of_percent(uint64_t part, uint64_t total) {
+	return (total == 0)? 0 : (uint32_t) ((part * 10000) / total);
+}
+
+SensorPowerManager::SensorPowerManager(SensorScheduler& scheduler, SchedulerClock& clock,
+		I2CTransactionEngine& engine, mbed::DigitalOut& enable) :
+	scheduler(scheduler), clock(clock), engine(engine), enable(enable), domain(), reinit(),
+	domain_cycling(false), domain_on(true), holds(0), tasks(), num_tasks(0), devices(),
+	num_devices(0), max_reinit_us(0), power_cycles(0), reinit_failures(0), stats_start_us(0),
+	last_account_us(0), domain_off_us(0), charge_pc(0) {
+	stats_start_us = clock.now_us();
+	last_account_us = stats_start_us;
+}
+
+void SensorPowerManager::set_domain(const sensor_power_domain_t& domain, mbed::Callback<bool()> reinit) {
+	this->domain = domain;
+	this->reinit = reinit;
+	max_reinit_us = (uint32_t) MS_TO_US(domain.reinit_ms);
+}
+
+void SensorPowerManager::set_domain_cycling(bool enabled) {
+	domain_cycling = enabled;
+	if(!enabled && !domain_on) {
+		power_up();
+	}
+}
+
+bool SensorPowerManager::add_task(SensorScheduler::task_id_t task, bool power_cycle_ok,
+		uint32_t run_charge_nc) {
+	if(num_tasks >= SENSOR_POWER_MAX_TASKS || task == SensorScheduler::INVALID_TASK) {
+		return false;
+	}
+
+	domain_task_t& entry = tasks[num_tasks++];
+	entry.task = task;
+	entry.power_cycle_ok = power_cycle_ok;
+	entry.run_charge_nc = run_charge_nc;
+	const SensorScheduler::task_stats_t* stats = scheduler.get_stats(task);
+	entry.runs_at_reset = (stats != NULL)? stats->runs : 0;
+	return true;
+}
+
+void SensorPowerManager::set_power_cycle_ok(SensorScheduler::task_id_t task, bool power_cycle_ok) {
+	for(int i = 0; i < num_tasks; i++) {
+		if(tasks[i].task == task) {
+			tasks[i].power_cycle_ok = power_cycle_ok;
+		}
+	}
+}
+
+void SensorPowerManager::set_run_charge(SensorScheduler::task_id_t task, uint32_t run_charge_nc) {
+	for(int i = 0; i < num_tasks; i++) {
+		if(tasks[i].task == task) {
+			tasks[i].run_charge_nc = run_charge_nc;
+		}
+	}
+}
+
+bool SensorPowerManager::add_device(const char* name, SensorScheduler::task_id_t task,
+		low_power_cb_t set_low_power, uint32_t wake_ms, uint32_t active_ua, uint32_t low_power_ua) {
+	if(num_devices >= SENSOR_POWER_MAX_DEVICES || task == SensorScheduler::INVALID_TASK) {
+		return false;
+	}
+
+	device_t& device = devices[num_devices++];
+	device.name = name;
+	device.task = task;
+	device.set_low_power = set_low_power;
+	device.wake_us = MS_TO_US(wake_ms + SENSOR_POWER_WAKE_MARGIN_MS);
+	device.active_ua = active_ua;
+	device.low_power_ua = low_power_ua;
+	device.low_power = false;
+	device.low_power_entries = 0;
+	device.low_power_us = 0;
+	return true;
+}
+
+void SensorPowerManager::acquire(void) {
+	holds++;
+
+	if(!domain_on) {
+		power_up();
+		return;
+	}
+
+	uint64_t now = clock.now_us();
+	for(int i = 0; i < num_devices; i++) {
+		if(devices[i].low_power) {
+			set_device_low_power(devices[i], false, now);
+		}
+	}
+}
+
+void SensorPowerManager::release(void) {
+	if(holds > 0) {
+		holds--;
+	}
+}
+
+uint64_t SensorPowerManager::enter_idle(uint64_t now_us, uint64_t next_release_us) {
+	account(now_us);
+
+	if(holds != 0) {
+		return next_release_us;
+	}
+
+	uint64_t domain_release_us = next_domain_release_us();
+
+	if(!domain_on) {
+		// Back on in time for the re-init before the first task that needs it
+		uint64_t wakeup_us = wake_time_us(domain_release_us, domain_lead_us());
+		return (wakeup_us < next_release_us)? wakeup_us : next_release_us;
+	}
+
+	bool cut_domain = domain_cycling && !domain_pinned() &&
+			(domain_release_us == UINT64_MAX ||
+			 domain_release_us >= now_us + domain_lead_us() + MS_TO_US(SENSOR_POWER_MIN_OFF_MS));
+
+	bool sleep_devices = false;
+	for(int i = 0; i < num_devices; i++) {
+		sleep_devices |= device_can_sleep(devices[i], now_us);
+	}
+
+	// A queued transfer would reach a sensor that is already off or asleep
+	if((cut_domain || sleep_devices) && !engine.is_idle()) {
+		uint64_t retry_us = now_us + MS_TO_US(SENSOR_POWER_BUSY_RETRY_MS);
+		return (retry_us < next_release_us)? retry_us : next_release_us;
+	}
+
+	if(cut_domain) {
+		power_down(now_us);
+		uint64_t wakeup_us = wake_time_us(domain_release_us, domain_lead_us());
+		return (wakeup_us < next_release_us)? wakeup_us : next_release_us;
+	}
+
+	uint64_t wakeup_us = next_release_us;
+	for(int i = 0; i < num_devices; i++) {
+		device_t& device = devices[i];
+		if(device_can_sleep(device, now_us)) {
+			set_device_low_power(device, true, now_us);
+		}
+
+		if(device.low_power) {
+			uint64_t device_wakeup_us = wake_time_us(scheduler.get_release_us(device.task),
+					device.wake_us);
+			if(device_wakeup_us < wakeup_us) {
+				wakeup_us = device_wakeup_us;
+			}
+		}
+	}
+
+	return wakeup_us;
+}
+
+void SensorPowerManager::exit_idle(uint64_t now_us) {
+	if(!domain_on) {
+		// Also comes back when a task that needs continuous power was enabled meanwhile
+		if(domain_pinned() || now_us >= wake_time_us(next_domain_release_us(), domain_lead_us())) {
+			power_up();
+		}
+		return;
+	}
+
+	for(int i = 0; i < num_devices; i++) {
+		device_t& device = devices[i];
+		if(device.low_power &&
+		   now_us >= wake_time_us(scheduler.get_release_us(device.task), device.wake_us)) {
+			set_device_low_power(device, false, now_us);
+		}
+	}
+}
+
+uint64_t SensorPowerManager::next_domain_release_us(void) const {
+	uint64_t next = UINT64_MAX;
+	for(int i = 0; i < num_tasks; i++) {
+		uint64_t release_us = scheduler.get_release_us(tasks[i].task);
+		if(release_us < next) {
+			next = release_us;
+		}
+	}
+	return next;
+}
+
+bool SensorPowerManager::device_can_sleep(const device_t& device, uint64_t now_us) const {
+	if(device.low_power) {
+		return false;
+	}
+	uint64_t release_us = scheduler.get_release_us(device.task);
+	return (release_us == UINT64_MAX ||
+			release_us >= now_us + device.wake_us + MS_TO_US(SENSOR_POWER_MIN_OFF_MS));
+}
+
+bool SensorPowerManager::domain_pinned(void) const {
+	for(int i = 0; i < num_tasks; i++) {
+		if(!tasks[i].power_cycle_ok && scheduler.is_active(tasks[i].task)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+uint64_t SensorPowerManager::domain_lead_us(void) const {
+	return MS_TO_US(domain.power_up_ms + domain.settle_ms + SENSOR_POWER_WAKE_MARGIN_MS) +
+			max_reinit_us;
+}
+
+void SensorPowerManager::power_down(uint64_t now_us) {
+	account(now_us);
+	TRACE_INSTANT(TRACE_EVENT_SENSOR_POWER, 0);
+
+	// Everything comes back in its power-on mode
+	for(int i = 0; i < num_devices; i++) {
+		devices[i].low_power = false;
+	}
+
+	enable = 0;
+	domain_on = false;
+	power_cycles++;
+}
+
+void SensorPowerManager::power_up(void) {
+	account(clock.now_us());
+	TRACE_BEGIN(TRACE_EVENT_SENSOR_POWER, 0);
+
+	enable = 1;
+	domain_on = true;
+
+	// Blocks without dispatching the sensor event queue, so nothing posted
+	// there talks to the sensors before they are re-initialized
+	rtos::ThisThread::sleep_for(domain.power_up_ms);
+
+	uint64_t start = clock.now_us();
+	if(reinit && !reinit()) {
+		reinit_failures++;
+	}
+	uint32_t reinit_us = (uint32_t) (clock.now_us() - start);
+	if(reinit_us > max_reinit_us) {
+		// Later wake-ups start earlier to cover it
+		max_reinit_us = reinit_us;
+	}
+
+	TRACE_END(TRACE_EVENT_SENSOR_POWER, 0);
+}
+
+void SensorPowerManager::set_device_low_power(device_t& device, bool low_power, uint64_t now_us) {
+	account(now_us);
+	if(device.set_low_power) {
+		device.set_low_power(low_power);
+	}
+	device.low_power = low_power;
+	if(low_power) {
+		device.low_power_entries++;
+	}
+}
+
+void SensorPowerManager::account(uint64_t now_us) {
+	if(now_us <= last_account_us) {
+		return;
+	}
+
+	uint64_t elapsed = now_us - last_account_us;
+	charge_pc += (uint64_t) current_ua() * elapsed;
+	if(!domain_on) {
+		domain_off_us += elapsed;
+	}
+	for(int i = 0; i < num_devices; i++) {
+		if(devices[i].low_power) {
+			devices[i].low_power_us += elapsed;
+		}
+	}
+	last_account_us = now_us;
+}
+
+uint32_t SensorPowerManager::current_ua(void) const {
+	if(!domain_on) {
+		return domain.off_ua;
+	}
+
+	uint32_t total = domain.on_ua;
+	for(int i = 0; i < num_devices; i++) {
+		total += devices[i].low_power? devices[i].low_power_ua : devices[i].active_ua;
+	}
+	return total;
+}
+
+uint32_t SensorPowerManager::get_average_ua(void) {
+	// Read-only, may be called from another thread than the sensor thread
+	uint64_t now = clock.now_us();
+	uint64_t elapsed = now - stats_start_us;
+	if(elapsed == 0) {
+		return current_ua();
+	}
+
+	uint64_t charge = charge_pc;
+	if(now > last_account_us) {
+		charge += (uint64_t) current_ua() * (now - last_account_us);
+	}
+
+	for(int i = 0; i < num_tasks; i++) {
+		const SensorScheduler::task_stats_t* stats = scheduler.get_stats(tasks[i].task);
+		if(stats != NULL && stats->runs > tasks[i].runs_at_reset) {
+			charge += (uint64_t) (stats->runs - tasks[i].runs_at_reset) * tasks[i].run_charge_nc * 1000;
+		}
+	}
+
+	return (uint32_t) (charge / elapsed);
+}
+
+void SensorPowerManager::reset_stats(void) {
+	stats_start_us = clock.now_us();
+	last_account_us = stats_start_us;
+	charge_pc = 0;
+	domain_off_us = 0;
+	power_cycles = 0;
+	reinit_failures = 0;
+
+	for(int i = 0; i < num_tasks; i++) {
+		const SensorScheduler::task_stats_t* stats = scheduler.get_stats(tasks[i].task);
+		tasks[i].runs_at_reset = (stats != NULL)? stats->runs : 0;
+	}
+	for(int i = 0; i < num_devices; i++) {
+		devices[i].low_power_entries = 0;
+		devices[i].low_power_us = 0;
+	}
+}
+
+void SensorPowerManager::print_stats(void) {
+	uint64_t elapsed = clock.now_us() - stats_start_us;
+
+	uint32_t off = hundredths_of_percent(domain_off_us, elapsed);
+	printf("power: domain %s, cycling %s, off %lu.%02lu%%, %lu power cycles, "
+			"reinit max %lu us, %lu failed\r\n", domain_on? "on" : "off",
+			domain_cycling? "on" : "off", (unsigned long) (off / 100), (unsigned long) (off % 100),
+			(unsigned long) power_cycles, (unsigned long) max_reinit_us,
+			(unsigned long) reinit_failures);
+
+	for(int i = 0; i < num_devices; i++) {
+		device_t& device = devices[i];
+		uint32_t low = hundredths_of_percent(device.low_power_us, elapsed);
+		printf("power: %-10s low power %lu.%02lu%%, entered %lu times\r\n", device.name,
+				(unsigned long) (low / 100), (unsigned long) (low % 100),
+				(unsigned long) device.low_power_entries);
+	}
+
+	printf("power: estimated average %lu uA over %lu ms\r\n", (unsigned long) get_average_ua(),
+			(unsigned long) (elapsed / 1000));
+}
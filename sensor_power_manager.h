@@ -0,0 +1,213 @@
+/*
+ * sensor_power_manager.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef SENSOR_POWER_MANAGER_H_
+#define SENSOR_POWER_MANAGER_H_
+
+#include <stdint.h>
+
+#include "drivers/DigitalOut.h"
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+#include "i2c_transaction_engine.h"
+#include "sensor_scheduler.h"
+
+#define SENSOR_POWER_MAX_TASKS		SENSOR_SCHEDULER_MAX_TASKS
+#define SENSOR_POWER_MAX_DEVICES	4
+
+/** Shortest time worth switching something off for, on top of its wake-up time */
+#define SENSOR_POWER_MIN_OFF_MS		20
+
+/** Slack added to every wake-up, covers the scheduler clock's millisecond rounding */
+#define SENSOR_POWER_WAKE_MARGIN_MS	5
+
+/** Retry interval while queued I2C transfers keep the sensors from being switched */
+#define SENSOR_POWER_BUSY_RETRY_MS	2
+
+/** The sensor power domain (eg: sensor_power_en) */
+typedef struct {
+	uint32_t power_up_ms;	/** Switch-on until the sensors respond */
+	uint32_t reinit_ms;		/** Expected re-init time, replaced by the worst one measured */
+	uint32_t settle_ms;		/** Re-init until the readings are valid (eg: a first conversion) */
+	uint32_t on_ua;			/** Supply current while on, devices registered with add_device() excluded */
+	uint32_t off_ua;		/** Supply current while off */
+} sensor_power_domain_t;
+
+/**
+ * Duty cycles the sensor power domain and the sensors' own low power modes
+ *
+ * Installed as the scheduler's idle handler, so every decision is made on the
+ * sensor thread right before it sleeps:
+ *  - A sensor with a low power mode of its own (add_device) is put in it when
+ *    its task is not due within its wake-up time, and woken that long ahead of
+ *    the task's next release.
+ *  - The whole domain is switched off when no task on it is due within the
+ *    power-up, re-init and settling time and none of them needs continuous
+ *    power (eg: BSEC keeps its state in the BME680). It is switched back on
+ *    early enough for the re-init to finish before the first release that needs it.
+ *
+ * Nothing is switched while transfers are queued on the I2C engine. Domain
+ * cycling is off until set_domain_cycling(true).
+ *
+ * The time spent in every state is integrated into an estimate of the sensors'
+ * average supply current, so configurations (poll periods, which sensors run)
+ * can be compared on the device.
+ */
+class SensorPowerManager : public SchedulerIdleHandler, private mbed::NonCopyable<SensorPowerManager> {
+public:
+
+	/** Enter (true) or leave (false) a sensor's low power mode, runs on the sensor thread */
+	typedef mbed::Callback<void(bool)> low_power_cb_t;
+
+	/**
+	 * @param[in] scheduler Scheduler whose releases drive the power states
+	 * @param[in] clock Clock of that scheduler
+	 * @param[in] engine Engine the sensors are read through
+	 * @param[in] enable Domain power switch, the sensors must be on and initialized
+	 * when the scheduler starts
+	 */
+	SensorPowerManager(SensorScheduler& scheduler, SchedulerClock& clock,
+			I2CTransactionEngine& engine, mbed::DigitalOut& enable);
+
+	/**
+	 * Describe the power domain
+	 * @param[in] domain Timing and supply current
+	 * @param[in] reinit Restores the sensors after the domain was switched back on,
+	 * runs on the sensor thread. Should reuse any calibration instead of redoing it.
+	 */
+	void set_domain(const sensor_power_domain_t& domain, mbed::Callback<bool()> reinit);
+
+	/** Allow switching the domain off between releases */
+	void set_domain_cycling(bool enabled);
+
+	bool get_domain_cycling(void) const {
+		return domain_cycling;
+	}
+
+	/**
+	 * Register a task that talks to sensors on the domain
+	 * @param[in] task Scheduler task
+	 * @param[in] power_cycle_ok false if the domain must stay on while the task is active
+	 * @param[in] run_charge_nc Charge one run draws on top of the standby currents
+	 * (eg: a ranging measurement), in nC (uA x ms)
+	 * @retval false if the table is full
+	 */
+	bool add_task(SensorScheduler::task_id_t task, bool power_cycle_ok, uint32_t run_charge_nc = 0);
+
+	/**
+	 * Change whether a registered task lets the domain be switched off
+	 * (eg: a sensor that has to stay powered to raise interrupts)
+	 */
+	void set_power_cycle_ok(SensorScheduler::task_id_t task, bool power_cycle_ok);
+
+	/** Change the charge a run of a registered task draws (eg: a new measurement time) */
+	void set_run_charge(SensorScheduler::task_id_t task, uint32_t run_charge_nc);
+
+	/**
+	 * Register a sensor with a low power mode of its own
+	 * @param[in] name Human-readable name (must outlive the manager)
+	 * @param[in] task Task that reads the sensor
+	 * @param[in] set_low_power Switches the mode
+	 * @param[in] wake_ms Time the sensor needs after leaving the low power mode
+	 * @param[in] active_ua, low_power_ua Supply current in each mode
+	 * @retval false if the table is full
+	 */
+	bool add_device(const char* name, SensorScheduler::task_id_t task, low_power_cb_t set_low_power,
+			uint32_t wake_ms, uint32_t active_ua, uint32_t low_power_ua);
+
+	/**
+	 * Keep the domain and every device powered until release() (eg: while streaming)
+	 *
+	 * Switches the domain back on and re-initializes it first if it was off.
+	 * Sensor thread only.
+	 */
+	void acquire(void);
+
+	void release(void);
+
+	virtual uint64_t enter_idle(uint64_t now_us, uint64_t next_release_us);
+
+	virtual void exit_idle(uint64_t now_us);
+
+	/** Estimated average supply current of the sensors since the last reset_stats() */
+	uint32_t get_average_ua(void);
+
+	void reset_stats(void);
+
+	/** Print the time spent in each state and the current estimate */
+	void print_stats(void);
+
+private:
+
+	typedef struct {
+		SensorScheduler::task_id_t task;
+		bool power_cycle_ok;
+		uint32_t run_charge_nc;
+		uint32_t runs_at_reset;
+	} domain_task_t;
+
+	typedef struct {
+		const char* name;
+		SensorScheduler::task_id_t task;
+		low_power_cb_t set_low_power;
+		uint64_t wake_us;
+		uint32_t active_ua;
+		uint32_t low_power_ua;
+		bool low_power;
+		uint32_t low_power_entries;
+		uint64_t low_power_us;
+	} device_t;
+
+	/** Earliest release among the domain's tasks, UINT64_MAX if none is active */
+	uint64_t next_domain_release_us(void) const;
+
+	/** True if the device is awake and its task is not due within its wake-up time */
+	bool device_can_sleep(const device_t& device, uint64_t now_us) const;
+
+	/** True if an active task needs the domain to stay on */
+	bool domain_pinned(void) const;
+
+	/** Switch-on to first release */
+	uint64_t domain_lead_us(void) const;
+
+	void power_down(uint64_t now_us);
+
+	void power_up(void);
+
+	void set_device_low_power(device_t& device, bool low_power, uint64_t now_us);
+
+	/** Charge the time since the last state change to the current state */
+	void account(uint64_t now_us);
+
+	uint32_t current_ua(void) const;
+
+	SensorScheduler& scheduler;
+	SchedulerClock& clock;
+	I2CTransactionEngine& engine;
+	mbed::DigitalOut& enable;
+	sensor_power_domain_t domain;
+	mbed::Callback<bool()> reinit;
+	bool domain_cycling;
+	bool domain_on;
+	int holds;
+	domain_task_t tasks[SENSOR_POWER_MAX_TASKS];
+	int num_tasks;
+	device_t devices[SENSOR_POWER_MAX_DEVICES];
+	int num_devices;
+
+	/** Statistics */
+	uint32_t max_reinit_us;
+	uint32_t power_cycles;
+	uint32_t reinit_failures;
+	uint64_t stats_start_us;
+	uint64_t last_account_us;
+	uint64_t domain_off_us;
+	uint64_t charge_pc;			/** Standby charge in pC (uA x us) */
+
+};
+
+#endif /* SENSOR_POWER_MANAGER_H_ */
@@ -0,0 +1,56 @@
+/*
+ * sensor_sample.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "sensor_sample.h"
+
+typedef struct {
+	const char* name;
+	sensor_value_type_t type;
+	sensor_id_t sensor;
+} channel_info_t;
+
+/** Indexed by sensor_channel_t */
+static const channel_info_t channel_info[SENSOR_CHANNEL_COUNT] = {
+	{ "bme680 temp",		SENSOR_VALUE_I32,	SENSOR_ID_BME680 },
+	{ "bme680 pressure",	SENSOR_VALUE_U32,	SENSOR_ID_BME680 },
+	{ "bme680 humidity",	SENSOR_VALUE_U32,	SENSOR_ID_BME680 },
+	{ "bme680 gas res",		SENSOR_VALUE_U32,	SENSOR_ID_BME680 },
+	{ "bme680 co2",			SENSOR_VALUE_FLOAT,	SENSOR_ID_BME680 },
+	{ "bme680 bvoc",		SENSOR_VALUE_FLOAT,	SENSOR_ID_BME680 },
+	{ "bme680 iaq",			SENSOR_VALUE_U32,	SENSOR_ID_BME680 },
+	{ "bme680 iaq acc",		SENSOR_VALUE_U32,	SENSOR_ID_BME680 },
+	{ "max44009 als",		SENSOR_VALUE_FLOAT,	SENSOR_ID_MAX44009 },
+	{ "si7021 temp",		SENSOR_VALUE_I32,	SENSOR_ID_SI7021 },
+	{ "si7021 humidity",	SENSOR_VALUE_U32,	SENSOR_ID_SI7021 },
+	{ "vl53l0x distance",	SENSOR_VALUE_U32,	SENSOR_ID_VL53L0X },
+	{ "lsm9ds1 accel",		SENSOR_VALUE_VEC3,	SENSOR_ID_LSM9DS1 },
+	{ "lsm9ds1 gyro",		SENSOR_VALUE_VEC3,	SENSOR_ID_LSM9DS1 },
+	{ "lsm9ds1 mag",		SENSOR_VALUE_VEC3,	SENSOR_ID_LSM9DS1 },
+	{ "icm20602 accel",		SENSOR_VALUE_VEC3,	SENSOR_ID_ICM20602 },
+	{ "icm20602 gyro",		SENSOR_VALUE_VEC3,	SENSOR_ID_ICM20602 },
+	{ "battery",			SENSOR_VALUE_FLOAT,	SENSOR_ID_BATTERY },
+};
+
+sensor_value_type_t sensor_channel_value_type(sensor_channel_t channel) {
+	if(channel >= SENSOR_CHANNEL_COUNT) {
+		return SENSOR_VALUE_U32;
+	}
+	return channel_info[channel].type;
+}
+
+sensor_id_t sensor_channel_sensor(sensor_channel_t channel) {
+	if(channel >= SENSOR_CHANNEL_COUNT) {
+		return SENSOR_ID_COUNT;
+	}
+	return channel_info[channel].sensor;
+}
+
+const char* sensor_channel_name(sensor_channel_t channel) {
+	if(channel >= SENSOR_CHANNEL_COUNT) {
+		return "unknown";
+	}
+	return channel_info[channel].name;
+}
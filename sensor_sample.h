@@ -0,0 +1,145 @@
+/*
+ * sensor_sample.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef SENSOR_SAMPLE_H_
+#define SENSOR_SAMPLE_H_
+
+#include <stdint.h>
+
+/**
+ * Every value published over BLE, one channel per GATT characteristic
+ *
+ * Integer channels carry the value already scaled to the characteristic's
+ * unit (eg: 0.01 degC for temperature) and range, see gatt_units.h.
+ */
+typedef enum {
+	SENSOR_CHANNEL_BME680_TEMP = 0,			/** int32, 0.01 degC */
+	SENSOR_CHANNEL_BME680_PRESSURE,			/** uint32, 0.1 Pa */
+	SENSOR_CHANNEL_BME680_HUMIDITY,			/** uint32, 0.01 %RH */
+	SENSOR_CHANNEL_BME680_GAS_RESISTANCE,	/** uint32, Ohm */
+	SENSOR_CHANNEL_BME680_CO2,				/** float, ppm */
+	SENSOR_CHANNEL_BME680_BVOC,				/** float, ppm */
+	SENSOR_CHANNEL_BME680_IAQ_SCORE,		/** uint32 */
+	SENSOR_CHANNEL_BME680_IAQ_ACCURACY,		/** uint32 */
+	SENSOR_CHANNEL_MAX44009_ALS,			/** float, lux */
+	SENSOR_CHANNEL_SI7021_TEMP,				/** int32, 0.01 degC */
+	SENSOR_CHANNEL_SI7021_HUMIDITY,			/** uint32, 0.01 %RH */
+	SENSOR_CHANNEL_VL53L0X_DISTANCE,		/** uint32, mm */
+	SENSOR_CHANNEL_LSM9DS1_ACCEL,			/** vec3, g */
+	SENSOR_CHANNEL_LSM9DS1_GYRO,			/** vec3, dps */
+	SENSOR_CHANNEL_LSM9DS1_MAG,				/** vec3, gauss */
+	SENSOR_CHANNEL_ICM20602_ACCEL,			/** vec3, g */
+	SENSOR_CHANNEL_ICM20602_GYRO,			/** vec3, dps */
+	SENSOR_CHANNEL_BATTERY_VOLTAGE,			/** float, V */
+	SENSOR_CHANNEL_COUNT
+} sensor_channel_t;
+
+/** Sensors behind the channels, each keeps its own reading sequence number */
+typedef enum {
+	SENSOR_ID_BME680 = 0,
+	SENSOR_ID_MAX44009,
+	SENSOR_ID_SI7021,
+	SENSOR_ID_VL53L0X,
+	SENSOR_ID_LSM9DS1,
+	SENSOR_ID_ICM20602,
+	SENSOR_ID_BATTERY,
+	SENSOR_ID_COUNT
+} sensor_id_t;
+
+typedef enum {
+	SENSOR_VALUE_I32,
+	SENSOR_VALUE_U32,
+	SENSOR_VALUE_FLOAT,
+	SENSOR_VALUE_VEC3
+} sensor_value_type_t;
+
+typedef union {
+	int32_t i32;
+	uint32_t u32;
+	float f;
+	float vec3[3];
+} sensor_value_t;
+
+/** Saturation value of sensor_sample_t::skipped */
+#define SENSOR_SAMPLE_MAX_SKIPPED	0xFF
+
+/**
+ * A value and when it was read
+ *
+ * time_ms and sequence are stamped when the sample is handed off from the
+ * sensor thread (see SensorSampleHandoff::push()). The sequence number counts
+ * the sensor's readings: every channel of one reading carries the same
+ * number. Stages that hold readings back on purpose (deadbands, coalescing,
+ * the log's rate limit) add them to skipped of the next sample of the
+ * channel they let through, so of a gap in the sequence numbers only what
+ * skipped does not account for was lost on the way.
+ */
+typedef struct {
+	uint8_t channel;	/** sensor_channel_t */
+	uint8_t skipped;	/** Readings of the channel held back since the previous sample, saturates */
+	uint16_t sequence;	/** Reading of the channel's sensor, wraps at 0xFFFF */
+	uint32_t time_ms;	/** Device monotonic time, ms since boot (wraps after 49 days) */
+	sensor_value_t value;
+} sensor_sample_t;
+
+/** Type of the value carried by a channel */
+sensor_value_type_t sensor_channel_value_type(sensor_channel_t channel);
+
+/** Sensor a channel is read from */
+sensor_id_t sensor_channel_sensor(sensor_channel_t channel);
+
+/** Add count to a skipped field, saturating at SENSOR_SAMPLE_MAX_SKIPPED */
+static inline uint8_t sensor_sample_add_skipped(uint8_t skipped, uint32_t count) {
+	uint32_t sum = skipped + count;
+	return (uint8_t) ((sum > SENSOR_SAMPLE_MAX_SKIPPED)? SENSOR_SAMPLE_MAX_SKIPPED : sum);
+}
+
+/** Human-readable channel name */
+const char* sensor_channel_name(sensor_channel_t channel);
+
+static inline sensor_sample_t sensor_sample_i32(sensor_channel_t channel, int32_t value) {
+	sensor_sample_t sample;
+	sample.channel = (uint8_t) channel;
+	sample.skipped = 0;
+	sample.sequence = 0;
+	sample.time_ms = 0;
+	sample.value.i32 = value;
+	return sample;
+}
+
+static inline sensor_sample_t sensor_sample_u32(sensor_channel_t channel, uint32_t value) {
+	sensor_sample_t sample;
+	sample.channel = (uint8_t) channel;
+	sample.skipped = 0;
+	sample.sequence = 0;
+	sample.time_ms = 0;
+	sample.value.u32 = value;
+	return sample;
+}
+
+static inline sensor_sample_t sensor_sample_float(sensor_channel_t channel, float value) {
+	sensor_sample_t sample;
+	sample.channel = (uint8_t) channel;
+	sample.skipped = 0;
+	sample.sequence = 0;
+	sample.time_ms = 0;
+	sample.value.f = value;
+	return sample;
+}
+
+static inline sensor_sample_t sensor_sample_vec3(sensor_channel_t channel, float x, float y, float z) {
+	sensor_sample_t sample;
+	sample.channel = (uint8_t) channel;
+	sample.skipped = 0;
+	sample.sequence = 0;
+	sample.time_ms = 0;
+	sample.value.vec3[0] = x;
+	sample.value.vec3[1] = y;
+	sample.value.vec3[2] = z;
+	return sample;
+}
+
+#endif /* SENSOR_SAMPLE_H_ */
@@ -0,0 +1,81 @@
+/*
+ * sensor_sample_handoff.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "sensor_sample_handoff.h"
+
+#include <stdio.h>
+
+#include "rtos/Kernel.h"
+
+SensorSampleHandoff::SensorSampleHandoff(events::EventQueue& queue, consumer_t consumer,
+		mbed::Callback<void()> end_of_batch) :
+	queue(queue), consumer(consumer), end_of_batch(end_of_batch), ring(),
+	drain_scheduled(false), sequence(), reading_mask(0), high_water(0), drained(0) {
+}
+
+bool SensorSampleHandoff::push(const sensor_sample_t& sample) {
+	sensor_sample_t stamped = sample;
+	stamped.time_ms = (uint32_t) rtos::Kernel::get_ms_count();
+
+	sensor_id_t sensor = sensor_channel_sensor((sensor_channel_t) sample.channel);
+	if(sensor < SENSOR_ID_COUNT) {
+		// The first channel of a reading starts it
+		if((reading_mask & (1UL << sensor)) == 0) {
+			reading_mask |= (1UL << sensor);
+			sequence[sensor]++;
+		}
+		stamped.sequence = sequence[sensor];
+	}
+
+	return ring.push(stamped);
+}
+
+void SensorSampleHandoff::commit(void) {
+	// Whatever comes next is a new reading
+	reading_mask = 0;
+
+	if(ring.empty()) {
+		return;
+	}
+
+	// Only one drain in flight, it picks up everything pushed before it runs
+	if(drain_scheduled.exchange(true)) {
+		return;
+	}
+
+	if(queue.call(mbed::callback(this, &SensorSampleHandoff::drain)) == 0) {
+		// Event queue is out of memory, the next commit will retry
+		drain_scheduled.store(false);
+	}
+}
+
+void SensorSampleHandoff::drain(void) {
+	// Clear before popping so a sample pushed during the drain schedules a new one
+	drain_scheduled.store(false);
+
+	uint32_t depth = ring.size();
+	if(depth > high_water) {
+		high_water = depth;
+	}
+
+	sensor_sample_t sample;
+	while(ring.pop(sample)) {
+		drained++;
+		if(consumer) {
+			consumer(sample);
+		}
+	}
+
+	if(end_of_batch) {
+		end_of_batch();
+	}
+}
+
+void SensorSampleHandoff::print_stats(void) {
+	printf("handoff: %lu samples, %lu dropped, high water %lu/%d\r\n",
+			(unsigned long) drained, (unsigned long) ring.get_dropped(),
+			(unsigned long) high_water, SENSOR_HANDOFF_DEPTH);
+}
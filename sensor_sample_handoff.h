@@ -0,0 +1,94 @@
+/*
+ * sensor_sample_handoff.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef SENSOR_SAMPLE_HANDOFF_H_
+#define SENSOR_SAMPLE_HANDOFF_H_
+
+#include <stdint.h>
+#include <atomic>
+
+#include "events/EventQueue.h"
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+#include "sensor_sample.h"
+#include "spsc_ring.h"
+
+/** Number of samples that can be in flight between the sensor and BLE threads */
+#define SENSOR_HANDOFF_DEPTH 64
+
+/**
+ * Hands sensor samples from the sensor thread to the BLE event queue
+ *
+ * The sensor thread push()es samples into a lock-free SPSC ring and calls
+ * commit() at the end of a poll. push() stamps every sample with the time
+ * and its sensor's reading sequence number, the samples pushed between two
+ * commits are one reading. commit() posts at most one drain to the BLE
+ * event queue; the drain runs on the BLE thread and passes every queued
+ * sample to the consumer, followed by a single end-of-batch call. The sensor
+ * thread therefore never touches BLE stack state.
+ */
+class SensorSampleHandoff : private mbed::NonCopyable<SensorSampleHandoff> {
+public:
+
+	typedef mbed::Callback<void(const sensor_sample_t&)> consumer_t;
+
+	/**
+	 * @param[in] queue BLE event queue the drain runs on
+	 * @param[in] consumer Called on the BLE thread for every sample
+	 * @param[in] end_of_batch Called on the BLE thread after each drain, may be empty
+	 */
+	SensorSampleHandoff(events::EventQueue& queue, consumer_t consumer,
+			mbed::Callback<void()> end_of_batch = mbed::Callback<void()>());
+
+	/**
+	 * Producer side: stamp and queue a sample
+	 *
+	 * A sample dropped here still uses up its sequence number, so the
+	 * consumer sees the gap.
+	 * @retval false if the ring is full and the sample was dropped
+	 */
+	bool push(const sensor_sample_t& sample);
+
+	/** Producer side: make sure a drain is scheduled on the BLE queue */
+	void commit(void);
+
+	/** Samples dropped because the BLE thread fell behind */
+	uint32_t get_dropped(void) const {
+		return ring.get_dropped();
+	}
+
+	/** Deepest the ring has been observed at the start of a drain */
+	uint32_t get_high_water(void) const {
+		return high_water;
+	}
+
+	uint32_t get_drained(void) const {
+		return drained;
+	}
+
+	void print_stats(void);
+
+private:
+
+	void drain(void);
+
+	events::EventQueue& queue;
+	consumer_t consumer;
+	mbed::Callback<void()> end_of_batch;
+	SpscRing<sensor_sample_t, SENSOR_HANDOFF_DEPTH> ring;
+	std::atomic<bool> drain_scheduled;
+
+	/** Producer side: last reading of each sensor, and which sensors the current one covers */
+	uint16_t sequence[SENSOR_ID_COUNT];
+	uint32_t reading_mask;
+
+	uint32_t high_water;
+	uint32_t drained;
+
+};
+
+#endif /* SENSOR_SAMPLE_HANDOFF_H_ */
@@ -0,0 +1,282 @@
+/*
+ * sensor_scheduler.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "sensor_scheduler.h"
+
+#include <stdio.h>
+
+#include "trace.h"
+
+#define MS_TO_US(x) (((uint64_t) (x)) * 1000)
+
+const SensorScheduler::task_id_t SensorScheduler::INVALID_TASK;
+
+SensorScheduler::SensorScheduler(SchedulerClock& clock) :
+	clock(clock), idle_handler(NULL), tasks(), num_tasks(0), stats_start_us(0) {
+	stats_start_us = clock.now_us();
+}
+
+SensorScheduler::task_id_t SensorScheduler::add_task(const char* name, uint32_t period_ms,
+		uint32_t deadline_ms, mbed::Callback<void()> cb, uint32_t offset_ms) {
+
+	if(num_tasks >= SENSOR_SCHEDULER_MAX_TASKS || period_ms == 0) {
+		return INVALID_TASK;
+	}
+
+	task_t& task = tasks[num_tasks];
+	task.name = name;
+	task.cb = cb;
+	task.period_us = MS_TO_US(period_ms);
+	task.deadline_us = MS_TO_US((deadline_ms == 0)? period_ms : deadline_ms);
+	task.release_us = clock.now_us() + MS_TO_US(offset_ms);
+	task.periodic_release_us = task.release_us;
+	task.one_shot_pending = false;
+	task.active = true;
+	task.stats = task_stats_t();
+
+	return num_tasks++;
+}
+
+void SensorScheduler::set_period(task_id_t id, uint32_t period_ms) {
+	if(!valid(id) || period_ms == 0) {
+		return;
+	}
+
+	task_t& task = tasks[id];
+	uint64_t old_period_us = task.period_us;
+	task.period_us = MS_TO_US(period_ms);
+
+	if(!task.active) {
+		return;
+	}
+
+	// Pull the next periodic release in if the new period is shorter
+	uint64_t last_release_us = task.periodic_release_us - old_period_us;
+	if(last_release_us + task.period_us < task.periodic_release_us) {
+		task.periodic_release_us = last_release_us + task.period_us;
+		if(!task.one_shot_pending) {
+			task.release_us = task.periodic_release_us;
+		}
+		// The current sleep may run past the new release
+		clock.wake();
+	}
+}
+
+uint32_t SensorScheduler::get_period(task_id_t id) const {
+	if(!valid(id)) {
+		return 0;
+	}
+	return (uint32_t) (tasks[id].period_us / 1000);
+}
+
+void SensorScheduler::set_active(task_id_t id, bool active) {
+	if(!valid(id) || tasks[id].active == active) {
+		return;
+	}
+
+	task_t& task = tasks[id];
+	task.active = active;
+	task.one_shot_pending = false;
+
+	if(active) {
+		task.release_us = clock.now_us();
+		task.periodic_release_us = task.release_us;
+		clock.wake();
+	} else {
+		task.release_us = UINT64_MAX;
+		task.periodic_release_us = UINT64_MAX;
+	}
+}
+
+bool SensorScheduler::is_active(task_id_t id) const {
+	return valid(id) && tasks[id].active;
+}
+
+void SensorScheduler::run_again_in(task_id_t id, uint32_t delay_ms) {
+	if(!valid(id) || !tasks[id].active) {
+		return;
+	}
+
+	tasks[id].release_us = clock.now_us() + MS_TO_US(delay_ms);
+	tasks[id].one_shot_pending = true;
+}
+
+void SensorScheduler::trigger(task_id_t id) {
+	if(!valid(id) || !tasks[id].active) {
+		return;
+	}
+
+	task_t& task = tasks[id];
+	task.release_us = clock.now_us();
+	task.periodic_release_us = task.release_us;
+	task.one_shot_pending = false;
+	clock.wake();
+}
+
+int SensorScheduler::run_pending(void) {
+	int executed = 0;
+
+	while(true) {
+		uint64_t now = clock.now_us();
+
+		// Earliest absolute deadline among released tasks goes first
+		task_t* next = NULL;
+		for(int i = 0; i < num_tasks; i++) {
+			task_t& task = tasks[i];
+			if(task.release_us > now) {
+				continue;
+			}
+			if(next == NULL ||
+			   (task.release_us + task.deadline_us) < (next->release_us + next->deadline_us)) {
+				next = &task;
+			}
+		}
+
+		if(next == NULL) {
+			break;
+		}
+
+		execute(*next);
+		executed++;
+	}
+
+	return executed;
+}
+
+void SensorScheduler::execute(task_t& task) {
+	uint64_t release = task.release_us;
+	bool periodic = !task.one_shot_pending;
+	task.one_shot_pending = false;
+
+	uint64_t start = clock.now_us();
+
+	if(periodic) {
+		// Advance the periodic schedule, dropping releases we are too late for
+		task.periodic_release_us += task.period_us;
+		while(task.periodic_release_us <= start) {
+			task.periodic_release_us += task.period_us;
+			task.stats.skipped_releases++;
+		}
+	}
+
+	TRACE_BEGIN(TRACE_EVENT_POLL, &task - tasks);
+
+	if(task.cb) {
+		task.cb();
+	}
+
+	TRACE_END(TRACE_EVENT_POLL, &task - tasks);
+
+	uint64_t end = clock.now_us();
+
+	// The task may have requested a one-shot release while running
+	if(!task.active) {
+		// Disabled itself while running
+		task.release_us = UINT64_MAX;
+	} else if(!task.one_shot_pending) {
+		task.release_us = task.periodic_release_us;
+	}
+
+	uint32_t lateness = (uint32_t) (start - release);
+	uint32_t runtime = (uint32_t) (end - start);
+
+	task.stats.runs++;
+	task.stats.total_lateness_us += lateness;
+	task.stats.total_runtime_us += runtime;
+	if(lateness > task.stats.max_lateness_us) {
+		task.stats.max_lateness_us = lateness;
+	}
+	if(runtime > task.stats.max_runtime_us) {
+		task.stats.max_runtime_us = runtime;
+	}
+	if(end > release + task.deadline_us) {
+		task.stats.deadline_misses++;
+	}
+}
+
+uint64_t SensorScheduler::next_release_us(void) const {
+	uint64_t next = UINT64_MAX;
+	for(int i = 0; i < num_tasks; i++) {
+		if(tasks[i].release_us < next) {
+			next = tasks[i].release_us;
+		}
+	}
+	return next;
+}
+
+uint64_t SensorScheduler::get_release_us(task_id_t id) const {
+	if(!valid(id)) {
+		return UINT64_MAX;
+	}
+	return tasks[id].release_us;
+}
+
+void SensorScheduler::run_forever(void) {
+	while(true) {
+		run_pending();
+
+		uint64_t wakeup_us = next_release_us();
+		if(idle_handler == NULL) {
+			clock.sleep_until_us(wakeup_us);
+			continue;
+		}
+
+		// The handler may wake us early to power sensors up ahead of their release
+		uint64_t handler_wakeup_us = idle_handler->enter_idle(clock.now_us(), wakeup_us);
+		if(handler_wakeup_us < wakeup_us) {
+			wakeup_us = handler_wakeup_us;
+		}
+		clock.sleep_until_us(wakeup_us);
+		idle_handler->exit_idle(clock.now_us());
+	}
+}
+
+const char* SensorScheduler::get_name(task_id_t id) const {
+	if(!valid(id)) {
+		return NULL;
+	}
+	return tasks[id].name;
+}
+
+const SensorScheduler::task_stats_t* SensorScheduler::get_stats(task_id_t id) const {
+	if(!valid(id)) {
+		return NULL;
+	}
+	return &tasks[id].stats;
+}
+
+void SensorScheduler::reset_stats(void) {
+	for(int i = 0; i < num_tasks; i++) {
+		tasks[i].stats = task_stats_t();
+	}
+	stats_start_us = clock.now_us();
+}
+
+void SensorScheduler::print_stats(void) {
+	uint64_t elapsed = clock.now_us() - stats_start_us;
+	uint64_t busy = 0;
+
+	printf("scheduler: %-10s %6s %6s %6s %10s %10s %10s\r\n", "task", "runs", "miss",
+			"skip", "avg jit us", "max jit us", "max run us");
+
+	for(int i = 0; i < num_tasks; i++) {
+		task_stats_t& stats = tasks[i].stats;
+		uint32_t avg_lateness = (stats.runs == 0)? 0 :
+				(uint32_t) (stats.total_lateness_us / stats.runs);
+		printf("scheduler: %-10s %6lu %6lu %6lu %10lu %10lu %10lu\r\n", tasks[i].name,
+				(unsigned long) stats.runs, (unsigned long) stats.deadline_misses,
+				(unsigned long) stats.skipped_releases, (unsigned long) avg_lateness,
+				(unsigned long) stats.max_lateness_us, (unsigned long) stats.max_runtime_us);
+		busy += stats.total_runtime_us;
+	}
+
+	if(elapsed != 0) {
+		// Utilization in hundredths of a percent, avoids float formatting
+		uint32_t load = (uint32_t) ((busy * 10000) / elapsed);
+		printf("scheduler: cpu %lu.%02lu%% over %lu ms\r\n", (unsigned long) (load / 100),
+				(unsigned long) (load % 100), (unsigned long) (elapsed / 1000));
+	}
+}
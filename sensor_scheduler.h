@@ -0,0 +1,207 @@
+/*
+ * sensor_scheduler.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef SENSOR_SCHEDULER_H_
+#define SENSOR_SCHEDULER_H_
+
+#include <stdint.h>
+
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+/** Maximum number of tasks that can be registered with a scheduler */
+#define SENSOR_SCHEDULER_MAX_TASKS 12
+
+/**
+ * Time source used by the SensorScheduler
+ *
+ * Abstracted so the scheduler can be driven by the RTOS on target
+ * or by a simulated clock when characterizing jitter on a host.
+ */
+class SchedulerClock {
+public:
+
+	virtual ~SchedulerClock() { }
+
+	/** Monotonic time in microseconds */
+	virtual uint64_t now_us(void) = 0;
+
+	/** Block the calling thread until the given time */
+	virtual void sleep_until_us(uint64_t wakeup_us) = 0;
+
+	/**
+	 * End the current sleep_until_us() early (or the next one, if not sleeping)
+	 *
+	 * Called from the sleeping thread itself, by work it dispatches while
+	 * waiting. Clocks that cannot be interrupted keep sleeping.
+	 */
+	virtual void wake(void) { }
+
+};
+
+/**
+ * Hook run by SensorScheduler::run_forever() around every sleep
+ *
+ * Lets power management switch sensors off while nothing is due and bring
+ * them back ahead of the release that needs them. Both calls are made on
+ * the scheduler's thread.
+ */
+class SchedulerIdleHandler {
+public:
+
+	virtual ~SchedulerIdleHandler() { }
+
+	/**
+	 * About to sleep until the next release
+	 * @param[in] now_us Current time
+	 * @param[in] next_release_us Earliest pending release (UINT64_MAX if none)
+	 * @retval time to wake up at, at most next_release_us
+	 */
+	virtual uint64_t enter_idle(uint64_t now_us, uint64_t next_release_us) = 0;
+
+	/** Woke up, called before any due task runs */
+	virtual void exit_idle(uint64_t now_us) = 0;
+
+};
+
+/**
+ * Cooperative, non-preemptive scheduler for sensor acquisition
+ *
+ * Each task has its own period and relative deadline. When several
+ * tasks are due at once the one with the earliest absolute deadline runs first.
+ * Release jitter, runtime and deadline misses are tracked per task.
+ */
+class SensorScheduler : private mbed::NonCopyable<SensorScheduler> {
+public:
+
+	typedef int task_id_t;
+
+	static const task_id_t INVALID_TASK = -1;
+
+	typedef struct {
+		uint32_t runs;				/** Number of times the task executed */
+		uint32_t deadline_misses;	/** Runs that finished after their deadline */
+		uint32_t skipped_releases;	/** Periods dropped because the task fell behind */
+		uint32_t max_lateness_us;	/** Worst-case release jitter */
+		uint64_t total_lateness_us;
+		uint32_t max_runtime_us;	/** Worst-case execution time */
+		uint64_t total_runtime_us;
+	} task_stats_t;
+
+	SensorScheduler(SchedulerClock& clock);
+
+	/**
+	 * Register a periodic task
+	 * @param[in] name Human-readable name (must outlive the scheduler)
+	 * @param[in] period_ms Release period of the task
+	 * @param[in] deadline_ms Relative deadline; 0 means the deadline equals the period
+	 * @param[in] cb Function executed on every release
+	 * @param[in] offset_ms Delay of the first release, used to stagger tasks
+	 * @retval id of the task or INVALID_TASK if the task table is full
+	 */
+	task_id_t add_task(const char* name, uint32_t period_ms, uint32_t deadline_ms,
+			mbed::Callback<void()> cb, uint32_t offset_ms = 0);
+
+	/**
+	 * Change the period of a task, effective from its next release
+	 *
+	 * Ends the current sleep if the next release moves in, like trigger().
+	 */
+	void set_period(task_id_t id, uint32_t period_ms);
+
+	/** Get the period of a task */
+	uint32_t get_period(task_id_t id) const;
+
+	/**
+	 * Enable or disable a task
+	 *
+	 * Disabled tasks are never released. When re-enabled the task is
+	 * released immediately, ending the current sleep, and then follows its period.
+	 */
+	void set_active(task_id_t id, bool active);
+
+	bool is_active(task_id_t id) const;
+
+	/**
+	 * Override the next release of a task
+	 *
+	 * Intended to be called from within the task itself to implement
+	 * non-blocking state machines (eg: come back after a settling time).
+	 * The periodic schedule resumes after the overridden release.
+	 */
+	void run_again_in(task_id_t id, uint32_t delay_ms);
+
+	/**
+	 * Release a task now (eg: on a sensor interrupt) and restart its period from there
+	 *
+	 * Ends the current sleep. Runs on the scheduler's thread, from a task or
+	 * from work the clock dispatches while sleeping.
+	 */
+	void trigger(task_id_t id);
+
+	/**
+	 * Execute every task that is currently due
+	 * @retval number of tasks executed
+	 */
+	int run_pending(void);
+
+	/** Absolute time of the earliest pending release */
+	uint64_t next_release_us(void) const;
+
+	/** Absolute time of the next release of a task, UINT64_MAX while it is disabled */
+	uint64_t get_release_us(task_id_t id) const;
+
+	/** Install a hook run around the sleeps of run_forever(), NULL removes it */
+	void set_idle_handler(SchedulerIdleHandler* handler) {
+		idle_handler = handler;
+	}
+
+	/** Run tasks and sleep between releases, never returns */
+	void run_forever(void);
+
+	/** Number of registered tasks, ids run from 0 to get_task_count() - 1 */
+	int get_task_count(void) const {
+		return num_tasks;
+	}
+
+	const char* get_name(task_id_t id) const;
+
+	const task_stats_t* get_stats(task_id_t id) const;
+
+	void reset_stats(void);
+
+	/** Print per-task jitter, runtime and CPU utilization */
+	void print_stats(void);
+
+private:
+
+	typedef struct {
+		const char* name;
+		mbed::Callback<void()> cb;
+		uint64_t period_us;
+		uint64_t deadline_us;
+		uint64_t release_us;			/** Absolute time of the next release */
+		uint64_t periodic_release_us;	/** Next release of the periodic schedule */
+		bool one_shot_pending;			/** Next release was set by run_again_in */
+		bool active;
+		task_stats_t stats;
+	} task_t;
+
+	bool valid(task_id_t id) const {
+		return (id >= 0 && id < num_tasks);
+	}
+
+	void execute(task_t& task);
+
+	SchedulerClock& clock;
+	SchedulerIdleHandler* idle_handler;
+	task_t tasks[SENSOR_SCHEDULER_MAX_TASKS];
+	int num_tasks;
+	uint64_t stats_start_us;
+
+};
+
+#endif /* SENSOR_SCHEDULER_H_ */
@@ -0,0 +1,229 @@
+/*
+ * sensor_snapshot_service.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "sensor_snapshot_service.h"
+
+#include <string.h>
+
+#include "rtos/Kernel.h"
+
+#include "gatt_units.h"
+
+/** Field offsets, see sensor_snapshot_service.h */
+#define SNAP_SEQUENCE			1
+#define SNAP_TIMESTAMP			3
+#define SNAP_BME680_TEMP		7
+#define SNAP_BME680_HUMIDITY	9
+#define SNAP_BME680_PRESSURE	11
+#define SNAP_BME680_GAS			15
+#define SNAP_IAQ_SCORE			19
+#define SNAP_IAQ_ACCURACY		21
+#define SNAP_CO2				22
+#define SNAP_BVOC				24
+#define SNAP_SI7021_TEMP		26
+#define SNAP_SI7021_HUMIDITY	28
+#define SNAP_ALS				30
+#define SNAP_DISTANCE			34
+#define SNAP_LSM9DS1_ACCEL		36
+#define SNAP_LSM9DS1_GYRO		42
+#define SNAP_LSM9DS1_MAG		48
+#define SNAP_ICM20602_ACCEL		54
+#define SNAP_ICM20602_GYRO		60
+#define SNAP_BATTERY			66
+#define SNAP_READINGS			68
+
+static_assert(SNAP_READINGS + SENSOR_SNAPSHOT_READING_SIZE * SENSOR_ID_COUNT ==
+		SENSOR_SNAPSHOT_VALUE_SIZE, "snapshot layout");
+
+static void put_u16(uint8_t* p, uint16_t value) {
+	p[0] = (uint8_t) (value & 0xFF);
+	p[1] = (uint8_t) (value >> 8);
+}
+
+static void put_u32(uint8_t* p, uint32_t value) {
+	put_u16(p, (uint16_t) (value & 0xFFFF));
+	put_u16(p + 2, (uint16_t) (value >> 16));
+}
+
+/** Write a field, true if it changed */
+static bool set_u16(uint8_t* p, uint16_t value) {
+	uint8_t encoded[2];
+	put_u16(encoded, value);
+	if(memcmp(p, encoded, sizeof(encoded)) == 0) {
+		return false;
+	}
+	memcpy(p, encoded, sizeof(encoded));
+	return true;
+}
+
+static bool set_u32(uint8_t* p, uint32_t value) {
+	uint8_t encoded[4];
+	put_u32(encoded, value);
+	if(memcmp(p, encoded, sizeof(encoded)) == 0) {
+		return false;
+	}
+	memcpy(p, encoded, sizeof(encoded));
+	return true;
+}
+
+static bool set_u8(uint8_t* p, uint8_t value) {
+	if(*p == value) {
+		return false;
+	}
+	*p = value;
+	return true;
+}
+
+/** Three axes of a vec3 sample */
+template<typename scale_t>
+static bool set_vec3(uint8_t* p, const sensor_sample_t& sample) {
+	bool changed = false;
+	for(int i = 0; i < 3; i++) {
+		changed |= set_u16(&p[2*i], (uint16_t) scale_t::from_float(sample.value.vec3[i]));
+	}
+	return changed;
+}
+
+/** Unknown values: 0x8000 for the signed fields, all ones otherwise */
+static void init_snapshot(uint8_t* p) {
+	memset(p, 0xFF, SENSOR_SNAPSHOT_VALUE_SIZE);
+	p[0] = SENSOR_SNAPSHOT_VERSION;
+	put_u16(&p[SNAP_SEQUENCE], 0);
+	put_u32(&p[SNAP_TIMESTAMP], 0);
+	put_u16(&p[SNAP_BME680_TEMP], 0x8000);
+	put_u16(&p[SNAP_SI7021_TEMP], 0x8000);
+	for(int i = 0; i < 3; i++) {
+		put_u16(&p[SNAP_LSM9DS1_ACCEL + 2*i], 0x8000);
+		put_u16(&p[SNAP_LSM9DS1_GYRO + 2*i], 0x8000);
+		put_u16(&p[SNAP_LSM9DS1_MAG + 2*i], 0x8000);
+		put_u16(&p[SNAP_ICM20602_ACCEL + 2*i], 0x8000);
+		put_u16(&p[SNAP_ICM20602_GYRO + 2*i], 0x8000);
+	}
+}
+
+SensorSnapshotService::SensorSnapshotService(events::EventQueue& queue) :
+	queue(queue),
+	ble(NULL),
+	tick_event(0),
+	pending(),
+	dirty(false),
+	snapshot_value(),
+	snapshot_char(UUID(SENSOR_SNAPSHOT_CHAR_UUID), snapshot_value,
+			GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY),
+	sequence(0),
+	updates(0) {
+	init_snapshot(pending);
+	memcpy(snapshot_value, pending, sizeof(snapshot_value));
+}
+
+SensorSnapshotService::~SensorSnapshotService() {
+	if(tick_event != 0) {
+		queue.cancel(tick_event);
+	}
+}
+
+void SensorSnapshotService::start(BLE& ble) {
+	this->ble = &ble;
+
+	GattCharacteristic* chars[] = { &snapshot_char };
+	GattService service(UUID(SENSOR_SNAPSHOT_SERVICE_UUID), chars, sizeof(chars) / sizeof(chars[0]));
+
+	ble.gattServer().addService(service);
+
+	// Values received before the service existed
+	tick();
+	tick_event = queue.call_every(SENSOR_SNAPSHOT_INTERVAL_MS, this, &SensorSnapshotService::tick);
+}
+
+void SensorSnapshotService::update(const sensor_sample_t& sample) {
+	uint8_t* p = pending;
+	bool changed = false;
+
+	switch(sample.channel) {
+	case SENSOR_CHANNEL_BME680_TEMP:
+		changed = set_u16(&p[SNAP_BME680_TEMP], (uint16_t) (int16_t) sample.value.i32);
+		break;
+	case SENSOR_CHANNEL_BME680_HUMIDITY:
+		changed = set_u16(&p[SNAP_BME680_HUMIDITY], (uint16_t) sample.value.u32);
+		break;
+	case SENSOR_CHANNEL_BME680_PRESSURE:
+		changed = set_u32(&p[SNAP_BME680_PRESSURE], sample.value.u32);
+		break;
+	case SENSOR_CHANNEL_BME680_GAS_RESISTANCE:
+		changed = set_u32(&p[SNAP_BME680_GAS], sample.value.u32);
+		break;
+	case SENSOR_CHANNEL_BME680_IAQ_SCORE:
+		changed = set_u16(&p[SNAP_IAQ_SCORE], (uint16_t) sample.value.u32);
+		break;
+	case SENSOR_CHANNEL_BME680_IAQ_ACCURACY:
+		changed = set_u8(&p[SNAP_IAQ_ACCURACY], (uint8_t) sample.value.u32);
+		break;
+	case SENSOR_CHANNEL_BME680_CO2:
+		changed = set_u16(&p[SNAP_CO2], Co2FromPpm::from_float(sample.value.f));
+		break;
+	case SENSOR_CHANNEL_BME680_BVOC:
+		changed = set_u16(&p[SNAP_BVOC], VocPpbFromPpm::from_float(sample.value.f));
+		break;
+	case SENSOR_CHANNEL_SI7021_TEMP:
+		changed = set_u16(&p[SNAP_SI7021_TEMP], (uint16_t) (int16_t) sample.value.i32);
+		break;
+	case SENSOR_CHANNEL_SI7021_HUMIDITY:
+		changed = set_u16(&p[SNAP_SI7021_HUMIDITY], (uint16_t) sample.value.u32);
+		break;
+	case SENSOR_CHANNEL_MAX44009_ALS:
+		changed = set_u32(&p[SNAP_ALS], LuxHundredthsFromLux::from_float(sample.value.f));
+		break;
+	case SENSOR_CHANNEL_VL53L0X_DISTANCE:
+		changed = set_u16(&p[SNAP_DISTANCE], (uint16_t) sample.value.u32);
+		break;
+	case SENSOR_CHANNEL_LSM9DS1_ACCEL:
+		changed = set_vec3<MilliGFromG>(&p[SNAP_LSM9DS1_ACCEL], sample);
+		break;
+	case SENSOR_CHANNEL_LSM9DS1_GYRO:
+		changed = set_vec3<DeciDpsFromDps>(&p[SNAP_LSM9DS1_GYRO], sample);
+		break;
+	case SENSOR_CHANNEL_LSM9DS1_MAG:
+		changed = set_vec3<MilliGaussFromGauss>(&p[SNAP_LSM9DS1_MAG], sample);
+		break;
+	case SENSOR_CHANNEL_ICM20602_ACCEL:
+		changed = set_vec3<MilliGFromG>(&p[SNAP_ICM20602_ACCEL], sample);
+		break;
+	case SENSOR_CHANNEL_ICM20602_GYRO:
+		changed = set_vec3<DeciDpsFromDps>(&p[SNAP_ICM20602_GYRO], sample);
+		break;
+	case SENSOR_CHANNEL_BATTERY_VOLTAGE:
+		changed = set_u16(&p[SNAP_BATTERY], MillivoltFromVolt::from_float(sample.value.f));
+		break;
+	default:
+		break;
+	}
+
+	// A reading counts even if its values did not change
+	sensor_id_t sensor = sensor_channel_sensor((sensor_channel_t) sample.channel);
+	if(sensor < SENSOR_ID_COUNT) {
+		uint8_t* reading = &p[SNAP_READINGS + SENSOR_SNAPSHOT_READING_SIZE * sensor];
+		changed |= set_u16(&reading[0], sample.sequence);
+		changed |= set_u32(&reading[2], sample.time_ms);
+	}
+
+	dirty |= changed;
+}
+
+void SensorSnapshotService::tick(void) {
+	if(ble == NULL || !dirty) {
+		return;
+	}
+	dirty = false;
+
+	sequence++;
+	put_u16(&pending[SNAP_SEQUENCE], sequence);
+	put_u32(&pending[SNAP_TIMESTAMP], (uint32_t) rtos::Kernel::get_ms_count());
+
+	// One write, clients never see a half updated snapshot
+	memcpy(snapshot_value, pending, sizeof(snapshot_value));
+	ble->gattServer().write(snapshot_char.getValueHandle(), snapshot_value, sizeof(snapshot_value));
+	updates++;
+}
@@ -0,0 +1,119 @@
+/*
+ * sensor_snapshot_service.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef SENSOR_SNAPSHOT_SERVICE_H_
+#define SENSOR_SNAPSHOT_SERVICE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "ble/BLE.h"
+#include "ble/GattServer.h"
+#include "events/EventQueue.h"
+#include "platform/NonCopyable.h"
+
+#include "sensor_sample.h"
+
+#define SENSOR_SNAPSHOT_SERVICE_UUID	"00000015-8dd4-4087-a16a-04a7c8e01734"
+#define SENSOR_SNAPSHOT_CHAR_UUID		"00001015-8dd4-4087-a16a-04a7c8e01734"
+
+/**
+ * Snapshot (all fields little endian), 110 bytes:
+ *
+ *   [0]      version
+ *   [1:2]    sequence, increments with every published snapshot, wraps at 0xFFFF
+ *   [3:6]    uint32 ms since boot the snapshot was taken at
+ *   [7:8]    BME680 temperature, sint16 0.01 degC
+ *   [9:10]   BME680 humidity, uint16 0.01 %RH
+ *   [11:14]  BME680 pressure, uint32 0.1 Pa
+ *   [15:18]  BME680 gas resistance, uint32 Ohm
+ *   [19:20]  IAQ score, uint16
+ *   [21]     IAQ accuracy, uint8
+ *   [22:23]  CO2 equivalent, uint16 ppm
+ *   [24:25]  breath VOC equivalent, uint16 ppb
+ *   [26:27]  Si7021 temperature, sint16 0.01 degC
+ *   [28:29]  Si7021 humidity, uint16 0.01 %RH
+ *   [30:33]  ambient light, uint32 0.01 lux
+ *   [34:35]  distance, uint16 mm (0xFFFF out of range)
+ *   [36:41]  LSM9DS1 acceleration x, y, z, sint16 mg
+ *   [42:47]  LSM9DS1 rotation rate x, y, z, sint16 0.1 dps
+ *   [48:53]  LSM9DS1 magnetic field x, y, z, sint16 mgauss
+ *   [54:59]  ICM20602 acceleration x, y, z, sint16 mg
+ *   [60:65]  ICM20602 rotation rate x, y, z, sint16 0.1 dps
+ *   [66:67]  battery, uint16 mV
+ *   [68:109] latest reading of each sensor, in sensor_id_t order:
+ *            uint16 reading sequence number, uint32 ms since boot it was read at
+ *
+ * Values that are not known yet read as 0x8000 (signed) or all ones, like
+ * the broadcast pages. scripts/main.py decodes this format.
+ */
+#define SENSOR_SNAPSHOT_VERSION			2
+#define SENSOR_SNAPSHOT_HEADER_SIZE		7
+#define SENSOR_SNAPSHOT_READING_SIZE	6
+#define SENSOR_SNAPSHOT_VALUE_SIZE		(68 + SENSOR_SNAPSHOT_READING_SIZE * SENSOR_ID_COUNT)
+
+/** Snapshots are taken this often, when a value changed since the last one */
+#define SENSOR_SNAPSHOT_INTERVAL_MS		1000
+
+/**
+ * Every sensor's latest value in a single characteristic
+ *
+ * Clients that want a full reading otherwise need one ATT read per
+ * characteristic, around twenty of them. Samples are handed to update()
+ * before the deadbands so the snapshot holds the latest value of every
+ * channel. Every SENSOR_SNAPSHOT_INTERVAL_MS the pending values are stamped
+ * and written to the characteristic in one go (read and notify), so a
+ * snapshot never mixes two polls of a sensor. Each sensor's sequence number
+ * and read time come with it, so a client sees how old every value is and
+ * how many readings it missed. Since the snapshot sees every reading (it is
+ * fed ahead of the deadbands) no skip counts are needed: readings between
+ * two snapshots were superseded, not lost. Notifications carry the whole snapshot from an
+ * ATT MTU of 113, below that clients should read it.
+ *
+ * All calls must come from the BLE event queue.
+ */
+class SensorSnapshotService : private mbed::NonCopyable<SensorSnapshotService> {
+public:
+
+	SensorSnapshotService(events::EventQueue& queue);
+
+	~SensorSnapshotService();
+
+	void start(BLE& ble);
+
+	/** Encode a sample into the pending snapshot */
+	void update(const sensor_sample_t& sample);
+
+	uint32_t get_updates(void) const {
+		return updates;
+	}
+
+	uint16_t get_sequence(void) const {
+		return sequence;
+	}
+
+private:
+
+	/** Publish the pending snapshot if a value changed */
+	void tick(void);
+
+	events::EventQueue& queue;
+	BLE* ble;
+	int tick_event;
+
+	/** Updated as samples come in, copied to the characteristic by tick() */
+	uint8_t pending[SENSOR_SNAPSHOT_VALUE_SIZE];
+	bool dirty;
+
+	uint8_t snapshot_value[SENSOR_SNAPSHOT_VALUE_SIZE];
+	ReadOnlyArrayGattCharacteristic<uint8_t, SENSOR_SNAPSHOT_VALUE_SIZE> snapshot_char;
+
+	uint16_t sequence;
+	uint32_t updates;
+
+};
+
+#endif /* SENSOR_SNAPSHOT_SERVICE_H_ */
@@ -0,0 +1,59 @@
+/*
+ * sensor_telemetry.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "sensor_telemetry.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "drivers/MbedCRC.h"
+#include "hal/us_ticker_api.h"
+
+#include "cobs.h"
+
+#define TELEMETRY_MAX_FRAME_SIZE \
+	(TELEMETRY_HEADER_SIZE + TELEMETRY_MAX_RECORD_SIZE + TELEMETRY_CRC_SIZE)
+
+SensorTelemetry::SensorTelemetry(AsyncUartWriter& writer) :
+	writer(writer),
+	enabled(false),
+	sequence(0),
+	frames_sent(0),
+	frames_dropped(0) {
+}
+
+void SensorTelemetry::send_frame(telemetry_record_type_t type, const void* record, size_t len) {
+	uint8_t frame[TELEMETRY_MAX_FRAME_SIZE];
+	uint8_t encoded[COBS_MAX_ENCODED_SIZE(TELEMETRY_MAX_FRAME_SIZE) + 1];
+
+	uint32_t now = us_ticker_read();
+	frame[0] = (uint8_t) type;
+	frame[1] = sequence++;
+	memcpy(&frame[2], &now, sizeof(now));
+	memcpy(&frame[TELEMETRY_HEADER_SIZE], record, len);
+
+	size_t frame_len = TELEMETRY_HEADER_SIZE + len;
+	mbed::MbedCRC<POLY_16BIT_CCITT, 16> ct;
+	uint32_t crc = 0;
+	ct.compute(frame, frame_len, &crc);
+	frame[frame_len++] = (uint8_t) (crc & 0xFF);
+	frame[frame_len++] = (uint8_t) (crc >> 8);
+
+	size_t encoded_len = cobs_encode(frame, frame_len, encoded);
+	encoded[encoded_len++] = 0;
+
+	if(writer.write(encoded, encoded_len)) {
+		frames_sent++;
+	} else {
+		frames_dropped++;
+	}
+}
+
+void SensorTelemetry::print_stats(void) {
+	printf("telemetry: %s, %lu frames sent, %lu dropped, %lu bytes\r\n",
+			is_enabled()? "on" : "off", frames_sent, frames_dropped,
+			writer.get_bytes_written());
+}
@@ -0,0 +1,150 @@
+/*
+ * sensor_telemetry.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef SENSOR_TELEMETRY_H_
+#define SENSOR_TELEMETRY_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#include "platform/mbed_toolchain.h"
+#include "platform/NonCopyable.h"
+
+#include "async_uart_writer.h"
+
+/**
+ * Binary sensor telemetry for bench characterization
+ *
+ * Every sensor reading is sent as one frame, COBS encoded (see cobs.h) and
+ * terminated by a 0x00 byte. Decoded frame (all fields little endian):
+ *
+ *   [0]    telemetry_record_type_t
+ *   [1]    frame sequence number, wraps at 0xFF (gaps are dropped frames)
+ *   [2:5]  microsecond timestamp, wraps at 32 bits
+ *   [6:]   record of the given type, below
+ *   [-2:]  CRC-16/CCITT-FALSE of everything before it
+ *
+ * Text printed to the same UART shows up between frames and fails the CRC.
+ * scripts/telemetry_decode.py converts the stream to CSV.
+ */
+#define TELEMETRY_HEADER_SIZE		6
+#define TELEMETRY_CRC_SIZE			2
+
+typedef enum {
+	TELEMETRY_RECORD_BME680 = 1,
+	TELEMETRY_RECORD_MAX44009,
+	TELEMETRY_RECORD_SI7021,
+	TELEMETRY_RECORD_VL53L0X,
+	TELEMETRY_RECORD_LSM9DS1,
+	TELEMETRY_RECORD_ICM20602,
+	TELEMETRY_RECORD_BATTERY
+} telemetry_record_type_t;
+
+MBED_PACKED(struct) telemetry_bme680_t {
+	float temperature;		/** degC */
+	float pressure;			/** Pa */
+	float humidity;			/** %RH */
+	float gas_resistance;	/** Ohm */
+	float co2_equivalent;	/** ppm */
+	float breath_voc;		/** ppm */
+	float iaq_score;
+	uint8_t iaq_accuracy;
+};
+
+MBED_PACKED(struct) telemetry_max44009_t {
+	float lux;
+};
+
+MBED_PACKED(struct) telemetry_si7021_t {
+	int32_t temperature;	/** 0.01 degC */
+	uint32_t humidity;		/** 0.01 %RH */
+};
+
+MBED_PACKED(struct) telemetry_vl53l0x_t {
+	uint32_t distance;		/** mm, 0xFFFF when out of range */
+	uint8_t range_status;	/** vl53l0x_range_status_t */
+	uint16_t signal_rate;	/** MCPS, 9.7 fixed point */
+};
+
+/** Bits of telemetry_lsm9ds1_t::valid_mask, accel/gyro are missing while streaming without a new sample */
+#define TELEMETRY_LSM9DS1_ACCEL_VALID	0x01
+#define TELEMETRY_LSM9DS1_GYRO_VALID	0x02
+#define TELEMETRY_LSM9DS1_MAG_VALID		0x04
+
+MBED_PACKED(struct) telemetry_lsm9ds1_t {
+	uint8_t valid_mask;
+	float accel[3];			/** g */
+	float gyro[3];			/** dps */
+	float mag[3];			/** gauss */
+};
+
+MBED_PACKED(struct) telemetry_icm20602_t {
+	float accel[3];			/** g */
+	float gyro[3];			/** dps */
+};
+
+MBED_PACKED(struct) telemetry_battery_t {
+	float voltage;			/** V */
+};
+
+/** Largest record, sizes the frame buffer */
+#define TELEMETRY_MAX_RECORD_SIZE	sizeof(telemetry_lsm9ds1_t)
+
+/**
+ * Frames sensor records onto an AsyncUartWriter
+ *
+ * Nothing is sent until enabled. send() never blocks, frames that do not
+ * fit in the writer's buffer are counted and dropped.
+ *
+ * send() must be called from a single thread (the sensor thread).
+ */
+class SensorTelemetry : private mbed::NonCopyable<SensorTelemetry> {
+public:
+
+	SensorTelemetry(AsyncUartWriter& writer);
+
+	/** Start or stop sending frames, from any thread */
+	void set_enabled(bool enabled) {
+		this->enabled.store(enabled);
+	}
+
+	bool is_enabled(void) const {
+		return enabled.load(std::memory_order_relaxed);
+	}
+
+	/** Frame and queue a record, does nothing while disabled */
+	template<typename record_t>
+	void send(telemetry_record_type_t type, const record_t& record) {
+		static_assert(sizeof(record_t) <= TELEMETRY_MAX_RECORD_SIZE, "telemetry record too large");
+		if(is_enabled()) {
+			send_frame(type, &record, sizeof(record));
+		}
+	}
+
+	uint32_t get_frames_sent(void) const {
+		return frames_sent;
+	}
+
+	uint32_t get_frames_dropped(void) const {
+		return frames_dropped;
+	}
+
+	void print_stats(void);
+
+private:
+
+	void send_frame(telemetry_record_type_t type, const void* record, size_t len);
+
+	AsyncUartWriter& writer;
+	std::atomic<bool> enabled;
+	uint8_t sequence;
+	uint32_t frames_sent;
+	uint32_t frames_dropped;
+
+};
+
+#endif /* SENSOR_TELEMETRY_H_ */
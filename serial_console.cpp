@@ -0,0 +1,65 @@
+/*
+ * serial_console.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "serial_console.h"
+
+#include <stdio.h>
+
+SerialConsole::SerialConsole(mbed::RawSerial& serial) :
+	serial(serial),
+	queue(SERIAL_CONSOLE_QUEUE_SIZE),
+	thread(osPriorityLow, SERIAL_CONSOLE_THREAD_STACK_SIZE, NULL, "console"),
+	commands(),
+	command_count(0) {
+}
+
+bool SerialConsole::add_command(char key, const char* help, mbed::Callback<void()> cb) {
+	if(command_count >= SERIAL_CONSOLE_MAX_COMMANDS) {
+		return false;
+	}
+
+	command_t& command = commands[command_count++];
+	command.key = key;
+	command.help = help;
+	command.cb = cb;
+
+	return true;
+}
+
+void SerialConsole::start(void) {
+	thread.start(mbed::callback(&queue, &events::EventQueue::dispatch_forever));
+	serial.attach(mbed::callback(this, &SerialConsole::on_rx), mbed::SerialBase::RxIrq);
+}
+
+void SerialConsole::on_rx(void) {
+	// Interrupt context: drain the receiver, anything that does not fit is lost
+	while(serial.readable()) {
+		char key = (char) serial.getc();
+		queue.call(mbed::callback(this, &SerialConsole::handle_key), key);
+	}
+}
+
+void SerialConsole::handle_key(char key) {
+	if(key == '\r' || key == '\n') {
+		return;
+	}
+
+	for(int i = 0; i < command_count; i++) {
+		if(commands[i].key == key) {
+			commands[i].cb();
+			return;
+		}
+	}
+
+	print_help();
+}
+
+void SerialConsole::print_help(void) {
+	printf("console: commands\r\n");
+	for(int i = 0; i < command_count; i++) {
+		printf("\t%c - %s\r\n", commands[i].key, commands[i].help);
+	}
+}
@@ -0,0 +1,75 @@
+/*
+ * serial_console.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef SERIAL_CONSOLE_H_
+#define SERIAL_CONSOLE_H_
+
+#include <stdint.h>
+
+#include "drivers/RawSerial.h"
+#include "events/EventQueue.h"
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+#include "rtos/Thread.h"
+
+/** Room for every command main.cpp registers, the optional ones included */
+#define SERIAL_CONSOLE_MAX_COMMANDS		16
+
+#define SERIAL_CONSOLE_THREAD_STACK_SIZE	2048
+
+/** Keys typed faster than the console thread handles them are dropped past this */
+#define SERIAL_CONSOLE_QUEUE_SIZE		(8 * EVENTS_EVENT_SIZE)
+
+/**
+ * Single-key commands typed on the debug UART
+ *
+ * Received characters are picked up in the UART interrupt and handed to a
+ * low priority thread, so commands that print a lot (eg: a trace dump) never
+ * hold up the BLE or sensor threads. '?' lists the commands.
+ *
+ * Output goes through printf, the console UART is shared with stdio. The
+ * serial object is only used for receiving and may be shared with a writer.
+ */
+class SerialConsole : private mbed::NonCopyable<SerialConsole> {
+public:
+
+	SerialConsole(mbed::RawSerial& serial);
+
+	/**
+	 * Register a command, before start()
+	 * @param[in] key Character that runs the command
+	 * @param[in] help Shown by '?', must outlive the console
+	 * @param[in] cb Runs on the console thread
+	 * @retval false if the command table is full
+	 */
+	bool add_command(char key, const char* help, mbed::Callback<void()> cb);
+
+	/** Start the console thread and enable the receive interrupt */
+	void start(void);
+
+private:
+
+	typedef struct {
+		char key;
+		const char* help;
+		mbed::Callback<void()> cb;
+	} command_t;
+
+	void on_rx(void);
+
+	void handle_key(char key);
+
+	void print_help(void);
+
+	mbed::RawSerial& serial;
+	events::EventQueue queue;
+	rtos::Thread thread;
+	command_t commands[SERIAL_CONSOLE_MAX_COMMANDS];
+	int command_count;
+
+};
+
+#endif /* SERIAL_CONSOLE_H_ */
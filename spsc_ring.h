@@ -0,0 +1,115 @@
+/*
+ * spsc_ring.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef SPSC_RING_H_
+#define SPSC_RING_H_
+
+#include <stdint.h>
+#include <atomic>
+
+#include "platform/NonCopyable.h"
+
+/**
+ * Bounded, lock-free single-producer/single-consumer ring buffer
+ *
+ * push() may only be called from one thread and pop() from one other thread.
+ * Neither side ever blocks or disables interrupts; the indices are published
+ * with release/acquire ordering so an element is fully written before the
+ * consumer can see it.
+ *
+ * @tparam T Element type, copied in and out
+ * @tparam N Capacity, must be a power of two
+ */
+template<typename T, uint32_t N>
+class SpscRing : private mbed::NonCopyable<SpscRing<T, N> > {
+public:
+
+	static_assert(N != 0 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+	SpscRing() : head(0), tail(0), dropped(0) {
+	}
+
+	/**
+	 * Producer side: append an element
+	 * @retval false if the ring is full (the element is dropped and counted)
+	 */
+	bool push(const T& item) {
+		uint32_t h = head.load(std::memory_order_relaxed);
+		if(h - tail.load(std::memory_order_acquire) == N) {
+			dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		buffer[h & (N - 1)] = item;
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Consumer side: remove the oldest element
+	 * @retval false if the ring is empty
+	 */
+	bool pop(T& item) {
+		uint32_t t = tail.load(std::memory_order_relaxed);
+		if(t == head.load(std::memory_order_acquire)) {
+			return false;
+		}
+
+		item = buffer[t & (N - 1)];
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Consumer side: copy the oldest element without removing it
+	 * @retval false if the ring is empty
+	 */
+	bool peek(T& item) const {
+		uint32_t t = tail.load(std::memory_order_relaxed);
+		if(t == head.load(std::memory_order_acquire)) {
+			return false;
+		}
+
+		item = buffer[t & (N - 1)];
+		return true;
+	}
+
+	/** Consumer side: remove the oldest element after a successful peek() */
+	void discard(void) {
+		uint32_t t = tail.load(std::memory_order_relaxed);
+		if(t != head.load(std::memory_order_acquire)) {
+			tail.store(t + 1, std::memory_order_release);
+		}
+	}
+
+	/** Number of elements currently stored (approximate when called concurrently) */
+	uint32_t size(void) const {
+		return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+	}
+
+	bool empty(void) const {
+		return size() == 0;
+	}
+
+	uint32_t capacity(void) const {
+		return N;
+	}
+
+	/** Number of elements rejected because the ring was full (producer side counter, readable anywhere) */
+	uint32_t get_dropped(void) const {
+		return dropped.load(std::memory_order_relaxed);
+	}
+
+private:
+
+	T buffer[N];
+	std::atomic<uint32_t> head;		/** Written by the producer only */
+	std::atomic<uint32_t> tail;		/** Written by the consumer only */
+	std::atomic<uint32_t> dropped;	/** Written by the producer only */
+
+};
+
+#endif /* SPSC_RING_H_ */
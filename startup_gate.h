@@ -0,0 +1,59 @@
+/*
+ * startup_gate.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef STARTUP_GATE_H_
+#define STARTUP_GATE_H_
+
+#include <stdint.h>
+
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+/**
+ * Runs an action once, after every prerequisite it waits for is met
+ *
+ * Prerequisites are bits chosen by the owner, met in any order (eg: BLEProcess
+ * sets up the security manager once both the BLE stack and the filesystem are up).
+ * Not thread safe, use from a single event queue.
+ */
+class StartupGate : private mbed::NonCopyable<StartupGate> {
+public:
+
+	StartupGate(mbed::Callback<void()> action) : action(action), pending(0), opened(false) {
+	}
+
+	/** Also wait for prerequisite, ignored once the gate is open */
+	void require(uint32_t prerequisite) {
+		if(!opened) {
+			pending |= prerequisite;
+		}
+	}
+
+	/** The prerequisite is met, runs the action if it was the last one */
+	void satisfy(uint32_t prerequisite) {
+		pending &= ~prerequisite;
+		if(pending == 0 && !opened) {
+			opened = true;
+			if(action) {
+				action();
+			}
+		}
+	}
+
+	/** True once the action ran */
+	bool is_open(void) const {
+		return opened;
+	}
+
+private:
+
+	mbed::Callback<void()> action;
+	uint32_t pending;
+	bool opened;
+
+};
+
+#endif /* STARTUP_GATE_H_ */
@@ -0,0 +1,68 @@
+/*
+ * status_service.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "status_service.h"
+
+#include <string.h>
+
+StatusService::StatusService(events::EventQueue& queue) :
+	queue(queue),
+	ble(NULL),
+	ready_value(),
+	ready_char(UUID(STATUS_READY_CHAR_UUID), ready_value,
+			GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY),
+	ready_mask(0),
+	failed_mask(0),
+	update_scheduled(false) {
+}
+
+void StatusService::start(BLE& ble) {
+	this->ble = &ble;
+
+	GattCharacteristic* chars[] = { &ready_char };
+	GattService service(UUID(STATUS_SERVICE_UUID), chars, sizeof(chars) / sizeof(chars[0]));
+
+	ble.gattServer().addService(service);
+
+	update();
+}
+
+void StatusService::set_ready(status_component_t component, bool ready) {
+	if(component >= STATUS_COMPONENT_COUNT) {
+		return;
+	}
+
+	uint32_t bit = 1UL << component;
+	if(ready) {
+		ready_mask.fetch_or(bit);
+		failed_mask.fetch_and(~bit);
+	} else {
+		failed_mask.fetch_or(bit);
+		ready_mask.fetch_and(~bit);
+	}
+
+	if(!update_scheduled.exchange(true)) {
+		if(queue.call(mbed::callback(this, &StatusService::update)) == 0) {
+			update_scheduled.store(false);
+		}
+	}
+}
+
+void StatusService::update(void) {
+	update_scheduled.store(false);
+
+	if(ble == NULL) {
+		// start() writes whatever has been reported by then
+		return;
+	}
+
+	uint32_t ready = ready_mask.load();
+	uint32_t failed = failed_mask.load();
+	memcpy(&ready_value[0], &ready, sizeof(ready));
+	memcpy(&ready_value[4], &failed, sizeof(failed));
+
+	ble->gattServer().write(ready_char.getValueHandle(), ready_value, sizeof(ready_value));
+}
@@ -0,0 +1,82 @@
+/*
+ * status_service.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef STATUS_SERVICE_H_
+#define STATUS_SERVICE_H_
+
+#include <stdint.h>
+#include <atomic>
+
+#include "ble/BLE.h"
+#include "ble/GattServer.h"
+#include "events/EventQueue.h"
+#include "platform/NonCopyable.h"
+
+#define STATUS_SERVICE_UUID			"00000012-8dd4-4087-a16a-04a7c8e01734"
+#define STATUS_READY_CHAR_UUID		"00001012-8dd4-4087-a16a-04a7c8e01734"
+
+/** Components brought up in the background after advertising starts */
+typedef enum {
+	STATUS_COMPONENT_BME680 = 0,
+	STATUS_COMPONENT_MAX44009,
+	STATUS_COMPONENT_SI7021,
+	STATUS_COMPONENT_VL53L0X,
+	STATUS_COMPONENT_LSM9DS1,
+	STATUS_COMPONENT_ICM20602,
+	STATUS_COMPONENT_FILESYSTEM,
+	STATUS_COMPONENT_SENSOR_LOG,
+	STATUS_COMPONENT_COUNT
+} status_component_t;
+
+/**
+ * Readiness of the components behind the other services
+ *
+ * The ready characteristic holds { uint32 ready mask, uint32 failed mask }
+ * with one bit per status_component_t (read and notify). A component in
+ * neither mask is still initializing: its service is up but has no data
+ * yet, clients should not trust its characteristics until the ready bit
+ * is set.
+ */
+class StatusService : private mbed::NonCopyable<StatusService> {
+public:
+
+	StatusService(events::EventQueue& queue);
+
+	void start(BLE& ble);
+
+	/** Report that a component came up or failed, safe to call from any thread */
+	void set_ready(status_component_t component, bool ready);
+
+	bool is_ready(status_component_t component) const {
+		return (ready_mask.load() & (1UL << component)) != 0;
+	}
+
+	uint32_t get_ready_mask(void) const {
+		return ready_mask.load();
+	}
+
+	uint32_t get_failed_mask(void) const {
+		return failed_mask.load();
+	}
+
+private:
+
+	/** Write the masks to the characteristic, BLE thread */
+	void update(void);
+
+	events::EventQueue& queue;
+	BLE* ble;
+
+	uint8_t ready_value[8];
+	ReadOnlyArrayGattCharacteristic<uint8_t, 8> ready_char;
+
+	std::atomic<uint32_t> ready_mask;
+	std::atomic<uint32_t> failed_mask;
+	std::atomic<bool> update_scheduled;
+
+};
+
+#endif /* STATUS_SERVICE_H_ */
@@ -0,0 +1,150 @@
+/*
+ * bench_filesystem_boot.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "HeapBlockDevice.h"
+#include "rtos/Kernel.h"
+#include "filesystem_boot.h"
+
+/**
+ * Boot time of the filesystem on a flash that erases slowly
+ *
+ * Compares mounting the existing filesystem with erasing the block device
+ * on every boot, as it used to be. The block device charges typical QSPI NOR
+ * timings to the kernel clock instead of waiting, and the filesystem models
+ * LittleFS: formatting writes the two superblock blocks, mounting reads them.
+ */
+
+/** The slice main.cpp gives the filesystem */
+#define BENCH_FS_SIZE			(128 * 1024)
+#define BENCH_SECTOR_SIZE		4096
+#define BENCH_PAGE_SIZE			256
+
+/** Typical NOR timings: 4 KB sector erase, 256 byte page program, quad read */
+#define SECTOR_ERASE_US			45000
+#define PAGE_PROGRAM_US			850
+#define READ_BYTES_PER_US		4
+
+/** Mounting has to be at least this many times faster than erasing */
+#define MIN_SPEEDUP				20
+
+class SlowEraseBlockDevice : public HeapBlockDevice {
+public:
+
+	SlowEraseBlockDevice(bd_size_t size) :
+		HeapBlockDevice(size, 1, BENCH_PAGE_SIZE, BENCH_SECTOR_SIZE) { }
+
+	virtual int read(void* buffer, bd_addr_t addr, bd_size_t size) {
+		rtos::Kernel::host_advance_us(size / READ_BYTES_PER_US);
+		return HeapBlockDevice::read(buffer, addr, size);
+	}
+
+	virtual int program(const void* buffer, bd_addr_t addr, bd_size_t size) {
+		rtos::Kernel::host_advance_us((size / BENCH_PAGE_SIZE) * PAGE_PROGRAM_US);
+		return HeapBlockDevice::program(buffer, addr, size);
+	}
+
+	virtual int erase(bd_addr_t addr, bd_size_t size) {
+		rtos::Kernel::host_advance_us((size / BENCH_SECTOR_SIZE) * SECTOR_ERASE_US);
+		return HeapBlockDevice::erase(addr, size);
+	}
+
+};
+
+/** Superblock pair in the first two sectors, like LittleFS */
+class SuperblockFileSystem : public FileSystem {
+public:
+
+	SuperblockFileSystem() : bd(NULL) { }
+
+	virtual int mount(BlockDevice* bd) {
+		for(bd_addr_t block = 0; block < 2; block++) {
+			uint8_t superblock[BENCH_PAGE_SIZE];
+			int err = bd->read(superblock, block * BENCH_SECTOR_SIZE, sizeof(superblock));
+			if(err) {
+				return err;
+			}
+			if(memcmp(superblock, MAGIC, sizeof(MAGIC)) == 0) {
+				this->bd = bd;
+				return 0;
+			}
+		}
+		return -1;
+	}
+
+	virtual int unmount() {
+		bd = NULL;
+		return 0;
+	}
+
+	virtual int reformat(BlockDevice* bd) {
+		uint8_t superblock[BENCH_PAGE_SIZE];
+		memset(superblock, 0xFF, sizeof(superblock));
+		memcpy(superblock, MAGIC, sizeof(MAGIC));
+		for(bd_addr_t block = 0; block < 2; block++) {
+			int err = bd->erase(block * BENCH_SECTOR_SIZE, BENCH_SECTOR_SIZE);
+			if(!err) {
+				err = bd->program(superblock, block * BENCH_SECTOR_SIZE, sizeof(superblock));
+			}
+			if(err) {
+				return err;
+			}
+		}
+		return mount(bd);
+	}
+
+protected:
+
+	virtual int dir_open(mbed::fs_dir_t* dir, const char* path) {
+		return (bd != NULL)? 0 : -1;
+	}
+
+	virtual int dir_close(mbed::fs_dir_t dir) {
+		return 0;
+	}
+
+private:
+
+	static const char MAGIC[9];
+
+	BlockDevice* bd;
+
+};
+
+const char SuperblockFileSystem::MAGIC[9] = "littlefs";
+
+static filesystem_boot_stats_t boot(const char* name, SlowEraseBlockDevice& bd, bool erase) {
+	SuperblockFileSystem fs;
+	filesystem_boot_stats_t stats;
+	filesystem_boot(fs, bd, erase, stats);
+
+	printf("%-20s %-12s %6lu ms (erase %lu, mount %lu, format %lu)\n", name,
+			filesystem_boot_result_name(stats.result), (unsigned long) stats.total_ms,
+			(unsigned long) stats.erase_ms, (unsigned long) stats.mount_ms,
+			(unsigned long) stats.format_ms);
+	return stats;
+}
+
+int main(void) {
+	SlowEraseBlockDevice bd(BENCH_FS_SIZE);
+
+	filesystem_boot_stats_t first = boot("first boot", bd, false);
+	filesystem_boot_stats_t mounted = boot("mount", bd, false);
+	filesystem_boot_stats_t erased = boot("erase every boot", bd, true);
+
+	if(first.result != FILESYSTEM_BOOT_REFORMATTED || mounted.result != FILESYSTEM_BOOT_MOUNTED ||
+			erased.result != FILESYSTEM_BOOT_ERASED) {
+		printf("FAIL: unexpected boot result\n");
+		return 1;
+	}
+	if((uint64_t) mounted.total_ms * MIN_SPEEDUP > erased.total_ms) {
+		printf("FAIL: mounting is less than %u times faster than erasing\n", MIN_SPEEDUP);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,43 @@
+/*
+ * bench_imu_dsp.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#include "imu_dsp.h"
+#include "imu_dsp_benchmark.h"
+
+/**
+ * Feature kernels against their reference versions, every FFT size
+ *
+ * Fails if a kernel's results differ from the reference by more than
+ * imu_dsp_benchmark() allows. Optional argument: iterations per kernel.
+ */
+
+#define BENCH_ITERATIONS	100
+
+static uint32_t host_clock_us(void) {
+	return (uint32_t) std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main(int argc, char** argv) {
+	uint32_t iterations = (argc > 1)? (uint32_t) strtoul(argv[1], NULL, 0) : BENCH_ITERATIONS;
+	bool ok = true;
+
+	for(size_t n = 16; n <= IMU_DSP_MAX_FFT_SIZE; n *= 2) {
+		imu_dsp_benchmark_result_t result;
+		bool passed = imu_dsp_benchmark(n, iterations, host_clock_us, result);
+		imu_dsp_benchmark_print(result);
+		if(!passed) {
+			printf("FAIL: %u points differ from the reference\n", (unsigned) n);
+		}
+		ok &= passed;
+	}
+
+	return ok? 0 : 1;
+}
@@ -0,0 +1,106 @@
+/*
+ * bench_sensor_log.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#include "HeapBlockDevice.h"
+#include "rtos/ThisThread.h"
+#include "sensor_log.h"
+
+/**
+ * Sensor log throughput and write amplification on a heap block device
+ *
+ * Write amplification is the bytes programmed and erased per byte of
+ * records logged. Full segments cost one erase and one program of
+ * SENSOR_LOG_SEGMENT_SIZE, a sync() writes the whole partial segment.
+ */
+
+#define BENCH_BD_SIZE		(64 * SENSOR_LOG_SEGMENT_SIZE)
+#define BENCH_RECORDS		(200 * SENSOR_LOG_RECORDS_PER_SEGMENT)
+
+/** Full segments should stay close to the ideal of an erase plus a program */
+#define MAX_FULL_SEGMENT_AMPLIFICATION_X100		205
+
+/** Counts the bytes passed to program and erase */
+class CountingBlockDevice : public HeapBlockDevice {
+public:
+
+	CountingBlockDevice(bd_size_t size) :
+		HeapBlockDevice(size, 1, 1, SENSOR_LOG_SEGMENT_SIZE), programmed(0), erased(0) { }
+
+	virtual int program(const void* buffer, bd_addr_t addr, bd_size_t size) {
+		programmed += size;
+		return HeapBlockDevice::program(buffer, addr, size);
+	}
+
+	virtual int erase(bd_addr_t addr, bd_size_t size) {
+		erased += size;
+		return HeapBlockDevice::erase(addr, size);
+	}
+
+	uint64_t programmed;
+	uint64_t erased;
+
+};
+
+/**
+ * Log BENCH_RECORDS records, syncing every sync_every records (0: never)
+ * @retval Write amplification times 100
+ */
+static unsigned long run(const char* name, uint32_t sync_every) {
+	// The writer thread is detached, the log lives until the process exits
+	CountingBlockDevice& bd = *new CountingBlockDevice(BENCH_BD_SIZE);
+	SensorLog& log = *new SensorLog(bd);
+	if(log.init() != 0) {
+		return ~0UL;
+	}
+
+	sensor_sample_t sample;
+	memset(&sample, 0, sizeof(sample));
+	sample.channel = SENSOR_CHANNEL_LSM9DS1_ACCEL;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for(uint32_t n = 0; n < BENCH_RECORDS; n++) {
+		sample.sequence = (uint16_t) n;
+		sample.time_ms = n;
+		while(!log.append(sample)) {
+			rtos::ThisThread::yield();
+		}
+		if(sync_every != 0 && (n + 1) % sync_every == 0) {
+			log.sync();
+		}
+	}
+	log.sync();
+	std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+
+	unsigned long us = (unsigned long)
+			std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+	unsigned long records_per_s = (unsigned long) (BENCH_RECORDS * 1000000ULL / (us? us : 1));
+	unsigned long record_bytes = BENCH_RECORDS * sizeof(sensor_log_record_t);
+	unsigned long amplification = (unsigned long)
+			((bd.programmed + bd.erased) * 100 / record_bytes);
+
+	printf("%-22s %9lu records/s, %lu bytes programmed, %lu erased, write amplification %lu.%02lu\n",
+			name, records_per_s, (unsigned long) bd.programmed, (unsigned long) bd.erased,
+			amplification / 100, amplification % 100);
+
+	return amplification;
+}
+
+int main(void) {
+	unsigned long full = run("full segments", 0);
+	run("sync every 1000", 1000);
+	run("sync every 100", 100);
+
+	if(full > MAX_FULL_SEGMENT_AMPLIFICATION_X100) {
+		printf("FAIL: write amplification of full segments above %u.%02u\n",
+				MAX_FULL_SEGMENT_AMPLIFICATION_X100 / 100, MAX_FULL_SEGMENT_AMPLIFICATION_X100 % 100);
+		return 1;
+	}
+	return 0;
+}
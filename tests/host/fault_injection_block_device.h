@@ -0,0 +1,148 @@
+/*
+ * fault_injection_block_device.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef FAULT_INJECTION_BLOCK_DEVICE_H_
+#define FAULT_INJECTION_BLOCK_DEVICE_H_
+
+#include <stdint.h>
+
+#include "BlockDevice.h"
+
+/**
+ * Block device that loses power on a chosen program or erase
+ *
+ * Wraps another block device (a HeapBlockDevice on a host or in RAM) and
+ * counts the programs and erases passed through. Once cut_power_after()
+ * ran out, the next program only writes its first half (rounded to the
+ * program size), a torn write, and the next erase is not performed. Every
+ * operation after that fails until restore_power(), which stands in for
+ * the reboot.
+ */
+class FaultInjectionBlockDevice : public BlockDevice {
+public:
+
+	FaultInjectionBlockDevice(BlockDevice& bd) :
+		bd(bd), armed(false), countdown(0), powered(true), operations(0) {
+	}
+
+	/** Let count more programs or erases through, lose power on the next one */
+	void cut_power_after(uint32_t count) {
+		armed = true;
+		countdown = count;
+	}
+
+	void restore_power(void) {
+		armed = false;
+		powered = true;
+	}
+
+	bool is_powered(void) const {
+		return powered;
+	}
+
+	/** Programs and erases since construction */
+	uint32_t get_operations(void) const {
+		return operations;
+	}
+
+	virtual int init(void) {
+		return bd.init();
+	}
+
+	virtual int deinit(void) {
+		return bd.deinit();
+	}
+
+	virtual int sync(void) {
+		return powered? bd.sync() : BD_ERROR_DEVICE_ERROR;
+	}
+
+	virtual int read(void* buffer, bd_addr_t addr, bd_size_t size) {
+		return powered? bd.read(buffer, addr, size) : BD_ERROR_DEVICE_ERROR;
+	}
+
+	virtual int program(const void* buffer, bd_addr_t addr, bd_size_t size) {
+		if(!powered) {
+			return BD_ERROR_DEVICE_ERROR;
+		}
+
+		operations++;
+		if(cut_now()) {
+			bd_size_t torn = (size / 2) - (size / 2) % bd.get_program_size();
+			if(torn != 0) {
+				bd.program(buffer, addr, torn);
+			}
+			return BD_ERROR_DEVICE_ERROR;
+		}
+		return bd.program(buffer, addr, size);
+	}
+
+	virtual int erase(bd_addr_t addr, bd_size_t size) {
+		if(!powered) {
+			return BD_ERROR_DEVICE_ERROR;
+		}
+
+		operations++;
+		if(cut_now()) {
+			return BD_ERROR_DEVICE_ERROR;
+		}
+		return bd.erase(addr, size);
+	}
+
+	virtual bd_size_t get_read_size(void) const {
+		return bd.get_read_size();
+	}
+
+	virtual bd_size_t get_program_size(void) const {
+		return bd.get_program_size();
+	}
+
+	virtual bd_size_t get_erase_size(void) const {
+		return bd.get_erase_size();
+	}
+
+	virtual bd_size_t get_erase_size(bd_addr_t addr) const {
+		return bd.get_erase_size(addr);
+	}
+
+	virtual int get_erase_value(void) const {
+		return bd.get_erase_value();
+	}
+
+	virtual bd_size_t size(void) const {
+		return bd.size();
+	}
+
+	virtual const char* get_type(void) const {
+		return "FAULT_INJECTION";
+	}
+
+private:
+
+	/** Counts an operation down, true if power goes with this one */
+	bool cut_now(void) {
+		if(!armed) {
+			return false;
+		}
+		if(countdown != 0) {
+			countdown--;
+			return false;
+		}
+
+		armed = false;
+		powered = false;
+		return true;
+	}
+
+	BlockDevice& bd;
+	bool armed;
+	uint32_t countdown;
+	bool powered;
+	uint32_t operations;
+
+};
+
+#endif /* FAULT_INJECTION_BLOCK_DEVICE_H_ */
@@ -0,0 +1,129 @@
+/*
+ * FileSystem.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef HOST_STUB_FILE_SYSTEM_H_
+#define HOST_STUB_FILE_SYSTEM_H_
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "BlockDevice.h"
+
+namespace mbed {
+
+typedef void* fs_file_t;
+typedef void* fs_dir_t;
+
+class Dir;
+class File;
+
+/**
+ * Host stand-in for mbed::FileSystem
+ *
+ * Mounting, files and the few path operations the application uses. Unlike
+ * mbed, only mount() and unmount() must be implemented, everything else
+ * defaults to -ENOSYS so a fake only overrides what its test needs.
+ */
+class FileSystem {
+public:
+
+	FileSystem(const char* name = NULL) : name(name) { }
+
+	virtual ~FileSystem() { }
+
+	virtual int mount(BlockDevice* bd) = 0;
+
+	virtual int unmount() = 0;
+
+	virtual int reformat(BlockDevice* bd) {
+		return -ENOSYS;
+	}
+
+	virtual int remove(const char* path) {
+		return -ENOSYS;
+	}
+
+	virtual int rename(const char* path, const char* newpath) {
+		return -ENOSYS;
+	}
+
+	virtual int stat(const char* path, struct stat* st) {
+		return -ENOSYS;
+	}
+
+	virtual int mkdir(const char* path, mode_t mode) {
+		return -ENOSYS;
+	}
+
+	const char* get_name(void) const {
+		return name;
+	}
+
+protected:
+
+	friend class Dir;
+	friend class File;
+
+	virtual int file_open(fs_file_t* file, const char* path, int flags) {
+		return -ENOSYS;
+	}
+
+	virtual int file_close(fs_file_t file) {
+		return -ENOSYS;
+	}
+
+	virtual ssize_t file_read(fs_file_t file, void* buffer, size_t len) {
+		return -ENOSYS;
+	}
+
+	virtual ssize_t file_write(fs_file_t file, const void* buffer, size_t len) {
+		return -ENOSYS;
+	}
+
+	virtual int file_sync(fs_file_t file) {
+		return 0;
+	}
+
+	virtual off_t file_seek(fs_file_t file, off_t offset, int whence) {
+		return -ENOSYS;
+	}
+
+	virtual off_t file_tell(fs_file_t file) {
+		return file_seek(file, 0, SEEK_CUR);
+	}
+
+	virtual off_t file_size(fs_file_t file) {
+		return -ENOSYS;
+	}
+
+	virtual int file_truncate(fs_file_t file, off_t length) {
+		return -ENOSYS;
+	}
+
+	virtual int dir_open(fs_dir_t* dir, const char* path) {
+		return -ENOSYS;
+	}
+
+	virtual int dir_close(fs_dir_t dir) {
+		return -ENOSYS;
+	}
+
+private:
+
+	const char* name;
+
+};
+
+} // namespace mbed
+
+using mbed::FileSystem;
+using mbed::fs_file_t;
+using mbed::fs_dir_t;
+
+#endif /* HOST_STUB_FILE_SYSTEM_H_ */
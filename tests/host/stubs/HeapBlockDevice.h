@@ -0,0 +1,102 @@
+/*
+ * HeapBlockDevice.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef HOST_STUB_HEAP_BLOCK_DEVICE_H_
+#define HOST_STUB_HEAP_BLOCK_DEVICE_H_
+
+#include <string.h>
+#include <vector>
+
+#include "BlockDevice.h"
+
+/**
+ * Host stand-in for mbed's HeapBlockDevice
+ *
+ * Behaves like NOR flash: erased bytes read as 0xFF, programming can only
+ * clear bits. Misaligned accesses fail like they do on the real devices.
+ */
+class HeapBlockDevice : public BlockDevice {
+public:
+
+	HeapBlockDevice(bd_size_t size, bd_size_t block = 512) :
+		memory(size, 0xFF), read_size(block), program_size(block), erase_size(block) { }
+
+	HeapBlockDevice(bd_size_t size, bd_size_t read, bd_size_t program, bd_size_t erase) :
+		memory(size, 0xFF), read_size(read), program_size(program), erase_size(erase) { }
+
+	virtual int init() {
+		return 0;
+	}
+
+	virtual int deinit() {
+		return 0;
+	}
+
+	virtual int read(void* buffer, bd_addr_t addr, bd_size_t size) {
+		if(!valid(addr, size, read_size)) {
+			return BD_ERROR_DEVICE_ERROR;
+		}
+		memcpy(buffer, &memory[addr], size);
+		return 0;
+	}
+
+	virtual int program(const void* buffer, bd_addr_t addr, bd_size_t size) {
+		if(!valid(addr, size, program_size)) {
+			return BD_ERROR_DEVICE_ERROR;
+		}
+		const uint8_t* data = (const uint8_t*) buffer;
+		for(bd_size_t i = 0; i < size; i++) {
+			memory[addr + i] &= data[i];
+		}
+		return 0;
+	}
+
+	virtual int erase(bd_addr_t addr, bd_size_t size) {
+		if(!valid(addr, size, erase_size)) {
+			return BD_ERROR_DEVICE_ERROR;
+		}
+		memset(&memory[addr], 0xFF, size);
+		return 0;
+	}
+
+	virtual bd_size_t get_read_size() const {
+		return read_size;
+	}
+
+	virtual bd_size_t get_program_size() const {
+		return program_size;
+	}
+
+	virtual bd_size_t get_erase_size() const {
+		return erase_size;
+	}
+
+	virtual int get_erase_value() const {
+		return 0xFF;
+	}
+
+	virtual bd_size_t size() const {
+		return memory.size();
+	}
+
+	virtual const char* get_type() const {
+		return "HEAP";
+	}
+
+private:
+
+	bool valid(bd_addr_t addr, bd_size_t size, bd_size_t unit) const {
+		return addr % unit == 0 && size % unit == 0 && addr + size <= memory.size();
+	}
+
+	std::vector<uint8_t> memory;
+	bd_size_t read_size;
+	bd_size_t program_size;
+	bd_size_t erase_size;
+
+};
+
+#endif /* HOST_STUB_HEAP_BLOCK_DEVICE_H_ */
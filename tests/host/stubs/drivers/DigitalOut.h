@@ -0,0 +1,43 @@
+/*
+ * DigitalOut.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef HOST_STUB_DIGITAL_OUT_H_
+#define HOST_STUB_DIGITAL_OUT_H_
+
+namespace mbed {
+
+/** Host stand-in for mbed::DigitalOut, only remembers the level written */
+class DigitalOut {
+public:
+
+	DigitalOut(int pin, int value = 0) : value(value) { }
+
+	void write(int value) {
+		this->value = value;
+	}
+
+	int read(void) {
+		return value;
+	}
+
+	DigitalOut& operator=(int value) {
+		write(value);
+		return *this;
+	}
+
+	operator int() {
+		return read();
+	}
+
+private:
+
+	int value;
+
+};
+
+} // namespace mbed
+
+#endif /* HOST_STUB_DIGITAL_OUT_H_ */
@@ -0,0 +1,74 @@
+/*
+ * MbedCRC.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef HOST_STUB_MBED_CRC_H_
+#define HOST_STUB_MBED_CRC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum {
+	POLY_16BIT_CCITT = 0x1021,
+	POLY_32BIT_ANSI = 0x04C11DB7
+} crc_polynomial_t;
+
+namespace mbed {
+
+/**
+ * Host stand-in for mbed::MbedCRC, bitwise
+ *
+ * Same parameters as mbed's defaults for the polynomials the application
+ * uses: CRC-32 is reflected with an all ones seed and final XOR (the zlib
+ * CRC), CCITT is not reflected and starts from 0xFFFF.
+ */
+template<uint32_t polynomial, uint8_t width>
+class MbedCRC {
+public:
+
+	static_assert((polynomial == POLY_32BIT_ANSI && width == 32) ||
+			(polynomial == POLY_16BIT_CCITT && width == 16), "polynomial not supported on the host");
+
+	int32_t compute_partial_start(uint32_t* crc) {
+		*crc = (width == 32)? 0xFFFFFFFFu : 0xFFFFu;
+		return 0;
+	}
+
+	int32_t compute_partial(const void* buffer, size_t size, uint32_t* crc) {
+		const uint8_t* data = (const uint8_t*) buffer;
+		for(size_t i = 0; i < size; i++) {
+			if(width == 32) {
+				*crc ^= data[i];
+				for(int bit = 0; bit < 8; bit++) {
+					*crc = (*crc >> 1) ^ ((*crc & 1)? 0xEDB88320u : 0);
+				}
+			} else {
+				*crc ^= (uint32_t) data[i] << 8;
+				for(int bit = 0; bit < 8; bit++) {
+					*crc = ((*crc << 1) ^ ((*crc & 0x8000)? polynomial : 0)) & 0xFFFF;
+				}
+			}
+		}
+		return 0;
+	}
+
+	int32_t compute_partial_stop(uint32_t* crc) {
+		if(width == 32) {
+			*crc ^= 0xFFFFFFFFu;
+		}
+		return 0;
+	}
+
+	int32_t compute(const void* buffer, size_t size, uint32_t* crc) {
+		compute_partial_start(crc);
+		compute_partial(buffer, size, crc);
+		return compute_partial_stop(crc);
+	}
+
+};
+
+} // namespace mbed
+
+#endif /* HOST_STUB_MBED_CRC_H_ */
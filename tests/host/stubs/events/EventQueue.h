@@ -0,0 +1,136 @@
+/*
+ * EventQueue.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef HOST_STUB_EVENT_QUEUE_H_
+#define HOST_STUB_EVENT_QUEUE_H_
+
+#include <stddef.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+/** Bytes an event takes in the queue's buffer, the host queue counts events of this size */
+#define EVENTS_EVENT_SIZE	64
+
+#define EVENTS_QUEUE_SIZE	(32 * EVENTS_EVENT_SIZE)
+
+namespace events {
+
+/**
+ * Host stand-in for events::EventQueue
+ *
+ * Holds size / EVENTS_EVENT_SIZE events, call() fails (returns 0) once
+ * they are all pending, like the equeue allocator running out. Immediate
+ * events only, dispatched in order on the thread calling dispatch().
+ */
+class EventQueue : private mbed::NonCopyable<EventQueue> {
+public:
+
+	EventQueue(unsigned size = EVENTS_QUEUE_SIZE, unsigned char* buffer = NULL) :
+		capacity(size / EVENTS_EVENT_SIZE), next_id(1), broken(false) { }
+
+	template<typename F>
+	int call(F f) {
+		return post(mbed::Callback<void()>(f));
+	}
+
+	template<typename F, typename A0>
+	int call(F f, A0 a0) {
+		return post(mbed::Callback<void()>([f, a0]() { f(a0); }));
+	}
+
+	template<typename T, typename R, typename... Args, typename... BoundArgs>
+	int call(T* obj, R (T::*method)(Args...), BoundArgs... args) {
+		return post(mbed::Callback<void()>([obj, method, args...]() { (obj->*method)(args...); }));
+	}
+
+	/**
+	 * Run events for ms milliseconds, until break_dispatch() or forever if negative
+	 *
+	 * dispatch(0) runs the pending events and returns.
+	 */
+	void dispatch(int ms = -1) {
+		std::chrono::steady_clock::time_point deadline =
+				std::chrono::steady_clock::now() + std::chrono::milliseconds(ms < 0? 0 : ms);
+
+		std::unique_lock<std::mutex> guard(lock);
+		while(true) {
+			if(!events.empty()) {
+				mbed::Callback<void()> event = events.front().second;
+				events.pop_front();
+				guard.unlock();
+				event();
+				guard.lock();
+				continue;
+			}
+
+			if(broken || ms == 0 || (ms > 0 && std::chrono::steady_clock::now() >= deadline)) {
+				broken = false;
+				return;
+			}
+
+			if(ms < 0) {
+				ready.wait(guard);
+			} else {
+				ready.wait_until(guard, deadline);
+			}
+		}
+	}
+
+	/** Drop a pending event, ignored if it already ran */
+	void cancel(int id) {
+		std::lock_guard<std::mutex> guard(lock);
+		for(std::deque<event_t>::iterator it = events.begin(); it != events.end(); ++it) {
+			if(it->first == id) {
+				events.erase(it);
+				return;
+			}
+		}
+	}
+
+	/** Number of events waiting to be dispatched */
+	size_t pending(void) {
+		std::lock_guard<std::mutex> guard(lock);
+		return events.size();
+	}
+
+	void break_dispatch(void) {
+		std::lock_guard<std::mutex> guard(lock);
+		broken = true;
+		ready.notify_all();
+	}
+
+private:
+
+	typedef std::pair<int, mbed::Callback<void()> > event_t;
+
+	int post(const mbed::Callback<void()>& event) {
+		std::lock_guard<std::mutex> guard(lock);
+		if(events.size() >= capacity) {
+			return 0;
+		}
+		events.push_back(event_t(next_id, event));
+		ready.notify_all();
+		return next_id++;
+	}
+
+	std::mutex lock;
+	std::condition_variable ready;
+	std::deque<event_t> events;
+	size_t capacity;
+	int next_id;
+	bool broken;
+
+};
+
+} // namespace events
+
+#endif /* HOST_STUB_EVENT_QUEUE_H_ */
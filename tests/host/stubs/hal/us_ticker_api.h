@@ -0,0 +1,19 @@
+/*
+ * us_ticker_api.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef HOST_STUB_US_TICKER_API_H_
+#define HOST_STUB_US_TICKER_API_H_
+
+#include <stdint.h>
+#include <chrono>
+
+/** Free running microsecond counter, wraps at 32 bits like the hardware one */
+inline uint32_t us_ticker_read(void) {
+	return (uint32_t) std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif /* HOST_STUB_US_TICKER_API_H_ */
@@ -0,0 +1,88 @@
+/*
+ * Callback.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef HOST_STUB_CALLBACK_H_
+#define HOST_STUB_CALLBACK_H_
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+namespace mbed {
+
+template<typename F>
+class Callback;
+
+/**
+ * Host stand-in for mbed::Callback
+ *
+ * Same construction and call syntax as the mbed class (free functions,
+ * object and member function pairs, function objects), backed by
+ * std::function since allocation does not matter on a host.
+ */
+template<typename R, typename... Args>
+class Callback<R(Args...)> {
+public:
+
+	Callback() : fn() { }
+
+	Callback(std::nullptr_t) : fn() { }
+
+	Callback(R (*func)(Args...)) : fn() {
+		if(func != NULL) {
+			fn = func;
+		}
+	}
+
+	template<typename T, typename U>
+	Callback(U* obj, R (T::*method)(Args...)) :
+		fn([obj, method](Args... args) { return (obj->*method)(args...); }) { }
+
+	template<typename T, typename U>
+	Callback(const U* obj, R (T::*method)(Args...) const) :
+		fn([obj, method](Args... args) { return (obj->*method)(args...); }) { }
+
+	template<typename F, typename = typename std::enable_if<
+			!std::is_same<typename std::decay<F>::type, Callback>::value &&
+			!std::is_pointer<typename std::decay<F>::type>::value>::type>
+	Callback(F func) : fn(func) { }
+
+	R call(Args... args) const {
+		return fn(args...);
+	}
+
+	R operator()(Args... args) const {
+		return fn(args...);
+	}
+
+	explicit operator bool() const {
+		return static_cast<bool>(fn);
+	}
+
+private:
+
+	std::function<R(Args...)> fn;
+
+};
+
+template<typename R, typename... Args>
+Callback<R(Args...)> callback(R (*func)(Args...)) {
+	return Callback<R(Args...)>(func);
+}
+
+template<typename T, typename U, typename R, typename... Args>
+Callback<R(Args...)> callback(U* obj, R (T::*method)(Args...)) {
+	return Callback<R(Args...)>(obj, method);
+}
+
+template<typename T, typename U, typename R, typename... Args>
+Callback<R(Args...)> callback(const U* obj, R (T::*method)(Args...) const) {
+	return Callback<R(Args...)>(obj, method);
+}
+
+} // namespace mbed
+
+#endif /* HOST_STUB_CALLBACK_H_ */
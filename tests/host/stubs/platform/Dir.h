@@ -0,0 +1,52 @@
+/*
+ * Dir.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef HOST_STUB_DIR_H_
+#define HOST_STUB_DIR_H_
+
+#include <stddef.h>
+
+#include "FileSystem.h"
+
+namespace mbed {
+
+/** Host stand-in for mbed::Dir */
+class Dir {
+public:
+
+	Dir() : fs(NULL), dir(NULL) { }
+
+	~Dir() {
+		close();
+	}
+
+	int open(FileSystem* fs, const char* path) {
+		int err = fs->dir_open(&dir, path);
+		if(err == 0) {
+			this->fs = fs;
+		}
+		return err;
+	}
+
+	int close() {
+		if(fs == NULL) {
+			return 0;
+		}
+		int err = fs->dir_close(dir);
+		fs = NULL;
+		return err;
+	}
+
+private:
+
+	FileSystem* fs;
+	fs_dir_t dir;
+
+};
+
+} // namespace mbed
+
+#endif /* HOST_STUB_DIR_H_ */
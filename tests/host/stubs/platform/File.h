@@ -0,0 +1,81 @@
+/*
+ * File.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef HOST_STUB_FILE_H_
+#define HOST_STUB_FILE_H_
+
+#include <stddef.h>
+
+#include "FileSystem.h"
+
+namespace mbed {
+
+/** Host stand-in for mbed::File, forwards to the filesystem it was opened on */
+class File {
+public:
+
+	File() : fs(NULL), file(NULL) { }
+
+	~File() {
+		close();
+	}
+
+	int open(FileSystem* fs, const char* path, int flags = O_RDONLY) {
+		close();
+		int err = fs->file_open(&file, path, flags);
+		if(err == 0) {
+			this->fs = fs;
+		}
+		return err;
+	}
+
+	int close() {
+		if(fs == NULL) {
+			return 0;
+		}
+		int err = fs->file_close(file);
+		fs = NULL;
+		return err;
+	}
+
+	ssize_t read(void* buffer, size_t len) {
+		return (fs == NULL)? -EBADF : fs->file_read(file, buffer, len);
+	}
+
+	ssize_t write(const void* buffer, size_t len) {
+		return (fs == NULL)? -EBADF : fs->file_write(file, buffer, len);
+	}
+
+	int sync() {
+		return (fs == NULL)? -EBADF : fs->file_sync(file);
+	}
+
+	off_t seek(off_t offset, int whence = SEEK_SET) {
+		return (fs == NULL)? -EBADF : fs->file_seek(file, offset, whence);
+	}
+
+	off_t tell() {
+		return (fs == NULL)? -EBADF : fs->file_tell(file);
+	}
+
+	off_t size() {
+		return (fs == NULL)? -EBADF : fs->file_size(file);
+	}
+
+	int truncate(off_t length) {
+		return (fs == NULL)? -EBADF : fs->file_truncate(file, length);
+	}
+
+private:
+
+	FileSystem* fs;
+	fs_file_t file;
+
+};
+
+} // namespace mbed
+
+#endif /* HOST_STUB_FILE_H_ */
@@ -0,0 +1,31 @@
+/*
+ * NonCopyable.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef HOST_STUB_NON_COPYABLE_H_
+#define HOST_STUB_NON_COPYABLE_H_
+
+namespace mbed {
+
+/** Host stand-in for mbed::NonCopyable */
+template<typename T>
+class NonCopyable {
+protected:
+
+	NonCopyable() { }
+
+	~NonCopyable() { }
+
+private:
+
+	NonCopyable(const NonCopyable&);
+
+	NonCopyable& operator=(const NonCopyable&);
+
+};
+
+} // namespace mbed
+
+#endif /* HOST_STUB_NON_COPYABLE_H_ */
@@ -0,0 +1,72 @@
+/*
+ * EventFlags.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef HOST_STUB_EVENT_FLAGS_H_
+#define HOST_STUB_EVENT_FLAGS_H_
+
+#include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include "platform/NonCopyable.h"
+#include "rtos/mbed_rtos_types.h"
+
+namespace rtos {
+
+/** Host stand-in for rtos::EventFlags */
+class EventFlags : private mbed::NonCopyable<EventFlags> {
+public:
+
+	EventFlags() : lock(), changed(), flags(0) { }
+
+	uint32_t set(uint32_t set_flags) {
+		std::lock_guard<std::mutex> guard(lock);
+		flags |= set_flags;
+		changed.notify_all();
+		return flags;
+	}
+
+	uint32_t clear(uint32_t clear_flags = 0x7FFFFFFF) {
+		std::lock_guard<std::mutex> guard(lock);
+		uint32_t previous = flags;
+		flags &= ~clear_flags;
+		return previous;
+	}
+
+	uint32_t get(void) {
+		std::lock_guard<std::mutex> guard(lock);
+		return flags;
+	}
+
+	/** @retval the flags when the wait ended, 0 on a timeout (osFlagsErrorTimeout on target) */
+	uint32_t wait_any(uint32_t wait_flags = 0, uint32_t millisec = osWaitForever, bool clear = true) {
+		std::unique_lock<std::mutex> guard(lock);
+		if(millisec == osWaitForever) {
+			changed.wait(guard, [this, wait_flags]() { return (flags & wait_flags) != 0; });
+		} else if(!changed.wait_for(guard, std::chrono::milliseconds(millisec),
+				[this, wait_flags]() { return (flags & wait_flags) != 0; })) {
+			return 0;
+		}
+
+		uint32_t result = flags;
+		if(clear) {
+			flags &= ~wait_flags;
+		}
+		return result;
+	}
+
+private:
+
+	std::mutex lock;
+	std::condition_variable changed;
+	uint32_t flags;
+
+};
+
+} // namespace rtos
+
+#endif /* HOST_STUB_EVENT_FLAGS_H_ */
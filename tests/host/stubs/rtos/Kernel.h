@@ -0,0 +1,36 @@
+/*
+ * Kernel.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef HOST_STUB_KERNEL_H_
+#define HOST_STUB_KERNEL_H_
+
+#include <stdint.h>
+#include <chrono>
+
+namespace rtos {
+namespace Kernel {
+
+/** Simulated time added to the host clock, see host_advance_us() */
+inline uint64_t& host_offset_us(void) {
+	static uint64_t offset_us = 0;
+	return offset_us;
+}
+
+/** Let time pass without waiting for it (eg: a simulated slow flash erase) */
+inline void host_advance_us(uint64_t us) {
+	host_offset_us() += us;
+}
+
+inline uint64_t get_ms_count(void) {
+	uint64_t us = (uint64_t) std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	return (us + host_offset_us()) / 1000;
+}
+
+} // namespace Kernel
+} // namespace rtos
+
+#endif /* HOST_STUB_KERNEL_H_ */
@@ -0,0 +1,103 @@
+/*
+ * Mail.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef HOST_STUB_MAIL_H_
+#define HOST_STUB_MAIL_H_
+
+#include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <new>
+
+#include "platform/NonCopyable.h"
+#include "rtos/mbed_rtos_types.h"
+
+namespace rtos {
+
+/**
+ * Host stand-in for rtos::Mail: a pool of queue_sz messages and a queue
+ *
+ * calloc() value-initializes the message instead of zeroing it, so messages
+ * may hold the host's (non trivial) mbed::Callback.
+ */
+template<typename T, uint32_t queue_sz>
+class Mail : private mbed::NonCopyable<Mail<T, queue_sz> > {
+public:
+
+	Mail() : lock(), ready(), used(), queue() { }
+
+	T* alloc(uint32_t millisec = 0) {
+		return calloc(millisec);
+	}
+
+	T* calloc(uint32_t millisec = 0) {
+		std::lock_guard<std::mutex> guard(lock);
+		for(uint32_t i = 0; i < queue_sz; i++) {
+			if(!used[i]) {
+				used[i] = true;
+				return new (&pool[i * sizeof(T)]) T();
+			}
+		}
+		return NULL;
+	}
+
+	osStatus put(T* mptr) {
+		std::lock_guard<std::mutex> guard(lock);
+		queue.push_back(mptr);
+		ready.notify_one();
+		return osOK;
+	}
+
+	osEvent get(uint32_t millisec = osWaitForever) {
+		osEvent evt;
+		evt.value.p = NULL;
+
+		std::unique_lock<std::mutex> guard(lock);
+		if(millisec == osWaitForever) {
+			ready.wait(guard, [this]() { return !queue.empty(); });
+		} else if(!ready.wait_for(guard, std::chrono::milliseconds(millisec),
+				[this]() { return !queue.empty(); })) {
+			evt.status = osEventTimeout;
+			return evt;
+		}
+
+		evt.status = osEventMail;
+		evt.value.p = queue.front();
+		queue.pop_front();
+		return evt;
+	}
+
+	osStatus free(T* mptr) {
+		std::lock_guard<std::mutex> guard(lock);
+		uint32_t i = (uint32_t) (((unsigned char*) mptr - pool) / sizeof(T));
+		if(i >= queue_sz || !used[i]) {
+			return osErrorParameter;
+		}
+		mptr->~T();
+		used[i] = false;
+		return osOK;
+	}
+
+	bool empty(void) {
+		std::lock_guard<std::mutex> guard(lock);
+		return queue.empty();
+	}
+
+private:
+
+	std::mutex lock;
+	std::condition_variable ready;
+	bool used[queue_sz];
+	std::deque<T*> queue;
+	alignas(T) unsigned char pool[queue_sz * sizeof(T)];
+
+};
+
+} // namespace rtos
+
+#endif /* HOST_STUB_MAIL_H_ */
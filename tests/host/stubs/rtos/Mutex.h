@@ -0,0 +1,44 @@
+/*
+ * Mutex.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef HOST_STUB_MUTEX_H_
+#define HOST_STUB_MUTEX_H_
+
+#include <mutex>
+
+#include "platform/NonCopyable.h"
+
+namespace rtos {
+
+/** Host stand-in for rtos::Mutex, recursive like the RTX one */
+class Mutex : private mbed::NonCopyable<Mutex> {
+public:
+
+	Mutex() : mutex() { }
+
+	Mutex(const char* name) : mutex() { }
+
+	void lock(void) {
+		mutex.lock();
+	}
+
+	bool trylock(void) {
+		return mutex.try_lock();
+	}
+
+	void unlock(void) {
+		mutex.unlock();
+	}
+
+private:
+
+	std::recursive_mutex mutex;
+
+};
+
+} // namespace rtos
+
+#endif /* HOST_STUB_MUTEX_H_ */
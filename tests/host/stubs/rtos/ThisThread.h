@@ -0,0 +1,28 @@
+/*
+ * ThisThread.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef HOST_STUB_THIS_THREAD_H_
+#define HOST_STUB_THIS_THREAD_H_
+
+#include <stdint.h>
+#include <chrono>
+#include <thread>
+
+namespace rtos {
+namespace ThisThread {
+
+inline void sleep_for(uint32_t millisec) {
+	std::this_thread::sleep_for(std::chrono::milliseconds(millisec));
+}
+
+inline void yield(void) {
+	std::this_thread::yield();
+}
+
+} // namespace ThisThread
+} // namespace rtos
+
+#endif /* HOST_STUB_THIS_THREAD_H_ */
@@ -0,0 +1,41 @@
+/*
+ * Thread.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef HOST_STUB_THREAD_H_
+#define HOST_STUB_THREAD_H_
+
+#include <stdint.h>
+#include <thread>
+
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+#include "rtos/mbed_rtos_types.h"
+
+namespace rtos {
+
+/**
+ * Host stand-in for rtos::Thread
+ *
+ * Priority and stack are ignored. The application's threads never return,
+ * so started threads are detached: objects they use have to outlive the
+ * test process (allocate them and never free them).
+ */
+class Thread : private mbed::NonCopyable<Thread> {
+public:
+
+	Thread(osPriority priority = osPriorityNormal, uint32_t stack_size = 0,
+			unsigned char* stack_mem = NULL, const char* name = NULL) { }
+
+	osStatus start(mbed::Callback<void()> task) {
+		std::thread(task).detach();
+		return osOK;
+	}
+
+};
+
+} // namespace rtos
+
+#endif /* HOST_STUB_THREAD_H_ */
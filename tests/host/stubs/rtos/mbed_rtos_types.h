@@ -0,0 +1,45 @@
+/*
+ * mbed_rtos_types.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef HOST_STUB_MBED_RTOS_TYPES_H_
+#define HOST_STUB_MBED_RTOS_TYPES_H_
+
+#include <stdint.h>
+
+/** The CMSIS-RTOS types the application uses, values as in cmsis_os.h */
+
+#define osWaitForever 0xFFFFFFFFU
+
+typedef enum {
+	osPriorityIdle = 1,
+	osPriorityLow = 8,
+	osPriorityBelowNormal = 16,
+	osPriorityBelowNormal1 = 17,
+	osPriorityNormal = 24,
+	osPriorityAboveNormal = 32,
+	osPriorityHigh = 40,
+	osPriorityRealtime = 48
+} osPriority;
+
+typedef int32_t osStatus;
+
+#define osOK				0
+#define osEventMessage		0x10
+#define osEventMail			0x20
+#define osEventTimeout		0x40
+#define osErrorResource		-3
+#define osErrorParameter	-4
+
+typedef struct {
+	osStatus status;
+	union {
+		uint32_t v;
+		void* p;
+		int32_t signals;
+	} value;
+} osEvent;
+
+#endif /* HOST_STUB_MBED_RTOS_TYPES_H_ */
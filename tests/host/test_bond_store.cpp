@@ -0,0 +1,452 @@
+/*
+ * test_bond_store.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <string.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "FileSystem.h"
+#include "events/EventQueue.h"
+#include "platform/File.h"
+
+#include "bond_store.h"
+
+#define TEST_DIR			"bonds"
+
+/** Database written before the cut, and updates (commits) attempted after it */
+#define TEST_DB_SIZE		1024
+#define TEST_UPDATES		24
+
+/** Cut passed to run the workload with the power on throughout */
+#define NO_POWER_CUT		0xFFFFFFFF
+
+/** Written after the recovery, to check the store carries on */
+#define TEST_AFTER_UPDATE	1000
+
+namespace {
+
+/**
+ * In-memory filesystem with LittleFS' power-loss behaviour
+ *
+ * A file's changes are committed when it is closed or synced, a rename or a
+ * remove in one step, each of these counts as an operation. After
+ * cut_power_after(n) the n operations that follow go through and the next
+ * one fails with nothing committed, like every call after it until
+ * restore_power() (the reboot: files that were open are forgotten).
+ */
+class PowerCutFileSystem : public FileSystem {
+public:
+
+	PowerCutFileSystem() : operations(0), cut_at(0), cut_armed(false), powered(true) {
+		dirs.insert("");
+	}
+
+	virtual ~PowerCutFileSystem() {
+		forget_open_files();
+	}
+
+	void cut_power_after(uint32_t count) {
+		cut_at = operations + count;
+		cut_armed = true;
+	}
+
+	void restore_power(void) {
+		forget_open_files();
+		cut_armed = false;
+		powered = true;
+	}
+
+	bool is_powered(void) const {
+		return powered;
+	}
+
+	/** Committed operations so far */
+	uint32_t get_operations(void) const {
+		return operations;
+	}
+
+	/** Committed contents of a file, empty if there is none */
+	std::vector<uint8_t>& contents(const char* path) {
+		return files[path];
+	}
+
+	virtual int mount(BlockDevice* bd) {
+		return 0;
+	}
+
+	virtual int unmount(void) {
+		return 0;
+	}
+
+	virtual int remove(const char* path) {
+		if(!commit()) {
+			return -EIO;
+		}
+		return (files.erase(path) == 0 && dirs.erase(path) == 0)? -ENOENT : 0;
+	}
+
+	virtual int rename(const char* path, const char* newpath) {
+		std::map<std::string, std::vector<uint8_t> >::iterator it = files.find(path);
+		if(it == files.end()) {
+			return powered? -ENOENT : -EIO;
+		}
+		if(!commit()) {
+			return -EIO;
+		}
+		files[newpath] = it->second;
+		files.erase(path);
+		return 0;
+	}
+
+	virtual int stat(const char* path, struct stat* st) {
+		std::map<std::string, std::vector<uint8_t> >::iterator it = files.find(path);
+		if(it == files.end()) {
+			return -ENOENT;
+		}
+		memset(st, 0, sizeof(*st));
+		st->st_size = it->second.size();
+		st->st_mode = S_IFREG | 0666;
+		return 0;
+	}
+
+	virtual int mkdir(const char* path, mode_t mode) {
+		if(dirs.count(path) != 0) {
+			return -EEXIST;
+		}
+		if(!commit()) {
+			return -EIO;
+		}
+		dirs.insert(path);
+		return 0;
+	}
+
+protected:
+
+	typedef struct {
+		std::string path;
+		std::vector<uint8_t> data;	/** Staged until close or sync */
+		size_t position;
+		bool append;
+		bool modified;
+	} open_file_t;
+
+	virtual int file_open(fs_file_t* file, const char* path, int flags) {
+		if(!powered) {
+			return -EIO;
+		}
+		std::map<std::string, std::vector<uint8_t> >::iterator it = files.find(path);
+		if(it == files.end() && !(flags & O_CREAT)) {
+			return -ENOENT;
+		}
+
+		open_file_t* open = new open_file_t();
+		open->path = path;
+		open->position = 0;
+		open->append = (flags & O_APPEND) != 0;
+		open->modified = (it == files.end());
+		if(it != files.end()) {
+			open->data = it->second;
+		}
+		if(flags & O_TRUNC) {
+			open->modified = open->modified || !open->data.empty();
+			open->data.clear();
+		}
+
+		open_files.insert(open);
+		*file = open;
+		return 0;
+	}
+
+	virtual int file_close(fs_file_t file) {
+		open_file_t* open = (open_file_t*) file;
+		int err = file_sync(file);
+		open_files.erase(open);
+		delete open;
+		return err;
+	}
+
+	virtual ssize_t file_read(fs_file_t file, void* buffer, size_t len) {
+		open_file_t* open = (open_file_t*) file;
+		if(!powered) {
+			return -EIO;
+		}
+		if(open->position >= open->data.size()) {
+			return 0;
+		}
+		if(len > open->data.size() - open->position) {
+			len = open->data.size() - open->position;
+		}
+		memcpy(buffer, &open->data[open->position], len);
+		open->position += len;
+		return len;
+	}
+
+	virtual ssize_t file_write(fs_file_t file, const void* buffer, size_t len) {
+		open_file_t* open = (open_file_t*) file;
+		if(!powered) {
+			return -EIO;
+		}
+		if(open->append) {
+			open->position = open->data.size();
+		}
+		if(open->position + len > open->data.size()) {
+			open->data.resize(open->position + len);
+		}
+		memcpy(&open->data[open->position], buffer, len);
+		open->position += len;
+		open->modified = true;
+		return len;
+	}
+
+	virtual int file_sync(fs_file_t file) {
+		open_file_t* open = (open_file_t*) file;
+		if(!open->modified) {
+			return powered? 0 : -EIO;
+		}
+		if(!commit()) {
+			return -EIO;
+		}
+		files[open->path] = open->data;
+		open->modified = false;
+		return 0;
+	}
+
+	virtual off_t file_seek(fs_file_t file, off_t offset, int whence) {
+		open_file_t* open = (open_file_t*) file;
+		off_t target = offset;
+		if(whence == SEEK_CUR) {
+			target += open->position;
+		} else if(whence == SEEK_END) {
+			target += open->data.size();
+		}
+		if(target < 0) {
+			return -EINVAL;
+		}
+		open->position = (size_t) target;
+		return target;
+	}
+
+	virtual off_t file_size(fs_file_t file) {
+		return ((open_file_t*) file)->data.size();
+	}
+
+private:
+
+	/** Account for one operation, false once the power is gone */
+	bool commit(void) {
+		if(!powered) {
+			return false;
+		}
+		if(cut_armed && operations == cut_at) {
+			powered = false;
+			return false;
+		}
+		operations++;
+		return true;
+	}
+
+	void forget_open_files(void) {
+		for(std::set<open_file_t*>::iterator it = open_files.begin(); it != open_files.end(); ++it) {
+			delete *it;
+		}
+		open_files.clear();
+	}
+
+	std::map<std::string, std::vector<uint8_t> > files;
+	std::set<std::string> dirs;
+	std::set<open_file_t*> open_files;
+	uint32_t operations;
+	uint32_t cut_at;
+	bool cut_armed;
+	bool powered;
+
+};
+
+typedef std::vector<uint8_t> database_t;
+
+bool write_range(mbed::File& file, const database_t& db, size_t offset, size_t len) {
+	return file.seek(offset, SEEK_SET) == (off_t) offset &&
+			file.write(&db[offset], len) == (ssize_t) len;
+}
+
+/** Update k of the workload: a key, an address and a flag, written field by field like a pairing */
+bool apply_update(mbed::File& file, database_t& db, uint32_t k) {
+	size_t key = (k * 97) % (TEST_DB_SIZE - 16);
+	size_t address = (k * 211 + 500) % (TEST_DB_SIZE - 6);
+	size_t flag = (k * 13) % TEST_DB_SIZE;
+
+	for(size_t i = 0; i < 16; i++) {
+		db[key + i] = (uint8_t) (k * 31 + i);
+	}
+	for(size_t i = 0; i < 6; i++) {
+		db[address + i] = (uint8_t) ~(k + i);
+	}
+	db[flag] ^= 0x5A;
+
+	return write_range(file, db, key, 16) && write_range(file, db, address, 6) &&
+			write_range(file, db, flag, 1);
+}
+
+/** Attach a store and read the database back, empty if that fails */
+database_t read_back(FileSystem& fs, events::EventQueue& queue) {
+	BondStore store(queue);
+	database_t db;
+	if(store.attach(fs, TEST_DIR) != 0) {
+		return db;
+	}
+
+	mbed::File file;
+	if(file.open(&store, BOND_STORE_FILE_NAME, O_RDONLY) != 0) {
+		return db;
+	}
+	db.resize(store.get_size());
+	if(file.read(&db[0], db.size()) != (ssize_t) db.size()) {
+		db.clear();
+	}
+	file.close();
+	store.unmount();
+	return db;
+}
+
+/** Outcome of a run with the power cut after a number of operations */
+typedef struct {
+	bool cut_reached;
+	uint32_t committed;				/** Updates whose flush() completed before the cut */
+	std::vector<database_t> states;	/** Database after each update, [0] before the first */
+	uint32_t generation;
+} run_t;
+
+/** Commit a database, then TEST_UPDATES updates with the power lost after cut operations */
+run_t run_workload(PowerCutFileSystem& fs, events::EventQueue& queue, uint32_t cut) {
+	run_t run;
+	run.committed = 0;
+
+	BondStore* store = new BondStore(queue);
+	EXPECT_EQ(0, store->attach(fs, TEST_DIR));
+
+	mbed::File file;
+	EXPECT_EQ(0, file.open(store, BOND_STORE_FILE_NAME, O_RDWR | O_CREAT));
+	database_t db(TEST_DB_SIZE, 0xA5);
+	EXPECT_EQ((ssize_t) db.size(), file.write(&db[0], db.size()));
+	EXPECT_EQ(0, store->flush());
+	run.states.push_back(db);
+
+	if(cut != NO_POWER_CUT) {
+		fs.cut_power_after(cut);
+	}
+	for(uint32_t k = 0; k < TEST_UPDATES; k++) {
+		bool written = apply_update(file, db, k);
+		run.states.push_back(db);
+		if(!written || store->flush() != 0 || !fs.is_powered()) {
+			break;
+		}
+		run.committed = k + 1;
+	}
+
+	// Whatever the objects still write on the way out is lost with the power
+	run.cut_reached = !fs.is_powered();
+	run.generation = store->get_generation();
+	file.close();
+	delete store;
+	return run;
+}
+
+} // namespace
+
+TEST(BondStore, CommitsSurviveARemount) {
+	PowerCutFileSystem fs;
+	// Never dispatched, every commit is a flush() or a close() here
+	events::EventQueue queue;
+
+	run_t run = run_workload(fs, queue, NO_POWER_CUT);
+	ASSERT_FALSE(run.cut_reached);
+	EXPECT_EQ((uint32_t) TEST_UPDATES, run.committed);
+	// The journal was folded into a new image along the way
+	EXPECT_GT(run.generation, 1u);
+
+	EXPECT_EQ(run.states.back(), read_back(fs, queue));
+}
+
+TEST(BondStore, PowerCutLeavesACommittedState) {
+	uint32_t cuts = 0;
+	uint32_t new_state = 0;
+	uint32_t old_state = 0;
+
+	for(uint32_t cut = 0; ; cut++) {
+		PowerCutFileSystem& fs = *new PowerCutFileSystem();
+		events::EventQueue queue;
+
+		run_t run = run_workload(fs, queue, cut);
+		if(!run.cut_reached) {
+			// Every operation of the workload was hit once
+			delete &fs;
+			break;
+		}
+		cuts++;
+
+		// Reboot
+		fs.restore_power();
+		database_t recovered = read_back(fs, queue);
+		if(recovered == run.states[run.committed]) {
+			old_state++;
+		} else if(run.committed < TEST_UPDATES && recovered == run.states[run.committed + 1]) {
+			new_state++;
+		} else {
+			ADD_FAILURE() << "power cut after " << cut << " operations (" << run.committed <<
+					" commits) not recovered";
+			delete &fs;
+			continue;
+		}
+
+		// The recovered store keeps committing (no torn record left in front of new ones)
+		BondStore store(queue);
+		ASSERT_EQ(0, store.attach(fs, TEST_DIR));
+		mbed::File after;
+		ASSERT_EQ(0, after.open(&store, BOND_STORE_FILE_NAME, O_RDWR));
+		EXPECT_TRUE(apply_update(after, recovered, TEST_AFTER_UPDATE));
+		EXPECT_EQ(0, after.close());
+		store.unmount();
+		EXPECT_EQ(recovered, read_back(fs, queue)) << "after the cut at " << cut;
+
+		delete &fs;
+	}
+
+	printf("bonds: %lu power cuts, %lu recovered the commit in progress, %lu the previous one\n",
+			(unsigned long) cuts, (unsigned long) new_state, (unsigned long) old_state);
+	EXPECT_GT(cuts, (uint32_t) TEST_UPDATES);
+	EXPECT_GT(old_state, 0u);
+}
+
+TEST(BondStore, TornJournalRecordIsDropped) {
+	PowerCutFileSystem fs;
+	events::EventQueue queue;
+
+	run_t run = run_workload(fs, queue, NO_POWER_CUT);
+	ASSERT_FALSE(run.cut_reached);
+
+	// A filesystem without atomic appends could leave half a record behind
+	std::vector<uint8_t>& journal = fs.contents(TEST_DIR "/journal");
+	bond_store_record_t record;
+	memset(&record, 0, sizeof(record));
+	record.magic = BOND_STORE_RECORD_MAGIC;
+	record.length = 16;
+	record.size = TEST_DB_SIZE;
+	record.generation = run.generation;
+	const uint8_t* bytes = (const uint8_t*) &record;
+	journal.insert(journal.end(), bytes, bytes + sizeof(record));
+	journal.insert(journal.end(), 4, 0xEE);
+
+	BondStore store(queue);
+	ASSERT_EQ(0, store.attach(fs, TEST_DIR));
+	EXPECT_EQ(run.generation + 1, store.get_generation());
+	store.unmount();
+
+	EXPECT_EQ(run.states.back(), read_back(fs, queue));
+}
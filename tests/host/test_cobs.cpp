@@ -0,0 +1,219 @@
+/*
+ * test_cobs.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cobs.h"
+
+/** Written past the end of every output buffer, must survive */
+#define GUARD_BYTE	0xA5
+#define GUARD_LEN	16
+
+typedef std::vector<uint8_t> bytes_t;
+
+static bytes_t encode(const bytes_t& in) {
+	bytes_t out(COBS_MAX_ENCODED_SIZE(in.size()) + GUARD_LEN, GUARD_BYTE);
+	size_t len = cobs_encode(in.data(), in.size(), out.data());
+	EXPECT_LE(len, COBS_MAX_ENCODED_SIZE(in.size()));
+	for(size_t i = len; i < out.size(); i++) {
+		EXPECT_EQ(GUARD_BYTE, out[i]) << "encoder wrote past " << len;
+	}
+	out.resize(len);
+	return out;
+}
+
+/** Decodes into a buffer of exactly in.size() bytes, the documented bound */
+static bytes_t decode(const bytes_t& in, size_t* decoded_len = NULL) {
+	bytes_t out(in.size() + GUARD_LEN, GUARD_BYTE);
+	size_t len = cobs_decode(in.data(), in.size(), out.data());
+	EXPECT_LE(len, in.size());
+	for(size_t i = in.size(); i < out.size(); i++) {
+		EXPECT_EQ(GUARD_BYTE, out[i]) << "decoder wrote past " << in.size();
+	}
+	out.resize(len);
+	if(decoded_len != NULL) {
+		*decoded_len = len;
+	}
+	return out;
+}
+
+static bool has_zero(const bytes_t& data) {
+	for(size_t i = 0; i < data.size(); i++) {
+		if(data[i] == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/** Encodes and decodes, checking the encoding has no delimiter in it */
+static void round_trip(const bytes_t& in) {
+	bytes_t encoded = encode(in);
+	EXPECT_FALSE(has_zero(encoded));
+	EXPECT_EQ(in, decode(encoded));
+}
+
+static bytes_t filled(size_t len, uint8_t value) {
+	return bytes_t(len, value);
+}
+
+/** 1, 2, ... 255, 1, 2, ..., no zeros */
+static bytes_t nonzero_run(size_t len) {
+	bytes_t data(len);
+	for(size_t i = 0; i < len; i++) {
+		data[i] = (uint8_t) (i % 255 + 1);
+	}
+	return data;
+}
+
+TEST(Cobs, KnownEncodings) {
+	EXPECT_EQ(bytes_t({ 0x01, 0x01 }), encode(bytes_t({ 0x00 })));
+	EXPECT_EQ(bytes_t({ 0x01, 0x01, 0x01 }), encode(bytes_t({ 0x00, 0x00 })));
+	EXPECT_EQ(bytes_t({ 0x03, 0x11, 0x22, 0x02, 0x33 }), encode(bytes_t({ 0x11, 0x22, 0x00, 0x33 })));
+	EXPECT_EQ(bytes_t({ 0x02, 0x11, 0x01, 0x01, 0x01 }), encode(bytes_t({ 0x11, 0x00, 0x00, 0x00 })));
+}
+
+TEST(Cobs, EmptyFrame) {
+	bytes_t encoded = encode(bytes_t());
+	EXPECT_EQ(bytes_t({ 0x01 }), encoded);
+	EXPECT_TRUE(decode(encoded).empty());
+	EXPECT_TRUE(decode(bytes_t()).empty());
+}
+
+TEST(Cobs, ZeroRuns) {
+	for(size_t len = 1; len <= 600; len++) {
+		SCOPED_TRACE(len);
+		bytes_t zeros = filled(len, 0);
+		bytes_t encoded = encode(zeros);
+		// Every zero becomes a one byte block
+		EXPECT_EQ(filled(len + 1, 0x01), encoded);
+		EXPECT_EQ(zeros, decode(encoded));
+	}
+
+	// Zeros on either side of data and between it
+	round_trip(bytes_t({ 0x00, 0x00, 0x42 }));
+	round_trip(bytes_t({ 0x42, 0x00, 0x00 }));
+	round_trip(bytes_t({ 0x00, 0x42, 0x00, 0x00, 0x42, 0x00 }));
+}
+
+TEST(Cobs, BlockBoundary) {
+	// 254 non-zero bytes fill a block, the lengths around one and two blocks
+	const size_t lengths[] = { 253, 254, 255, 256, 507, 508, 509, 510 };
+	for(size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+		size_t len = lengths[i];
+		SCOPED_TRACE(len);
+		bytes_t data = nonzero_run(len);
+		bytes_t encoded = encode(data);
+		EXPECT_EQ(COBS_MAX_ENCODED_SIZE(len), encoded.size());
+		EXPECT_FALSE(has_zero(encoded));
+		EXPECT_EQ(data, decode(encoded));
+
+		// A zero right after the full block and right before it
+		bytes_t trailing = data;
+		trailing.push_back(0x00);
+		round_trip(trailing);
+
+		bytes_t leading = data;
+		leading.insert(leading.begin(), 0x00);
+		round_trip(leading);
+	}
+
+	bytes_t encoded = encode(nonzero_run(254));
+	EXPECT_EQ(0xFF, encoded[0]);
+	EXPECT_EQ(0x01, encoded[255]);
+}
+
+TEST(Cobs, RandomRoundTrips) {
+	srand(1);
+	for(int n = 0; n < 2000; n++) {
+		bytes_t data(rand() % 1024);
+		// Mostly zeros, mostly non-zero or anything
+		int density = rand() % 3;
+		for(size_t i = 0; i < data.size(); i++) {
+			int r = rand();
+			data[i] = (density == 0 && r % 4 != 0)? 0 :
+					(density == 1)? (uint8_t) (r % 255 + 1) : (uint8_t) r;
+		}
+		round_trip(data);
+	}
+}
+
+TEST(Cobs, MalformedFramesAreRejected) {
+	size_t len = 1;
+
+	// A delimiter inside the frame
+	decode(bytes_t({ 0x03, 0x11, 0x00, 0x22 }), &len);
+	EXPECT_EQ(0u, len);
+
+	// A code pointing past the end of the frame
+	decode(bytes_t({ 0x05, 0x11, 0x22 }), &len);
+	EXPECT_EQ(0u, len);
+
+	// Truncated in the second block
+	bytes_t encoded = encode(bytes_t({ 0x11, 0x00, 0x22, 0x33 }));
+	encoded.pop_back();
+	decode(encoded, &len);
+	EXPECT_EQ(0u, len);
+}
+
+TEST(Cobs, GarbageNeverOverrunsTheOutput) {
+	srand(2);
+	for(int n = 0; n < 20000; n++) {
+		bytes_t garbage(rand() % 600);
+		for(size_t i = 0; i < garbage.size(); i++) {
+			garbage[i] = (uint8_t) rand();
+		}
+		// Checks the bound and the guard bytes
+		decode(garbage);
+	}
+}
+
+TEST(Cobs, StreamResynchronizesAfterGarbage) {
+	srand(3);
+	std::vector<bytes_t> frames;
+	bytes_t stream;
+	for(int n = 0; n < 50; n++) {
+		bytes_t frame(rand() % 300);
+		for(size_t i = 0; i < frame.size(); i++) {
+			frame[i] = (uint8_t) rand();
+		}
+		frames.push_back(frame);
+
+		// Line noise, cut off by the delimiter of the frame before the next one
+		if(n % 5 == 4) {
+			for(int i = rand() % 40; i >= 0; i--) {
+				stream.push_back((uint8_t) (rand() | 1));
+			}
+			stream.push_back(0x00);
+		}
+
+		bytes_t encoded = encode(frame);
+		stream.insert(stream.end(), encoded.begin(), encoded.end());
+		stream.push_back(0x00);
+	}
+
+	// What a receiver does: decode whatever lies between two delimiters
+	size_t next = 0;
+	bytes_t pending;
+	for(size_t i = 0; i < stream.size(); i++) {
+		if(stream[i] != 0) {
+			pending.push_back(stream[i]);
+			continue;
+		}
+
+		size_t len = 0;
+		bytes_t decoded = decode(pending, &len);
+		pending.clear();
+		if(next < frames.size() && decoded == frames[next]) {
+			next++;
+		}
+	}
+	EXPECT_EQ(frames.size(), next);
+}
@@ -0,0 +1,153 @@
+/*
+ * test_fixed_point.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdint.h>
+#include <math.h>
+#include <limits>
+
+#include <gtest/gtest.h>
+
+#include "fixed_point.h"
+#include "gatt_units.h"
+
+/** Keeps the compiler from folding a conversion, so the runtime path is what runs */
+template<typename T>
+static T runtime(T value) {
+	volatile T copy = value;
+	return copy;
+}
+
+/** Reference rounding in double precision */
+static int64_t reference_round(double value) {
+	return (int64_t) ((value < 0)? -floor(-value + 0.5) : floor(value + 0.5));
+}
+
+TEST(FixedPoint, DivRoundsHalfAwayFromZero) {
+	EXPECT_EQ(0, fixed::div_round(runtime(4), 10));
+	EXPECT_EQ(1, fixed::div_round(runtime(5), 10));
+	EXPECT_EQ(1, fixed::div_round(runtime(14), 10));
+	EXPECT_EQ(0, fixed::div_round(runtime(-4), 10));
+	EXPECT_EQ(-1, fixed::div_round(runtime(-5), 10));
+	EXPECT_EQ(-1, fixed::div_round(runtime(-14), 10));
+	EXPECT_EQ(-2, fixed::div_round(runtime(-15), 10));
+	EXPECT_EQ(0, fixed::div_round(runtime(0), 7));
+
+	// Odd denominators have no exact half
+	EXPECT_EQ(1, fixed::div_round(runtime(2), 3));
+	EXPECT_EQ(-1, fixed::div_round(runtime(-2), 3));
+	EXPECT_EQ(0, fixed::div_round(runtime(-1), 3));
+}
+
+TEST(FixedPoint, DivMatchesReference) {
+	for(int64_t num = -2000; num <= 2000; num++) {
+		for(int64_t den = 1; den <= 40; den++) {
+			ASSERT_EQ(reference_round((double) num / (double) den), fixed::div_round(num, den))
+					<< num << " / " << den;
+		}
+	}
+}
+
+TEST(FixedPoint, SaturatesToTheType) {
+	EXPECT_EQ(INT16_MAX, fixed::saturate<int16_t>(runtime<int64_t>(40000)));
+	EXPECT_EQ(INT16_MIN, fixed::saturate<int16_t>(runtime<int64_t>(-40000)));
+	EXPECT_EQ(-123, fixed::saturate<int16_t>(runtime<int64_t>(-123)));
+	EXPECT_EQ(0, fixed::saturate<uint16_t>(runtime<int64_t>(-1)));
+	EXPECT_EQ(UINT16_MAX, fixed::saturate<uint16_t>(runtime<int64_t>(65536)));
+	EXPECT_EQ(UINT32_MAX, fixed::saturate<uint32_t>(runtime<int64_t>(INT64_MAX)));
+	EXPECT_EQ(0u, fixed::saturate<uint32_t>(runtime<int64_t>(INT64_MIN)));
+
+	EXPECT_EQ(INT16_MIN, fixed::saturating_sub<int16_t>(runtime(-32700), 200));
+	EXPECT_EQ(INT16_MAX, fixed::saturating_sub<int16_t>(runtime(32700), -200));
+	EXPECT_EQ(-100, fixed::saturating_sub<int16_t>(runtime(100), 200));
+}
+
+TEST(FixedPoint, FloatRoundsHalfAwayFromZero) {
+	EXPECT_EQ(0, fixed::round_clamp(runtime(0.0f), -100, 100));
+	EXPECT_EQ(0, fixed::round_clamp(runtime(-0.0f), -100, 100));
+	EXPECT_EQ(1, fixed::round_clamp(runtime(0.5f), -100, 100));
+	EXPECT_EQ(-1, fixed::round_clamp(runtime(-0.5f), -100, 100));
+	EXPECT_EQ(3, fixed::round_clamp(runtime(2.5f), -100, 100));
+	EXPECT_EQ(-3, fixed::round_clamp(runtime(-2.5f), -100, 100));
+	EXPECT_EQ(2, fixed::round_clamp(runtime(2.4999998f), -100, 100));
+	EXPECT_EQ(-2, fixed::round_clamp(runtime(-2.4999998f), -100, 100));
+
+	// The float just below one half, adding 0.5f to it rounds up to 1.0f
+	float below_half = nextafterf(0.5f, 0.0f);
+	EXPECT_EQ(0, fixed::round_clamp(runtime(below_half), -100, 100));
+	EXPECT_EQ(0, fixed::round_clamp(runtime(-below_half), -100, 100));
+}
+
+TEST(FixedPoint, FloatMatchesReference) {
+	// Every float from -2^14 to 2^14 with a few bits of fraction
+	for(int32_t i = -(1 << 18); i <= (1 << 18); i++) {
+		float value = (float) i / 16.0f;
+		ASSERT_EQ(reference_round(value), fixed::round_clamp(value, INT32_MIN, INT32_MAX)) << value;
+	}
+
+	// Neighbours of the halves, where float rounding goes wrong
+	for(int32_t i = -1000; i <= 1000; i++) {
+		float half = (float) i + 0.5f;
+		float below = nextafterf(half, -INFINITY);
+		float above = nextafterf(half, INFINITY);
+		ASSERT_EQ(reference_round(below), fixed::round_clamp(below, INT32_MIN, INT32_MAX)) << below;
+		ASSERT_EQ(reference_round(above), fixed::round_clamp(above, INT32_MIN, INT32_MAX)) << above;
+	}
+}
+
+TEST(FixedPoint, FloatClampsNonFiniteValues) {
+	EXPECT_EQ(100, fixed::round_clamp(runtime(INFINITY), -100, 100));
+	EXPECT_EQ(-100, fixed::round_clamp(runtime(-INFINITY), -100, 100));
+	EXPECT_EQ(0, fixed::round_clamp(runtime(NAN), -100, 100));
+	// NaN maps to 0 and then into the range
+	EXPECT_EQ(5, fixed::round_clamp(runtime(NAN), 5, 10));
+
+	EXPECT_EQ(100, fixed::round_clamp(runtime(1e30f), -100, 100));
+	EXPECT_EQ(-100, fixed::round_clamp(runtime(-1e30f), -100, 100));
+
+	// The largest float below 2^32 still fits a uint32_t
+	EXPECT_EQ(4294967040LL, fixed::round_clamp(runtime(4294967040.0f), 0, UINT32_MAX));
+	EXPECT_EQ((int64_t) UINT32_MAX, fixed::round_clamp(runtime(4294967296.0f), 0, UINT32_MAX));
+}
+
+TEST(FixedPoint, ScaleAppliesOffsetAndRange) {
+	typedef fixed::Scale<int16_t, 1, 4, -10, -50, 50> Quarter;
+	EXPECT_EQ(-10, Quarter::from_int(runtime(1)));
+	EXPECT_EQ(-9, Quarter::from_int(runtime(2)));
+	EXPECT_EQ(-11, Quarter::from_int(runtime(-2)));
+	EXPECT_EQ(50, Quarter::from_int(runtime(1000)));
+	EXPECT_EQ(-50, Quarter::from_int(runtime(-1000)));
+	EXPECT_EQ(-9, Quarter::from_float(runtime(2.0f)));
+	EXPECT_EQ(-11, Quarter::from_float(runtime(-2.0f)));
+
+	// 64-bit intermediates, in * Num overflows 32 bits
+	typedef fixed::Scale<uint32_t, 1000000, 1000> Large;
+	EXPECT_EQ(4000000000u, Large::from_int(runtime<int64_t>(4000000)));
+	EXPECT_EQ(UINT32_MAX, Large::from_int(runtime<int64_t>(5000000)));
+}
+
+TEST(FixedPoint, GattEncodings) {
+	EXPECT_EQ(2346, TemperatureFromCelsius::from_float(runtime(23.456f)));
+	EXPECT_EQ(-1, TemperatureFromCelsius::from_float(runtime(-0.005f)));
+	EXPECT_EQ(-2735, TemperatureFromCelsius::from_float(runtime(-27.345f)));
+	EXPECT_EQ(INT16_MIN, TemperatureFromCelsius::from_float(runtime(-400.0f)));
+	EXPECT_EQ(-1235, TemperatureFromMilliCelsius::from_int(runtime(-12345)));
+	EXPECT_EQ(-1234, TemperatureFromMilliCelsius::from_int(runtime(-12344)));
+
+	EXPECT_EQ(0, HumidityFromPercent::from_float(runtime(-0.4f)));
+	EXPECT_EQ(10000, HumidityFromPercent::from_float(runtime(100.004f)));
+	EXPECT_EQ(0, HumidityFromMilliPercent::from_int(runtime(-3000)));
+
+	EXPECT_EQ(0u, PressureFromPascal::from_float(runtime(-1.0f)));
+	EXPECT_EQ(UINT32_MAX, PressureFromPascal::from_float(runtime(1e12f)));
+	EXPECT_EQ(0, IaqScore::from_float(runtime(NAN)));
+	EXPECT_EQ(3, IaqAccuracy::from_int(runtime(7)));
+	EXPECT_EQ(GATT_DISTANCE_OUT_OF_RANGE, DistanceFromMillimeter::from_int(runtime(70000)));
+
+	EXPECT_EQ(INT16_MIN, MilliGFromG::from_float(runtime(-40.0f)));
+	EXPECT_EQ(INT16_MAX, MilliGFromG::from_float(runtime(40.0f)));
+	EXPECT_EQ(-20000, DeciDpsFromDps::from_float(runtime(-2000.04f)));
+	EXPECT_EQ(0, MilliGMagnitudeFromG::from_float(runtime(-0.1f)));
+}
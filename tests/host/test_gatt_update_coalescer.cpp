@@ -0,0 +1,83 @@
+/*
+ * test_gatt_update_coalescer.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <string.h>
+#include <vector>
+
+#include "gatt_update_coalescer.h"
+
+namespace {
+
+std::vector<sensor_sample_t> published;
+
+void publish(const sensor_sample_t& sample) {
+	published.push_back(sample);
+}
+
+sensor_sample_t make_sample(uint16_t sequence, int32_t value) {
+	sensor_sample_t sample;
+	memset(&sample, 0, sizeof(sample));
+	sample.channel = SENSOR_CHANNEL_BME680_TEMP;
+	sample.sequence = sequence;
+	sample.value.i32 = value;
+	return sample;
+}
+
+class GattUpdateCoalescerTest : public ::testing::Test {
+protected:
+	GattUpdateCoalescerTest() : coalescer(publish) {
+		published.clear();
+		sensor_value_t deadband;
+		deadband.i32 = 10;
+		coalescer.set_deadband(SENSOR_CHANNEL_BME680_TEMP, deadband);
+	}
+
+	GattUpdateCoalescer coalescer;
+};
+
+} // namespace
+
+TEST_F(GattUpdateCoalescerTest, DeadbandSkipsAreCounted) {
+	EXPECT_TRUE(coalescer.update(make_sample(0, 0)));
+	coalescer.flush();
+	EXPECT_FALSE(coalescer.update(make_sample(1, 5)));
+	EXPECT_FALSE(coalescer.update(make_sample(2, 5)));
+	EXPECT_TRUE(coalescer.update(make_sample(3, 50)));
+	coalescer.flush();
+
+	ASSERT_EQ(2u, published.size());
+	EXPECT_EQ(0, published[0].skipped);
+	EXPECT_EQ(3, published[1].sequence);
+	EXPECT_EQ(2, published[1].skipped);
+}
+
+TEST_F(GattUpdateCoalescerTest, OverwrittenSamplesAreCounted) {
+	EXPECT_TRUE(coalescer.update(make_sample(0, 0)));
+	EXPECT_FALSE(coalescer.update(make_sample(1, 5)));
+	EXPECT_TRUE(coalescer.update(make_sample(2, 50)));
+	EXPECT_TRUE(coalescer.update(make_sample(3, 100)));
+	coalescer.flush();
+
+	// 0 and 2 were overwritten, 1 suppressed
+	ASSERT_EQ(1u, published.size());
+	EXPECT_EQ(3, published[0].sequence);
+	EXPECT_EQ(3, published[0].skipped);
+}
+
+TEST_F(GattUpdateCoalescerTest, SkipCountSaturates) {
+	EXPECT_TRUE(coalescer.update(make_sample(0, 0)));
+	coalescer.flush();
+	for(uint16_t n = 1; n < 1000; n++) {
+		coalescer.update(make_sample(n, 0));
+	}
+	EXPECT_TRUE(coalescer.update(make_sample(1000, 50)));
+	coalescer.flush();
+
+	ASSERT_EQ(2u, published.size());
+	EXPECT_EQ(SENSOR_SAMPLE_MAX_SKIPPED, published[1].skipped);
+}
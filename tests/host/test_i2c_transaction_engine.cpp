@@ -0,0 +1,270 @@
+/*
+ * test_i2c_transaction_engine.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "i2c_transaction_engine.h"
+
+/** Longest a test waits for the bus thread */
+#define WAIT_MS 2000
+
+/**
+ * Fake bus: answers reads with address + register + offset, fails the
+ * addresses it is told to NACK and can be held to let transactions queue up
+ */
+class FakeI2CBus : public I2CBus {
+public:
+
+	typedef struct {
+		int address;
+		std::vector<uint8_t> tx;
+		size_t rx_len;
+	} transfer_t;
+
+	FakeI2CBus() : nack_address(-1), held(false), locked(0) { }
+
+	virtual void lock(void) {
+		std::lock_guard<std::mutex> guard(mutex);
+		locked++;
+	}
+
+	virtual void unlock(void) {
+		std::lock_guard<std::mutex> guard(mutex);
+		locked--;
+	}
+
+	virtual int transfer(int address, const uint8_t* tx, size_t tx_len,
+			uint8_t* rx, size_t rx_len) {
+		std::unique_lock<std::mutex> guard(mutex);
+		EXPECT_EQ(1, locked);
+		released.wait(guard, [this]() { return !held; });
+
+		transfer_t t = { address, std::vector<uint8_t>(tx, tx + tx_len), rx_len };
+		transfers.push_back(t);
+		changed.notify_all();
+
+		if(address == nack_address) {
+			return -1;
+		}
+		for(size_t i = 0; i < rx_len; i++) {
+			rx[i] = (uint8_t) (address + ((tx_len != 0)? tx[0] : 0) + i);
+		}
+		return 0;
+	}
+
+	void hold(bool hold) {
+		std::lock_guard<std::mutex> guard(mutex);
+		held = hold;
+		released.notify_all();
+	}
+
+	bool wait_for_transfers(size_t count) {
+		std::unique_lock<std::mutex> guard(mutex);
+		return changed.wait_for(guard, std::chrono::milliseconds(WAIT_MS),
+				[this, count]() { return transfers.size() >= count; });
+	}
+
+	std::vector<transfer_t> get_transfers(void) {
+		std::lock_guard<std::mutex> guard(mutex);
+		return transfers;
+	}
+
+	int nack_address;
+
+private:
+
+	std::mutex mutex;
+	std::condition_variable released;
+	std::condition_variable changed;
+	bool held;
+	int locked;
+	std::vector<transfer_t> transfers;
+
+};
+
+/** Completions received on the test thread */
+static std::vector<i2c_transaction_result_t> results;
+static std::thread::id completion_thread;
+
+static void on_complete(i2c_transaction_result_t result) {
+	results.push_back(result);
+	completion_thread = std::this_thread::get_id();
+}
+
+class I2CTransactionEngineTest : public ::testing::Test {
+protected:
+
+	// The bus thread never returns, the engine and what it uses outlive the test
+	I2CTransactionEngineTest() : bus(*new FakeI2CBus()), engine(*new I2CTransactionEngine(bus)),
+		queue(*new events::EventQueue()) {
+		results.clear();
+		engine.start();
+	}
+
+	/** Dispatch the queue until count completions arrived */
+	bool wait_for_results(size_t count, events::EventQueue& q) {
+		for(int ms = 0; ms < WAIT_MS && results.size() < count; ms++) {
+			q.dispatch(1);
+		}
+		return results.size() >= count;
+	}
+
+	bool wait_for_results(size_t count) {
+		return wait_for_results(count, queue);
+	}
+
+	FakeI2CBus& bus;
+	I2CTransactionEngine& engine;
+	events::EventQueue& queue;
+
+};
+
+TEST_F(I2CTransactionEngineTest, ReadCompletesOnTheSubmittersQueue) {
+	uint8_t rx[4] = { 0 };
+	ASSERT_TRUE(engine.read_registers(0xD4, 0x28, rx, sizeof(rx), &queue, on_complete));
+
+	ASSERT_TRUE(wait_for_results(1));
+	EXPECT_EQ(std::this_thread::get_id(), completion_thread);
+
+	const i2c_transaction_result_t& result = results[0];
+	EXPECT_EQ(0, result.status);
+	EXPECT_EQ(0xD4, result.address);
+	EXPECT_EQ(rx, result.rx);
+	EXPECT_EQ(sizeof(rx), result.rx_len);
+	for(size_t i = 0; i < sizeof(rx); i++) {
+		EXPECT_EQ((uint8_t) (0xD4 + 0x28 + i), rx[i]);
+	}
+
+	std::vector<FakeI2CBus::transfer_t> transfers = bus.get_transfers();
+	ASSERT_EQ(1u, transfers.size());
+	EXPECT_EQ(std::vector<uint8_t>(1, 0x28), transfers[0].tx);
+	EXPECT_TRUE(engine.is_idle());
+}
+
+TEST_F(I2CTransactionEngineTest, TransactionsRunInSubmissionOrder) {
+	uint8_t rx[3][2];
+	bus.hold(true);
+	for(int i = 0; i < 3; i++) {
+		ASSERT_TRUE(engine.read_registers(0x10 + 2*i, i, rx[i], sizeof(rx[i]), &queue, on_complete));
+	}
+	ASSERT_TRUE(engine.write_register(0x40, 0x0F, 0xA5, &queue, on_complete));
+	EXPECT_FALSE(engine.is_idle());
+	bus.hold(false);
+
+	ASSERT_TRUE(wait_for_results(4));
+	std::vector<FakeI2CBus::transfer_t> transfers = bus.get_transfers();
+	ASSERT_EQ(4u, transfers.size());
+	for(int i = 0; i < 3; i++) {
+		EXPECT_EQ(0x10 + 2*i, transfers[i].address);
+		EXPECT_EQ(0x10 + 2*i, results[i].address);
+	}
+
+	const uint8_t write[] = { 0x0F, 0xA5 };
+	EXPECT_EQ(std::vector<uint8_t>(write, write + 2), transfers[3].tx);
+	EXPECT_EQ(0u, transfers[3].rx_len);
+}
+
+TEST_F(I2CTransactionEngineTest, BusErrorsAreReportedAndCounted) {
+	uint8_t rx[2];
+	bus.nack_address = 0x52;
+	ASSERT_TRUE(engine.read_registers(0x52, 0x00, rx, sizeof(rx), &queue, on_complete));
+	ASSERT_TRUE(engine.read_registers(0x54, 0x00, rx, sizeof(rx), &queue, on_complete));
+
+	ASSERT_TRUE(wait_for_results(2));
+	EXPECT_NE(0, results[0].status);
+	EXPECT_EQ(0, results[1].status);
+
+	I2CTransactionEngine::stats_t stats = engine.get_stats();
+	EXPECT_EQ(2u, stats.completed);
+	EXPECT_EQ(1u, stats.errors);
+}
+
+TEST_F(I2CTransactionEngineTest, InvalidSubmissionsAreRefused) {
+	uint8_t tx[I2C_ENGINE_MAX_TX_LEN + 1] = { 0 };
+	EXPECT_FALSE(engine.submit(0x10, tx, sizeof(tx), NULL, 0, &queue, on_complete));
+	EXPECT_FALSE(engine.submit(0x10, tx, 1, NULL, 4, &queue, on_complete));
+	EXPECT_TRUE(engine.is_idle());
+}
+
+TEST_F(I2CTransactionEngineTest, FullQueueRejectsSubmissions) {
+	bus.hold(true);
+	for(int i = 0; i < I2C_ENGINE_QUEUE_DEPTH; i++) {
+		ASSERT_TRUE(engine.write_register(0x20, (uint8_t) i, 0, &queue, on_complete));
+	}
+	EXPECT_FALSE(engine.write_register(0x20, 0xFF, 0, &queue, on_complete));
+	EXPECT_EQ(1u, engine.get_stats().rejected);
+	bus.hold(false);
+
+	ASSERT_TRUE(wait_for_results(I2C_ENGINE_QUEUE_DEPTH));
+	EXPECT_EQ((uint32_t) I2C_ENGINE_QUEUE_DEPTH, engine.get_stats().completed);
+
+	engine.reset_stats();
+	EXPECT_EQ(0u, engine.get_stats().rejected);
+	EXPECT_EQ(0u, engine.get_stats().completed);
+}
+
+TEST_F(I2CTransactionEngineTest, CompletionWithoutQueueRunsOnTheBusThread) {
+	std::mutex mutex;
+	std::condition_variable done;
+	std::thread::id thread;
+	bool called = false;
+
+	ASSERT_TRUE(engine.write_register(0x30, 0x01, 0x02, NULL,
+			i2c_completion_cb_t([&](i2c_transaction_result_t result) {
+		std::lock_guard<std::mutex> guard(mutex);
+		thread = std::this_thread::get_id();
+		called = true;
+		done.notify_all();
+	})));
+
+	std::unique_lock<std::mutex> guard(mutex);
+	ASSERT_TRUE(done.wait_for(guard, std::chrono::milliseconds(WAIT_MS), [&]() { return called; }));
+	EXPECT_NE(std::this_thread::get_id(), thread);
+}
+
+TEST_F(I2CTransactionEngineTest, CompletionIsRetriedWhileTheQueueIsFull) {
+	// Room for a single event, taken
+	events::EventQueue& tiny = *new events::EventQueue(EVENTS_EVENT_SIZE);
+	int placeholder_runs = 0;
+	ASSERT_NE(0, tiny.call([&]() { placeholder_runs++; }));
+
+	uint8_t rx[2];
+	ASSERT_TRUE(engine.read_registers(0x60, 0x00, rx, sizeof(rx), &tiny, on_complete));
+	ASSERT_TRUE(bus.wait_for_transfers(1));
+
+	// Making room lets the next retry through
+	tiny.dispatch(0);
+	EXPECT_EQ(1, placeholder_runs);
+	ASSERT_TRUE(wait_for_results(1, tiny));
+	EXPECT_EQ(0, results[0].status);
+	EXPECT_EQ(0u, engine.get_stats().lost_completions);
+}
+
+TEST_F(I2CTransactionEngineTest, CompletionIsCountedWhenTheQueueStaysFull) {
+	events::EventQueue& tiny = *new events::EventQueue(EVENTS_EVENT_SIZE);
+	ASSERT_NE(0, tiny.call([]() { }));
+
+	uint8_t rx[2];
+	ASSERT_TRUE(engine.read_registers(0x62, 0x00, rx, sizeof(rx), &tiny, on_complete));
+
+	for(int ms = 0; ms < WAIT_MS && engine.get_stats().lost_completions == 0; ms++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	EXPECT_EQ(1u, engine.get_stats().lost_completions);
+
+	// The engine carries on
+	ASSERT_TRUE(engine.read_registers(0x64, 0x00, rx, sizeof(rx), &queue, on_complete));
+	ASSERT_TRUE(wait_for_results(1));
+	EXPECT_EQ(0x64, results[0].address);
+}
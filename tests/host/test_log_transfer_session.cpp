@@ -0,0 +1,177 @@
+/*
+ * test_log_transfer_session.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <string.h>
+#include <vector>
+
+#include "HeapBlockDevice.h"
+#include "rtos/ThisThread.h"
+#include "log_transfer_session.h"
+#include "loopback_log_transport.h"
+
+#define TEST_BD_SIZE	(4 * SENSOR_LOG_SEGMENT_SIZE)
+
+namespace {
+
+sensor_sample_t make_sample(uint32_t n) {
+	sensor_sample_t sample;
+	memset(&sample, 0, sizeof(sample));
+	sample.channel = SENSOR_CHANNEL_BME680_TEMP;
+	sample.sequence = (uint16_t) n;
+	sample.time_ms = n;
+	return sample;
+}
+
+void append_all(SensorLog& log, uint32_t first, uint32_t count) {
+	for(uint32_t n = first; n < first + count; n++) {
+		while(!log.append(make_sample(n))) {
+			rtos::ThisThread::sleep_for(1);
+		}
+	}
+}
+
+/** Client side: receives in order, acknowledges every packet */
+class TransferTest : public ::testing::Test {
+protected:
+
+	TransferTest() :
+		bd(*new HeapBlockDevice(TEST_BD_SIZE, 1, 1, SENSOR_LOG_SEGMENT_SIZE)),
+		log(*new SensorLog(bd)), transport(), session(log, transport), now_ms(0),
+		end_type(0) { }
+
+	virtual void SetUp() {
+		ASSERT_EQ(0, log.init());
+	}
+
+	void start(uint32_t sequence, uint16_t record, uint8_t window) {
+		uint8_t command[8] = { LOG_TRANSFER_CMD_START };
+		memcpy(&command[1], &sequence, 4);
+		memcpy(&command[5], &record, 2);
+		command[7] = window;
+		stream.clear();
+		end_type = 0;
+		session.handle_command(command, sizeof(command), now_ms);
+	}
+
+	/** Take what was sent and acknowledge it, true once the stream ended */
+	bool receive(void) {
+		LoopbackLogTransport<LOG_TRANSFER_MAX_WINDOW>::packet_t packet;
+		bool any = false;
+		uint16_t last = 0;
+		while(transport.receive(packet)) {
+			any = true;
+			memcpy(&last, &packet.data[1], 2);
+			if(packet.data[0] == LOG_TRANSFER_PACKET_DATA) {
+				stream.insert(stream.end(), &packet.data[LOG_TRANSFER_PACKET_HEADER_SIZE],
+						&packet.data[packet.len]);
+			} else {
+				end_type = packet.data[0];
+				memcpy(end_payload, &packet.data[LOG_TRANSFER_PACKET_HEADER_SIZE],
+						packet.len - LOG_TRANSFER_PACKET_HEADER_SIZE);
+			}
+		}
+		if(any) {
+			uint8_t ack[3] = { LOG_TRANSFER_CMD_ACK };
+			memcpy(&ack[1], &last, 2);
+			session.handle_command(ack, sizeof(ack), now_ms);
+		}
+		return end_type != 0;
+	}
+
+	/** Run the transfer to its end, ticking while the session waits for the writer */
+	void run(void) {
+		for(int i = 0; i < 1000 && !receive(); i++) {
+			rtos::ThisThread::sleep_for(1);
+			now_ms += 1;
+			session.tick(now_ms);
+		}
+	}
+
+	/** Records in the stream, by block header */
+	uint32_t count_records(void) const {
+		uint32_t records = 0;
+		size_t offset = 0;
+		while(offset + LOG_TRANSFER_BLOCK_HEADER_SIZE <= stream.size()) {
+			uint16_t count;
+			memcpy(&count, &stream[offset + 10], 2);
+			records += count;
+			offset += LOG_TRANSFER_BLOCK_HEADER_SIZE + count * sizeof(sensor_log_record_t);
+		}
+		return records;
+	}
+
+	HeapBlockDevice& bd;
+	SensorLog& log;
+	LoopbackLogTransport<LOG_TRANSFER_MAX_WINDOW> transport;
+	LogTransferSession session;
+	uint32_t now_ms;
+
+	std::vector<uint8_t> stream;
+	uint8_t end_type;
+	uint8_t end_payload[LOG_TRANSFER_MAX_PACKET_SIZE];
+
+};
+
+} // namespace
+
+TEST_F(TransferTest, StartDoesNotSync) {
+	append_all(log, 0, SENSOR_LOG_RECORDS_PER_SEGMENT + 10);
+	log.sync();
+	append_all(log, 0, 10);
+
+	// The window ends well before the tail, it stays in RAM
+	start(0, 0, 4);
+	EXPECT_TRUE(log.has_unsynced());
+
+	run();
+	EXPECT_EQ(LOG_TRANSFER_PACKET_END, end_type);
+	EXPECT_EQ(SENSOR_LOG_RECORDS_PER_SEGMENT + 20u, count_records());
+	EXPECT_FALSE(log.has_unsynced());
+}
+
+TEST_F(TransferTest, CaughtUpClientGetsTheTail) {
+	append_all(log, 0, SENSOR_LOG_RECORDS_PER_SEGMENT);
+	log.sync();
+	append_all(log, 0, 5);
+
+	start(1, 0, 16);
+	run();
+	EXPECT_EQ(LOG_TRANSFER_PACKET_END, end_type);
+	EXPECT_EQ(5u, count_records());
+}
+
+TEST_F(TransferTest, EmptyLogEnds) {
+	start(0, 0, 16);
+	run();
+	EXPECT_EQ(LOG_TRANSFER_PACKET_END, end_type);
+	EXPECT_EQ(0u, count_records());
+}
+
+TEST_F(TransferTest, RecycledSegmentBreaksOff) {
+	append_all(log, 0, 3 * SENSOR_LOG_RECORDS_PER_SEGMENT);
+	log.sync();
+
+	// Part of segment 0, then the log wraps over it
+	start(0, 0, 2);
+	ASSERT_FALSE(receive());
+	append_all(log, 0, 3 * SENSOR_LOG_RECORDS_PER_SEGMENT);
+	log.sync();
+
+	run();
+	ASSERT_EQ(LOG_TRANSFER_PACKET_RESUME, end_type);
+	uint32_t sequence;
+	memcpy(&sequence, end_payload, 4);
+	EXPECT_EQ(0u, sequence);
+	EXPECT_EQ(1u, session.get_transfers_broken());
+
+	// Resuming skips to the oldest segment left
+	start(0, 1, 16);
+	run();
+	EXPECT_EQ(LOG_TRANSFER_PACKET_END, end_type);
+	EXPECT_EQ(3u * SENSOR_LOG_RECORDS_PER_SEGMENT, count_records());
+}
@@ -0,0 +1,172 @@
+/*
+ * test_sensor_log.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <string.h>
+
+#include "HeapBlockDevice.h"
+#include "rtos/ThisThread.h"
+#include "fault_injection_block_device.h"
+#include "sensor_log.h"
+
+/** Four segments, byte granularity so single bytes can be corrupted */
+#define TEST_BD_SIZE	(4 * SENSOR_LOG_SEGMENT_SIZE)
+
+namespace {
+
+sensor_sample_t make_sample(uint32_t n) {
+	sensor_sample_t sample;
+	memset(&sample, 0, sizeof(sample));
+	sample.channel = SENSOR_CHANNEL_BME680_TEMP;
+	sample.sequence = (uint16_t) n;
+	sample.time_ms = 1000 + n;
+	sample.value.i32 = (int32_t) n;
+	return sample;
+}
+
+/** Append count samples, waiting for the writer when both buffers are full */
+void append_all(SensorLog& log, uint32_t first, uint32_t count) {
+	for(uint32_t n = first; n < first + count; n++) {
+		while(!log.append(make_sample(n))) {
+			rtos::ThisThread::sleep_for(1);
+		}
+	}
+}
+
+/** Clear the bits of one record byte of a segment, the CRC no longer matches */
+void corrupt_record(BlockDevice& bd, const SensorLog& log, uint32_t sequence) {
+	bd_addr_t addr = (bd_addr_t) (sequence % log.get_segment_count()) * SENSOR_LOG_SEGMENT_SIZE +
+			SENSOR_LOG_HEADER_SIZE;
+	uint8_t zero = 0;
+	ASSERT_EQ(0, bd.program(&zero, addr, 1));
+}
+
+/** The writer thread is detached, logs live until the process exits */
+SensorLog& make_log(BlockDevice& bd) {
+	SensorLog& log = *new SensorLog(bd);
+	EXPECT_EQ(0, log.init());
+	return log;
+}
+
+} // namespace
+
+TEST(SensorLog, RecordsReadBack) {
+	HeapBlockDevice& bd = *new HeapBlockDevice(TEST_BD_SIZE, 1, 1, SENSOR_LOG_SEGMENT_SIZE);
+	SensorLog& log = make_log(bd);
+
+	append_all(log, 0, SENSOR_LOG_RECORDS_PER_SEGMENT + 10);
+	log.sync();
+
+	uint32_t oldest, newest;
+	ASSERT_TRUE(log.get_sequence_range(oldest, newest));
+	EXPECT_EQ(0u, oldest);
+	EXPECT_EQ(1u, newest);
+
+	sensor_log_record_t records[10];
+	ASSERT_EQ(10, log.read_records(1, 0, records, 10));
+	for(int i = 0; i < 10; i++) {
+		EXPECT_EQ(SENSOR_LOG_RECORDS_PER_SEGMENT + i, records[i].sequence);
+	}
+
+	sensor_log_record_t raw;
+	ASSERT_EQ(0, log.read_record_data(0, 5 * sizeof(raw), &raw, sizeof(raw)));
+	EXPECT_EQ(1005u, raw.time_ms);
+}
+
+TEST(SensorLog, RateLimitedReadingsAreCounted) {
+	HeapBlockDevice& bd = *new HeapBlockDevice(TEST_BD_SIZE, 1, 1, SENSOR_LOG_SEGMENT_SIZE);
+	SensorLog& log = make_log(bd);
+	log.set_min_interval(SENSOR_CHANNEL_BME680_TEMP, 10);
+
+	// One reading per ms, every tenth is logged (append() is false for the rest)
+	for(uint32_t n = 0; n < 40; n++) {
+		EXPECT_EQ(n % 10 == 0, log.append(make_sample(n)));
+	}
+	sensor_sample_t held_back = make_sample(40);
+	held_back.skipped = 5;
+	ASSERT_TRUE(log.append(held_back));
+	log.sync();
+
+	sensor_log_record_t records[5];
+	ASSERT_EQ(5, log.read_records(0, 0, records, 5));
+	EXPECT_EQ(0, records[0].skipped);
+	EXPECT_EQ(10, records[1].sequence);
+	EXPECT_EQ(9, records[1].skipped);
+	EXPECT_EQ(30, records[3].sequence);
+	EXPECT_EQ(40, records[4].sequence);
+	EXPECT_EQ(9 + 5, records[4].skipped);
+}
+
+TEST(SensorLog, CorruptSegmentIsNotRead) {
+	HeapBlockDevice& bd = *new HeapBlockDevice(TEST_BD_SIZE, 1, 1, SENSOR_LOG_SEGMENT_SIZE);
+	SensorLog& log = make_log(bd);
+
+	append_all(log, 0, 3 * SENSOR_LOG_RECORDS_PER_SEGMENT);
+	log.sync();
+	corrupt_record(bd, log, 1);
+
+	sensor_log_segment_header_t header;
+	sensor_log_record_t record;
+	EXPECT_FALSE(log.read_header(1, header));
+	EXPECT_LT(log.read_records(1, 0, &record, 1), 0);
+	EXPECT_NE(0, log.read_record_data(1, 0, &record, sizeof(record)));
+
+	// Its neighbours are fine
+	EXPECT_TRUE(log.read_header(0, header));
+	EXPECT_EQ(1, log.read_records(2, 0, &record, 1));
+}
+
+TEST(SensorLog, MountSkipsCorruptSegments) {
+	HeapBlockDevice& bd = *new HeapBlockDevice(TEST_BD_SIZE, 1, 1, SENSOR_LOG_SEGMENT_SIZE);
+	SensorLog& first_boot = make_log(bd);
+	append_all(first_boot, 0, 3 * SENSOR_LOG_RECORDS_PER_SEGMENT);
+	first_boot.sync();
+
+	// Corrupt the oldest and the newest segment
+	corrupt_record(bd, first_boot, 0);
+	corrupt_record(bd, first_boot, 2);
+
+	SensorLog& log = make_log(bd);
+	EXPECT_EQ(2u, log.get_corrupt_segments());
+
+	uint32_t oldest, newest;
+	ASSERT_TRUE(log.get_sequence_range(oldest, newest));
+	EXPECT_EQ(1u, oldest);
+	EXPECT_EQ(1u, newest);
+	EXPECT_EQ(1u, log.get_boot_count());
+}
+
+TEST(SensorLog, TornSegmentIsDroppedAtMount) {
+	HeapBlockDevice& heap = *new HeapBlockDevice(TEST_BD_SIZE, 1, 1, SENSOR_LOG_SEGMENT_SIZE);
+	FaultInjectionBlockDevice& bd = *new FaultInjectionBlockDevice(heap);
+	SensorLog& first_boot = make_log(bd);
+
+	append_all(first_boot, 0, SENSOR_LOG_RECORDS_PER_SEGMENT);
+	first_boot.sync();
+
+	// The erase goes through, power is lost halfway through the program: the
+	// header is on flash, the second half of the records is not
+	bd.cut_power_after(1);
+	append_all(first_boot, SENSOR_LOG_RECORDS_PER_SEGMENT, SENSOR_LOG_RECORDS_PER_SEGMENT);
+	first_boot.sync();
+	EXPECT_EQ(1u, first_boot.get_write_errors());
+
+	bd.restore_power();
+	SensorLog& log = make_log(bd);
+	EXPECT_EQ(1u, log.get_corrupt_segments());
+
+	uint32_t oldest, newest;
+	ASSERT_TRUE(log.get_sequence_range(oldest, newest));
+	EXPECT_EQ(0u, newest);
+
+	// The torn segment's slot is written again
+	append_all(log, 0, 1);
+	log.sync();
+	sensor_log_segment_header_t header;
+	ASSERT_TRUE(log.read_header(1, header));
+	EXPECT_EQ(1u, header.boot_count);
+}
@@ -0,0 +1,224 @@
+/*
+ * test_sensor_power_manager.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdint.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "sensor_power_manager.h"
+
+#define MS(x) ((uint64_t) (x) * 1000)
+
+/** Domain timing of the tests, short because power_up() really sleeps for power_up_ms */
+#define POWER_UP_MS		10
+#define REINIT_MS		5
+#define SETTLE_MS		80
+
+/** Switch-on to first release: power-up, settling, wake margin and re-init */
+#define LEAD_MS			(POWER_UP_MS + SETTLE_MS + SENSOR_POWER_WAKE_MARGIN_MS + REINIT_MS)
+
+/** Time only moves when a test moves it */
+class SimulatedClock : public SchedulerClock {
+public:
+
+	SimulatedClock() : now(0) { }
+
+	virtual uint64_t now_us(void) {
+		return now;
+	}
+
+	virtual void sleep_until_us(uint64_t wakeup_us) {
+		if(wakeup_us != UINT64_MAX && wakeup_us > now) {
+			now = wakeup_us;
+		}
+	}
+
+	virtual void wake(void) {
+	}
+
+	uint64_t now;
+
+};
+
+/** Never transfers anything, the engine is not started so a queued transaction keeps it busy */
+class IdleI2CBus : public I2CBus {
+public:
+
+	virtual void lock(void) { }
+
+	virtual void unlock(void) { }
+
+	virtual int transfer(int address, const uint8_t* tx, size_t tx_len,
+			uint8_t* rx, size_t rx_len) {
+		return -1;
+	}
+
+};
+
+/** One sensor task at 500 ms + n x 1000 ms on a domain that is on at start */
+class PowerManagerTest : public ::testing::Test {
+protected:
+
+	PowerManagerTest() : scheduler(clock), bus(), engine(bus), enable(0, 1),
+			power(scheduler, clock, engine, enable), reinit_ms(0), reinits(0) {
+		sensor = scheduler.add_task("sensor", 1000, 0, mbed::Callback<void()>([]() { }), 500);
+		EXPECT_NE(SensorScheduler::INVALID_TASK, sensor);
+		EXPECT_TRUE(power.add_task(sensor, true));
+
+		sensor_power_domain_t domain = { POWER_UP_MS, REINIT_MS, SETTLE_MS, 100, 1 };
+		power.set_domain(domain, mbed::Callback<bool()>([this]() { return reinit(); }));
+	}
+
+	/** Burns reinit_ms of simulated time, like a sensor driver talking to the devices */
+	bool reinit(void) {
+		reinits++;
+		clock.now += MS(reinit_ms);
+		return true;
+	}
+
+	/** What the scheduler's run_forever() does around one sleep */
+	uint64_t idle(uint64_t now_ms) {
+		clock.now = MS(now_ms);
+		return power.enter_idle(clock.now, scheduler.next_release_us());
+	}
+
+	void wake(uint64_t now_us) {
+		clock.now = now_us;
+		power.exit_idle(now_us);
+	}
+
+	SimulatedClock clock;
+	SensorScheduler scheduler;
+	IdleI2CBus bus;
+	I2CTransactionEngine engine;
+	mbed::DigitalOut enable;
+	SensorPowerManager power;
+	SensorScheduler::task_id_t sensor;
+	uint32_t reinit_ms;
+	int reinits;
+
+};
+
+TEST_F(PowerManagerTest, DomainStaysOnWithoutCycling) {
+	EXPECT_EQ(MS(500), idle(0));
+	EXPECT_EQ(1, enable.read());
+}
+
+TEST_F(PowerManagerTest, DomainIsSwitchedOffUntilItsLeadTime) {
+	power.set_domain_cycling(true);
+
+	EXPECT_EQ(MS(500 - LEAD_MS), idle(0));
+	EXPECT_EQ(0, enable.read());
+
+	// Woken early (eg: another event), stays off
+	wake(MS(500 - LEAD_MS) - 1);
+	EXPECT_EQ(0, enable.read());
+	EXPECT_EQ(0, reinits);
+
+	wake(MS(500 - LEAD_MS));
+	EXPECT_EQ(1, enable.read());
+	EXPECT_EQ(1, reinits);
+}
+
+TEST_F(PowerManagerTest, DomainStaysOnForACloseRelease) {
+	power.set_domain_cycling(true);
+
+	// Off for less than the minimum off time
+	EXPECT_EQ(MS(500), idle(500 - LEAD_MS - SENSOR_POWER_MIN_OFF_MS + 1));
+	EXPECT_EQ(1, enable.read());
+
+	EXPECT_EQ(MS(500 - LEAD_MS), idle(500 - LEAD_MS - SENSOR_POWER_MIN_OFF_MS));
+	EXPECT_EQ(0, enable.read());
+}
+
+TEST_F(PowerManagerTest, SlowReinitWakesEarlier) {
+	power.set_domain_cycling(true);
+	reinit_ms = REINIT_MS + 30;
+
+	idle(0);
+	wake(MS(500 - LEAD_MS));
+	ASSERT_EQ(1, enable.read());
+
+	clock.now = MS(500);
+	scheduler.run_pending();
+	EXPECT_EQ(MS(1500 - LEAD_MS - 30), idle(501));
+	EXPECT_EQ(0, enable.read());
+}
+
+TEST_F(PowerManagerTest, TaskNeedingPowerPinsTheDomain) {
+	power.set_domain_cycling(true);
+	power.set_power_cycle_ok(sensor, false);
+
+	EXPECT_EQ(MS(500), idle(0));
+	EXPECT_EQ(1, enable.read());
+
+	// Disabled, it no longer needs the domain
+	scheduler.set_active(sensor, false);
+	EXPECT_EQ(UINT64_MAX, idle(1));
+	EXPECT_EQ(0, enable.read());
+
+	// Enabled while the domain is off, it comes back on the next wake-up
+	scheduler.set_active(sensor, true);
+	wake(MS(2));
+	EXPECT_EQ(1, enable.read());
+}
+
+TEST_F(PowerManagerTest, QueuedTransferDelaysPowerDown) {
+	power.set_domain_cycling(true);
+
+	ASSERT_TRUE(engine.write_register(0x10, 0x20, 0x01));
+	EXPECT_EQ(MS(SENSOR_POWER_BUSY_RETRY_MS), idle(0));
+	EXPECT_EQ(1, enable.read());
+}
+
+TEST_F(PowerManagerTest, DeviceSleepsUntilItsWakeTime) {
+	std::vector<bool> modes;
+	SensorScheduler::task_id_t imu = scheduler.add_task("imu", 1000, 10,
+			mbed::Callback<void()>([]() { }), 200);
+	ASSERT_TRUE(power.add_device("imu", imu,
+			SensorPowerManager::low_power_cb_t([&modes](bool low_power) { modes.push_back(low_power); }),
+			50, 1000, 10));
+
+	const uint64_t wake_ms = 50 + SENSOR_POWER_WAKE_MARGIN_MS;
+	EXPECT_EQ(MS(200 - wake_ms), idle(0));
+	ASSERT_EQ(1u, modes.size());
+	EXPECT_TRUE(modes[0]);
+
+	wake(MS(200 - wake_ms) - 1);
+	EXPECT_EQ(1u, modes.size());
+
+	wake(MS(200 - wake_ms));
+	ASSERT_EQ(2u, modes.size());
+	EXPECT_FALSE(modes[1]);
+}
+
+TEST_F(PowerManagerTest, DeviceStaysAwakeForACloseRelease) {
+	std::vector<bool> modes;
+	SensorScheduler::task_id_t imu = scheduler.add_task("imu", 1000, 10,
+			mbed::Callback<void()>([]() { }), 200);
+	ASSERT_TRUE(power.add_device("imu", imu,
+			SensorPowerManager::low_power_cb_t([&modes](bool low_power) { modes.push_back(low_power); }),
+			50, 1000, 10));
+
+	EXPECT_EQ(MS(200), idle(200 - 50 - SENSOR_POWER_WAKE_MARGIN_MS - SENSOR_POWER_MIN_OFF_MS + 1));
+	EXPECT_TRUE(modes.empty());
+}
+
+TEST_F(PowerManagerTest, AcquireKeepsEverythingOn) {
+	power.set_domain_cycling(true);
+	idle(0);
+	ASSERT_EQ(0, enable.read());
+
+	power.acquire();
+	EXPECT_EQ(1, enable.read());
+	EXPECT_EQ(MS(500), idle(1));
+	EXPECT_EQ(1, enable.read());
+
+	power.release();
+	idle(2);
+	EXPECT_EQ(0, enable.read());
+}
@@ -0,0 +1,261 @@
+/*
+ * test_sensor_scheduler.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdint.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "sensor_scheduler.h"
+
+#define MS(x) ((uint64_t) (x) * 1000)
+
+/** Time only moves when a test or a task moves it */
+class SimulatedClock : public SchedulerClock {
+public:
+
+	SimulatedClock() : now(0), wakes(0) { }
+
+	virtual uint64_t now_us(void) {
+		return now;
+	}
+
+	virtual void sleep_until_us(uint64_t wakeup_us) {
+		if(wakeup_us != UINT64_MAX && wakeup_us > now) {
+			now = wakeup_us;
+		}
+	}
+
+	virtual void wake(void) {
+		wakes++;
+	}
+
+	void advance_ms(uint32_t ms) {
+		now += MS(ms);
+	}
+
+	uint64_t now;
+	int wakes;
+
+};
+
+/** Records the order tasks ran in, optionally burning simulated time */
+class SchedulerTest : public ::testing::Test {
+protected:
+
+	SchedulerTest() : scheduler(clock), runtime_ms(), on_run() { }
+
+	SensorScheduler::task_id_t add(const char* name, uint32_t period_ms, uint32_t deadline_ms,
+			uint32_t offset_ms = 0) {
+		SensorScheduler::task_id_t id = (SensorScheduler::task_id_t) runtime_ms.size();
+		runtime_ms.push_back(0);
+		on_run.push_back(mbed::Callback<void()>());
+		SensorScheduler::task_id_t added = scheduler.add_task(name, period_ms, deadline_ms,
+				mbed::Callback<void()>([this, id]() { run(id); }), offset_ms);
+		EXPECT_EQ(id, added);
+		return added;
+	}
+
+	void run(SensorScheduler::task_id_t id) {
+		order.push_back(id);
+		clock.advance_ms(runtime_ms[id]);
+		if(on_run[id]) {
+			on_run[id]();
+		}
+	}
+
+	/** What run_forever() does, until the given time */
+	void run_until_ms(uint32_t end_ms) {
+		while(true) {
+			scheduler.run_pending();
+			uint64_t next = scheduler.next_release_us();
+			if(next > MS(end_ms)) {
+				break;
+			}
+			clock.sleep_until_us(next);
+		}
+	}
+
+	SimulatedClock clock;
+	SensorScheduler scheduler;
+	std::vector<uint32_t> runtime_ms;
+	std::vector<mbed::Callback<void()> > on_run;
+	std::vector<SensorScheduler::task_id_t> order;
+
+};
+
+TEST_F(SchedulerTest, EarliestDeadlineRunsFirst) {
+	SensorScheduler::task_id_t slow = add("slow", 100, 0);
+	SensorScheduler::task_id_t urgent = add("urgent", 100, 10);
+	SensorScheduler::task_id_t medium = add("medium", 100, 30);
+
+	EXPECT_EQ(3, scheduler.run_pending());
+
+	std::vector<SensorScheduler::task_id_t> expected = { urgent, medium, slow };
+	EXPECT_EQ(expected, order);
+}
+
+TEST_F(SchedulerTest, LaterReleaseWithEarlierDeadlineWins) {
+	// Released at 0 with a deadline at 100, and at 5 with a deadline at 15
+	SensorScheduler::task_id_t early = add("early", 1000, 100);
+	SensorScheduler::task_id_t tight = add("tight", 1000, 10, 5);
+
+	clock.advance_ms(5);
+	scheduler.run_pending();
+
+	std::vector<SensorScheduler::task_id_t> expected = { tight, early };
+	EXPECT_EQ(expected, order);
+}
+
+TEST_F(SchedulerTest, ReleasesFollowThePeriod) {
+	SensorScheduler::task_id_t fast = add("fast", 10, 0);
+	SensorScheduler::task_id_t slow = add("slow", 25, 0, 5);
+
+	run_until_ms(100);
+
+	// 0, 10, ... 100 and 5, 30, 55, 80
+	EXPECT_EQ(11u, scheduler.get_stats(fast)->runs);
+	EXPECT_EQ(4u, scheduler.get_stats(slow)->runs);
+	EXPECT_EQ(0u, scheduler.get_stats(fast)->max_lateness_us);
+	EXPECT_EQ(0u, scheduler.get_stats(fast)->skipped_releases);
+	EXPECT_EQ(MS(110), scheduler.get_release_us(fast));
+	EXPECT_EQ(MS(105), scheduler.get_release_us(slow));
+}
+
+TEST_F(SchedulerTest, RunAgainInOverridesOneRelease) {
+	SensorScheduler::task_id_t id = add("fsm", 100, 0);
+	int runs = 0;
+	on_run[id] = [this, id, &runs]() {
+		// Come back after a settling time on the first run only
+		if(runs++ == 0) {
+			scheduler.run_again_in(id, 7);
+		}
+	};
+
+	scheduler.run_pending();
+	EXPECT_EQ(MS(7), scheduler.get_release_us(id));
+
+	run_until_ms(7);
+	EXPECT_EQ(2, runs);
+
+	// Back on the periodic schedule, not 7 ms + period
+	EXPECT_EQ(MS(100), scheduler.get_release_us(id));
+	EXPECT_EQ(0u, scheduler.get_stats(id)->skipped_releases);
+}
+
+TEST_F(SchedulerTest, ShorterPeriodPullsTheNextReleaseIn) {
+	SensorScheduler::task_id_t id = add("poll", 1000, 0);
+	scheduler.run_pending();
+	EXPECT_EQ(MS(1000), scheduler.get_release_us(id));
+
+	clock.advance_ms(50);
+	scheduler.set_period(id, 100);
+	EXPECT_EQ(100u, scheduler.get_period(id));
+	EXPECT_EQ(MS(100), scheduler.get_release_us(id));
+	EXPECT_EQ(1, clock.wakes);
+
+	run_until_ms(300);
+	EXPECT_EQ(4u, scheduler.get_stats(id)->runs);
+	EXPECT_EQ(MS(400), scheduler.get_release_us(id));
+}
+
+TEST_F(SchedulerTest, LongerPeriodStartsAfterTheNextRelease) {
+	SensorScheduler::task_id_t id = add("poll", 100, 0);
+	scheduler.run_pending();
+
+	scheduler.set_period(id, 500);
+	EXPECT_EQ(MS(100), scheduler.get_release_us(id));
+	EXPECT_EQ(0, clock.wakes);
+
+	run_until_ms(100);
+	EXPECT_EQ(MS(600), scheduler.get_release_us(id));
+}
+
+TEST_F(SchedulerTest, LateReleasesAreSkippedAndCounted) {
+	SensorScheduler::task_id_t id = add("poll", 10, 5);
+
+	// Starts 35 ms late: 10, 20 and 30 are gone, the next one is at 40
+	clock.advance_ms(35);
+	scheduler.run_pending();
+
+	const SensorScheduler::task_stats_t* stats = scheduler.get_stats(id);
+	EXPECT_EQ(1u, stats->runs);
+	EXPECT_EQ(3u, stats->skipped_releases);
+	EXPECT_EQ(MS(35), stats->max_lateness_us);
+	EXPECT_EQ(1u, stats->deadline_misses);
+	EXPECT_EQ(MS(40), scheduler.get_release_us(id));
+}
+
+TEST_F(SchedulerTest, OverrunningTaskSkipsReleasesOfTheNextRun) {
+	SensorScheduler::task_id_t hog = add("hog", 100, 0);
+	SensorScheduler::task_id_t poll = add("poll", 10, 0);
+	runtime_ms[hog] = 25;
+
+	// poll (deadline 10) goes before hog (deadline 100), which then holds
+	// the CPU until 25: the release at 10 runs 15 ms late, the one at 20 is dropped
+	run_until_ms(30);
+
+	const SensorScheduler::task_stats_t* stats = scheduler.get_stats(poll);
+	EXPECT_EQ(3u, stats->runs);
+	EXPECT_EQ(1u, stats->skipped_releases);
+	EXPECT_EQ(MS(15), stats->max_lateness_us);
+	EXPECT_EQ(1u, stats->deadline_misses);
+	EXPECT_EQ(MS(25), scheduler.get_stats(hog)->max_runtime_us);
+}
+
+TEST_F(SchedulerTest, TriggerReleasesNowAndRestartsThePeriod) {
+	SensorScheduler::task_id_t id = add("irq", 100, 0);
+	scheduler.run_pending();
+
+	clock.advance_ms(30);
+	scheduler.trigger(id);
+	EXPECT_EQ(1, clock.wakes);
+	EXPECT_EQ(MS(30), scheduler.next_release_us());
+
+	scheduler.run_pending();
+	EXPECT_EQ(MS(130), scheduler.get_release_us(id));
+	EXPECT_EQ(0u, scheduler.get_stats(id)->skipped_releases);
+}
+
+TEST_F(SchedulerTest, DisabledTasksAreNotReleased) {
+	SensorScheduler::task_id_t id = add("off", 10, 0);
+	scheduler.set_active(id, false);
+	EXPECT_EQ(UINT64_MAX, scheduler.get_release_us(id));
+	EXPECT_EQ(0, clock.wakes);
+
+	clock.advance_ms(50);
+	EXPECT_EQ(0, scheduler.run_pending());
+
+	// Triggers and one-shots are ignored while disabled
+	scheduler.trigger(id);
+	scheduler.run_again_in(id, 1);
+	EXPECT_EQ(0, scheduler.run_pending());
+
+	scheduler.set_active(id, true);
+	EXPECT_EQ(MS(50), scheduler.get_release_us(id));
+	EXPECT_EQ(1, clock.wakes);
+	EXPECT_EQ(1, scheduler.run_pending());
+	EXPECT_EQ(MS(60), scheduler.get_release_us(id));
+}
+
+TEST_F(SchedulerTest, TaskCanDisableItself) {
+	SensorScheduler::task_id_t id = add("once", 10, 0);
+	on_run[id] = [this, id]() { scheduler.set_active(id, false); };
+
+	run_until_ms(100);
+	EXPECT_EQ(1u, scheduler.get_stats(id)->runs);
+	EXPECT_EQ(UINT64_MAX, scheduler.next_release_us());
+}
+
+TEST_F(SchedulerTest, TaskTableIsBounded) {
+	for(int i = 0; i < SENSOR_SCHEDULER_MAX_TASKS; i++) {
+		add("task", 10, 0);
+	}
+	EXPECT_EQ(SensorScheduler::INVALID_TASK,
+			scheduler.add_task("full", 10, 0, mbed::Callback<void()>()));
+	EXPECT_EQ(SensorScheduler::INVALID_TASK,
+			scheduler.add_task("zero", 0, 0, mbed::Callback<void()>()));
+}
@@ -0,0 +1,163 @@
+/*
+ * test_spsc_ring.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "spsc_ring.h"
+
+/**
+ * Built with -fsanitize=thread (see CMakeLists.txt): a data race between
+ * the producer and the consumer fails the test even when the values
+ * happen to come out right.
+ */
+
+/** Elements pushed by the stress tests */
+#define STRESS_COUNT 2000000
+
+/** Larger than a word so a torn copy shows up as a mismatch */
+typedef struct {
+	uint32_t sequence;
+	uint32_t check[5];
+} element_t;
+
+static element_t make_element(uint32_t sequence) {
+	element_t e;
+	e.sequence = sequence;
+	for(int i = 0; i < 5; i++) {
+		e.check[i] = sequence * 2654435761u + i;
+	}
+	return e;
+}
+
+static bool is_intact(const element_t& e) {
+	for(int i = 0; i < 5; i++) {
+		if(e.check[i] != e.sequence * 2654435761u + i) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST(SpscRing, FifoOrderAndCapacity) {
+	SpscRing<element_t, 4> ring;
+	element_t e;
+
+	EXPECT_TRUE(ring.empty());
+	EXPECT_FALSE(ring.pop(e));
+
+	for(uint32_t i = 0; i < 4; i++) {
+		EXPECT_TRUE(ring.push(make_element(i)));
+	}
+	EXPECT_FALSE(ring.push(make_element(4)));
+	EXPECT_EQ(1u, ring.get_dropped());
+	EXPECT_EQ(4u, ring.size());
+
+	ASSERT_TRUE(ring.peek(e));
+	EXPECT_EQ(0u, e.sequence);
+	ring.discard();
+
+	for(uint32_t i = 1; i < 4; i++) {
+		ASSERT_TRUE(ring.pop(e));
+		EXPECT_EQ(i, e.sequence);
+	}
+	EXPECT_TRUE(ring.empty());
+}
+
+TEST(SpscRing, IndicesWrapAround) {
+	SpscRing<uint32_t, 2> ring;
+	uint32_t value;
+
+	// Many times round the buffer
+	for(uint32_t i = 0; i < 1000; i++) {
+		ASSERT_TRUE(ring.push(i));
+		ASSERT_TRUE(ring.pop(value));
+		EXPECT_EQ(i, value);
+	}
+	EXPECT_EQ(0u, ring.get_dropped());
+}
+
+/** One thread pushes a sequence, another pops it: nothing lost but the drops, nothing out of order */
+TEST(SpscRing, ConcurrentPushPop) {
+	static SpscRing<element_t, 16> ring;
+	std::atomic<bool> done(false);
+	uint32_t pushed = 0;
+
+	std::thread producer([&]() {
+		for(uint32_t i = 0; i < STRESS_COUNT; i++) {
+			if(ring.push(make_element(i))) {
+				pushed++;
+			}
+		}
+		done.store(true);
+	});
+
+	uint32_t popped = 0;
+	uint32_t last = 0;
+	bool first = true;
+	uint32_t dropped_seen = 0;
+	element_t e;
+	while(true) {
+		bool finished = done.load();
+		if(!ring.pop(e)) {
+			if(finished && ring.empty()) {
+				break;
+			}
+			// Read concurrently with the producer's updates, like the stats dump
+			dropped_seen = ring.get_dropped();
+			continue;
+		}
+
+		ASSERT_TRUE(is_intact(e)) << "element " << e.sequence << " torn";
+		if(!first) {
+			ASSERT_GT(e.sequence, last);
+		}
+		first = false;
+		last = e.sequence;
+		popped++;
+	}
+
+	producer.join();
+	EXPECT_EQ(pushed, popped);
+	EXPECT_EQ((uint32_t) STRESS_COUNT, pushed + ring.get_dropped());
+	EXPECT_LE(dropped_seen, ring.get_dropped());
+}
+
+/** Same with the peek()/discard() consumer used by the sample handoff */
+TEST(SpscRing, ConcurrentPeekDiscard) {
+	static SpscRing<element_t, 8> ring;
+	std::atomic<bool> done(false);
+
+	std::thread producer([&]() {
+		for(uint32_t i = 0; i < STRESS_COUNT; i++) {
+			// Retried until there is room, the consumer must see every element
+			while(!ring.push(make_element(i))) {
+				std::this_thread::yield();
+			}
+		}
+		done.store(true);
+	});
+
+	uint32_t expected = 0;
+	element_t e;
+	while(expected < STRESS_COUNT) {
+		if(!ring.peek(e)) {
+			std::this_thread::yield();
+			continue;
+		}
+		ASSERT_TRUE(is_intact(e));
+		ASSERT_EQ(expected, e.sequence);
+		ring.discard();
+		expected++;
+	}
+
+	producer.join();
+	EXPECT_TRUE(done.load());
+	EXPECT_TRUE(ring.empty());
+}
@@ -0,0 +1,93 @@
+/*
+ * test_startup_gate.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdint.h>
+
+#include <gtest/gtest.h>
+
+#include "startup_gate.h"
+
+/** The prerequisites BLEProcess gives the security manager */
+#define NEEDS_STACK		(1 << 0)
+#define NEEDS_STORAGE	(1 << 1)
+
+/** Counts the security manager set-ups */
+class StartupGateTest : public ::testing::Test {
+protected:
+
+	StartupGateTest() : runs(0), gate(mbed::Callback<void()>([this]() { runs++; })) {
+		gate.require(NEEDS_STACK);
+	}
+
+	int runs;
+	StartupGate gate;
+
+};
+
+TEST_F(StartupGateTest, OpensWithTheStackWithoutDeferral) {
+	EXPECT_FALSE(gate.is_open());
+	gate.satisfy(NEEDS_STACK);
+	EXPECT_EQ(1, runs);
+	EXPECT_TRUE(gate.is_open());
+
+	// A filesystem that comes up later changes nothing
+	gate.satisfy(NEEDS_STORAGE);
+	EXPECT_EQ(1, runs);
+}
+
+TEST_F(StartupGateTest, StorageBeforeStack) {
+	gate.require(NEEDS_STORAGE);
+
+	gate.satisfy(NEEDS_STORAGE);
+	EXPECT_EQ(0, runs);
+
+	gate.satisfy(NEEDS_STACK);
+	EXPECT_EQ(1, runs);
+}
+
+TEST_F(StartupGateTest, StackBeforeStorage) {
+	gate.require(NEEDS_STORAGE);
+
+	// Advertising starts, pairing waits for the filesystem
+	gate.satisfy(NEEDS_STACK);
+	EXPECT_EQ(0, runs);
+	EXPECT_FALSE(gate.is_open());
+
+	gate.satisfy(NEEDS_STORAGE);
+	EXPECT_EQ(1, runs);
+	EXPECT_TRUE(gate.is_open());
+}
+
+TEST_F(StartupGateTest, RunsOnlyOnce) {
+	gate.require(NEEDS_STORAGE);
+	gate.satisfy(NEEDS_STACK);
+	gate.satisfy(NEEDS_STORAGE);
+	gate.satisfy(NEEDS_STORAGE);
+	gate.satisfy(NEEDS_STACK);
+	EXPECT_EQ(1, runs);
+
+	// Too late to hold it back
+	gate.require(NEEDS_STORAGE);
+	EXPECT_TRUE(gate.is_open());
+	gate.satisfy(NEEDS_STORAGE);
+	EXPECT_EQ(1, runs);
+}
+
+TEST_F(StartupGateTest, StorageWithoutStackKeepsItClosed) {
+	// storage_ready() without defer_security_until_storage()
+	gate.satisfy(NEEDS_STORAGE);
+	EXPECT_EQ(0, runs);
+
+	gate.satisfy(NEEDS_STACK);
+	EXPECT_EQ(1, runs);
+}
+
+TEST(StartupGate, EmptyActionOpens) {
+	StartupGate gate((mbed::Callback<void()>()));
+	gate.require(NEEDS_STACK);
+	gate.satisfy(NEEDS_STACK);
+	EXPECT_TRUE(gate.is_open());
+}
@@ -0,0 +1,80 @@
+/*
+ * time_sync_service.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "time_sync_service.h"
+
+#include <stdio.h>
+
+#include "rtos/Kernel.h"
+
+static void put_u64(uint8_t* p, uint64_t value) {
+	for(int i = 0; i < 8; i++) {
+		p[i] = (uint8_t) (value >> (8 * i));
+	}
+}
+
+static uint64_t get_u64(const uint8_t* p) {
+	uint64_t value = 0;
+	for(int i = 7; i >= 0; i--) {
+		value = (value << 8) | p[i];
+	}
+	return value;
+}
+
+TimeSyncService::TimeSyncService() :
+	ble(NULL),
+	sync_cb(),
+	time_value(),
+	time_char(UUID(TIME_SYNC_CHAR_UUID), time_value, sizeof(time_value), sizeof(time_value),
+			GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ |
+			GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_WRITE, NULL, 0, false),
+	offset_ms(TIME_SYNC_UNSYNCED),
+	syncs(0) {
+	put_u64(&time_value[8], (uint64_t) offset_ms);
+	time_char.setReadAuthorizationCallback(this, &TimeSyncService::on_read);
+}
+
+void TimeSyncService::start(BLE& ble) {
+	this->ble = &ble;
+
+	GattCharacteristic* chars[] = { &time_char };
+	GattService service(UUID(TIME_SYNC_SERVICE_UUID), chars, sizeof(chars) / sizeof(chars[0]));
+
+	ble.gattServer().addService(service);
+	ble.gattServer().onDataWritten(this, &TimeSyncService::on_data_written);
+}
+
+void TimeSyncService::on_read(GattReadAuthCallbackParams* params) {
+	put_u64(&time_value[0], rtos::Kernel::get_ms_count());
+	put_u64(&time_value[8], (uint64_t) offset_ms);
+
+	params->data = time_value;
+	params->len = sizeof(time_value);
+	params->authorizationReply = AUTH_CALLBACK_REPLY_SUCCESS;
+}
+
+void TimeSyncService::on_data_written(const GattWriteCallbackParams* params) {
+	if(params->handle != time_char.getValueHandle()) {
+		return;
+	}
+
+	uint64_t now_ms = rtos::Kernel::get_ms_count();
+	if(params->len != TIME_SYNC_WRITE_SIZE) {
+		printf("time sync: ignoring a %u byte write\r\n", params->len);
+		return;
+	}
+
+	int64_t wall_ms = (int64_t) get_u64(params->data);
+	offset_ms = wall_ms - (int64_t) now_ms;
+	syncs++;
+
+	printf("time sync: device %lu ms is Unix %lu.%03lu s\r\n", (unsigned long) now_ms,
+			(unsigned long) (wall_ms / 1000), (unsigned long) (wall_ms % 1000));
+
+	if(sync_cb) {
+		sync_cb(now_ms, wall_ms);
+	}
+}
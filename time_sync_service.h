@@ -0,0 +1,94 @@
+/*
+ * time_sync_service.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef TIME_SYNC_SERVICE_H_
+#define TIME_SYNC_SERVICE_H_
+
+#include <stdint.h>
+
+#include "ble/BLE.h"
+#include "ble/GattServer.h"
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+#define TIME_SYNC_SERVICE_UUID		"00000016-8dd4-4087-a16a-04a7c8e01734"
+#define TIME_SYNC_CHAR_UUID			"00001016-8dd4-4087-a16a-04a7c8e01734"
+
+/**
+ * Read (all fields little endian), 16 bytes:
+ *
+ *   [0:7]   device monotonic time, uint64 ms since boot, taken when the read is served
+ *   [8:15]  wall clock offset, sint64 ms: Unix time = device time + offset,
+ *           TIME_SYNC_UNSYNCED until a host wrote the time this boot
+ *
+ * Write, 8 bytes:
+ *
+ *   [0:7]   host wall clock, sint64 ms since the Unix epoch
+ */
+#define TIME_SYNC_VALUE_SIZE		16
+#define TIME_SYNC_WRITE_SIZE		8
+#define TIME_SYNC_UNSYNCED			INT64_MIN
+
+/**
+ * Maps the device's monotonic clock to wall time
+ *
+ * Sample timestamps (see sensor_sample_t) count ms since boot. A host that
+ * only wants to convert what it receives reads the characteristic and
+ * takes the device time as the middle of the read's round trip. A host that
+ * writes its wall clock sets the offset for everyone: the device keeps it
+ * until the next reboot and reports every sync (eg: into the sensor log,
+ * so downloads can be converted later). The write lands half a connection
+ * interval or so after the host took the time, that is the error of the
+ * offset.
+ *
+ * All calls must come from the BLE event queue.
+ */
+class TimeSyncService : private mbed::NonCopyable<TimeSyncService> {
+public:
+
+	/** A host set the wall clock: device time (ms since boot) and the wall time (Unix ms) it maps to */
+	typedef mbed::Callback<void(uint64_t, int64_t)> sync_cb_t;
+
+	TimeSyncService();
+
+	void on_sync(sync_cb_t cb) {
+		sync_cb = cb;
+	}
+
+	void start(BLE& ble);
+
+	bool is_synced(void) const {
+		return offset_ms != TIME_SYNC_UNSYNCED;
+	}
+
+	/** Unix time in ms = device time + offset, TIME_SYNC_UNSYNCED before the first sync */
+	int64_t get_offset_ms(void) const {
+		return offset_ms;
+	}
+
+	uint32_t get_syncs(void) const {
+		return syncs;
+	}
+
+private:
+
+	/** Fill in the current device time before the value is sent */
+	void on_read(GattReadAuthCallbackParams* params);
+
+	void on_data_written(const GattWriteCallbackParams* params);
+
+	BLE* ble;
+	sync_cb_t sync_cb;
+
+	uint8_t time_value[TIME_SYNC_VALUE_SIZE];
+	GattCharacteristic time_char;
+
+	int64_t offset_ms;
+	uint32_t syncs;
+
+};
+
+#endif /* TIME_SYNC_SERVICE_H_ */
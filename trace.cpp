@@ -0,0 +1,130 @@
+/*
+ * trace.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "trace.h"
+
+#include <stdio.h>
+#include <atomic>
+
+#include "cmsis.h"
+#include "hal/us_ticker_api.h"
+
+static_assert(TRACE_BUFFER_SIZE != 0 && (TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) == 0,
+		"TRACE_BUFFER_SIZE must be a power of two");
+
+/** Cortex-M3 and up have a cycle counter in the DWT unit */
+#if defined(DWT_CTRL_CYCCNTENA_Msk)
+#define TRACE_USE_CYCLE_COUNTER 1
+#else
+#define TRACE_USE_CYCLE_COUNTER 0
+#endif
+
+typedef struct {
+	uint32_t timestamp;
+	uint8_t event;
+	uint8_t phase;
+	uint16_t arg;
+} trace_entry_t;
+
+static trace_entry_t entries[TRACE_BUFFER_SIZE];
+
+/** Total number of events recorded, the ring holds the last TRACE_BUFFER_SIZE */
+static std::atomic<uint32_t> head(0);
+
+static std::atomic<bool> enabled(false);
+
+static const char* const event_names[TRACE_EVENT_COUNT] = {
+	"poll",
+	"i2c_submit",
+	"i2c_transfer",
+	"ble_schedule",
+	"ble_process",
+	"ble_connect",
+	"ble_disconnect",
+	"sensor_power",
+};
+
+static inline uint32_t timestamp(void) {
+#if TRACE_USE_CYCLE_COUNTER
+	return DWT->CYCCNT;
+#else
+	return us_ticker_read();
+#endif
+}
+
+static uint32_t timestamp_hz(void) {
+#if TRACE_USE_CYCLE_COUNTER
+	return SystemCoreClock;
+#else
+	return 1000000;
+#endif
+}
+
+void trace_record(trace_event_t event, trace_phase_t phase, uint16_t arg) {
+	if(!enabled.load(std::memory_order_relaxed)) {
+		return;
+	}
+
+	uint32_t now = timestamp();
+	uint32_t index = head.fetch_add(1, std::memory_order_relaxed);
+
+	trace_entry_t& entry = entries[index & (TRACE_BUFFER_SIZE - 1)];
+	entry.timestamp = now;
+	entry.event = (uint8_t) event;
+	entry.phase = (uint8_t) phase;
+	entry.arg = arg;
+}
+
+void trace_init(void) {
+#if TRACE_USE_CYCLE_COUNTER
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+	enabled.store(true);
+}
+
+void trace_set_enabled(bool enable) {
+	enabled.store(enable);
+}
+
+void trace_clear(void) {
+	bool was_enabled = enabled.exchange(false);
+	head.store(0);
+	enabled.store(was_enabled);
+}
+
+const char* trace_event_name(trace_event_t event) {
+	if(event >= TRACE_EVENT_COUNT) {
+		return "?";
+	}
+	return event_names[event];
+}
+
+void trace_dump(void) {
+	static const char phase_names[] = { 'I', 'B', 'E' };
+
+	// Writers that already passed the enabled check may still land one event
+	bool was_enabled = enabled.exchange(false);
+
+	uint32_t end = head.load();
+	uint32_t count = (end > TRACE_BUFFER_SIZE)? TRACE_BUFFER_SIZE : end;
+
+	printf("trace: begin %lu %lu %lu\r\n", (unsigned long) count,
+			(unsigned long) (end - count), (unsigned long) timestamp_hz());
+
+	for(uint32_t i = end - count; i != end; i++) {
+		const trace_entry_t& entry = entries[i & (TRACE_BUFFER_SIZE - 1)];
+		printf("T %08lx %s %c %lx\r\n", (unsigned long) entry.timestamp,
+				trace_event_name((trace_event_t) entry.event),
+				(entry.phase <= TRACE_PHASE_END)? phase_names[entry.phase] : '?',
+				(unsigned long) entry.arg);
+	}
+
+	printf("trace: end\r\n");
+
+	enabled.store(was_enabled);
+}
@@ -0,0 +1,90 @@
+/*
+ * trace.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdint.h>
+
+/**
+ * Set to 0 to compile every TRACE_* macro out
+ */
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+/** Number of events kept, must be a power of two (8 bytes each) */
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE 512
+#endif
+
+/** What happened, the meaning of the argument depends on the event */
+typedef enum {
+	TRACE_EVENT_POLL = 0,			/** Scheduler task ran, arg is the task id */
+	TRACE_EVENT_I2C_SUBMIT,			/** Transaction queued, arg is the 8-bit address */
+	TRACE_EVENT_I2C_TRANSFER,		/** Transaction on the bus, arg is the 8-bit address */
+	TRACE_EVENT_BLE_SCHEDULE,		/** Stack asked for its events to be processed */
+	TRACE_EVENT_BLE_PROCESS,		/** Stack events processed on the event queue */
+	TRACE_EVENT_BLE_CONNECT,		/** Connection handler, arg is the connection handle */
+	TRACE_EVENT_BLE_DISCONNECT,		/** Disconnection handler, arg is the connection handle */
+	TRACE_EVENT_SENSOR_POWER,		/** Sensor domain power-up and re-init, instant when switched off */
+	TRACE_EVENT_COUNT
+} trace_event_t;
+
+typedef enum {
+	TRACE_PHASE_INSTANT = 0,
+	TRACE_PHASE_BEGIN,
+	TRACE_PHASE_END
+} trace_phase_t;
+
+/**
+ * Record an event in the trace ring
+ *
+ * Lock-free and allocation-free, callable from any thread or interrupt. Events
+ * are stamped with the DWT cycle counter where the core has one, or the
+ * microsecond ticker otherwise. The oldest events are overwritten once the
+ * ring is full.
+ */
+void trace_record(trace_event_t event, trace_phase_t phase, uint16_t arg);
+
+/** Enable the cycle counter and start recording */
+void trace_init(void);
+
+/** Pause or resume recording, events recorded while paused are discarded */
+void trace_set_enabled(bool enabled);
+
+/** Forget every recorded event */
+void trace_clear(void);
+
+/**
+ * Print the recorded events, oldest first
+ *
+ * Recording is paused while the ring is printed. The output is parsed by
+ * scripts/trace_decode.py:
+ *
+ *   trace: begin <events> <overwritten> <timestamp Hz>
+ *   T <timestamp> <event> <B|E|I> <arg>
+ *   ...
+ *   trace: end
+ *
+ * Timestamps and arguments are hexadecimal, timestamps wrap at 32 bits.
+ */
+void trace_dump(void);
+
+/** Name of an event as printed by trace_dump() */
+const char* trace_event_name(trace_event_t event);
+
+#if TRACE_ENABLED
+#define TRACE_BEGIN(event, arg)		trace_record((event), TRACE_PHASE_BEGIN, (uint16_t) (arg))
+#define TRACE_END(event, arg)		trace_record((event), TRACE_PHASE_END, (uint16_t) (arg))
+#define TRACE_INSTANT(event, arg)	trace_record((event), TRACE_PHASE_INSTANT, (uint16_t) (arg))
+#else
+#define TRACE_BEGIN(event, arg)
+#define TRACE_END(event, arg)
+#define TRACE_INSTANT(event, arg)
+#endif
+
+#endif /* TRACE_H_ */
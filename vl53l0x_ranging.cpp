@@ -0,0 +1,380 @@
+/*
+ * vl53l0x_ranging.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "vl53l0x_ranging.h"
+
+/** VL53L0X registers */
+#define VL53L0X_SYSRANGE_START				0x00
+#define VL53L0X_SYSTEM_SEQUENCE_CONFIG		0x01
+#define VL53L0X_SYSTEM_INTERMEASUREMENT_PERIOD	0x04
+#define VL53L0X_SYSTEM_INTERRUPT_CONFIG_GPIO	0x0A
+#define VL53L0X_SYSTEM_INTERRUPT_CLEAR		0x0B
+#define VL53L0X_RESULT_INTERRUPT_STATUS		0x13
+#define VL53L0X_FINAL_RANGE_MIN_COUNT_RATE_RTN_LIMIT	0x44
+#define VL53L0X_MSRC_CONFIG_TIMEOUT_MACROP	0x46
+#define VL53L0X_PRE_RANGE_CONFIG_VCSEL_PERIOD	0x50
+#define VL53L0X_PRE_RANGE_CONFIG_TIMEOUT_MACROP_HI	0x51
+#define VL53L0X_FINAL_RANGE_CONFIG_VCSEL_PERIOD	0x70
+#define VL53L0X_FINAL_RANGE_CONFIG_TIMEOUT_MACROP_HI	0x71
+#define VL53L0X_OSC_CALIBRATE_VAL			0xF8
+
+#define VL53L0X_SYSRANGE_STOP				0x01
+#define VL53L0X_SYSRANGE_MODE_TIMED			0x04
+#define VL53L0X_INTERRUPT_NEW_SAMPLE_READY	0x04
+#define VL53L0X_INTERRUPT_STATUS_MASK		0x07
+
+/** Offsets in the burst read starting at RESULT_INTERRUPT_STATUS */
+#define RESULT_INTERRUPT_STATUS_OFFSET		0
+#define RESULT_RANGE_STATUS_OFFSET			1
+#define RESULT_SIGNAL_RATE_OFFSET			7
+#define RESULT_AMBIENT_RATE_OFFSET			9
+#define RESULT_DISTANCE_OFFSET				11
+
+/** Timing budget overheads of the sequence steps (us), from the ST API */
+#define BUDGET_START_OVERHEAD_US			1910
+#define BUDGET_END_OVERHEAD_US				960
+#define BUDGET_MSRC_OVERHEAD_US				660
+#define BUDGET_TCC_OVERHEAD_US				590
+#define BUDGET_DSS_OVERHEAD_US				690
+#define BUDGET_PRE_RANGE_OVERHEAD_US		660
+#define BUDGET_FINAL_RANGE_OVERHEAD_US		550
+#define BUDGET_MIN_US						20000
+
+#define SEQUENCE_TCC			(1 << 4)
+#define SEQUENCE_DSS			(1 << 3)
+#define SEQUENCE_MSRC			(1 << 2)
+#define SEQUENCE_PRE_RANGE		(1 << 6)
+#define SEQUENCE_FINAL_RANGE	(1 << 7)
+
+typedef struct {
+	uint32_t timing_budget_us;
+	uint16_t signal_rate_limit;		/** MCPS, 9.7 fixed point */
+} profile_entry_t;
+
+static const profile_entry_t profile_table[VL53L0X_PROFILE_COUNT] = {
+	{ 33000, 32 },		// 0.25 MCPS
+	{ 20000, 32 },
+	{ 200000, 32 },
+};
+
+/** Macro period in ns for a VCSEL period in PCLKs */
+static uint32_t macro_period_ns(uint8_t vcsel_period_pclks) {
+	return ((2304UL * vcsel_period_pclks * 1655UL) + 500) / 1000;
+}
+
+static uint32_t mclks_to_us(uint32_t mclks, uint8_t vcsel_period_pclks) {
+	uint32_t period_ns = macro_period_ns(vcsel_period_pclks);
+	return ((mclks * period_ns) + 500) / 1000;
+}
+
+static uint32_t us_to_mclks(uint32_t us, uint8_t vcsel_period_pclks) {
+	uint32_t period_ns = macro_period_ns(vcsel_period_pclks);
+	return ((us * 1000) + (period_ns / 2)) / period_ns;
+}
+
+/** Timeout registers hold (LSB + 1) << MSB */
+static uint32_t decode_timeout(uint16_t value) {
+	return ((uint32_t) (value & 0xFF) << (value >> 8)) + 1;
+}
+
+static uint16_t encode_timeout(uint32_t mclks) {
+	if(mclks == 0) {
+		return 0;
+	}
+	uint32_t lsb = mclks - 1;
+	uint16_t msb = 0;
+	while(lsb > 0xFF) {
+		lsb >>= 1;
+		msb++;
+	}
+	return (uint16_t) ((msb << 8) | lsb);
+}
+
+static uint8_t decode_vcsel_period(uint8_t value) {
+	return (uint8_t) ((value + 1) << 1);
+}
+
+static uint16_t be16(const uint8_t* p) {
+	return (uint16_t) ((p[0] << 8) | p[1]);
+}
+
+VL53L0XRanging::VL53L0XRanging(I2CBus& bus, I2CTransactionEngine& engine,
+		events::EventQueue& queue, uint8_t address) :
+	bus(bus), engine(engine), queue(queue), address(address), range_sink(),
+	profile(VL53L0X_PROFILE_DEFAULT), ranging(false), period_ms(0), stop_variable(0),
+	read_pending(false), retries_left(0), result_raw(), measurements(0), misses(0), errors(0) {
+}
+
+uint32_t VL53L0XRanging::get_timing_budget_us(void) const {
+	return profile_table[profile].timing_budget_us;
+}
+
+int VL53L0XRanging::retry_interval_ms(void) const {
+	int interval_ms = (int) (get_timing_budget_us() / 1000 / VL53L0X_RANGING_RETRIES);
+	return (interval_ms < VL53L0X_RANGING_MIN_RETRY_MS)? VL53L0X_RANGING_MIN_RETRY_MS : interval_ms;
+}
+
+const char* VL53L0XRanging::get_profile_name(vl53l0x_profile_t profile) {
+	switch(profile) {
+	case VL53L0X_PROFILE_DEFAULT:
+		return "default";
+	case VL53L0X_PROFILE_HIGH_SPEED:
+		return "high speed";
+	case VL53L0X_PROFILE_HIGH_ACCURACY:
+		return "high accuracy";
+	default:
+		return "unknown";
+	}
+}
+
+uint8_t VL53L0XRanging::decode_range_status(uint8_t result_range_status) {
+	switch((result_range_status & 0x78) >> 3) {
+	case 11:
+		return VL53L0X_RANGE_VALID;
+	case 1:
+	case 2:
+	case 3:
+		return VL53L0X_RANGE_HARDWARE_FAIL;
+	case 4:
+		return VL53L0X_RANGE_SIGNAL_FAIL;
+	case 6:
+	case 9:
+		return VL53L0X_RANGE_PHASE_FAIL;
+	case 8:
+	case 10:
+		return VL53L0X_RANGE_MIN_RANGE_FAIL;
+	default:
+		return VL53L0X_RANGE_NO_UPDATE;
+	}
+}
+
+bool VL53L0XRanging::configure(vl53l0x_profile_t profile) {
+	if(profile >= VL53L0X_PROFILE_COUNT) {
+		return false;
+	}
+
+	bool was_ranging = ranging;
+	if(was_ranging && !stop()) {
+		return false;
+	}
+
+	bus.lock();
+	bool ok = read_stop_variable();
+	ok = ok && write8(VL53L0X_SYSTEM_INTERRUPT_CONFIG_GPIO, VL53L0X_INTERRUPT_NEW_SAMPLE_READY);
+	ok = ok && write16(VL53L0X_FINAL_RANGE_MIN_COUNT_RATE_RTN_LIMIT,
+			profile_table[profile].signal_rate_limit);
+	ok = ok && set_timing_budget(profile_table[profile].timing_budget_us);
+	bus.unlock();
+
+	if(!ok) {
+		errors++;
+		return false;
+	}
+
+	this->profile = profile;
+	if(was_ranging) {
+		return start(period_ms);
+	}
+	return true;
+}
+
+bool VL53L0XRanging::start(uint32_t period_ms) {
+	uint32_t min_period_ms = (get_timing_budget_us() + 999) / 1000;
+	if(period_ms < min_period_ms) {
+		period_ms = min_period_ms;
+	}
+
+	if(ranging && !stop()) {
+		return false;
+	}
+
+	bus.lock();
+	uint8_t osc_raw[2];
+	bool ok = write8(0x80, 0x01) && write8(0xFF, 0x01) && write8(0x00, 0x00) &&
+			write8(0x91, stop_variable) && write8(0x00, 0x01) && write8(0xFF, 0x00) &&
+			write8(0x80, 0x00);
+	ok = ok && read(VL53L0X_OSC_CALIBRATE_VAL, osc_raw, sizeof(osc_raw));
+
+	// The period counts oscillator ticks once the oscillator is calibrated
+	uint32_t osc_calibrate = be16(osc_raw);
+	uint32_t period = (osc_calibrate != 0)? period_ms * osc_calibrate : period_ms;
+	ok = ok && write32(VL53L0X_SYSTEM_INTERMEASUREMENT_PERIOD, period);
+	ok = ok && write8(VL53L0X_SYSTEM_INTERRUPT_CLEAR, 0x01);
+	ok = ok && write8(VL53L0X_SYSRANGE_START, VL53L0X_SYSRANGE_MODE_TIMED);
+	bus.unlock();
+
+	if(!ok) {
+		errors++;
+		ranging = false;
+		return false;
+	}
+
+	this->period_ms = period_ms;
+	ranging = true;
+	return true;
+}
+
+bool VL53L0XRanging::stop(void) {
+	ranging = false;
+
+	bus.lock();
+	bool ok = write8(VL53L0X_SYSRANGE_START, VL53L0X_SYSRANGE_STOP) && write8(0xFF, 0x01) &&
+			write8(0x00, 0x00) && write8(0x91, 0x00) && write8(0x00, 0x01) && write8(0xFF, 0x00);
+	bus.unlock();
+
+	if(!ok) {
+		errors++;
+	}
+	return ok;
+}
+
+bool VL53L0XRanging::restore(void) {
+	// The part was reset, it is not ranging whatever we think
+	bool was_ranging = ranging;
+	ranging = false;
+	if(!configure(profile)) {
+		return false;
+	}
+	return !was_ranging || start(period_ms);
+}
+
+void VL53L0XRanging::poll(void) {
+	if(!ranging || read_pending || retries_left > 0) {
+		// Still waiting for the previous measurement
+		return;
+	}
+
+	retries_left = VL53L0X_RANGING_RETRIES;
+	read_result();
+}
+
+void VL53L0XRanging::read_result(void) {
+	read_pending = engine.read_registers(address, VL53L0X_RESULT_INTERRUPT_STATUS, result_raw,
+			sizeof(result_raw), &queue, mbed::callback(this, &VL53L0XRanging::on_result_read));
+	if(!read_pending) {
+		// Engine queue is full, the next poll tries again
+		retries_left = 0;
+		errors++;
+	}
+}
+
+void VL53L0XRanging::on_result_read(i2c_transaction_result_t result) {
+	read_pending = false;
+	if(result.status != 0) {
+		retries_left = 0;
+		errors++;
+		return;
+	}
+
+	if((result_raw[RESULT_INTERRUPT_STATUS_OFFSET] & VL53L0X_INTERRUPT_STATUS_MASK) == 0) {
+		if(ranging && --retries_left > 0) {
+			queue.call_in(retry_interval_ms(), mbed::callback(this, &VL53L0XRanging::read_result));
+		} else {
+			retries_left = 0;
+			misses++;
+		}
+		return;
+	}
+	retries_left = 0;
+
+	// Re-arms the data-ready status for the next measurement
+	engine.write_register(address, VL53L0X_SYSTEM_INTERRUPT_CLEAR, 0x01);
+
+	vl53l0x_range_t range;
+	range.status = decode_range_status(result_raw[RESULT_RANGE_STATUS_OFFSET]);
+	range.signal_rate = be16(&result_raw[RESULT_SIGNAL_RATE_OFFSET]);
+	range.ambient_rate = be16(&result_raw[RESULT_AMBIENT_RATE_OFFSET]);
+	range.distance_mm = be16(&result_raw[RESULT_DISTANCE_OFFSET]);
+	measurements++;
+
+	if(range_sink) {
+		range_sink(range);
+	}
+}
+
+bool VL53L0XRanging::set_timing_budget(uint32_t budget_us) {
+	if(budget_us < BUDGET_MIN_US) {
+		return false;
+	}
+
+	uint8_t sequence;
+	uint8_t pre_range_vcsel_raw;
+	uint8_t final_range_vcsel_raw;
+	uint8_t msrc_raw;
+	uint8_t pre_range_raw[2];
+	if(!read(VL53L0X_SYSTEM_SEQUENCE_CONFIG, &sequence, 1) ||
+	   !read(VL53L0X_PRE_RANGE_CONFIG_VCSEL_PERIOD, &pre_range_vcsel_raw, 1) ||
+	   !read(VL53L0X_FINAL_RANGE_CONFIG_VCSEL_PERIOD, &final_range_vcsel_raw, 1) ||
+	   !read(VL53L0X_MSRC_CONFIG_TIMEOUT_MACROP, &msrc_raw, 1) ||
+	   !read(VL53L0X_PRE_RANGE_CONFIG_TIMEOUT_MACROP_HI, pre_range_raw, sizeof(pre_range_raw))) {
+		return false;
+	}
+
+	uint8_t pre_range_vcsel = decode_vcsel_period(pre_range_vcsel_raw);
+	uint8_t final_range_vcsel = decode_vcsel_period(final_range_vcsel_raw);
+	uint32_t msrc_us = mclks_to_us(msrc_raw + 1, pre_range_vcsel);
+	uint32_t pre_range_mclks = decode_timeout(be16(pre_range_raw));
+	uint32_t pre_range_us = mclks_to_us(pre_range_mclks, pre_range_vcsel);
+
+	// Whatever the other sequence steps leave of the budget goes to the final range
+	uint32_t used_us = BUDGET_START_OVERHEAD_US + BUDGET_END_OVERHEAD_US +
+			BUDGET_FINAL_RANGE_OVERHEAD_US;
+	if(sequence & SEQUENCE_TCC) {
+		used_us += msrc_us + BUDGET_TCC_OVERHEAD_US;
+	}
+	if(sequence & SEQUENCE_DSS) {
+		used_us += 2 * (msrc_us + BUDGET_DSS_OVERHEAD_US);
+	} else if(sequence & SEQUENCE_MSRC) {
+		used_us += msrc_us + BUDGET_MSRC_OVERHEAD_US;
+	}
+	if(sequence & SEQUENCE_PRE_RANGE) {
+		used_us += pre_range_us + BUDGET_PRE_RANGE_OVERHEAD_US;
+	}
+	if(!(sequence & SEQUENCE_FINAL_RANGE) || used_us > budget_us) {
+		return false;
+	}
+
+	uint32_t final_range_mclks = us_to_mclks(budget_us - used_us, final_range_vcsel);
+	if(sequence & SEQUENCE_PRE_RANGE) {
+		// The final range timeout includes the pre-range
+		final_range_mclks += pre_range_mclks;
+	}
+	return write16(VL53L0X_FINAL_RANGE_CONFIG_TIMEOUT_MACROP_HI, encode_timeout(final_range_mclks));
+}
+
+bool VL53L0XRanging::read_stop_variable(void) {
+	return write8(0x80, 0x01) && write8(0xFF, 0x01) && write8(0x00, 0x00) &&
+			read(0x91, &stop_variable, 1) && write8(0x00, 0x01) && write8(0xFF, 0x00) &&
+			write8(0x80, 0x00);
+}
+
+bool VL53L0XRanging::read(uint8_t reg, uint8_t* rx, size_t len) {
+	return bus.transfer(address, &reg, 1, rx, len) == 0;
+}
+
+bool VL53L0XRanging::write(uint8_t reg, const uint8_t* data, size_t len) {
+	uint8_t tx[5];
+	tx[0] = reg;
+	for(size_t i = 0; i < len; i++) {
+		tx[1 + i] = data[i];
+	}
+	return bus.transfer(address, tx, 1 + len, NULL, 0) == 0;
+}
+
+bool VL53L0XRanging::write8(uint8_t reg, uint8_t value) {
+	return write(reg, &value, 1);
+}
+
+bool VL53L0XRanging::write16(uint8_t reg, uint16_t value) {
+	uint8_t data[2] = { (uint8_t) (value >> 8), (uint8_t) value };
+	return write(reg, data, sizeof(data));
+}
+
+bool VL53L0XRanging::write32(uint8_t reg, uint32_t value) {
+	uint8_t data[4] = { (uint8_t) (value >> 24), (uint8_t) (value >> 16),
+			(uint8_t) (value >> 8), (uint8_t) value };
+	return write(reg, data, sizeof(data));
+}
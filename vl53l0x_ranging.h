@@ -0,0 +1,186 @@
+/*
+ * vl53l0x_ranging.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef VL53L0X_RANGING_H_
+#define VL53L0X_RANGING_H_
+
+#include <stdint.h>
+
+#include "events/EventQueue.h"
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+#include "i2c_bus.h"
+#include "i2c_transaction_engine.h"
+
+/** Data-ready checks a poll spreads over one timing budget before giving up */
+#define VL53L0X_RANGING_RETRIES			8
+#define VL53L0X_RANGING_MIN_RETRY_MS	2
+
+/** Distances the VL53L0X reports when no target was found */
+#define VL53L0X_RANGING_MAX_DISTANCE_MM	8190
+
+typedef enum {
+	VL53L0X_PROFILE_DEFAULT = 0,	/** 33 ms timing budget */
+	VL53L0X_PROFILE_HIGH_SPEED,		/** 20 ms, the shortest, noisier at range */
+	VL53L0X_PROFILE_HIGH_ACCURACY,	/** 200 ms */
+	VL53L0X_PROFILE_COUNT
+} vl53l0x_profile_t;
+
+/** Range status, numbered like VL53L0X_RangingMeasurementData_t::RangeStatus of the ST API */
+typedef enum {
+	VL53L0X_RANGE_VALID = 0,
+	VL53L0X_RANGE_SIGNAL_FAIL = 2,		/** Return signal too weak */
+	VL53L0X_RANGE_MIN_RANGE_FAIL = 3,	/** Target closer than the minimum range */
+	VL53L0X_RANGE_PHASE_FAIL = 4,		/** Target beyond the maximum range (wrap around) */
+	VL53L0X_RANGE_HARDWARE_FAIL = 5,	/** VCSEL or VHV failure */
+	VL53L0X_RANGE_NO_UPDATE = 255,
+} vl53l0x_range_status_t;
+
+typedef struct {
+	uint16_t distance_mm;
+	uint8_t status;			/** vl53l0x_range_status_t */
+	uint16_t signal_rate;	/** Return signal rate, MCPS in 9.7 fixed point */
+	uint16_t ambient_rate;	/** Ambient light rate, MCPS in 9.7 fixed point */
+} vl53l0x_range_t;
+
+/**
+ * Timed continuous ranging on the VL53L0X without blocking the sensor thread
+ *
+ * The driver's get_distance() runs a single-shot measurement and waits
+ * through the whole timing budget. Instead the part ranges on its own
+ * inter-measurement period and poll() only queues one burst read of the
+ * interrupt status and the result registers on the I2C engine. A result
+ * that is not there yet is checked again from the event queue, at most
+ * VL53L0X_RANGING_RETRIES times over one timing budget.
+ *
+ * configure(), start() and stop() talk to the part directly and hold the
+ * bus for a few transfers (the register page switches must not interleave
+ * with other accesses). They only run on mode changes, after the driver's
+ * init_sensor() has done the reference and SPAD calibration.
+ *
+ * All methods and callbacks run on the sensor thread.
+ */
+class VL53L0XRanging : private mbed::NonCopyable<VL53L0XRanging> {
+public:
+
+	/** A new measurement was read */
+	typedef mbed::Callback<void(const vl53l0x_range_t&)> range_sink_t;
+
+	/**
+	 * @param[in] bus Bus the engine runs on, for the blocking configuration
+	 * @param[in] engine I2C transaction engine shared with the other sensors
+	 * @param[in] queue Event queue of the sensor thread
+	 * @param[in] address 8-bit address of the VL53L0X
+	 */
+	VL53L0XRanging(I2CBus& bus, I2CTransactionEngine& engine, events::EventQueue& queue,
+			uint8_t address);
+
+	void set_range_sink(range_sink_t sink) {
+		range_sink = sink;
+	}
+
+	/**
+	 * Apply the timing budget and signal rate limit of a profile
+	 *
+	 * Ranging restarts with the same period if it was running.
+	 * @retval false on a bus error
+	 */
+	bool configure(vl53l0x_profile_t profile);
+
+	vl53l0x_profile_t get_profile(void) const {
+		return profile;
+	}
+
+	uint32_t get_timing_budget_us(void) const;
+
+	/**
+	 * Start ranging every period_ms (at least the timing budget), restarts if already ranging
+	 * @retval false on a bus error
+	 */
+	bool start(uint32_t period_ms);
+
+	bool stop(void);
+
+	/** Apply the profile and period again after the part was reset (eg: power cycled) */
+	bool restore(void);
+
+	bool is_ranging(void) const {
+		return ranging;
+	}
+
+	uint32_t get_period_ms(void) const {
+		return period_ms;
+	}
+
+	/** Read the latest measurement if there is one, never blocks */
+	void poll(void);
+
+	uint32_t get_measurements(void) const {
+		return measurements;
+	}
+
+	/** Polls that gave up waiting, the next poll catches the measurement */
+	uint32_t get_misses(void) const {
+		return misses;
+	}
+
+	uint32_t get_errors(void) const {
+		return errors;
+	}
+
+	static const char* get_profile_name(vl53l0x_profile_t profile);
+
+	/** Range status from the device status field of RESULT_RANGE_STATUS */
+	static uint8_t decode_range_status(uint8_t result_range_status);
+
+private:
+
+	int retry_interval_ms(void) const;
+
+	void read_result(void);
+
+	void on_result_read(i2c_transaction_result_t result);
+
+	bool set_timing_budget(uint32_t budget_us);
+
+	/** Blocking register access, the bus must be locked */
+	bool read(uint8_t reg, uint8_t* rx, size_t len);
+
+	bool write(uint8_t reg, const uint8_t* data, size_t len);
+
+	bool write8(uint8_t reg, uint8_t value);
+
+	bool write16(uint8_t reg, uint16_t value);
+
+	bool write32(uint8_t reg, uint32_t value);
+
+	/** Load the stop variable the start/stop sequences restore */
+	bool read_stop_variable(void);
+
+	I2CBus& bus;
+	I2CTransactionEngine& engine;
+	events::EventQueue& queue;
+	uint8_t address;
+	range_sink_t range_sink;
+
+	vl53l0x_profile_t profile;
+	bool ranging;
+	uint32_t period_ms;
+	uint8_t stop_variable;
+
+	/** Poll state */
+	bool read_pending;
+	int retries_left;
+	uint8_t result_raw[13];
+
+	uint32_t measurements;
+	uint32_t misses;
+	uint32_t errors;
+
+};
+
+#endif /* VL53L0X_RANGING_H_ */
@@ -0,0 +1,87 @@
+/*
+ * vl53l0x_ranging_service.cpp
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "vl53l0x_ranging_service.h"
+
+#include <string.h>
+
+static void put_u16(uint8_t* p, uint16_t value) {
+	p[0] = (uint8_t) (value & 0xFF);
+	p[1] = (uint8_t) (value >> 8);
+}
+
+/** 9.7 fixed point MCPS to 0.01 MCPS, cannot overflow 16 bits */
+static uint16_t centi_mcps(uint16_t rate_9_7) {
+	return (uint16_t) (((uint32_t) rate_9_7 * 100 + 64) / 128);
+}
+
+VL53L0XRangingService::VL53L0XRangingService(events::EventQueue& queue) :
+	queue(queue),
+	ble(NULL),
+	ranging_value(),
+	ranging_char(UUID(VL53L0X_RANGING_CHAR_UUID), ranging_value,
+			GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY),
+	values(),
+	update_scheduled(false),
+	updates(0) {
+	// No measurement yet
+	put_u16(&ranging_value[0], 0xFFFF);
+	ranging_value[2] = VL53L0X_RANGE_NO_UPDATE;
+}
+
+void VL53L0XRangingService::start(BLE& ble) {
+	this->ble = &ble;
+
+	GattCharacteristic* chars[] = { &ranging_char };
+	GattService service(UUID(VL53L0X_RANGING_SERVICE_UUID), chars, sizeof(chars) / sizeof(chars[0]));
+
+	ble.gattServer().addService(service);
+
+	// Results measured before the service existed
+	update();
+}
+
+bool VL53L0XRangingService::set_range(const vl53l0x_range_t& range, uint16_t distance_mm,
+		vl53l0x_profile_t profile) {
+	vl53l0x_ranging_value_t value;
+	put_u16(&value.data[0], distance_mm);
+	value.data[2] = range.status;
+	value.data[3] = (uint8_t) profile;
+	put_u16(&value.data[4], centi_mcps(range.signal_rate));
+	put_u16(&value.data[6], centi_mcps(range.ambient_rate));
+	if(!values.push(value)) {
+		return false;
+	}
+
+	if(!update_scheduled.exchange(true)) {
+		if(queue.call(mbed::callback(this, &VL53L0XRangingService::update)) == 0) {
+			update_scheduled.store(false);
+		}
+	}
+	return true;
+}
+
+void VL53L0XRangingService::update(void) {
+	update_scheduled.store(false);
+
+	if(ble == NULL) {
+		// start() writes whatever has been measured by then
+		return;
+	}
+
+	vl53l0x_ranging_value_t value;
+	bool latest = false;
+	while(values.pop(value)) {
+		latest = true;
+	}
+	if(!latest) {
+		return;
+	}
+
+	memcpy(ranging_value, value.data, sizeof(ranging_value));
+	ble->gattServer().write(ranging_char.getValueHandle(), ranging_value, sizeof(ranging_value));
+	updates++;
+}
@@ -0,0 +1,92 @@
+/*
+ * vl53l0x_ranging_service.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef VL53L0X_RANGING_SERVICE_H_
+#define VL53L0X_RANGING_SERVICE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#include "ble/BLE.h"
+#include "ble/GattServer.h"
+#include "events/EventQueue.h"
+#include "platform/NonCopyable.h"
+
+#include "spsc_ring.h"
+#include "vl53l0x_ranging.h"
+
+#define VL53L0X_RANGING_SERVICE_UUID	"00000014-8dd4-4087-a16a-04a7c8e01734"
+#define VL53L0X_RANGING_CHAR_UUID		"00001014-8dd4-4087-a16a-04a7c8e01734"
+
+/**
+ * Ranging result (all fields little endian), 8 bytes:
+ *
+ *   [0:1]  distance, uint16 mm, 0xFFFF unless the range status is valid
+ *   [2]    range status (vl53l0x_range_status_t, 0 is valid)
+ *   [3]    vl53l0x_profile_t the result was measured with
+ *   [4:5]  return signal rate, uint16 0.01 MCPS
+ *   [6:7]  ambient rate, uint16 0.01 MCPS
+ */
+#define VL53L0X_RANGING_VALUE_SIZE		8
+
+/** Results buffered between the sensor thread and the BLE stack */
+#define VL53L0X_RANGING_QUEUE_DEPTH		2
+
+typedef struct {
+	uint8_t data[VL53L0X_RANGING_VALUE_SIZE];
+} vl53l0x_ranging_value_t;
+
+/**
+ * Range status and signal quality of the VL53L0X
+ *
+ * Completes the distance characteristic of VL53L0XService (which keeps
+ * carrying the distance alone) with why a measurement is not valid and
+ * how strong the return was. The characteristic is read and notify.
+ *
+ * Results are encoded on the sensor thread with set_range() and written
+ * to the characteristic from the BLE event queue, only the latest is notified.
+ */
+class VL53L0XRangingService : private mbed::NonCopyable<VL53L0XRangingService> {
+public:
+
+	VL53L0XRangingService(events::EventQueue& queue);
+
+	void start(BLE& ble);
+
+	/**
+	 * Producer side: encode a result and schedule its notification
+	 * @retval false if the queue is full and the result was dropped
+	 */
+	bool set_range(const vl53l0x_range_t& range, uint16_t distance_mm, vl53l0x_profile_t profile);
+
+	uint32_t get_updates(void) const {
+		return updates;
+	}
+
+	/** Results the BLE thread did not pick up in time */
+	uint32_t get_dropped(void) const {
+		return values.get_dropped();
+	}
+
+private:
+
+	/** Write the latest result to the characteristic, BLE thread */
+	void update(void);
+
+	events::EventQueue& queue;
+	BLE* ble;
+
+	uint8_t ranging_value[VL53L0X_RANGING_VALUE_SIZE];
+	ReadOnlyArrayGattCharacteristic<uint8_t, VL53L0X_RANGING_VALUE_SIZE> ranging_char;
+
+	SpscRing<vl53l0x_ranging_value_t, VL53L0X_RANGING_QUEUE_DEPTH> values;
+	std::atomic<bool> update_scheduled;
+	uint32_t updates;
+
+};
+
+#endif /* VL53L0X_RANGING_SERVICE_H_ */